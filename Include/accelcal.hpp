@@ -0,0 +1,85 @@
+/*
+ * accelcal.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_ACCELCAL_HPP_
+#define ZULS_INCLUDE_ACCELCAL_HPP_
+
+#include "icm20948.hpp"
+
+
+#define ACCELCAL_MAX_POSITIONS 24
+#define ACCELCAL_SAMPLES       500   // Samples per position (approx. 0.5s)
+#define ACCELCAL_MAX_STD_DEV   0.02  // Max. standard deviation [g] of a stationary position
+#define ACCELCAL_MIN_ALIGN     0.9   // Min. component [g] of the dominant axis (position must be axis-aligned)
+#define ACCELCAL_MAX_ROW_GAIN  1.99  // Max. L1 norm of a matrix row (keeps the fixed-point kernel within 32 bits)
+#define ACCELCAL_FRAC_BITS     14    // Matrix coefficients in Q14
+
+/* Orientation bits (axis pointing up) */
+#define ACCELCAL_POS_X  0x01
+#define ACCELCAL_NEG_X  0x02
+#define ACCELCAL_POS_Y  0x04
+#define ACCELCAL_NEG_Y  0x08
+#define ACCELCAL_POS_Z  0x10
+#define ACCELCAL_NEG_Z  0x20
+#define ACCELCAL_ALL    0x3F
+
+/* Calibration model: a = M * raw + b (raw and a in g). M combines scale factors and cross-axis coupling. */
+typedef struct
+{
+	float fMatrix[3][3];
+	float fBias[3];     // [g]
+	float fResidual;    // RMS fit residual [g]
+}ACCELCAL_Param_t;
+
+
+/* Six-position accelerometer calibration. The board is placed (at least) once in each of the six axis-aligned
+ * orientations. The reference of a position is the nearest axis (+-1g), the 12 parameters of M and b are solved
+ * by linear least squares. The correction is applied with a fixed-point kernel (Q14 matrix, 32-bit accumulators)
+ * to raw frame arrays, the output stays in raw counts of the selected full scale. */
+class ACCELCAL
+{
+public:
+	/* Constructor */
+	ACCELCAL(void);
+
+	/* Methods */
+	void reset(void);
+	int16_t capturePosition(ICM20948 *pICM20948, uint16_t ui16Samples = ACCELCAL_SAMPLES);
+	int16_t addPosition(ICM20948_fVector_t Mean, ICM20948_FullScale_t FullScale);
+	uint8_t getPositionCount(void);
+	uint8_t getMissingOrientations(void);
+
+	int16_t solve(void);
+	void getParameters(ACCELCAL_Param_t *pParam);
+	int16_t setParameters(const ACCELCAL_Param_t *pParam, ICM20948_FullScale_t FullScale);
+	int16_t setFullScale(ICM20948_FullScale_t FullScale);
+
+	void apply(ICM20948_Frame_t *pFrames, uint16_t ui16Count);
+	ICM20948_i16Vector_t apply(ICM20948_i16Vector_t Raw);
+
+
+private:
+	/* Variables */
+	ICM20948_fVector_t Position[ACCELCAL_MAX_POSITIONS]; // Stationary means [g]
+	uint8_t ui8Positions;
+	uint8_t ui8Orientations;
+
+	ACCELCAL_Param_t Param;
+	ICM20948_FullScale_t FullScale;
+
+	/* Fixed-point kernel for the selected full scale */
+	int16_t i16Matrix[3][3];
+	int32_t i32Bias[3]; // Bias in counts << ACCELCAL_FRAC_BITS, including the rounding constant
+
+	/* Methods */
+	uint8_t getOrientation(ICM20948_fVector_t Mean);
+	int16_t buildKernel(void);
+	inline int16_t saturate(int32_t i32Value);
+};
+
+
+#endif /* ZULS_INCLUDE_ACCELCAL_HPP_ */
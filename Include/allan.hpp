@@ -0,0 +1,86 @@
+/*
+ * allan.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_ALLAN_HPP_
+#define ZULS_INCLUDE_ALLAN_HPP_
+
+#include <stdint.h>
+
+
+#define ALLAN_MAX_CHANNELS    6     // Accel X/Y/Z + Gyro X/Y/Z
+#define ALLAN_MAX_OCTAVES     28    // Cluster times 2^0 ... 2^27 samples (approx. 33h at 1125Hz)
+#define ALLAN_DENSITY         8     // Stored points per cluster time (octaves with m <= ALLAN_DENSITY are fully overlapping)
+#define ALLAN_MIN_CLUSTERS    8     // Minimum number of independent clusters before an octave is evaluated
+
+constexpr uint16_t ALLAN_RING_SIZE = 2 * ALLAN_DENSITY + 1;
+
+/* sqrt(2 * ln(2) / pi), flicker floor of the Allan deviation (IEEE Std 952, Annex C) */
+constexpr float ALLAN_BIAS_INST_FACTOR = 0.664;
+
+typedef struct
+{
+	float    fTau;       // Cluster time [s]
+	float    fDeviation; // Allan deviation [unit of the input samples]
+	uint32_t ui32Count;  // Number of accumulated (overlapping) differences
+}ALLAN_Point_t;
+
+typedef struct
+{
+	float fRandomWalk;        // Angle/velocity random walk N [unit * s^0.5], read off the slope -1/2 at tau = 1s
+	float fBiasInstability;   // Bias instability B [unit], flicker floor divided by ALLAN_BIAS_INST_FACTOR
+	float fTauBiasInstability;// Cluster time of the flicker floor [s]
+	float fRateRandomWalk;    // Rate random walk K [unit / s^0.5], read off the slope +1/2 at tau = 3s
+}ALLAN_NoiseParam_t;
+
+
+/* Streaming overlapping Allan variance of stationary data.
+ * Every sample is integrated into theta(n) = tau0 * sum(y). For each octave-spaced cluster size m = 2^k
+ * the squared second difference theta(n) - 2*theta(n-m) + theta(n-2m) is accumulated in a single pass.
+ * Octaves with m <= ALLAN_DENSITY use every sample (fully overlapping), larger octaves use a stride of
+ * m / ALLAN_DENSITY, so memory stays bounded (ALLAN_RING_SIZE points per octave and channel) for arbitrarily
+ * long captures. */
+class ALLAN
+{
+public:
+	/* Constructor */
+	ALLAN(float fSampleRate, uint8_t ui8Channels = ALLAN_MAX_CHANNELS);
+
+	/* Methods */
+	void reset(void);
+	void addSample(const float *pSample); // ui8Channels values per call
+
+	uint64_t getSampleCount(void);
+	uint8_t  getOctaveCount(void);
+	int16_t  getPoint(uint8_t ui8Channel, uint8_t ui8Octave, ALLAN_Point_t *pPoint);
+	int16_t  getDeviationAt(uint8_t ui8Channel, float fTau, float *pDeviation);
+	int16_t  getNoiseParameters(uint8_t ui8Channel, ALLAN_NoiseParam_t *pParam);
+
+
+private:
+	/* Variables */
+	float   fSampleRate;
+	uint8_t ui8Channels;
+
+	uint64_t ui64Samples;
+	float    fFirstSample[ALLAN_MAX_CHANNELS]; // Subtracted from all samples to keep theta small
+	double   dTheta[ALLAN_MAX_CHANNELS];
+
+	double   dRing[ALLAN_MAX_OCTAVES][ALLAN_MAX_CHANNELS][ALLAN_RING_SIZE];
+	uint16_t ui16Head[ALLAN_MAX_OCTAVES];
+	uint16_t ui16Fill[ALLAN_MAX_OCTAVES];
+
+	double   dSum[ALLAN_MAX_OCTAVES][ALLAN_MAX_CHANNELS];
+	uint32_t ui32Count[ALLAN_MAX_OCTAVES];
+
+	/* Methods */
+	inline uint32_t getStride(uint8_t ui8Octave);
+	inline uint16_t getDistance(uint8_t ui8Octave);
+	float getSlope(uint8_t ui8Channel, uint8_t ui8Octave);
+};
+
+
+#endif /* ZULS_INCLUDE_ALLAN_HPP_ */
@@ -0,0 +1,62 @@
+/*
+ * autorange.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_AUTORANGE_HPP_
+#define ZULS_INCLUDE_AUTORANGE_HPP_
+
+#include "icm20948.hpp"
+
+
+typedef struct
+{
+	bool     boAccel;          // Auto-ranging of the accelerometer
+	bool     boGyro;           // Auto-ranging of the gyroscope
+	int16_t  i16UpThreshold;   // Max. |raw| >= i16UpThreshold: next higher range (clipped samples: two ranges up)
+	int16_t  i16DownThreshold; // Max. |raw| <  i16DownThreshold for ui16DownHold samples: next lower range.
+	                           // Must be below i16UpThreshold / 2, otherwise the ranges toggle
+	uint16_t ui16DownHold;
+	uint8_t  ui8AccelMin;      // Allowed ranges as index: 0 = 2g ... 3 = 16g
+	uint8_t  ui8AccelMax;
+	uint8_t  ui8GyroMin;       // 0 = 250dps ... 3 = 2000dps
+	uint8_t  ui8GyroMax;
+}AUTORANGE_Config_t;
+
+/* Up at 90%, down below 40% of the range for approx. 1s at 1125Hz */
+constexpr AUTORANGE_Config_t AUTORANGE_DEFAULT_CONFIG = {true, true, 29491, 13107, 1125, 0, 3, 0, 3};
+
+
+/* Automatic full scale switching. The range in force is taken from ui8Range of each frame, so manual
+ * changes are followed as well. Frames of an outdated configuration epoch (still in the FIFO after a
+ * switch) and transitional frames (ICM20948_FRAME_TRANSITION) are not evaluated. A switch is a single register write (see ICM20948::changeShadowRegister8()). */
+class AUTORANGE
+{
+public:
+	/* Constructor */
+	AUTORANGE(ICM20948 *pICM20948, const AUTORANGE_Config_t *pConfig = &AUTORANGE_DEFAULT_CONFIG);
+
+	/* Methods */
+	int16_t init(const AUTORANGE_Config_t *pConfig);
+	int16_t process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count);
+	uint32_t getSwitchCount(void);
+
+
+private:
+	/* Variables */
+	ICM20948 *pICM20948;
+	AUTORANGE_Config_t Config;
+
+	uint16_t ui16AccelHold;
+	uint16_t ui16GyroHold;
+	uint32_t ui32Switches;
+
+	/* Methods */
+	inline int32_t getPeak(const ICM20948_i16Vector_t *pVector);
+	int8_t getStep(int32_t i32Peak, uint8_t ui8Index, uint8_t ui8Min, uint8_t ui8Max, uint16_t *pHold);
+};
+
+
+#endif /* ZULS_INCLUDE_AUTORANGE_HPP_ */
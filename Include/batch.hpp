@@ -0,0 +1,96 @@
+/*
+ * batch.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_BATCH_HPP_
+#define ZULS_INCLUDE_BATCH_HPP_
+
+#include "icm20948.hpp"
+
+#if defined (ICM20948_HOST)
+
+#include <atomic>
+#include <vector>
+
+#include "decimator.hpp"
+
+
+#define BATCH_CHUNK_SIZE  65536 // Default number of input frames per chunk
+
+/* Processing step of a batch job. Every chunk gets its own state (ui32StateSize bytes), initialized with pInit()
+ * and first fed with the ui32Warmup frames before the chunk (outputs discarded), so stateful filters start the
+ * chunk in the same state as in a sequential run. ui32Alignment is the decimation of the step: chunk
+ * boundaries and the warm-up are multiples of it, the output phase does not depend on the chunking. */
+typedef struct
+{
+	const void *pContext;      // Parameters of the job (shared, read-only)
+	uint32_t    ui32StateSize;
+	uint32_t    ui32Warmup;    // [input frames]
+	uint32_t    ui32Alignment; // [input frames], >= 1
+	int16_t  (*pInit)(void *pState, const void *pContext);
+	uint32_t (*pProcess)(void *pState, const ICM20948_Frame_t *pIn, uint32_t ui32Count, ICM20948_Frame_t *pOut);
+	void     (*pMerge)(void *pResult, const void *pState); // Optional, called in chunk order after the run
+	void     (*pRelease)(void *pState);                    // Optional
+}BATCH_Kernel_t;
+
+/* Result of BATCH::getMeanKernel() */
+typedef struct
+{
+	int64_t  i64AccelSum[3];
+	int64_t  i64GyroSum[3];
+	int64_t  i64TempSum;
+	uint64_t ui64Count;
+}BATCH_Mean_t;
+
+
+/* Host-side batch engine for large frame archives (calibration, filtering and fusion with many parameter
+ * sets). The archive is split into chunks that are processed by a pool of threads. Every worker owns a
+ * contiguous range of chunks and takes them from the front, an idle worker steals the back half of the largest
+ * remaining range. The outputs of a chunk are written behind its input position and compacted in chunk order,
+ * the states are merged in chunk order: the result does not depend on the number of threads or the timing. */
+class BATCH
+{
+public:
+	/* Constructor */
+	BATCH(uint16_t ui16Threads = 0, uint32_t ui32ChunkSize = BATCH_CHUNK_SIZE); // 0: one thread per core
+
+	/* Methods */
+	int16_t run(const BATCH_Kernel_t *pKernel, const ICM20948_Frame_t *pIn, uint64_t ui64Count,
+			    ICM20948_Frame_t *pOut, uint64_t *pOutCount, void *pResult = NULL);
+	uint32_t getStealCount(void);
+
+	static BATCH_Kernel_t getDecimatorKernel(const DECIMATOR_Config_t *pConfig);
+	static BATCH_Kernel_t getMeanKernel(void);
+
+
+private:
+	/* Variables */
+	uint16_t ui16Threads;
+	uint32_t ui32ChunkSize;
+	std::atomic<uint32_t> ui32Steals;
+
+	/* Job */
+	const BATCH_Kernel_t   *pKernel;
+	const ICM20948_Frame_t *pIn;
+	ICM20948_Frame_t       *pOut;
+	uint64_t                ui64Count;
+	uint32_t                ui32Chunk;       // Chunk size of the job (multiple of the alignment)
+	uint32_t                ui32Warmup;
+	std::vector<uint8_t>    ui8States;
+	std::vector<uint64_t>   ui64OutCounts;
+	std::vector<int16_t>    i16Errors;
+	std::vector<std::atomic<uint64_t>> ui64Ranges; // Chunks of a worker: first (bits 32...63) and end (bits 0...31)
+
+	/* Methods */
+	void work(uint16_t ui16Worker);
+	bool takeChunk(uint16_t ui16Worker, uint32_t *pChunk);
+	bool stealRange(uint16_t ui16Worker);
+	void processChunk(uint32_t ui32Chunk);
+};
+
+#endif /* ICM20948_HOST */
+
+#endif /* ZULS_INCLUDE_BATCH_HPP_ */
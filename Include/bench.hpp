@@ -0,0 +1,118 @@
+/*
+ * bench.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_BENCH_HPP_
+#define ZULS_INCLUDE_BENCH_HPP_
+
+#include "icm20948.hpp"
+
+#if defined (ICM20948_HOST)
+
+#include <stdio.h>
+
+#include "convert.hpp"
+#include "decimator.hpp"
+#include "imusim.hpp"
+#include "motion.hpp"
+#include "seqframe.hpp"
+
+
+#ifndef BENCH_MAX_RESULTS
+	#define BENCH_MAX_RESULTS  48   // Results of one run (built-in and own cases)
+#endif
+#define BENCH_NAME_SIZE        32
+#define BENCH_TICK_CALLS       4    // Calls of BENCH::getTicks() per millisecond
+#define BENCH_FRAMES           16   // Frames per operation of the batch cases
+#define BENCH_ROUNDS           5    // Measurements of a case, the fastest one is reported
+
+constexpr double BENCH_DEFAULT_TOLERANCE = 0.20; // Allowed increase of ns/op against the baseline
+
+typedef struct
+{
+	char     cName[BENCH_NAME_SIZE];
+	uint32_t ui32Iterations;
+	double   dNsPerOp;
+	double   dTransactionsPerOp;
+	double   dBytesPerOp;            // Read and written
+}BENCH_Result_t;
+
+/* Device under test of a case: the driver on the register emulator (1125Hz, 2g, 250dps, full profile) */
+typedef struct
+{
+	ICM20948_MOCK    *pMock;
+	ICM20948         *pDevice;
+	CONVERT          *pConvert;
+	DECIMATOR        *pDecimator;               // 4500Hz -> 281.25Hz (CIC 3rd order / 4, FIR 32 taps / 4)
+	IMUSIM           *pSimulator;               // Stimulus of the signal processing cases
+	MOTION           *pMotion;
+	SEQFRAME         *pSeqframe;
+	uint8_t           ui8Sample[14];            // Data of ICM20948_MOCK::pushSample()
+	ICM20948_Frame_t  Frames[BENCH_FRAMES];
+	ICM20948_Frame_t  Outputs[BENCH_FRAMES];
+	ICM20948_fFrame_t fFrames[BENCH_FRAMES];
+	ICM20948_DmpPacket_t   Packets[BENCH_FRAMES];
+	ICM20948_RegSnapshot_t Snapshot;
+}BENCH_Target_t;
+
+/* One operation of a case (pRun()), pSetup() and pTeardown() are not measured */
+typedef struct
+{
+	const char *pName;
+	uint32_t    ui32Iterations;
+	int16_t   (*pSetup)(BENCH_Target_t *pTarget);     // Optional
+	int16_t   (*pRun)(BENCH_Target_t *pTarget);
+	int16_t   (*pTeardown)(BENCH_Target_t *pTarget);  // Optional
+}BENCH_Case_t;
+
+
+/* Host benchmarks of the driver hot paths, the signal processing and the CONVERT functions. Every case reports ns/op (steady clock,
+ * after a warm-up of a tenth of the iterations, fastest of BENCH_ROUNDS measurements against the noise of the
+ * host), bus transactions/op and bytes/op (counters of ICM20948_MOCK).
+ * The stimulus of a case (e.g. pushSample() before readLatest()) is part of the operation, it does not touch
+ * the bus counters. The delays of the driver need a deterministic time base, the application forwards it:
+ *     extern "C" uint32_t get_Ticks(void) {return BENCH::getTicks();}
+ * The results are written as CSV (writeResults()), a stored file is the baseline of compareBaseline():
+ * transactions and bytes are deterministic and must not increase, ns/op may increase by the tolerance, and every
+ * case of the baseline must still be measured. Test/bench_main.cpp is the runner of the host build. */
+class BENCH
+{
+public:
+	/* Constructor */
+	BENCH(void);
+
+	/* Methods */
+	uint16_t run(void);
+	int16_t runCase(const BENCH_Case_t *pCase);
+
+	uint16_t getResults(const BENCH_Result_t **ppResults);
+	void writeResults(FILE *pFile);
+	int16_t compareBaseline(FILE *pBaseline, double dTolerance = BENCH_DEFAULT_TOLERANCE, FILE *pReport = NULL);
+
+	static uint32_t getTicks(void);
+
+
+private:
+	/* Variables */
+	ICM20948_MOCK  Mock;
+	ICM20948       Device;
+	CONVERT        Convert;
+	DECIMATOR      Decimator;
+	IMUSIM         Simulator;
+	MOTION         Motion;
+	SEQFRAME       Seqframe;
+	BENCH_Target_t Target;
+
+	BENCH_Result_t Results[BENCH_MAX_RESULTS];
+	uint16_t       ui16Results;
+
+	/* Methods */
+	const BENCH_Result_t *findResult(const char *pName);
+};
+
+#endif /* ICM20948_HOST */
+
+#endif /* ZULS_INCLUDE_BENCH_HPP_ */
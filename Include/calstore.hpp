@@ -0,0 +1,111 @@
+/*
+ * calstore.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_CALSTORE_HPP_
+#define ZULS_INCLUDE_CALSTORE_HPP_
+
+#include "icm20948.hpp"
+
+
+/* Serialized calibration record (little endian, independent of the struct layout of the compiler):
+ *  0: Magic (uint32_t)        4: Version (uint16_t)     6: Record size (uint16_t)
+ *  8: AccelOffset (3 x int16_t)                        14: GyroOffset (3 x int16_t)
+ * 20: Temperature (int16_t)  22: Accel FS_SEL (uint8_t) 23: Gyro FS_SEL (uint8_t)
+ * 24: Accel divider (uint16_t)                         26: Gyro divider (uint8_t)
+ * 27: FCHOICE flags (bit 0: accel, bit 1: gyro)       28: Accel DLPF (uint8_t) 29: Gyro DLPF (uint8_t)
+ * 30: Mounting X, Y, Z (3 x uint8_t, ICM20948_AXIS_...) 33: Reserved (3 bytes)
+ * 36: CRC-32 of bytes 0...35 (uint32_t)
+ * Version 2: the unused scale factors of version 1 were removed, the mounting orientation was added. */
+constexpr uint32_t CALSTORE_MAGIC       = 0x4C414349; // "ICAL"
+constexpr uint16_t CALSTORE_VERSION     = 2;
+constexpr uint16_t CALSTORE_RECORD_SIZE = 40;
+
+typedef enum
+{
+	CALSTORE_RESTORED     =  0, // Stored record passed the quick check
+	CALSTORE_RECALIBRATED =  1, // Full calibration was executed and stored
+	CALSTORE_GEN_FAIL     = -1,
+	CALSTORE_CAL_FAIL     = -2  // Full calibration did not converge
+}CALSTORE_RetCode_t;
+
+
+/* Storage backend interface (not used in the sample path, therefore a virtual interface is fine) */
+class CALSTORE_BACKEND
+{
+public:
+	virtual ~CALSTORE_BACKEND(void) {}
+
+	virtual int16_t read(uint8_t *pData, uint16_t ui16Size) = 0;
+	virtual int16_t write(const uint8_t *pData, uint16_t ui16Size) = 0;
+};
+
+
+#if defined (STM32F411xE) || defined (STM32H743xx)
+/* Flash sector backend. The sector is used exclusively for the calibration record and is erased on each write.
+ * ui32Address must be the start address of sector ui8Sector (STM32H743: bank 1). */
+class CALSTORE_FLASH : public CALSTORE_BACKEND
+{
+public:
+	CALSTORE_FLASH(uint32_t ui32Address, uint8_t ui8Sector);
+
+	int16_t read(uint8_t *pData, uint16_t ui16Size);
+	int16_t write(const uint8_t *pData, uint16_t ui16Size);
+
+
+private:
+	uint32_t ui32Address;
+	uint8_t  ui8Sector;
+
+	int16_t waitReady(void);
+};
+#endif
+
+
+/* File backend (host) */
+class CALSTORE_FILE : public CALSTORE_BACKEND
+{
+public:
+	CALSTORE_FILE(const char *pPath);
+
+	int16_t read(uint8_t *pData, uint16_t ui16Size);
+	int16_t write(const uint8_t *pData, uint16_t ui16Size);
+
+
+private:
+	const char *pPath;
+};
+
+
+class CALSTORE
+{
+public:
+	/* Constructor */
+	CALSTORE(CALSTORE_BACKEND *pBackend);
+
+	/* Methods */
+	int16_t load(ICM20948_CalRecord_t *pRecord);
+	int16_t save(const ICM20948_CalRecord_t *pRecord);
+
+	CALSTORE_RetCode_t warmStart(ICM20948 *pICM20948);
+
+	void serialize(const ICM20948_CalRecord_t *pRecord, uint8_t *pBuffer);
+	int16_t deserialize(const uint8_t *pBuffer, ICM20948_CalRecord_t *pRecord);
+
+
+private:
+	/* Variables */
+	CALSTORE_BACKEND *pBackend;
+
+	/* Methods */
+	void putU16(uint8_t *pBuffer, uint16_t ui16Value);
+	void putU32(uint8_t *pBuffer, uint32_t ui32Value);
+	uint16_t getU16(const uint8_t *pBuffer);
+	uint32_t getU32(const uint8_t *pBuffer);
+};
+
+
+#endif /* ZULS_INCLUDE_CALSTORE_HPP_ */
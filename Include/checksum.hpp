@@ -0,0 +1,23 @@
+/*
+ * checksum.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_CHECKSUM_HPP_
+#define ZULS_INCLUDE_CHECKSUM_HPP_
+
+#include <stdint.h>
+
+
+/* Note: The class is not called CRC, because CMSIS defines CRC as the CRC peripheral of the STM32 */
+class CHECKSUM
+{
+public:
+	/* Methods */
+	uint32_t calcCRC32(const uint8_t *pData, uint32_t ui32Length, uint32_t ui32CRC = 0);
+};
+
+
+#endif /* ZULS_INCLUDE_CHECKSUM_HPP_ */
@@ -0,0 +1,81 @@
+/*
+ * decimator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_DECIMATOR_HPP_
+#define ZULS_INCLUDE_DECIMATOR_HPP_
+
+#include "icm20948.hpp"
+
+
+#define DECIMATOR_CHANNELS      6   // Accel X/Y/Z + Gyro X/Y/Z (temperature is passed through)
+#define DECIMATOR_MAX_CIC_ORDER 4
+#define DECIMATOR_MAX_CIC_SHIFT 16  // Bit growth ui8CicOrder * log2(ui8CicRate) must fit into 32 bits
+#define DECIMATOR_MAX_TAPS      64
+#define DECIMATOR_MIN_DESIGN    4   // Fewest taps of designFir(), the center tap of a shorter filter exceeds Q15
+
+typedef struct
+{
+	float          fInputRate;  // Rate of the FIFO frames [Hz], e.g. 1125 (equal accel and gyro rate)
+	uint8_t        ui8CicOrder; // 0: CIC stage bypassed (ui8CicRate must be 1), 1...4
+	uint8_t        ui8CicRate;  // Power of two
+	uint8_t        ui8FirRate;  // Decimation of the FIR stage
+	uint8_t        ui8FirTaps;  // 0: FIR stage bypassed (ui8FirRate must be 1), 1...DECIMATOR_MAX_TAPS
+	                            // (designed: DECIMATOR_MIN_DESIGN...DECIMATOR_MAX_TAPS)
+	const int16_t *pFirCoeffs;  // Q15 coefficients (ui8FirTaps values), NULL: designed with designFir()
+	float          fFirCutoff;  // Cutoff frequency [Hz] of the designed FIR filter (pFirCoeffs == NULL)
+}DECIMATOR_Config_t;
+
+
+/* Decimation of FIFO frames down to the control rate. The FIFO frames need equal accelerometer and gyroscope
+ * sample rates (ICM20948::enableFifo()), so the highest input rate of the FIFO path is 1125Hz. Cascade of a CIC decimator (integer only, wrapping 32-bit arithmetic) and a decimating FIR filter
+ * (Q15). The FIR output is only computed for every ui8FirRate-th input (equivalent to a polyphase structure), the
+ * delay line is stored twice so the dot product runs over a contiguous block (MAC/SIMD friendly, no modulo in the
+ * inner loop). After a change of the configuration epoch, the outputs are marked with ICM20948_FRAME_TRANSITION
+ * until the filter memory holds samples of the new epoch only. */
+class DECIMATOR
+{
+public:
+	/* Constructor */
+	DECIMATOR(void);
+
+	/* Methods */
+	int16_t init(const DECIMATOR_Config_t *pConfig);
+	void reset(void);
+	void process(const ICM20948_Frame_t *pIn, uint16_t ui16InCount, ICM20948_Frame_t *pOut, uint16_t *pOutCount);
+
+	float getOutputRate(void);
+	float getGroupDelay(void);
+	float getFrequencyResponse(float fFreq);
+
+	static int16_t designFir(uint8_t ui8Taps, float fCutoff, float fSampleRate, int16_t *pCoeffs);
+
+
+private:
+	/* Variables */
+	DECIMATOR_Config_t Config;
+	int16_t i16Coeffs[DECIMATOR_MAX_TAPS];
+	uint8_t ui8CicShift;
+
+	uint32_t ui32Integrator[DECIMATOR_CHANNELS][DECIMATOR_MAX_CIC_ORDER];
+	uint32_t ui32Comb[DECIMATOR_CHANNELS][DECIMATOR_MAX_CIC_ORDER];
+	uint8_t  ui8CicCount;
+
+	int16_t i16Delay[DECIMATOR_CHANNELS][2 * DECIMATOR_MAX_TAPS];
+	uint8_t ui8DelayIndex;
+	uint8_t ui8FirCount;
+
+	uint8_t  ui8Epoch;             // Configuration epoch of the last input frame
+	uint8_t  ui8Flags;             // Flags of the input frames since the last output
+	uint16_t ui16TransitionInputs; // Inputs until the filter memory holds a single epoch again
+
+	/* Methods */
+	inline bool processCic(const int16_t *pIn, int16_t *pOut);
+	inline bool processFir(const int16_t *pIn, int16_t *pOut);
+};
+
+
+#endif /* ZULS_INCLUDE_DECIMATOR_HPP_ */
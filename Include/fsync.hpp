@@ -0,0 +1,101 @@
+/*
+ * fsync.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_FSYNC_HPP_
+#define ZULS_INCLUDE_FSYNC_HPP_
+
+#include "icm20948.hpp"
+
+
+#ifndef FSYNC_MAX_WINDOW
+	#define FSYNC_MAX_WINDOW   64   // Max. frames of a window and length of the history (power of two)
+#endif
+#ifndef FSYNC_QUEUE_SIZE
+	#define FSYNC_QUEUE_SIZE   2    // Completed windows (power of two)
+#endif
+#define FSYNC_MAX_PENDING      4    // Triggers waiting for their frames after the trigger
+
+/* FSYNC_Window_t.ui8Flags */
+#define FSYNC_WINDOW_TRUNCATED     0x01 // Less than ui16Before frames before the trigger (start, reset())
+#define FSYNC_WINDOW_OVERLAP       0x02 // The window contains another trigger frame
+
+typedef struct
+{
+	uint32_t ui32SamplePeriod;  // [us] per frame (e.g. 889 at 1125Hz)
+	uint16_t ui16Before;        // Frames before the trigger frame
+	uint16_t ui16After;         // Frames after the trigger frame (ui16Before + 1 + ui16After <= FSYNC_MAX_WINDOW)
+}FSYNC_Config_t;
+
+constexpr FSYNC_Config_t FSYNC_DEFAULT_CONFIG = {889, 16, 16};
+
+typedef struct
+{
+	ICM20948_Frame_t Frame;
+	int32_t          i32Offset;  // [us] sample time relative to the FSYNC edge
+}FSYNC_Frame_t;
+
+typedef struct
+{
+	uint32_t ui32Trigger;        // Number of the trigger since reset() (starts with 1)
+	uint32_t ui32Sample;         // Sample number of the trigger frame since reset()
+	uint16_t ui16Delay;          // [us] FSYNC edge to the trigger frame (DELAY_TIME)
+	uint16_t ui16Frames;         // Valid entries of Frames[]
+	uint16_t ui16TriggerIndex;   // Index of the trigger frame in Frames[]
+	uint8_t  ui8Flags;           // FSYNC_WINDOW_...
+	FSYNC_Frame_t Frames[FSYNC_MAX_WINDOW];
+}FSYNC_Window_t;
+
+
+/* Sample windows bracketing external triggers (camera or LiDAR frame sync on the FSYNC pin, see
+ * ICM20948::setupFsync()). Every frame passed to process() is kept in a history of FSYNC_MAX_WINDOW frames.
+ * A frame marked with ICM20948_FRAME_FSYNC is the first sample after the FSYNC edge, DELAY_TIME is the time
+ * from the edge to this sample. ui16After frames later the window with ui16Before frames before and ui16After
+ * frames after the trigger frame is complete, each frame carries its offset to the edge:
+ *     offset = (sample - trigger sample) * ui32SamplePeriod + DELAY_TIME
+ * The windows are written into a single-producer single-consumer queue: process() may run in an interrupt or an
+ * acquisition thread, getWindow() in the application. A full queue drops new windows (getDropped()). */
+class FSYNC
+{
+public:
+	/* Constructor */
+	FSYNC(const FSYNC_Config_t *pConfig = &FSYNC_DEFAULT_CONFIG);
+
+	/* Methods */
+	int16_t init(const FSYNC_Config_t *pConfig);
+	void reset(void);
+	uint16_t process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, uint16_t ui16Delay);
+
+	int16_t getWindow(FSYNC_Window_t *pWindow);
+	uint32_t getTriggers(void);
+	uint32_t getDropped(void);
+
+
+private:
+	/* Variables */
+	FSYNC_Config_t Config;
+
+	ICM20948_Frame_t History[FSYNC_MAX_WINDOW];
+	uint32_t ui32Samples;                       // Frames since reset()
+	uint32_t ui32Triggers;
+
+	uint32_t ui32PendingTrigger[FSYNC_MAX_PENDING];
+	uint32_t ui32PendingSample[FSYNC_MAX_PENDING];
+	uint16_t ui16PendingDelay[FSYNC_MAX_PENDING];
+	uint8_t  ui8Pending;
+
+	/* Queue */
+	FSYNC_Window_t Queue[FSYNC_QUEUE_SIZE];
+	std::atomic<uint16_t> ui16Head;  // Written by the producer (process())
+	std::atomic<uint16_t> ui16Tail;  // Written by the consumer (getWindow())
+	std::atomic<uint32_t> ui32Dropped;
+
+	/* Methods */
+	bool pushWindow(uint32_t ui32Trigger, uint32_t ui32Sample, uint16_t ui16Delay);
+};
+
+
+#endif /* ZULS_INCLUDE_FSYNC_HPP_ */
@@ -0,0 +1,81 @@
+/*
+ * gyrobias.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_GYROBIAS_HPP_
+#define ZULS_INCLUDE_GYROBIAS_HPP_
+
+#include "icm20948.hpp"
+
+
+#define GYROBIAS_MAX_WINDOW  256
+
+typedef struct
+{
+	uint16_t ui16Window;       // Samples of the variance window (2...GYROBIAS_MAX_WINDOW)
+	float    fAccelStdDev;     // Max. standard deviation of |a| [g]
+	float    fGyroStdDev;      // Max. standard deviation of |w| [dps]
+	float    fGyroMaxRate;     // Max. mean of the corrected |w| [dps] (rejects a constant rotation)
+	uint8_t  ui8EmaShift;      // Time constant of the bias estimator: 2^ui8EmaShift stationary samples
+	uint16_t ui16PushInterval; // Min. number of stationary samples between two offset updates
+}GYROBIAS_Config_t;
+
+/* Approx. 0.25s window, 1s time constant and 0.25s update interval at 1125Hz */
+constexpr GYROBIAS_Config_t GYROBIAS_DEFAULT_CONFIG = {256, 0.01, 0.3, 2.0, 10, 256};
+
+
+/* Background gyro bias tracking. A stationarity detector evaluates the variance of the accelerometer magnitude
+ * and of the gyro norm over a sliding window (running sums of integer values, O(1) per sample and free of
+ * drift). While the sensor is stationary, an exponential estimator (Q16) follows the raw gyro bias, and
+ * the rounded estimate is pushed with ICM20948::setGyroOffset(), which switches the offset atomically.
+ * The data flow is not interrupted. A new configuration epoch re-initializes the detector, transitional
+ * frames are skipped. */
+class GYROBIAS
+{
+public:
+	/* Constructor */
+	GYROBIAS(ICM20948 *pICM20948, const GYROBIAS_Config_t *pConfig = &GYROBIAS_DEFAULT_CONFIG);
+
+	/* Methods */
+	int16_t init(void);
+	void reset(void);
+	int16_t update(const ICM20948_Frame_t *pFrames, uint16_t ui16Count);
+
+	bool isStationary(void);
+	uint32_t getUpdateCount(void);
+	void getBiasEstimate(ICM20948_fVector_t *pBias); // [raw counts], offset = -bias
+
+
+private:
+	/* Variables */
+	ICM20948 *pICM20948;
+	GYROBIAS_Config_t Config;
+
+	/* Thresholds in raw counts, scaled with the window length (variance * N^2) */
+	uint64_t ui64AccelVarLimit;
+	uint64_t ui64GyroVarLimit;
+	uint32_t ui32GyroSumLimit;
+
+	uint16_t ui16AccelNorm[GYROBIAS_MAX_WINDOW];
+	uint16_t ui16GyroNorm[GYROBIAS_MAX_WINDOW];
+	uint32_t ui32AccelSum, ui32GyroSum;
+	uint64_t ui64AccelSumSq, ui64GyroSumSq;
+	uint16_t ui16Head;
+	uint16_t ui16Fill;
+
+	int64_t  i64Bias[3];       // Q16 raw counts
+	ICM20948_i16Vector_t Offset;
+	uint16_t ui16Stationary;   // Stationary samples since the last push
+	bool     boStationary;
+	uint32_t ui32Updates;
+	uint8_t  ui8Epoch;         // Configuration epoch the thresholds were converted for
+
+	/* Methods */
+	inline uint16_t getNorm(int32_t i32X, int32_t i32Y, int32_t i32Z);
+};
+
+
+#endif /* ZULS_INCLUDE_GYROBIAS_HPP_ */
@@ -9,15 +9,9 @@
 #define ZULS_INCLUDE_ICM20948_HPP_
 
 #include <stdlib.h>  // For abs() function
+#include <atomic>
 
-
-#if defined (STM32F411xE)
-    #include "stm32f4xx_spi.hpp"
-#elif defined (STM32H743xx)
-    #include <stm32h7xx_spi.hpp>
-#else
-    #error "Please select first the target device used in your application (via preprocessor)"
-#endif
+#include "icm20948bus.hpp" // Selects the target device and the bus (SPI, I2C or host emulator)
 
 
 #define IS_VALID_FULL_SCALE(FullScale1,FullScale2)    (FullScale1.ui8Selection == FullScale2.ui8Selection \
@@ -33,12 +27,61 @@
 														    && SampleRate1.ui8Div    == SampleRate2.ui8Div)
 
 #define SAMPLES_MEAN_VALUE   1000
+#define SAMPLES_SKIP         100
+#define SAMPLES_QUICK_CHECK  50      // Short window of checkCalibration()
+#define SAMPLES_QUICK_SKIP   10
 #define MAX_ITERATIONS       100     // This value MUST be less than 255
 
+#define ICM20948_RESET_DELAY 10      // [ms] after DEVICE_RESET (not specified in datasheet)
+#define ICM20948_WAKE_DELAY  4       // [ms] after wake up, otherwise I2C_IF_DIS is not set in SPI mode
+
 /* Default values of maximum calibration error */
 constexpr int16_t ICM20948_ACCEL_PREC = 16; // 8;
 constexpr int16_t ICM20948_GYRO_PREC  = 8; // 4;
 
+/* Tolerances of the quick calibration check. The mean of SAMPLES_QUICK_CHECK samples is noisier than the mean
+ * of SAMPLES_MEAN_VALUE samples (approx. sqrt(1000 / 50) = 4.5), therefore the precision is multiplied. */
+constexpr int16_t ICM20948_CALCHECK_FACTOR = 4;
+constexpr int16_t ICM20948_CALCHECK_TEMP   = 3339; // 10 degC (333.87 LSB/degC, datasheet p. 14)
+
+/* Self-test (see exeSelfTest()): two FIFO windows at 1125Hz, 250dps and 2g, without and with actuation */
+#define ICM20948_ST_SAMPLES  16      // FIFO frames per window (max. 42)
+#define ICM20948_ST_SETTLE   20      // [ms] after a change of the configuration or the actuation
+#define ICM20948_ST_WINDOW   ((ICM20948_ST_SAMPLES * 1000 + 1124) / 1125 + 2) // [ms] to fill a window (with margin)
+
+/* Pass criteria of the InvenSense driver: response relative to the factory response (SELF_TEST_x registers,
+ * 2620 LSB * 1.01^(code - 1)), absolute limits if the factory code is 0 */
+constexpr float   ICM20948_ST_TRIM_BASE       = 2620.0f;
+constexpr float   ICM20948_ST_GYRO_RATIO_MIN  = 0.5f;
+constexpr float   ICM20948_ST_ACCEL_RATIO_MIN = 0.5f;
+constexpr float   ICM20948_ST_ACCEL_RATIO_MAX = 1.5f;
+constexpr int32_t ICM20948_ST_GYRO_MIN        = 60 * 131;           // 60 dps (131 LSB/dps)
+constexpr int32_t ICM20948_ST_ACCEL_MIN       = 225 * 16384 / 1000; // 225 mg (16384 LSB/g)
+constexpr int32_t ICM20948_ST_ACCEL_MAX       = 675 * 16384 / 1000; // 675 mg
+
+/* Mounting orientation: sensor axis and sign of the board X, Y and Z axes (e.g. upside down: PX, NY, NZ).
+ * ICM20948_MOUNT_X/Y/Z is the default of every instance, setMount() changes it per instance (several sensors on
+ * one board). The mapping is applied by the decoders of the sample path (register getters, FIFO and DMP
+ * accelerometer and gyroscope data), the offsets, the calibration (board +Z up) and the outputs are in the board
+ * frame. Only the 24 rotations are accepted, the self-test and the DMP quaternions stay in the sensor frame. */
+#define ICM20948_AXIS_PX     0x00
+#define ICM20948_AXIS_PY     0x01
+#define ICM20948_AXIS_PZ     0x02
+#define ICM20948_AXIS_NEG    0x80
+#define ICM20948_AXIS_NX     (ICM20948_AXIS_NEG | ICM20948_AXIS_PX)
+#define ICM20948_AXIS_NY     (ICM20948_AXIS_NEG | ICM20948_AXIS_PY)
+#define ICM20948_AXIS_NZ     (ICM20948_AXIS_NEG | ICM20948_AXIS_PZ)
+
+#ifndef ICM20948_MOUNT_X
+	#define ICM20948_MOUNT_X  ICM20948_AXIS_PX
+#endif
+#ifndef ICM20948_MOUNT_Y
+	#define ICM20948_MOUNT_Y  ICM20948_AXIS_PY
+#endif
+#ifndef ICM20948_MOUNT_Z
+	#define ICM20948_MOUNT_Z  ICM20948_AXIS_PZ
+#endif
+
 typedef enum
 {
 	ICM20948_RET_OK     =  0,
@@ -60,6 +103,28 @@ typedef enum
 	ICM20948_DLPF_7 = 0x38
 }ICM20948_DLPF_t;
 
+/* Acquisition profiles: burst window of readAllDataRaw() and powered sensors */
+typedef enum
+{
+	ICM20948_PROFILE_FULL   = 0, // Accelerometer + gyroscope + temperature (14 bytes)
+	ICM20948_PROFILE_MOTION = 1, // Accelerometer + gyroscope, temperature sensor disabled (12 bytes)
+	ICM20948_PROFILE_ACCEL  = 2, // Accelerometer only, gyroscope and temperature sensor disabled (6 bytes)
+	ICM20948_PROFILE_GYRO   = 3  // Gyroscope only, accelerometer and temperature sensor disabled (6 bytes)
+}ICM20948_Profile_t;
+
+/* FSYNC input: output register whose LSB carries the FSYNC status (EXT_SYNC_SET, datasheet p. 65) */
+typedef enum
+{
+	ICM20948_FSYNC_OFF     = 0,
+	ICM20948_FSYNC_TEMP    = 1, // Register reads only (the temperature is not stored in the FIFO)
+	ICM20948_FSYNC_GYRO_X  = 2,
+	ICM20948_FSYNC_GYRO_Y  = 3,
+	ICM20948_FSYNC_GYRO_Z  = 4,
+	ICM20948_FSYNC_ACCEL_X = 5,
+	ICM20948_FSYNC_ACCEL_Y = 6,
+	ICM20948_FSYNC_ACCEL_Z = 7
+}ICM20948_FsyncLatch_t;
+
 typedef struct
 {
 	uint8_t  ui8Selection;
@@ -102,11 +167,145 @@ typedef struct
 	float fZAxis;
 }ICM20948_fVector_t;
 
+/* Configuration epochs: every change of full scale, sample rate or DLPF starts a new epoch. Frames carry the
+ * epoch they were captured under, the scale factors of the last ICM20948_EPOCH_HISTORY epochs are kept. */
+#define ICM20948_EPOCH_HISTORY      4    // Power of two
+#define ICM20948_EPOCH_SETTLE       2    // Samples marked with ICM20948_FRAME_TRANSITION after a change
+
+/* Read attempts of the published gyro offset (only a writer on another core can interfere repeatedly) */
+#define ICM20948_GYRO_OFFSET_RETRIES 8
+
+#define ICM20948_FRAME_TRANSITION   0x01 // Captured while the new configuration took effect
+#define ICM20948_FRAME_STALE_EPOCH  0x02 // Epoch no longer in the history (set by convertFrames())
+#define ICM20948_FRAME_FSYNC        0x04 // First sample after an FSYNC edge (see setupFsync())
+#define ICM20948_FRAME_ACCEL_FRESH  0x08 // New accelerometer sample (multi-rate mode only, see setupMultiRate())
+#define ICM20948_FRAME_GYRO_FRESH   0x10 // New gyroscope sample (multi-rate mode only)
+
+/* ui8Range of a frame: ui8Selection of the accelerometer (bits 1...2) and gyroscope (bits 5...6) full scale */
+#define ICM20948_RANGE(AccelFS,GyroFS)  ((uint8_t)((AccelFS).ui8Selection | ((GyroFS).ui8Selection << 4)))
+#define ICM20948_RANGE_ACCEL(Range)     ((Range) & 0x0F)
+#define ICM20948_RANGE_GYRO(Range)      ((Range) >> 4)
+
+/* Decoded sample (burst or FIFO frame) */
+typedef struct
+{
+	ICM20948_i16Vector_t Accel;
+	ICM20948_i16Vector_t Gyro;
+	int16_t              i16Temperature; // Raw TEMP_OUT (0 for FIFO frames, the temperature is not stored in the FIFO)
+	uint8_t              ui8Epoch;       // Configuration epoch
+	uint8_t              ui8Flags;       // ICM20948_FRAME_...
+	uint8_t              ui8Range;       // Full scale in force, see ICM20948_RANGE_ACCEL() / ICM20948_RANGE_GYRO()
+}ICM20948_Frame_t;
+
+/* Converted sample */
+typedef struct
+{
+	ICM20948_fVector_t Accel; // [g]
+	ICM20948_fVector_t Gyro;  // [dps]
+	uint8_t            ui8Epoch;
+	uint8_t            ui8Flags;
+}ICM20948_fFrame_t;
+
+/* Statistics of readLatest() in timestamp units. Histograms with log2 bins: bin 0 counts the values 0 and 1,
+ * bin i counts the values 2^i...2^(i+1)-1, the last bin counts all larger values as well. */
+#define ICM20948_LATENCY_BINS  16
+
+typedef struct
+{
+	uint32_t ui32Calls;
+	uint32_t ui32NewSamples;
+	uint32_t ui32BankSwitches;                       // Calls that had to select user bank 0 first
+	uint32_t ui32LatencyMax;                         // Duration of a call
+	uint32_t ui32JitterMax;                          // Difference of two consecutive call intervals
+	uint32_t ui32AgeMax;
+	uint32_t ui32LatencyHist[ICM20948_LATENCY_BINS];
+	uint32_t ui32JitterHist[ICM20948_LATENCY_BINS];
+}ICM20948_LatencyStats_t;
+
+/* Continuity tracking (see setupContinuity()) */
+#ifndef ICM20948_GAP_LOG_SIZE
+	#define ICM20948_GAP_LOG_SIZE  8    // Entries of the gap log (power of two), the oldest entries are overwritten
+#endif
+
+#define ICM20948_GAP_MISSED        0x01 // Samples lost according to the timestamp model (registers or FIFO overwritten)
+#define ICM20948_GAP_DUPLICATE     0x02 // Previous sample read again (no data ready and unchanged data)
+#define ICM20948_GAP_OVERFLOW      0x03 // FIFO overflow (INT_STATUS_2), the lost frames are counted as missed
+
+typedef struct
+{
+	uint32_t ui32Time;    // Timestamp of the detection
+	uint32_t ui32Sample;  // New samples delivered before the gap
+	uint16_t ui16Count;   // Missed samples, duplicates or overflows (consecutive events of one type are merged)
+	uint8_t  ui8Type;     // ICM20948_GAP_...
+}ICM20948_Gap_t;
+
+typedef struct
+{
+	uint32_t ui32Samples;     // New samples delivered
+	uint32_t ui32Duplicates;
+	uint32_t ui32Missed;
+	uint32_t ui32Overflows;
+	uint32_t ui32Gaps;        // Gap log entries written (including overwritten ones)
+}ICM20948_ContinuityStats_t;
+
+/* Result of the self-test */
+#define ICM20948_ST_X    0x01 // ui8AccelPass, ui8GyroPass
+#define ICM20948_ST_Y    0x02
+#define ICM20948_ST_Z    0x04
+#define ICM20948_ST_ALL  0x07
+
+typedef struct
+{
+	ICM20948_i32Vector_t AccelResponse; // |mean with actuation - mean without| [LSB at 2g], sensor axes
+	ICM20948_i32Vector_t GyroResponse;  // [LSB at 250dps]
+	ICM20948_fVector_t   AccelRatio;    // Response / factory response (0: no factory code, absolute limits)
+	ICM20948_fVector_t   GyroRatio;
+	uint8_t              ui8AccelPass;  // ICM20948_ST_X/Y/Z of the axes that passed
+	uint8_t              ui8GyroPass;
+}ICM20948_SelfTest_t;
+
+/* Decoded DMP packet. Only the outputs set in ui16Header/ui16Header2 are valid, the data of other outputs
+ * (compass, pressure, step detector, ...) is skipped. */
+typedef struct
+{
+	uint16_t             ui16Header;        // ICM20948_DMP_... (icm20948reg.hpp)
+	uint16_t             ui16Header2;       // ICM20948_DMP_HDR2_...
+	ICM20948_i16Vector_t Accel;             // Raw, ACCEL_FS_4G (board frame, see setMount())
+	ICM20948_i16Vector_t Gyro;              // Raw, GYRO_FS_2000DPS (board frame)
+	ICM20948_i16Vector_t GyroBias;          // Gyro bias estimated by the DMP (board frame)
+	ICM20948_i32Vector_t Quat6;             // Q1...Q3 of the 6-axis quaternion (Q30, sensor frame), see getDmpQuaternion()
+	ICM20948_i16Vector_t PQuat6;            // Q1...Q3 of the 6-axis quaternion (Q14, low precision)
+	ICM20948_i32Vector_t GyroCalibr;        // Bias corrected gyro (DMP format, 32 bit)
+	uint16_t             ui16AccelAccuracy; // 0 (unreliable)...3 (high)
+	uint16_t             ui16GyroAccuracy;
+	uint16_t             ui16Footer;
+}ICM20948_DmpPacket_t;
+
+typedef struct
+{
+	float fW;
+	float fX;
+	float fY;
+	float fZ;
+}ICM20948_Quaternion_t;
+
+typedef struct
+{
+	uint8_t ui8Epoch;
+	uint8_t ui8Range;
+	float   fAccelSensitivity;
+	float   fGyroSensitivity;
+}ICM20948_EpochConfig_t;
+
 typedef struct
 {
 	bool boStatusOK;
 	bool boSleep;
 	bool boUseSPI;
+	bool boFifoEnabled;
+	bool boDmpEnabled;
+	ICM20948_Profile_t Profile;
+	ICM20948_FsyncLatch_t Fsync;
 	ICM20948_FullScale_t AccelFullScale;
 	ICM20948_AccelSampleRate_t AccelSampleRate;
 	ICM20948_DLPF_t AccelDLPF;
@@ -115,6 +314,41 @@ typedef struct
 	ICM20948_DLPF_t GyroDLPF;
 }ICM20948_SensorConfig_t;
 
+typedef struct
+{
+	ICM20948_i16Vector_t AccelOffset;
+	ICM20948_i16Vector_t GyroOffset;
+	int16_t              i16Temperature; // Raw TEMP_OUT value at the time of calibration
+	uint8_t              ui8AccelFullScale;
+	uint8_t              ui8GyroFullScale;
+	uint16_t             ui16AccelDiv;
+	uint8_t              ui8GyroDiv;
+	bool                 boAccelFCHOICE;
+	bool                 boGyroFCHOICE;
+	ICM20948_DLPF_t      AccelDLPF;
+	ICM20948_DLPF_t      GyroDLPF;
+	uint8_t              ui8MountX;      // setMount() / ICM20948_MOUNT_X/Y/Z (the offsets are in the board frame)
+	uint8_t              ui8MountY;
+	uint8_t              ui8MountZ;
+}ICM20948_CalRecord_t;
+
+/* Configuration registers of banks 0...3 (see ICM20948_REG_BLOCKS in icm20948.cpp) */
+#define ICM20948_SNAPSHOT_SIZE   60
+
+/* Snapshot of the configuration registers and the driver state for a warm restart without DEVICE_RESET.
+ * To survive an MCU reset, the snapshot must be placed in RAM that is not initialized by the startup code,
+ * e.g. __attribute__((section(".noinit"))). The CRC detects a snapshot lost by a power cycle. */
+typedef struct
+{
+	uint8_t                 ui8Register[ICM20948_SNAPSHOT_SIZE];
+	ICM20948_SensorConfig_t SensorConfig;
+	ICM20948_i16Vector_t    AccelOffset;
+	ICM20948_i16Vector_t    GyroOffset;
+	int16_t                 i16AccelPrec;
+	int16_t                 i16GyroPrec;
+	uint32_t                ui32CRC;
+}ICM20948_RegSnapshot_t;
+
 
 /* Constants for Accelerometer sample rate, low pass filter and full scale (ICM-20948 datasheet, p. 63 ff.)
  * Accelerometer Sample Rate = 4500 [Hz]                           when DLPF is disabled (ACCEL_FCHOICE = 0)
@@ -174,8 +408,11 @@ class ICM20948
 {
 public:
 	/* Constructor, Destructor */
-	ICM20948(SPI *pSPI, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+	ICM20948(ICM20948_Port_t *pPort, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
 			 ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF);
+	ICM20948(ICM20948_Port_t *pPort, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+			 ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF,
+			 const ICM20948_RegSnapshot_t *pSnapshot);
 	~ICM20948(void);
 
 	/* Methods */
@@ -203,18 +440,64 @@ public:
 	void setGyroOffset(ICM20948_i16Vector_t Offset);
 	void getGyroOffset(ICM20948_i16Vector_t *pOffset);
 	void resetGyroOffset(void);
+	void correctGyro(ICM20948_Frame_t *pFrames, uint16_t ui16Count);
+
+	int16_t readAllDataRaw(void); // Burst window of the acquisition profile (Accel + Gyro + Temp: 14 bytes)
+	int16_t setAcquisitionProfile(ICM20948_Profile_t Profile);
+
+	int16_t setupFsync(ICM20948_FsyncLatch_t Latch, bool boActiveLow);
+	uint16_t getFsyncDelay(void);
+
+	int16_t setupLatest(uint32_t (*pTimestamp)(void) = NULL);
+	int16_t readLatest(ICM20948_Frame_t *pFrame, uint32_t *pAge);
+	int16_t setupMultiRate(ICM20948_AccelSampleRate_t AccelSR, ICM20948_GyroSampleRate_t GyroSR, uint32_t ui32Period = 0);
+	uint32_t getSampleTick(void);
+	void getLatencyStats(ICM20948_LatencyStats_t *pStats);
+	void resetLatencyStats(void);
+
+	int16_t setupContinuity(uint32_t ui32TimestampHz, uint32_t (*pTimestamp)(void) = NULL);
+	void getContinuityStats(ICM20948_ContinuityStats_t *pStats);
+	uint8_t readGapLog(ICM20948_Gap_t *pGaps, uint8_t ui8MaxGaps);
+	void resetContinuityStats(void);
 
-	int16_t readAllDataRaw(void); // Accel + Gyro + Temp (14 bytes)
+	int16_t enableFifo(bool boEnable);
+	int16_t resetFifo(void);
+	int16_t getFifoCount(uint16_t *pCount);
+	int16_t readFifoFrames(ICM20948_Frame_t *pFrames, uint16_t ui16MaxFrames, uint16_t *pFrameCount);
+
+	int16_t loadDmpFirmware(const uint8_t *pImage, uint16_t ui16Size);
+	int16_t enableDmp(uint16_t ui16Outputs, uint16_t ui16OdrDiv);
+	int16_t disableDmp(void);
+	int16_t readDmpPackets(ICM20948_DmpPacket_t *pPackets, uint16_t ui16MaxPackets, uint16_t *pPacketCount);
+	static void getDmpQuaternion(const ICM20948_DmpPacket_t *pPacket, ICM20948_Quaternion_t *pQuat);
 
 	ICM20948_i16Vector_t getAccelRaw(void);
 	ICM20948_i16Vector_t getCorrectedAccelRaw(void);
 	ICM20948_i16Vector_t getGyroRaw(void);
 	ICM20948_i16Vector_t getCorrectedGyroRaw(void);
+	int16_t getTemperatureRaw(void);
+	ICM20948_Frame_t getFrame(void);
+
+	uint8_t getConfigEpoch(void);
+	int16_t convertFrames(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, ICM20948_fFrame_t *pOut);
 
 	int16_t calculateMeanValues(void);
 	int16_t exeCalibration(void);
 	int16_t exeCalibrationSingleIteration(uint8_t ui8Iteration, uint8_t *pReady);
 
+	int16_t setMount(uint8_t ui8X, uint8_t ui8Y, uint8_t ui8Z);
+
+	void getCalibrationRecord(ICM20948_CalRecord_t *pRecord);
+	int16_t setCalibrationRecord(const ICM20948_CalRecord_t *pRecord);
+	int16_t checkCalibration(uint16_t ui16Samples = SAMPLES_QUICK_CHECK);
+	int16_t exeSelfTest(ICM20948_SelfTest_t *pResult);
+
+	int16_t takeSnapshot(ICM20948_RegSnapshot_t *pSnapshot);
+	int16_t restoreSnapshot(const ICM20948_RegSnapshot_t *pSnapshot, uint8_t *pRestored);
+	bool    isWarmStart(void);
+
+	void setBusSpeedProfile(uint16_t ui16Config, uint16_t ui16Read, uint16_t ui16Burst);
+
 	int16_t setDebugFunction8(uint8_t ui8Data);
 
 	int16_t setDebugFunction16(uint16_t ui16Data);
@@ -222,43 +505,160 @@ public:
 
 
 private:
+	/* The asynchronous driver runs the blocking sequences (init, mean values, calibration) step by step */
+	friend class ICM20948_ASYNC;
+
+	/* Constructor without initialization (see ICM20948_ASYNC::init()) */
+	explicit ICM20948(ICM20948_Port_t *pPort);
+
 	/* Variables */
-	SPI *pSPI;
-	uint8_t ICM20948_I2C_ADDR;
+	ICM20948_Bus_t Bus;
 	uint8_t ui8CurrentBank;
 	ICM20948_SensorConfig_t ICM20948_SensorConfig;
 
 	uint8_t ui8DataArray[14]; /* 0...5 : Accelerometer
 	                             6...11: Gyroscope
 	                            12...13: Temperature  */
+	uint8_t ui8BurstOffset;   // Burst window of the acquisition profile within ui8DataArray[]
+	uint8_t ui8BurstLength;
+
+	uint8_t ui8Mount[3];                             // ICM20948_AXIS_... of the board X, Y and Z axes (setMount())
 
 	ICM20948_i16Vector_t AccelOffset;
-	ICM20948_i16Vector_t GyroOffset;
+	ICM20948_i16Vector_t GyroOffset;                 // Working copy (calibration, setGyroOffset())
+	std::atomic<uint32_t> ui32GyroOffsetSequence;   // Publications of GyroOffset (twice), +1 during a write
+	std::atomic<uint32_t> ui32GyroOffsetXY;         // Published copy used by the sample path: X (bits 0...15),
+	std::atomic<uint32_t> ui32GyroOffsetZ;          // Y (bits 16...31) and Z (bits 0...15)
+	std::atomic<uint32_t> ui32GyroOffsetLastXY;     // Previous publication, read while a write is in progress
+	std::atomic<uint32_t> ui32GyroOffsetLastZ;
 	ICM20948_i16Vector_t CorrectedAccelMean;
 	ICM20948_i16Vector_t CorrectedGyroMean;
 
 	int16_t i16AccelPrec;
 	int16_t i16GyroPrec;
 
+	bool boWarmStart;
+
+	uint8_t  ui8Epoch;                                    // Current configuration epoch
+	ICM20948_EpochConfig_t EpochConfig[ICM20948_EPOCH_HISTORY];
+	uint16_t ui16EpochFrames[ICM20948_EPOCH_HISTORY];     // Frames of older epochs still in the FIFO
+	uint16_t ui16FifoFramesAtChange;                      // FIFO frames before the last reconfiguration
+	uint8_t  ui8FifoEpoch;                                // Epoch of the oldest frame in the FIFO
+	uint8_t  ui8FifoSettle;                               // FIFO frames still to be marked as transitional
+	uint8_t  ui8RegisterSettle;                           // Burst reads still to be marked as transitional
+	uint8_t  ui8DataEpoch;                                // Epoch and flags of ui8DataArray
+	uint8_t  ui8DataFlags;
+
+	/* readLatest() */
+	uint32_t (*pGetTimestamp)(void);
+	ICM20948_LatencyStats_t LatencyStats;
+	uint32_t ui32LastCall;     // Start of the previous call
+	uint32_t ui32LastInterval; // Interval between the previous two calls
+	uint32_t ui32DataTime;     // Earliest point in time the sample in ui8DataArray[] became ready
+	bool     boLatestReady;
+
+	/* Multi-rate mode of readLatest() (ticks of the faster sensor since setupMultiRate()) */
+	uint8_t  ui8RateRatio;       // Samples of the faster sensor per sample of the slower one (0: off)
+	bool     boAccelSlow;        // The accelerometer is the slower sensor
+	uint32_t ui32RateTick;       // Tick of the last new sample
+	uint32_t ui32RateTime;       // Twice the middle of the interval in which it became ready (sum of both call times)
+	uint32_t ui32SlowSlot;       // ui32RateTick / ui8RateRatio of the last slow sample read
+	uint32_t ui32TickPeriod;     // Timestamp units per tick (0: no detection of missed samples)
+
+	/* Continuity tracking: expected samples at the configured rate versus delivered and missed samples */
+	uint32_t (*pTrackTimestamp)(void);
+	uint32_t ui32TrackHz;        // Frequency of the time base (0: tracking off)
+	uint32_t ui32TrackRateNum;   // Sample rate = ui32TrackRateNum / ui32TrackRateDen [Hz]
+	uint32_t ui32TrackRateDen;
+	uint32_t ui32TrackLast;      // Timestamp of the last check
+	uint64_t ui64TrackPhase;     // Time since the last expected sample [1 / (ui32TrackHz * ui32TrackRateDen) s]
+	uint32_t ui32TrackExpected;  // Samples expected since the anchor of the model
+	uint32_t ui32TrackCount;     // Samples delivered or counted as missed since the anchor
+	bool     boDataRepeated;     // The last readAllDataRaw() read the previous sample again
+	ICM20948_ContinuityStats_t ContinuityStats;
+	ICM20948_Gap_t GapLog[ICM20948_GAP_LOG_SIZE];
+	uint8_t  ui8GapHead;         // Next entry of the gap log
+	uint8_t  ui8GapCount;        // Entries not read by readGapLog()
+
+	/* Self-test */
+	uint8_t  ui8SelfTestStep;                // Next step of updateSelfTest() (0: start)
+	uint8_t  ui8SelfTestSaved[9];            // GYRO_SMPLRT_DIV...GYRO_CONFIG_2, ACCEL_SMPLRT_DIV_1...ACCEL_CONFIG_2
+	ICM20948_i32Vector_t SelfTestAccel;      // Means of the window without actuation
+	ICM20948_i32Vector_t SelfTestGyro;
+
+	/* FSYNC */
+	uint16_t ui16FsyncDelay;   // DELAY_TIME of the last FSYNC edge [us]
+
+	/* DMP */
+	bool     boDmpLoaded;
+	uint8_t  ui8DmpBuffer[ICM20948_DMP_BUFFER_SIZE]; // FIFO bytes not decoded yet (incomplete packet)
+	uint16_t ui16DmpBuffered;
+	ICM20948_FullScale_t DmpAccelFullScale;          // Full scales before enableDmp(), restored by disableDmp()
+	ICM20948_FullScale_t DmpGyroFullScale;
+
+	/* Shadows of ACCEL_CONFIG and GYRO_CONFIG_1 (a change is a single write without read back) */
+	uint8_t ui8AccelConfig;
+	uint8_t ui8GyroConfig1;
+	bool    boShadowValid;
+
 	/* Methods */
 	ICM20948_RetCode_t init(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
 			                ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF);
+	ICM20948_RetCode_t initReset(void);
+	ICM20948_RetCode_t initWake(void);
+	ICM20948_RetCode_t initConfig(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+			                      ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF);
+	ICM20948_RetCode_t warmInit(const ICM20948_RegSnapshot_t *pSnapshot);
+	uint32_t calcSnapshotCRC(const ICM20948_RegSnapshot_t *pSnapshot);
+	int16_t calculateMeanValues(uint16_t ui16Samples, uint16_t ui16Skip);
+	void addMeanSample(ICM20948_i32Vector_t *pAccelSum, ICM20948_i32Vector_t *pGyroSum);
+	void setMeanValues(const ICM20948_i32Vector_t *pAccelSum, const ICM20948_i32Vector_t *pGyroSum, uint16_t ui16Samples);
+	void startCalibration(void);
+	uint8_t updateCalibration(void);
+	int16_t updateSelfTest(ICM20948_SelfTest_t *pResult, uint32_t *pDelay);
+	int16_t readSelfTestWindow(ICM20948_i32Vector_t *pAccel, ICM20948_i32Vector_t *pGyro);
+	int16_t endSelfTest(void);
+	int16_t evaluateSelfTest(const ICM20948_i32Vector_t *pAccel, const ICM20948_i32Vector_t *pGyro, ICM20948_SelfTest_t *pResult);
+	inline int16_t getAccelOneG(void);
+	inline void decodeFrame(const uint8_t *pData, ICM20948_Frame_t *pFrame);
+	inline uint8_t latchFsync(uint8_t *pData, uint8_t ui8Length);
+	inline bool isFsyncInWindow(ICM20948_FsyncLatch_t Latch, ICM20948_Profile_t Profile);
+	void publishGyroOffset(void);
+	ICM20948_i16Vector_t loadGyroOffset(void);
+	void resetEpochs(void);
+	void setBurstWindow(void);
+	inline uint8_t getHistogramBin(uint32_t ui32Value);
+	void anchorContinuity(void);
+	void checkContinuity(uint32_t ui32Time, uint16_t ui16Delivered, uint16_t ui16Pending);
+	inline void checkOverflow(uint32_t ui32Time, uint8_t ui8Status2);
+	void logGap(uint32_t ui32Time, uint8_t ui8Type, uint16_t ui16Count);
+	int16_t getDmpPacketLength(const uint8_t *pData, uint16_t ui16Available);
+	void decodeDmpPacket(const uint8_t *pData, ICM20948_DmpPacket_t *pPacket);
+	int16_t writeDmpMemory(uint16_t ui16Addr, const uint8_t *pData, uint8_t ui8Length);
+	int16_t readDmpMemory(uint16_t ui16Addr, uint8_t *pData, uint8_t ui8Length);
+	int16_t writeDmpRegister(uint16_t ui16Addr, uint32_t ui32Value, uint8_t ui8Length);
+	int16_t beginEpoch(void);
+	int16_t commitEpoch(void);
+
 	int16_t resetBank(void);
 	int16_t switchBank(uint8_t ui8NewBank);
 	int16_t writeRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Data);
 	int16_t readRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t *pData);
 	int16_t writeRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t ui16Data);
 	int16_t readRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t *pData);
+	int16_t readBurst(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length, ICM20948_BusSpeed_t Speed);
 	int16_t setRegister8Bit(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Pos);
 	int16_t clearRegister8Bit(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Pos);
 	int16_t getRegister8Bit(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Pos, bool *pValue);
 	int16_t changeRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Msk, uint8_t ui8Value);
+	int16_t changeShadowRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Msk, uint8_t ui8Value, uint8_t *pShadow);
 
 	inline bool isValidPos(uint8_t ui8Pos);
 	inline bool isValidAccelFullScale(ICM20948_FullScale_t FullScale);
 	inline bool isValidGyroFullScale(ICM20948_FullScale_t FullScale);
 	inline bool isValidAccelSampleRate(ICM20948_AccelSampleRate_t SampleRate);
 	inline bool isValidGyroSampleRate(ICM20948_GyroSampleRate_t SampleRate);
+	inline bool isEqualSampleRate(ICM20948_AccelSampleRate_t AccelSR, ICM20948_GyroSampleRate_t GyroSR);
 	inline bool isValidDLPF(ICM20948_DLPF_t DLPF);
 };
 
@@ -0,0 +1,173 @@
+/*
+ * icm20948async.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_ICM20948ASYNC_HPP_
+#define ZULS_INCLUDE_ICM20948ASYNC_HPP_
+
+#include "icm20948.hpp"
+
+/* The asynchronous API needs C++20 coroutines (-std=c++20), with older standards it is not compiled */
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+
+
+#ifndef ASYNC_FRAME_SIZE
+	#define ASYNC_FRAME_SIZE   192  // Max. size of a coroutine frame [bytes] (multiple of 8)
+#endif
+#ifndef ASYNC_FRAMES
+	#define ASYNC_FRAMES       16   // Coroutine frames of the pool (1...32), a call chain needs one per level
+#endif
+#ifndef ASYNC_SLOTS
+	#define ASYNC_SLOTS        8    // Suspended task chains the scheduler can hold (1...32: delay, yield, spawn)
+#endif
+
+
+/* Task of the asynchronous API (lazy coroutine with an int16_t result, 0: OK).
+ * A task starts when it is awaited by another task (co_await) or passed to ASYNC_SCHEDULER::spawn().
+ * The frames are taken from a static pool without heap: if the pool is empty (or ASYNC_FRAME_SIZE is too small
+ * for the frame), the task is invalid and its result is ICM20948_GEN_FAIL. */
+class ASYNC_TASK
+{
+public:
+	struct FinalAwaiter;
+
+	struct promise_type
+	{
+		int16_t i16Result = ICM20948_GEN_FAIL;
+		std::coroutine_handle<> Continuation;    // Awaiting task (none: top-level task of the scheduler)
+
+		ASYNC_TASK get_return_object(void) noexcept;
+		static ASYNC_TASK get_return_object_on_allocation_failure(void) noexcept;
+		std::suspend_always initial_suspend(void) noexcept {return {};}
+		FinalAwaiter final_suspend(void) noexcept;
+		void return_value(int16_t i16Value) noexcept {i16Result = i16Value;}
+		void unhandled_exception(void) noexcept {i16Result = ICM20948_GEN_FAIL;}
+
+		static void *operator new(std::size_t Size) noexcept;
+		static void operator delete(void *pFrame) noexcept;
+	};
+
+	/* Resumes the awaiting task when the task is finished (symmetric transfer, no stack growth) */
+	struct FinalAwaiter
+	{
+		bool await_ready(void) noexcept {return false;}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> Handle) noexcept;
+		void await_resume(void) noexcept {}
+	};
+
+	struct Awaiter
+	{
+		std::coroutine_handle<promise_type> Handle;
+
+		bool await_ready(void) noexcept {return !Handle || Handle.done();}
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> Caller) noexcept;
+		int16_t await_resume(void) noexcept;
+	};
+
+	/* Constructor, Destructor */
+	ASYNC_TASK(ASYNC_TASK &&Other) noexcept;
+	ASYNC_TASK(const ASYNC_TASK &) = delete;
+	ASYNC_TASK &operator=(const ASYNC_TASK &) = delete;
+	~ASYNC_TASK(void);
+
+	/* Methods */
+	Awaiter operator co_await(void) noexcept {return Awaiter{Handle};}
+	bool isValid(void);
+	bool isDone(void);
+	int16_t getResult(void);
+
+	static uint8_t getFreeFrames(void);
+
+
+private:
+	friend class ASYNC_SCHEDULER;
+
+	explicit ASYNC_TASK(std::coroutine_handle<promise_type> Handle) noexcept : Handle(Handle) {}
+
+	/* Variables */
+	std::coroutine_handle<promise_type> Handle;
+};
+
+
+class ASYNC_SCHEDULER;
+
+/* co_await ASYNC_SCHEDULER::delay() / yield() */
+struct ASYNC_DELAY
+{
+	ASYNC_SCHEDULER *pScheduler;
+	uint32_t ui32Ticks;
+
+	bool await_ready(void) noexcept {return false;}
+	bool await_suspend(std::coroutine_handle<> Handle) noexcept;
+	void await_resume(void) noexcept {}
+};
+
+
+/* Cooperative scheduler for a bare-metal main loop or a host thread: poll() resumes the task chains whose
+ * delay has expired (time base get_Ticks(), 1ms). A chain occupies one slot while it waits, a running chain
+ * none. All state is in fixed arrays, poll() must not be called from a task or an interrupt. */
+class ASYNC_SCHEDULER
+{
+public:
+	/* Constructor */
+	ASYNC_SCHEDULER(void);
+
+	/* Methods */
+	int16_t spawn(ASYNC_TASK *pTask);
+	uint16_t poll(void);
+	int16_t run(ASYNC_TASK *pTask);
+	bool isIdle(void);
+
+	ASYNC_DELAY delay(uint32_t ui32Ms);
+	ASYNC_DELAY yield(void);
+
+
+private:
+	friend struct ASYNC_DELAY;
+
+	/* Variables */
+	std::coroutine_handle<> Slot[ASYNC_SLOTS];
+	uint32_t ui32Due[ASYNC_SLOTS];
+
+	/* Methods */
+	int16_t schedule(std::coroutine_handle<> Handle, uint32_t ui32Due);
+};
+
+
+/* Asynchronous ICM20948 driver: the sequences with delays (reset and wake up, mean values, calibration,
+ * self-test) and the wait for a new sample suspend instead of spinning, other tasks continue meanwhile.
+ * The register transfers themselves are blocking (a few us, the bus classes have no DMA interface).
+ * All other methods are available synchronously through getDevice(). Only one sequence may run at a time. */
+class ICM20948_ASYNC
+{
+public:
+	/* Constructor */
+	ICM20948_ASYNC(ICM20948_Port_t *pPort, ASYNC_SCHEDULER *pScheduler);
+
+	/* Methods */
+	ASYNC_TASK init(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+			        ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF,
+					ICM20948_SelfTest_t *pSelfTest = NULL);
+	ASYNC_TASK readFrame(ICM20948_Frame_t *pFrame);
+	ASYNC_TASK calculateMeanValues(uint16_t ui16Samples = SAMPLES_MEAN_VALUE, uint16_t ui16Skip = SAMPLES_SKIP);
+	ASYNC_TASK calibrate(void);
+	ASYNC_TASK selfTest(ICM20948_SelfTest_t *pResult);
+
+	ICM20948 *getDevice(void);
+
+
+private:
+	/* Variables */
+	ICM20948 Device;
+	ASYNC_SCHEDULER *pScheduler;
+};
+
+
+#endif /* __cpp_impl_coroutine */
+
+#endif /* ZULS_INCLUDE_ICM20948ASYNC_HPP_ */
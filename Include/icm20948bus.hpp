@@ -0,0 +1,454 @@
+/*
+ * icm20948bus.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_ICM20948BUS_HPP_
+#define ZULS_INCLUDE_ICM20948BUS_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+
+/* The bus is selected at compile time (like the target device), so the driver calls the transfer functions
+ * directly (no virtual calls, inlined into the sample path):
+ * - ICM20948_HOST:    Host build with the register-level emulator ICM20948_MOCK (no target device)
+ * - ICM20948_USE_I2C: I2C interface of the target device (address 0x68 | ICM20948_I2C_AD0)
+ * - Default:          SPI interface of the target device */
+#if defined (ICM20948_HOST)
+	/* No target device headers */
+#elif defined (STM32F411xE)
+	#if defined (ICM20948_USE_I2C)
+		#include "stm32f4xx_i2c.hpp"
+	#else
+		#include "stm32f4xx_spi.hpp"
+	#endif
+#elif defined (STM32H743xx)
+	#if defined (ICM20948_USE_I2C)
+		#include <stm32h7xx_i2c.hpp>
+	#else
+		#include <stm32h7xx_spi.hpp>
+	#endif
+#else
+	#error "Please select first the target device used in your application (via preprocessor)"
+#endif
+
+#include "icm20948reg.hpp"
+
+#ifndef ICM20948_I2C_AD0
+	#define ICM20948_I2C_AD0   0   // Level of pin AD0 (datasheet p. 14)
+#endif
+
+/* SPI baud rate prescalers of the speed classes (used with ICM20948_SPI_SPEED_PROFILES). Register writes and
+ * configuration reads are specified up to 1 MHz, sensor and interrupt registers can be read with 7 MHz
+ * (datasheet p. 16). The default values are for an SPI kernel clock of 100 MHz (781 kHz and 6.25 MHz). */
+#ifndef ICM20948_SPI_PRESC_SLOW
+	#define ICM20948_SPI_PRESC_SLOW   128
+#endif
+#ifndef ICM20948_SPI_PRESC_FAST
+	#define ICM20948_SPI_PRESC_FAST   16
+#endif
+
+typedef enum
+{
+	ICM20948_SPEED_CONFIG = 0, // Register writes (incl. bank switch)
+	ICM20948_SPEED_READ   = 1, // Configuration register reads
+	ICM20948_SPEED_BURST  = 2  // Sensor data and interrupt status bursts
+}ICM20948_BusSpeed_t;
+
+
+#if defined (ICM20948_HOST)
+/* Register-level emulation of the ICM20948 for host builds (user banks 0...3, REG_BANK_SEL, DEVICE_RESET, FIFO,
+ * DMP memory). The sensor data registers are set with setSensorData(), pushSample() emulates one ODR tick (data
+ * registers, RAW_DATA_0_RDY_INT and FIFO). The DMP itself is not emulated, its packets are written into the FIFO
+ * with pushFifo(). All transfers are counted. */
+class ICM20948_MOCK
+{
+public:
+	ICM20948_MOCK(void)
+	{
+		reset();
+		resetCounters();
+		setDmpFault(0, 0x00);
+	}
+
+	void reset(void)
+	{
+		memset(ui8Register, 0, sizeof(ui8Register));
+		memset(ui8DmpMemory, 0, sizeof(ui8DmpMemory));
+		ui8Bank = 0;
+		ui16FifoHead  = 0;
+		ui16FifoCount = 0;
+
+		/* Reset values (datasheet p. 32 ff.) */
+		ui8Register[0][ICM20948_WHO_AM_I]     = ICM20948_WHO_AM_I_VALUE;
+		ui8Register[0][ICM20948_LP_CONFIG]    = 0x40;
+		ui8Register[0][ICM20948_PWR_MGMT_1]   = 0x41;
+		ui8Register[2][ICM20948_GYRO_CONFIG_1] = 0x01;
+		ui8Register[2][ICM20948_ACCEL_CONFIG] = 0x01;
+	}
+
+	void resetCounters(void)
+	{
+		ui32Transactions    = 0;
+		ui32BytesRead       = 0;
+		ui32BytesWritten    = 0;
+		ui32SpeedSwitches   = 0;
+		ui32SpeedViolations = 0;
+		Speed = ICM20948_SPEED_CONFIG;
+	}
+
+	/* 14 bytes from ACCEL_XOUT_H to TEMP_OUT_L (big endian, like the sensor) */
+	void setSensorData(const uint8_t *pData)
+	{
+		memcpy(&ui8Register[0][ICM20948_ACCEL_XOUT_H], pData, 14);
+	}
+
+	/* One ODR tick: updates the data registers and writes the enabled sensors (FIFO_EN_2) into the FIFO */
+	void pushSample(const uint8_t *pData)
+	{
+		setSensorData(pData);
+		ui8Register[0][ICM20948_INT_STATUS_1] |= ICM20948_RAW_DATA_0_RDY_INT;
+
+		if (!(ui8Register[0][ICM20948_USER_CTRL] & ICM20948_FIFO_EN)) {return;}
+
+		if (ui8Register[0][ICM20948_FIFO_EN_2] & ICM20948_ACCEL_FIFO_EN) {pushFifo(&pData[0], 6);}
+		if (ui8Register[0][ICM20948_FIFO_EN_2] & ICM20948_GYRO_FIFO_EN)  {pushFifo(&pData[6], 6);}
+		if (ui8Register[0][ICM20948_FIFO_EN_2] & ICM20948_TEMP_FIFO_EN)  {pushFifo(&pData[12], 2);}
+	}
+
+	/* Stream mode: if the FIFO is full, the oldest bytes are overwritten and FIFO_OVERFLOW_INT is set */
+	void pushFifo(const uint8_t *pData, uint16_t ui16Length)
+	{
+		for (uint16_t i = 0; i < ui16Length; i++)
+		{
+			ui8Fifo[(ui16FifoHead + ui16FifoCount) % ICM20948_FIFO_SIZE] = pData[i];
+
+			if (ui16FifoCount < ICM20948_FIFO_SIZE) {ui16FifoCount++;}
+			else
+			{
+				ui16FifoHead = (ui16FifoHead + 1) % ICM20948_FIFO_SIZE;
+				ui8Register[0][ICM20948_INT_STATUS_2] |= ICM20948_FIFO_OVERFLOW_INT;
+			}
+		}
+	}
+
+	uint8_t getDmpMemory(uint16_t ui16Addr) {return ui8DmpMemory[ui16Addr % ICM20948_DMP_MEMORY_SIZE];}
+
+	/* Defective DMP memory cell: the bits of ui8StuckMask stay 0 when written (mask 0x00: no fault). Not
+	 * cleared by DEVICE_RESET. */
+	void setDmpFault(uint16_t ui16Addr, uint8_t ui8StuckMask)
+	{
+		ui16DmpFaultAddr = ui16Addr % ICM20948_DMP_MEMORY_SIZE;
+		ui8DmpFaultMask  = ui8StuckMask;
+	}
+
+	uint8_t getRegister(uint8_t ui8Bank, uint8_t ui8RegAddr)               {return ui8Register[ui8Bank & 0x03][ui8RegAddr & 0x7F];}
+	void    setRegister(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Data) {ui8Register[ui8Bank & 0x03][ui8RegAddr & 0x7F] = ui8Data;}
+
+	/* Bus endpoint */
+	void setSpeed(ICM20948_BusSpeed_t Speed)
+	{
+		if (Speed != this->Speed)
+		{
+			ui32SpeedSwitches++;
+			this->Speed = Speed;
+		}
+	}
+
+	int16_t readBurst(uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length)
+	{
+		ui32Transactions++;
+		ui32BytesRead += ui16Length;
+
+		for (uint16_t i = 0; i < ui16Length; i++)
+		{
+			/* The address does not increment when reading FIFO_R_W or MEM_R_W */
+			if (isStream(ui8RegAddr)) {pData[i] = readByte(ui8RegAddr);}
+			else                      {pData[i] = readByte((ui8RegAddr + i) & 0x7F);}
+		}
+
+		return 0;
+	}
+
+	int16_t writeBurst(uint8_t ui8RegAddr, const uint8_t *pData, uint16_t ui16Length)
+	{
+		ui32Transactions++;
+		ui32BytesWritten += ui16Length;
+
+		/* Writes are only specified up to 1 MHz */
+		if (Speed != ICM20948_SPEED_CONFIG) {ui32SpeedViolations++;}
+
+		for (uint16_t i = 0; i < ui16Length; i++)
+		{
+			if (isStream(ui8RegAddr)) {writeByte(ui8RegAddr, pData[i]);}
+			else                      {writeByte((ui8RegAddr + i) & 0x7F, pData[i]);}
+		}
+
+		return 0;
+	}
+
+	/* Counters (public for test and benchmark code) */
+	uint32_t ui32Transactions;
+	uint32_t ui32BytesRead;
+	uint32_t ui32BytesWritten;
+	uint32_t ui32SpeedSwitches;
+	uint32_t ui32SpeedViolations; // Writes with a speed class other than ICM20948_SPEED_CONFIG
+
+
+private:
+	uint8_t ui8Register[4][128];
+	uint8_t ui8Bank;
+	ICM20948_BusSpeed_t Speed;
+
+	uint8_t  ui8Fifo[ICM20948_FIFO_SIZE];
+	uint16_t ui16FifoHead;
+	uint16_t ui16FifoCount;
+
+	uint8_t  ui8DmpMemory[ICM20948_DMP_MEMORY_SIZE];
+	uint16_t ui16DmpFaultAddr;
+	uint8_t  ui8DmpFaultMask;
+
+	bool isStream(uint8_t ui8RegAddr)
+	{
+		return ui8Bank == 0 && (ui8RegAddr == ICM20948_FIFO_R_W || ui8RegAddr == ICM20948_MEM_R_W);
+	}
+
+	/* MEM_R_W accesses the DMP memory at MEM_BANK_SEL / MEM_START_ADDR, the address increments within the bank */
+	uint8_t *getDmpByte(void)
+	{
+		uint16_t ui16Addr = (ui8Register[0][ICM20948_MEM_BANK_SEL] << 8) | ui8Register[0][ICM20948_MEM_START_ADDR];
+
+		ui8Register[0][ICM20948_MEM_START_ADDR]++;
+
+		return &ui8DmpMemory[ui16Addr % ICM20948_DMP_MEMORY_SIZE];
+	}
+
+	uint8_t readByte(uint8_t ui8RegAddr)
+	{
+		uint8_t ui8Data;
+
+		if (ui8RegAddr == ICM20948_REG_BANK_SEL) {return ui8Bank << 4;}
+
+		if (ui8Bank == 0)
+		{
+			switch (ui8RegAddr)
+			{
+			case ICM20948_FIFO_COUNTH: return (ui16FifoCount >> 8) & 0x1F;
+			case ICM20948_FIFO_COUNTL: return ui16FifoCount;
+			case ICM20948_FIFO_R_W:
+				if (ui16FifoCount == 0) {return 0xFF;}
+				ui8Data = ui8Fifo[ui16FifoHead];
+				ui16FifoHead = (ui16FifoHead + 1) % ICM20948_FIFO_SIZE;
+				ui16FifoCount--;
+				return ui8Data;
+			case ICM20948_MEM_R_W:
+				return *getDmpByte();
+			case ICM20948_INT_STATUS:
+			case ICM20948_INT_STATUS_1:
+			case ICM20948_INT_STATUS_2:
+			case ICM20948_INT_STATUS_3:
+				/* Cleared on read */
+				ui8Data = ui8Register[0][ui8RegAddr];
+				ui8Register[0][ui8RegAddr] = 0x00;
+				return ui8Data;
+			default:
+				break;
+			}
+		}
+
+		return ui8Register[ui8Bank][ui8RegAddr];
+	}
+
+	void writeByte(uint8_t ui8RegAddr, uint8_t ui8Data)
+	{
+		if (ui8RegAddr == ICM20948_REG_BANK_SEL)
+		{
+			ui8Bank = (ui8Data >> 4) & 0x03;
+		}
+		else if (ui8Bank == 0 && ui8RegAddr == ICM20948_PWR_MGMT_1 && (ui8Data & ICM20948_DEVICE_RESET))
+		{
+			/* DEVICE_RESET restores the reset values and clears itself */
+			reset();
+		}
+		else if (ui8Bank == 0 && ui8RegAddr == ICM20948_FIFO_RST && (ui8Data & ICM20948_FIFO_RESET))
+		{
+			ui16FifoHead  = 0;
+			ui16FifoCount = 0;
+		}
+		else if (ui8Bank == 0 && ui8RegAddr == ICM20948_MEM_R_W)
+		{
+			uint8_t *pByte = getDmpByte();
+
+			*pByte = ui8Data;
+			if (pByte == &ui8DmpMemory[ui16DmpFaultAddr]) {*pByte &= ~ui8DmpFaultMask;}
+		}
+		else if (ui8Bank == 0 && ui8RegAddr == ICM20948_USER_CTRL)
+		{
+			/* DMP_RST clears itself */
+			ui8Register[0][ui8RegAddr] = ui8Data & ~ICM20948_DMP_RST;
+		}
+		else if (!(ui8Bank == 0 && ui8RegAddr == ICM20948_WHO_AM_I))
+		{
+			ui8Register[ui8Bank][ui8RegAddr] = ui8Data;
+		}
+	}
+};
+
+
+class ICM20948_MOCK_BUS
+{
+public:
+	static constexpr bool boSPI = true; // The emulator behaves like the SPI interface (I2C_IF_DIS is accepted)
+
+	ICM20948_MOCK_BUS(ICM20948_MOCK *pMock) {this->pMock = pMock;}
+
+	inline void setSpeedProfile(uint16_t ui16Config, uint16_t ui16Read, uint16_t ui16Burst)
+	{
+		(void)ui16Config; (void)ui16Read; (void)ui16Burst;
+	}
+
+	inline int16_t readBurst(uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length, ICM20948_BusSpeed_t Speed)
+	{
+		pMock->setSpeed(Speed);
+		return pMock->readBurst(ui8RegAddr, pData, ui16Length);
+	}
+
+	inline int16_t writeBurst(uint8_t ui8RegAddr, const uint8_t *pData, uint16_t ui16Length)
+	{
+		pMock->setSpeed(ICM20948_SPEED_CONFIG);
+		return pMock->writeBurst(ui8RegAddr, pData, ui16Length);
+	}
+
+
+private:
+	ICM20948_MOCK *pMock;
+};
+
+typedef ICM20948_MOCK     ICM20948_Port_t;
+typedef ICM20948_MOCK_BUS ICM20948_Bus_t;
+
+#elif defined (ICM20948_USE_I2C)
+/* I2C transport. The I2C class of the target device must provide register bursts with repeated start
+ * (same signature as the burst functions of the SPI class, plus the 7-bit slave address). */
+class ICM20948_I2C_BUS
+{
+public:
+	static constexpr bool boSPI = false;
+
+	ICM20948_I2C_BUS(I2C *pI2C)
+	{
+		this->pI2C = pI2C;
+		ui8SlaveAddr = ICM20948_I2C_BASE_ADDR | ICM20948_I2C_AD0;
+	}
+
+	/* All registers can be accessed with 400 kHz (datasheet p. 15), there is only one speed class */
+	inline void setSpeedProfile(uint16_t ui16Config, uint16_t ui16Read, uint16_t ui16Burst)
+	{
+		(void)ui16Config; (void)ui16Read; (void)ui16Burst;
+	}
+
+	inline int16_t readBurst(uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length, ICM20948_BusSpeed_t Speed)
+	{
+		(void)Speed;
+		return pI2C->readBurst(ui8SlaveAddr, ui8RegAddr, ui16Length, pData);
+	}
+
+	inline int16_t writeBurst(uint8_t ui8RegAddr, const uint8_t *pData, uint16_t ui16Length)
+	{
+		return pI2C->writeBurst(ui8SlaveAddr, ui8RegAddr, ui16Length, (uint8_t *)pData);
+	}
+
+
+private:
+	I2C *pI2C;
+	uint8_t ui8SlaveAddr;
+};
+
+typedef I2C              ICM20948_Port_t;
+typedef ICM20948_I2C_BUS ICM20948_Bus_t;
+
+#else
+/* SPI transport. The first byte includes the R/W-bit (read = 1, write = 0) and the 7-bit register address,
+ * the address auto-increments during a burst (datasheet p. 31).
+ * With ICM20948_SPI_SPEED_PROFILES, every transfer runs with the prescaler of its speed class. The prescaler
+ * is only changed when the class changes (the SPI class must provide setBaudRatePrescaler()). */
+class ICM20948_SPI_BUS
+{
+public:
+	static constexpr bool boSPI = true;
+
+	ICM20948_SPI_BUS(SPI *pSPI)
+	{
+		this->pSPI = pSPI;
+
+		ui16Prescaler[ICM20948_SPEED_CONFIG] = ICM20948_SPI_PRESC_SLOW;
+		ui16Prescaler[ICM20948_SPEED_READ]   = ICM20948_SPI_PRESC_SLOW;
+		ui16Prescaler[ICM20948_SPEED_BURST]  = ICM20948_SPI_PRESC_FAST;
+		ui8CurrentSpeed = 0xFF; // Unknown, the first transfer sets the prescaler
+	}
+
+	inline void setSpeedProfile(uint16_t ui16Config, uint16_t ui16Read, uint16_t ui16Burst)
+	{
+		ui16Prescaler[ICM20948_SPEED_CONFIG] = ui16Config;
+		ui16Prescaler[ICM20948_SPEED_READ]   = ui16Read;
+		ui16Prescaler[ICM20948_SPEED_BURST]  = ui16Burst;
+		ui8CurrentSpeed = 0xFF;
+	}
+
+	inline int16_t readBurst(uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length, ICM20948_BusSpeed_t Speed)
+	{
+		uint8_t ui8Data = 0x80 | ui8RegAddr;
+
+		setSpeed(Speed);
+
+		pSPI->enableNSS();
+		if (pSPI->transmitSPI(&ui8Data, 1) != 0)       {pSPI->disableNSS(); return -1;}
+		if (pSPI->receiveSPI(pData, ui16Length) != 0) {pSPI->disableNSS(); return -1;}
+		pSPI->disableNSS();
+
+		return 0;
+	}
+
+	inline int16_t writeBurst(uint8_t ui8RegAddr, const uint8_t *pData, uint16_t ui16Length)
+	{
+		uint8_t ui8Data = 0x7F & ui8RegAddr;
+
+		setSpeed(ICM20948_SPEED_CONFIG);
+
+		pSPI->enableNSS();
+		if (pSPI->transmitSPI(&ui8Data, 1) != 0)                   {pSPI->disableNSS(); return -1;}
+		if (pSPI->transmitSPI((uint8_t *)pData, ui16Length) != 0) {pSPI->disableNSS(); return -1;}
+		pSPI->disableNSS();
+
+		return 0;
+	}
+
+
+private:
+	SPI *pSPI;
+	uint16_t ui16Prescaler[3];
+	uint8_t  ui8CurrentSpeed;
+
+	inline void setSpeed(ICM20948_BusSpeed_t Speed)
+	{
+#if defined (ICM20948_SPI_SPEED_PROFILES)
+		if (Speed != ui8CurrentSpeed)
+		{
+			pSPI->setBaudRatePrescaler(ui16Prescaler[Speed]);
+			ui8CurrentSpeed = Speed;
+		}
+#else
+		(void)Speed;
+#endif
+	}
+};
+
+typedef SPI              ICM20948_Port_t;
+typedef ICM20948_SPI_BUS ICM20948_Bus_t;
+#endif
+
+
+#endif /* ZULS_INCLUDE_ICM20948BUS_HPP_ */
@@ -60,6 +60,9 @@ constexpr uint8_t ICM20948_FIFO_COUNTL           {0x71};    // Permission: R
 constexpr uint8_t ICM20948_FIFO_R_W              {0x72};    // Permission: R/W
 constexpr uint8_t ICM20948_DATA_RDY_STATUS       {0x74};    // Permission: R/C
 constexpr uint8_t ICM20948_FIFO_CFG              {0x76};    // Permission: R/W
+constexpr uint8_t ICM20948_MEM_START_ADDR        {0x7C};    // Permission: R/W (DMP memory, not in datasheet)
+constexpr uint8_t ICM20948_MEM_R_W               {0x7D};    // Permission: R/W
+constexpr uint8_t ICM20948_MEM_BANK_SEL          {0x7E};    // Permission: R/W
 
 /*************************************************************************************
  * User bank 1 (ICM-20948 datasheet p. 33 f.)
@@ -97,6 +100,8 @@ constexpr uint8_t ICM20948_ACCEL_INTEL_CTRL      {0x12};    // Permission: R/W
 constexpr uint8_t ICM20948_ACCEL_WOM_THR         {0x13};    // Permission: R/W
 constexpr uint8_t ICM20948_ACCEL_CONFIG          {0x14};    // Permission: R/W
 constexpr uint8_t ICM20948_ACCEL_CONFIG_2        {0x15};    // Permission: R/W
+constexpr uint8_t ICM20948_PRGM_START_ADDRH      {0x50};    // Permission: R/W (DMP program start, not in datasheet)
+constexpr uint8_t ICM20948_PRGM_START_ADDRL      {0x51};    // Permission: R/W
 constexpr uint8_t ICM20948_FSYNC_CONFIG          {0x52};    // Permission: R/W
 constexpr uint8_t ICM20948_TEMP_CONFIG           {0x53};    // Permission: R/W
 constexpr uint8_t ICM20948_MOD_CTRL_USR          {0x54};    // Permission: R/W
@@ -124,18 +129,121 @@ constexpr uint8_t ICM20948_REG_BANK_SEL          {0x7F};    // Permission: R/W
 /*************************************************************************************
  * Register bits
  *************************************************************************************/
-constexpr uint8_t ICM20948_I2C_IF_DIS            {0x10};    // ICM20948_USER_CTRL (datasheet p. 36)
+constexpr uint8_t ICM20948_DMP_EN                {0x80};    // ICM20948_USER_CTRL (datasheet p. 36)
+constexpr uint8_t ICM20948_FIFO_EN               {0x40};    // ICM20948_USER_CTRL
+constexpr uint8_t ICM20948_I2C_IF_DIS            {0x10};    // ICM20948_USER_CTRL
+constexpr uint8_t ICM20948_DMP_RST               {0x08};    // ICM20948_USER_CTRL (auto clear)
 
 constexpr uint8_t ICM20948_DEVICE_RESET          {0x80};    // ICM20948_PWR_MGMT_1 (datasheet p. 37)
 constexpr uint8_t ICM20948_SLEEP                 {0x40};    // ICM20948_PWR_MGMT_1
+constexpr uint8_t ICM20948_TEMP_DIS              {0x08};    // ICM20948_PWR_MGMT_1
+
+constexpr uint8_t ICM20948_DISABLE_ACCEL         {0x38};    // ICM20948_PWR_MGMT_2 (datasheet p. 37)
+constexpr uint8_t ICM20948_DISABLE_GYRO          {0x07};    // ICM20948_PWR_MGMT_2
 
 constexpr uint8_t ICM20948_GYRO_DLPFCFG          {0x38};    // ICM20948_GYRO_CONFIG_1 (datasheet p. 59)
 constexpr uint8_t ICM20948_GYRO_FS_SEL           {0x06};    // ICM20948_GYRO_CONFIG_1
 constexpr uint8_t ICM20948_GYRO_FCHOICE          {0x01};    // ICM20948_GYRO_CONFIG_1
+constexpr uint8_t ICM20948_GYRO_CTEN             {0x38};    // ICM20948_GYRO_CONFIG_2 (X/Y/ZGYRO_CTEN, datasheet p. 60)
 
 constexpr uint8_t ICM20948_ACCEL_DLPFCFG         {0x38};    // ICM20948_ACCEL_CONFIG (datasheet p. 64)
 constexpr uint8_t ICM20948_ACCEL_FS_SEL          {0x06};    // ICM20948_ACCEL_CONFIG
 constexpr uint8_t ICM20948_ACCEL_FCHOICE         {0x01};    // ICM20948_ACCEL_CONFIG
+constexpr uint8_t ICM20948_ACCEL_ST_EN           {0x1C};    // ICM20948_ACCEL_CONFIG_2 (AX/AY/AZ_ST_EN_REG, datasheet p. 65)
+
+constexpr uint8_t ICM20948_ODR_ALIGN              {0x01};    // ICM20948_ODR_ALIGN_EN (datasheet p. 63)
+
+constexpr uint8_t ICM20948_ACTL_FSYNC            {0x08};    // ICM20948_INT_PIN_CFG (datasheet p. 38)
+
+constexpr uint8_t ICM20948_DELAY_TIME_EN         {0x80};    // ICM20948_FSYNC_CONFIG (datasheet p. 65)
+constexpr uint8_t ICM20948_EXT_SYNC_SET          {0x0F};    // ICM20948_FSYNC_CONFIG
+
+constexpr uint8_t ICM20948_RAW_DATA_0_RDY_EN     {0x01};    // ICM20948_INT_ENABLE_1 (datasheet p. 38)
+constexpr uint8_t ICM20948_RAW_DATA_0_RDY_INT    {0x01};    // ICM20948_INT_STATUS_1 (datasheet p. 40)
+constexpr uint8_t ICM20948_FIFO_OVERFLOW_INT     {0x1F};    // ICM20948_INT_STATUS_2 (datasheet p. 41)
+constexpr uint8_t ICM20948_FIFO_OVERFLOW_EN      {0x1F};    // ICM20948_INT_ENABLE_2 (datasheet p. 39)
+
+constexpr uint8_t ICM20948_ACCEL_FIFO_EN         {0x10};    // ICM20948_FIFO_EN_2 (datasheet p. 55)
+constexpr uint8_t ICM20948_GYRO_FIFO_EN          {0x0E};    // ICM20948_FIFO_EN_2 (GYRO_Z/Y/X_FIFO_EN)
+constexpr uint8_t ICM20948_TEMP_FIFO_EN          {0x01};    // ICM20948_FIFO_EN_2
+
+constexpr uint8_t ICM20948_FIFO_RESET            {0x1F};    // ICM20948_FIFO_RST (datasheet p. 56)
+constexpr uint8_t ICM20948_FIFO_SNAPSHOT         {0x1F};    // ICM20948_FIFO_MODE (0 = stream mode)
+
+/*************************************************************************************
+ * FIFO
+ *************************************************************************************/
+constexpr uint16_t ICM20948_FIFO_SIZE            {512};     // Bytes
+constexpr uint8_t  ICM20948_FIFO_FRAME_SIZE      {12};      // Accelerometer + gyroscope (FIFO_EN_2 = 0x1E)
+
+/*************************************************************************************
+ * DMP (not documented in the datasheet, see InvenSense eMD and the DMP application notes)
+ *
+ * The DMP memory is accessed in banks of 256 bytes: MEM_BANK_SEL selects the bank, MEM_START_ADDR the
+ * address within the bank, MEM_R_W reads or writes with auto-increment (the register address itself does
+ * not increment during a burst). A burst must not cross a bank boundary.
+ *************************************************************************************/
+constexpr uint16_t ICM20948_DMP_LOAD_START       {0x0090};  // Firmware image is loaded to this address
+constexpr uint16_t ICM20948_DMP_START_ADDR       {0x1000};  // Program start (PRGM_START_ADDRH/L)
+constexpr uint16_t ICM20948_DMP_MEMORY_SIZE      {0x4000};  // Bytes
+constexpr uint8_t  ICM20948_DMP_CHUNK_SIZE       {16};      // Max. bytes per MEM_R_W burst
+
+/* DMP memory addresses of the configuration (big endian values) */
+constexpr uint16_t ICM20948_DMP_DATA_OUT_CTL1    {4 * 16};        // 2 bytes, ICM20948_DMP_... outputs
+constexpr uint16_t ICM20948_DMP_DATA_OUT_CTL2    {4 * 16 + 2};    // 2 bytes, ICM20948_DMP_HDR2_... outputs
+constexpr uint16_t ICM20948_DMP_DATA_INTR_CTL    {4 * 16 + 12};   // 2 bytes, outputs that assert the interrupt
+constexpr uint16_t ICM20948_DMP_MOTION_EVENT_CTL {4 * 16 + 14};   // 2 bytes
+constexpr uint16_t ICM20948_DMP_DATA_RDY_STATUS  {8 * 16 + 10};   // 2 bytes, sensors the DMP waits for
+constexpr uint16_t ICM20948_DMP_ODR_QUAT9        {10 * 16 + 8};   // 2 bytes, output rate = DMP rate / (value + 1)
+constexpr uint16_t ICM20948_DMP_ODR_PQUAT6       {10 * 16 + 4};
+constexpr uint16_t ICM20948_DMP_ODR_QUAT6        {10 * 16 + 12};
+constexpr uint16_t ICM20948_DMP_ODR_GYRO_CALIBR  {11 * 16 + 8};
+constexpr uint16_t ICM20948_DMP_ODR_GYRO         {11 * 16 + 10};
+constexpr uint16_t ICM20948_DMP_ODR_ACCEL        {11 * 16 + 14};
+constexpr uint16_t ICM20948_DMP_GYRO_SF          {19 * 16};       // 4 bytes, see enableDmp()
+constexpr uint16_t ICM20948_DMP_ACC_SCALE        {30 * 16};       // 4 bytes
+constexpr uint16_t ICM20948_DMP_GYRO_FULLSCALE   {72 * 16 + 12};  // 4 bytes
+constexpr uint16_t ICM20948_DMP_ACC_SCALE2       {79 * 16 + 4};   // 4 bytes
+
+constexpr uint32_t ICM20948_DMP_ACC_SCALE_4G     {0x04000000};    // ACC_SCALE for ACCEL_FS_4G (DMP default)
+constexpr uint32_t ICM20948_DMP_ACC_SCALE2_4G    {0x00040000};    // ACC_SCALE2 for ACCEL_FS_4G
+constexpr uint32_t ICM20948_DMP_GYRO_FS_2000DPS  {0x10000000};    // GYRO_FULLSCALE for GYRO_FS_2000DPS
+
+constexpr uint16_t ICM20948_DMP_RDY_GYRO         {0x0001};  // ICM20948_DMP_DATA_RDY_STATUS
+constexpr uint16_t ICM20948_DMP_RDY_ACCEL        {0x0002};
+
+constexpr uint16_t ICM20948_DMP_EVENT_GYRO_CALIBR  {0x0100}; // ICM20948_DMP_MOTION_EVENT_CTL
+constexpr uint16_t ICM20948_DMP_EVENT_ACCEL_CALIBR {0x0200};
+
+/* Header of a DMP FIFO packet (same bits as DATA_OUT_CTL1). The data follows in the order of the bits
+ * (MSB first), the packet ends with a 2 byte footer. */
+constexpr uint16_t ICM20948_DMP_ACCEL            {0x8000};  //  6 bytes
+constexpr uint16_t ICM20948_DMP_GYRO             {0x4000};  // 12 bytes (raw + bias)
+constexpr uint16_t ICM20948_DMP_CPASS            {0x2000};  //  6 bytes
+constexpr uint16_t ICM20948_DMP_ALS              {0x1000};  //  8 bytes
+constexpr uint16_t ICM20948_DMP_QUAT6            {0x0800};  // 12 bytes
+constexpr uint16_t ICM20948_DMP_QUAT9            {0x0400};  // 14 bytes (incl. accuracy)
+constexpr uint16_t ICM20948_DMP_PQUAT6           {0x0200};  //  6 bytes
+constexpr uint16_t ICM20948_DMP_GEOMAG           {0x0100};  // 14 bytes
+constexpr uint16_t ICM20948_DMP_PRESSURE         {0x0080};  //  6 bytes
+constexpr uint16_t ICM20948_DMP_GYRO_CALIBR      {0x0040};  // 12 bytes
+constexpr uint16_t ICM20948_DMP_CPASS_CALIBR     {0x0020};  // 12 bytes
+constexpr uint16_t ICM20948_DMP_STEP_DETECTOR    {0x0010};  //  4 bytes
+constexpr uint16_t ICM20948_DMP_HEADER2          {0x0008};  //  2 bytes (second header)
+
+/* Second header (same bits as DATA_OUT_CTL2), its data follows the data of the first header */
+constexpr uint16_t ICM20948_DMP_HDR2_ACCEL_ACCURACY {0x4000};  // 2 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_GYRO_ACCURACY  {0x2000};  // 2 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_CPASS_ACCURACY {0x1000};  // 2 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_FSYNC          {0x0800};  // 2 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_PICKUP         {0x0400};  // 2 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_BATCH_MODE     {0x0100};  // 0 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_ACT_RECOG      {0x0080};  // 6 bytes
+constexpr uint16_t ICM20948_DMP_HDR2_SECONDARY     {0x0040};  // 2 bytes (secondary sensor on/off)
+
+constexpr uint8_t  ICM20948_DMP_FOOTER_SIZE      {2};
+constexpr uint8_t  ICM20948_DMP_MAX_PACKET       {136};     // All outputs of both headers + footer
+constexpr uint16_t ICM20948_DMP_BUFFER_SIZE      {256};     // FIFO bytes buffered by readDmpPackets()
 
 
 #endif /* ZULS_INCLUDE_ICM20948REG_HPP_ */
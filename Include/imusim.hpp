@@ -0,0 +1,146 @@
+/*
+ * imusim.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_IMUSIM_HPP_
+#define ZULS_INCLUDE_IMUSIM_HPP_
+
+#include "icm20948.hpp"
+
+
+#define IMUSIM_FRAME_SIZE       14  // ACCEL_XOUT_H...TEMP_OUT_L (big endian, see ICM20948_MOCK::setSensorData())
+#define IMUSIM_MAX_TONES        4
+#define IMUSIM_BIAS_DECIMATION  16  // Samples per update of the bias processes (power of two)
+#define IMUSIM_RENORM_INTERVAL  4096
+
+/* Sinusoidal vibration component */
+typedef struct
+{
+	float              fFreq;     // [Hz], 0: unused
+	ICM20948_fVector_t Amplitude; // [g]
+}IMUSIM_Tone_t;
+
+typedef struct
+{
+	float    fSampleRate;             // ODR [Hz]
+	uint32_t ui32Seed;                // Same seed and configuration: same frame sequence
+
+	/* Motion */
+	ICM20948_fVector_t Gravity;       // Specific force at the start [g], e.g. {0, 0, 1} (board level)
+	ICM20948_fVector_t Rate;          // Constant angular rate [dps], rotates the gravity vector
+	IMUSIM_Tone_t      Tone[IMUSIM_MAX_TONES];
+	ICM20948_fVector_t ImpactPeak;    // Half-sine shock [g], 0: no impacts
+	float              fImpactLength; // [s]
+	float              fImpactPeriod; // [s]
+
+	/* Noise model (per axis) */
+	float fAccelNoise;                // White noise density [g/sqrt(Hz)], bandwidth fSampleRate / 2
+	float fGyroNoise;                 // [dps/sqrt(Hz)]
+	float fAccelBias;                 // Standard deviation of the turn-on bias [g]
+	float fGyroBias;                  // [dps]
+	float fAccelInstability;          // Bias instability, Gauss-Markov process [g]
+	float fGyroInstability;           // [dps]
+	float fCorrelationTime;           // Of the Gauss-Markov processes [s]
+	float fAccelRandomWalk;           // Bias random walk [g/sqrt(s)]
+	float fGyroRandomWalk;            // [dps/sqrt(s)]
+
+	/* Temperature */
+	float fTemperature;               // At the start [degC]
+	float fTemperatureSlope;          // [degC/s]
+	float fAccelTempCoeff;            // Bias drift [g/degC]
+	float fGyroTempCoeff;             // [dps/degC]
+}IMUSIM_Config_t;
+
+/* Static board at 1125Hz with the typical noise densities of the datasheet (p. 11 f.) */
+constexpr IMUSIM_Config_t IMUSIM_DEFAULT_CONFIG =
+{
+	1125.0, 1,
+	{0.0, 0.0, 1.0}, {0.0, 0.0, 0.0},
+	{{0.0, {0.0, 0.0, 0.0}}, {0.0, {0.0, 0.0, 0.0}}, {0.0, {0.0, 0.0, 0.0}}, {0.0, {0.0, 0.0, 0.0}}},
+	{0.0, 0.0, 0.0}, 0.0, 0.0,
+	0.00023, 0.015, 0.025, 0.5, 0.0002, 0.01, 100.0, 0.00002, 0.002,
+	25.0, 0.0, 0.0001, 0.005
+};
+
+/* Ground truth of the last generated frame */
+typedef struct
+{
+	ICM20948_fVector_t Accel;        // Specific force [g] without bias and noise (gravity, vibration, impact)
+	ICM20948_fVector_t Gyro;         // [dps]
+	ICM20948_fVector_t AccelBias;    // Total bias (turn-on, instability, random walk, temperature) [g]
+	ICM20948_fVector_t GyroBias;     // [dps]
+	float              fTemperature; // [degC]
+}IMUSIM_Truth_t;
+
+
+/* Deterministic synthetic IMU signal for benchmarks and tests on the host. The frames have the register format
+ * of the sensor (quantized with the selected full scale, saturated at +-32767) and can be decoded by the driver
+ * or fed into ICM20948_MOCK::pushSample(). Speed matters more than statistical perfection: the white noise is
+ * the normalized sum of four 16-bit uniform numbers (xorshift64*, truncated at +-3.46 sigma), the bias processes
+ * are updated every IMUSIM_BIAS_DECIMATION samples, and the rotation and the vibration tones are advanced with
+ * constant per-sample rotations (no trigonometric functions in the sample loop). */
+class IMUSIM
+{
+public:
+	/* Constructor */
+	IMUSIM(const IMUSIM_Config_t *pConfig = &IMUSIM_DEFAULT_CONFIG, ICM20948_FullScale_t AccelFullScale = ACCEL_FS_2G,
+		   ICM20948_FullScale_t GyroFullScale = GYRO_FS_250DPS);
+
+	/* Methods */
+	int16_t init(const IMUSIM_Config_t *pConfig);
+	void reset(void);
+	void setFullScale(ICM20948_FullScale_t AccelFullScale, ICM20948_FullScale_t GyroFullScale);
+
+	void generate(uint8_t *pFrames, uint32_t ui32Count);
+	void generate(ICM20948_Frame_t *pFrames, uint32_t ui32Count);
+
+	void getTruth(IMUSIM_Truth_t *pTruth);
+	uint64_t getSampleCount(void);
+
+
+private:
+	/* Variables */
+	IMUSIM_Config_t Config;
+	float fAccelCounts;          // Counts per g
+	float fGyroCounts;           // Counts per dps
+	uint8_t ui8Range;            // ICM20948_RANGE() of the selected full scale
+
+	uint64_t ui64State;          // xorshift64*
+	uint64_t ui64Samples;
+	float    fDt;
+
+	float fAccelSigma;           // Standard deviation of the white noise per sample
+	float fGyroSigma;
+	ICM20948_fVector_t Gravity;  // Gravity part of the specific force
+	float fRotation[3][3];       // Rotation of the gravity vector per sample
+	bool  boRotation;
+	float fTone[IMUSIM_MAX_TONES][2];     // Phasor (cos, sin)
+	float fToneStep[IMUSIM_MAX_TONES][2];
+	uint32_t ui32ImpactPeriod;   // [samples]
+	uint32_t ui32ImpactLength;
+	uint32_t ui32ImpactPhase;    // Samples since the start of the last impact
+	float    fImpact[2];         // Phasor of the half-sine (cos, sin)
+	float    fImpactStep[2];
+
+	float fGaussMarkov;          // Coefficient of the Gauss-Markov processes per bias update
+	float fAccelGMDrive, fGyroGMDrive;
+	float fAccelRWStep, fGyroRWStep;
+	float fAccelTurnOn[3], fGyroTurnOn[3];
+	float fAccelGM[3], fGyroGM[3];
+	float fAccelRW[3], fGyroRW[3];
+
+	IMUSIM_Truth_t Truth;
+
+	/* Methods */
+	void step(int16_t *pRaw);
+	void updateBias(void);
+	inline uint64_t getRandom(void);
+	inline float getGauss(void);
+	inline int16_t quantize(float fValue, float fCounts);
+};
+
+
+#endif /* ZULS_INCLUDE_IMUSIM_HPP_ */
@@ -0,0 +1,155 @@
+/*
+ * motion.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_MOTION_HPP_
+#define ZULS_INCLUDE_MOTION_HPP_
+
+#include "icm20948.hpp"
+
+
+#define MOTION_QUEUE_SIZE     16    // Power of two
+#define MOTION_LSB_PER_G      1024  // Internal resolution of the detectors (independent of the full scale)
+
+/* Event types (also used as bits of MOTION_Config_t.ui8Enable) */
+#define MOTION_EVENT_SHOCK         0x01
+#define MOTION_EVENT_FREEFALL      0x02
+#define MOTION_EVENT_TAP           0x04
+#define MOTION_EVENT_DOUBLE_TAP    0x08  // If disabled, a tap is reported without waiting for a second one
+#define MOTION_EVENT_ORIENTATION   0x10
+
+/* Orientation (axis pointing up) and direction of a tap */
+#define MOTION_ORIENT_X_POS        0
+#define MOTION_ORIENT_X_NEG        1
+#define MOTION_ORIENT_Y_POS        2
+#define MOTION_ORIENT_Y_NEG        3
+#define MOTION_ORIENT_Z_POS        4
+#define MOTION_ORIENT_Z_NEG        5
+#define MOTION_ORIENT_UNKNOWN      0xFF
+
+/* Thresholds in mg, durations in samples */
+typedef struct
+{
+	uint32_t ui32SamplePeriod;       // Timestamp units per frame (e.g. us: 889 at 1125Hz)
+	uint16_t ui16ShockThreshold;     // Magnitude of the acceleration
+	uint16_t ui16ShockDuration;      // Min. samples above the threshold
+	uint16_t ui16FreeFallThreshold;  // Magnitude of the acceleration
+	uint16_t ui16FreeFallDuration;   // Min. samples below the threshold
+	uint16_t ui16TapThreshold;       // Deviation of an axis from its low-pass value
+	uint16_t ui16TapMaxDuration;     // Max. samples above the threshold (longer: no tap)
+	uint16_t ui16TapQuiet;           // Samples after a tap in which no tap is detected
+	uint16_t ui16TapWindow;          // Samples after a tap in which a second tap makes a double tap
+	uint16_t ui16OrientThreshold;    // Min. low-pass gravity on the axis pointing up
+	uint16_t ui16OrientDuration;     // Samples the new orientation must be stable
+	uint16_t ui16Hysteresis;         // Release of shock (below threshold - hysteresis), free-fall (above) and tap
+	uint8_t  ui8TapShift;            // Low-pass of the tap detector: 2^ui8TapShift samples (1...15)
+	uint8_t  ui8OrientShift;         // Low-pass of the orientation detector: 2^ui8OrientShift samples (1...15)
+	uint8_t  ui8Enable;              // MOTION_EVENT_...
+}MOTION_Config_t;
+
+/* Example for 1125Hz and timestamps in us */
+constexpr MOTION_Config_t MOTION_DEFAULT_CONFIG =
+{
+	889,
+	3000, 3,
+	300, 120,
+	500, 20, 60, 300,
+	800, 500,
+	100,
+	3, 7,
+	MOTION_EVENT_SHOCK | MOTION_EVENT_FREEFALL | MOTION_EVENT_TAP | MOTION_EVENT_DOUBLE_TAP | MOTION_EVENT_ORIENTATION
+};
+
+typedef struct
+{
+	uint32_t ui32Timestamp; // Start of the event (shock, free-fall, tap) or time of the orientation change
+	uint8_t  ui8Type;       // MOTION_EVENT_...
+	uint8_t  ui8Direction;  // MOTION_ORIENT_...: direction of the (first) tap, new orientation
+	uint8_t  ui8Previous;   // Previous orientation (MOTION_EVENT_ORIENTATION)
+	uint16_t ui16Duration;  // Samples (shock, free-fall, tap)
+	uint16_t ui16Value;     // [mg] peak magnitude (shock), min. magnitude (free-fall), peak deviation (tap)
+}MOTION_Event_t;
+
+
+/* Shock, free-fall, single/double tap and orientation change on every decoded frame (burst or FIFO batch).
+ * The samples are converted to MOTION_LSB_PER_G with the full scale they carry (ui8Range), the detectors use
+ * integer arithmetic only with a constant cost per sample (squared magnitudes against squared thresholds,
+ * low-pass filters with shifts). Frames marked with ICM20948_FRAME_TRANSITION are skipped.
+ * The events are written into a single-producer single-consumer queue: process() may run in an interrupt or
+ * an acquisition thread, getEvent() in the application. A full queue drops new events (getDropped()). */
+class MOTION
+{
+public:
+	/* Constructor */
+	MOTION(const MOTION_Config_t *pConfig = &MOTION_DEFAULT_CONFIG);
+
+	/* Methods */
+	int16_t init(const MOTION_Config_t *pConfig);
+	void reset(void);
+	uint16_t process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, uint32_t ui32Timestamp);
+
+	int16_t getEvent(MOTION_Event_t *pEvent);
+	uint32_t getDropped(void);
+	uint8_t getOrientation(void);
+
+
+private:
+	/* Variables */
+	MOTION_Config_t Config;
+	uint32_t ui32ShockThr2;       // Squared thresholds [MOTION_LSB_PER_G^2]
+	uint32_t ui32ShockRelease2;
+	uint32_t ui32FreeFallThr2;
+	uint32_t ui32FreeFallRelease2;
+	int32_t  i32TapThr;
+	int32_t  i32TapRelease;
+	int32_t  i32OrientThr;
+
+	/* Shock */
+	bool     boShock;
+	uint16_t ui16ShockLength;
+	uint32_t ui32ShockPeak2;
+	uint32_t ui32ShockStart;
+
+	/* Free-fall */
+	uint16_t ui16FreeFallLength;
+	uint32_t ui32FreeFallMin2;
+	uint32_t ui32FreeFallStart;
+
+	/* Tap */
+	int32_t  i32TapLowPass[3];    // Q8
+	bool     boTap;
+	bool     boTapReject;         // Current deviation is too long for a tap
+	uint16_t ui16TapLength;
+	int32_t  i32TapPeak;
+	uint8_t  ui8TapDirection;
+	uint32_t ui32TapStart;
+	uint16_t ui16TapQuiet;
+	uint16_t ui16TapWindow;       // > 0: a tap waits for a second one
+	MOTION_Event_t PendingTap;
+
+	/* Orientation */
+	int32_t  i32OrientLowPass[3]; // Q8
+	uint8_t  ui8Orientation;
+	uint8_t  ui8Candidate;
+	uint16_t ui16CandidateLength;
+
+	bool     boFirst;             // Low-pass filters start at the first sample
+
+	/* Queue */
+	MOTION_Event_t Queue[MOTION_QUEUE_SIZE];
+	std::atomic<uint16_t> ui16Head;  // Written by the producer (process())
+	std::atomic<uint16_t> ui16Tail;  // Written by the consumer (getEvent())
+	std::atomic<uint32_t> ui32Dropped;
+
+	/* Methods */
+	inline void processSample(const int32_t *pSample, uint32_t ui32Time);
+	bool pushEvent(const MOTION_Event_t *pEvent);
+	static uint16_t toMilliG(uint32_t ui32Value);
+	static uint32_t sqrtInt(uint32_t ui32Value);
+};
+
+
+#endif /* ZULS_INCLUDE_MOTION_HPP_ */
@@ -0,0 +1,52 @@
+/*
+ * seqframe.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_SEQFRAME_HPP_
+#define ZULS_INCLUDE_SEQFRAME_HPP_
+
+#include "icm20948.hpp"
+
+
+#define SEQFRAME_MAX_RETRIES  64  // Default bound of the read attempts of a reader
+
+/* Published sample */
+typedef struct
+{
+	ICM20948_Frame_t Frame;
+	uint64_t         ui64Timestamp; // Time base of the acquisition thread, e.g. CLOCK_MONOTONIC [ns]
+	uint32_t         ui32Sequence;  // Number of the publication (1, 2, ...), 0: nothing published yet
+}SEQFRAME_Sample_t;
+
+constexpr uint16_t SEQFRAME_WORDS = (sizeof(SEQFRAME_Sample_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+
+/* Publication of the latest frame for several consumer threads (sequence lock). One acquisition thread writes
+ * with publish(), which never blocks. Any number of readers take consistent copies without locks or system
+ * calls: the sequence counter is odd while a write is in progress, a reader retries if the counter was odd or
+ * changed during its copy. The number of attempts is bounded (a reader never waits on the writer). The sample
+ * is stored in atomic words (relaxed accesses, ordered with fences), so a torn copy is discarded, not a data
+ * race. Lock-free on targets with native 32-bit atomics (Cortex-M3/M4/M7, x86, ARMv8). */
+class SEQFRAME
+{
+public:
+	/* Constructor */
+	SEQFRAME(void);
+
+	/* Methods */
+	void publish(const ICM20948_Frame_t *pFrame, uint64_t ui64Timestamp);
+	int16_t read(SEQFRAME_Sample_t *pSample, uint16_t ui16MaxRetries = SEQFRAME_MAX_RETRIES);
+	uint32_t getSequence(void);
+
+
+private:
+	/* Variables */
+	std::atomic<uint32_t> ui32Sequence;            // Twice the number of publications, +1 during a write
+	std::atomic<uint32_t> ui32Data[SEQFRAME_WORDS];
+};
+
+
+#endif /* ZULS_INCLUDE_SEQFRAME_HPP_ */
@@ -0,0 +1,105 @@
+/*
+ * spectrum.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_INCLUDE_SPECTRUM_HPP_
+#define ZULS_INCLUDE_SPECTRUM_HPP_
+
+#include "icm20948.hpp"
+
+
+#ifndef SPECTRUM_MAX_SIZE
+	#define SPECTRUM_MAX_SIZE   512  // Max. FFT length (power of two), all buffers are sized for it
+#endif
+#define SPECTRUM_MIN_SIZE       16
+#define SPECTRUM_AXES           3    // Accel X/Y/Z
+#define SPECTRUM_MAX_BANDS      16
+
+#define SPECTRUM_LEVEL_REF      1.0e-6f // Reference of the packed band levels [g] (level 0)
+#define SPECTRUM_LEVEL_STEP     0.5f    // Step of the packed band levels [dB]
+
+/* Size of a packed summary: header + per axis (overall level, peak bin, band levels) */
+#define SPECTRUM_PACKED_SIZE(Bands)   (8 + SPECTRUM_AXES * (3 + (Bands)))
+
+typedef struct
+{
+	float    fSampleRate;                        // Rate of the frames [Hz], e.g. 1125 (ACCEL_SR_1125_HZ)
+	uint16_t ui16Size;                           // FFT length, power of two, SPECTRUM_MIN_SIZE...SPECTRUM_MAX_SIZE
+	uint16_t ui16Hop;                            // Frames between two windows, 1...ui16Size (ui16Size / 2: 50% overlap)
+	uint16_t ui16Averages;                       // Windows per summary
+	uint8_t  ui8Bands;                           // 0...SPECTRUM_MAX_BANDS
+	float    fBandEdge[SPECTRUM_MAX_BANDS + 1];  // Ascending band edges [Hz], band i is fBandEdge[i]...fBandEdge[i+1]
+}SPECTRUM_Config_t;
+
+typedef struct
+{
+	uint32_t ui32Sequence;                              // Number of the summary (starts with 1)
+	uint16_t ui16Windows;                               // Averaged windows
+	uint8_t  ui8Bands;
+	uint8_t  ui8Flags;                                  // ICM20948_FRAME_... of the frames of all windows
+	float    fRms[SPECTRUM_AXES];                       // Overall RMS without DC [g]
+	float    fPeakFreq[SPECTRUM_AXES];                  // Center of the largest bin [Hz]
+	float    fPeakPsd[SPECTRUM_AXES];                   // [g^2/Hz]
+	float    fBandRms[SPECTRUM_AXES][SPECTRUM_MAX_BANDS];  // [g]
+}SPECTRUM_Summary_t;
+
+
+/* Vibration spectrum of the accelerometer (condition monitoring with FIFO batches, up to 1125Hz).
+ * The frames are converted to g with the full scale they carry (ui8Range), every ui16Hop frames the last
+ * ui16Size samples of each axis are detrended (mean), weighted with a Hann window and transformed with a real
+ * FFT. ui16Averages power spectral densities (Welch, one-sided) are averaged and reduced to a summary with the
+ * overall RMS, the peak and the RMS of the configured bands.
+ * The real FFT of length N runs as a complex FFT of length N/2 (radix-2^2 decimation in frequency, the last stage
+ * is radix-2 if log2(N/2) is odd). Real and imaginary parts are stored in separate arrays, the inner loop of a
+ * stage runs over contiguous elements with the same twiddle stride (SIMD friendly). All buffers are members. */
+class SPECTRUM
+{
+public:
+	/* Constructor */
+	SPECTRUM(void);
+
+	/* Methods */
+	int16_t init(const SPECTRUM_Config_t *pConfig);
+	void reset(void);
+	int16_t process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count);
+
+	void getSummary(SPECTRUM_Summary_t *pSummary);
+	int16_t getPsd(uint8_t ui8Axis, float *pPsd, uint16_t ui16MaxBins, uint16_t *pBins);
+	float getBinWidth(void);
+
+	static uint16_t packSummary(const SPECTRUM_Summary_t *pSummary, uint8_t *pBuffer, uint16_t ui16Size);
+	static float getLevelRms(uint8_t ui8Level);
+
+
+private:
+	/* Variables */
+	SPECTRUM_Config_t Config;
+	uint16_t ui16Half;                                  // Length of the complex FFT (ui16Size / 2)
+	float    fPsdScale;                                 // 2 / (fs * sum(w^2))
+
+	float    fCos[SPECTRUM_MAX_SIZE];                   // cos(2 pi k / N), W_N^k = fCos[k] + i fCos[k + N/4]
+	float    fWindow[SPECTRUM_MAX_SIZE];
+	uint16_t ui16BitRev[SPECTRUM_MAX_SIZE / 2];
+
+	float    fInput[SPECTRUM_AXES][SPECTRUM_MAX_SIZE];  // Last ui16Fill samples [g]
+	uint16_t ui16Fill;
+	float    fRe[SPECTRUM_MAX_SIZE / 2];
+	float    fIm[SPECTRUM_MAX_SIZE / 2];
+
+	float    fPsdSum[SPECTRUM_AXES][SPECTRUM_MAX_SIZE / 2 + 1];
+	float    fPsd[SPECTRUM_AXES][SPECTRUM_MAX_SIZE / 2 + 1];   // Average of the last summary
+	uint16_t ui16Windows;
+	uint8_t  ui8Flags;
+	SPECTRUM_Summary_t Summary;
+
+	/* Methods */
+	void processWindow(void);
+	void transform(void);
+	void finishSummary(void);
+};
+
+
+#endif /* ZULS_INCLUDE_SPECTRUM_HPP_ */
@@ -0,0 +1,377 @@
+/*
+ * accelcal.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "accelcal.hpp"
+#include <cmath>
+
+
+extern "C" uint32_t get_Ticks(void);
+
+
+/* ACCELCAL class */
+ACCELCAL::ACCELCAL(void)
+{
+	/* Identity until a calibration is solved or loaded */
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++) {Param.fMatrix[i][j] = (i == j) ? 1.0 : 0.0;}
+		Param.fBias[i] = 0.0;
+	}
+	Param.fResidual = 0.0;
+
+	FullScale = ACCEL_FS_2G;
+	buildKernel();
+
+	reset();
+}
+
+
+/* Public methods */
+/* Discards the captured positions (the current parameters are kept) */
+void ACCELCAL::reset(void)
+{
+	ui8Positions    = 0;
+	ui8Orientations = 0;
+}
+
+
+/**
+  @brief  Averages ui16Samples raw accelerometer samples (1ms period, as calculateMeanValues()) of one position
+  @retval  0: OK
+           1: Position rejected (board not stationary or not axis-aligned)
+          -1: Bus error or position buffer full
+**/
+int16_t ACCELCAL::capturePosition(ICM20948 *pICM20948, uint16_t ui16Samples)
+{
+	ICM20948_i16Vector_t AccelRaw;
+	ICM20948_fVector_t Mean;
+
+	int32_t i32Sum[3] = {0, 0, 0};
+	int64_t i64SumSq[3] = {0, 0, 0};
+	int16_t i16Value[3];
+
+	float fOneG, fVar;
+	uint32_t ui32Ticks;
+
+	if (ui16Samples < 2 || ui8Positions >= ACCELCAL_MAX_POSITIONS) {return -1;}
+
+	ui32Ticks = get_Ticks();
+
+	while(get_Ticks() < (ui32Ticks + 1));
+	ui32Ticks = get_Ticks(); // Update ticks
+
+	for (uint16_t i = 0; i < ui16Samples; i++)
+	{
+		if (pICM20948->readAllDataRaw() != 0) {return -1;}
+
+		AccelRaw = pICM20948->getAccelRaw();
+		i16Value[0] = AccelRaw.i16XAxis;
+		i16Value[1] = AccelRaw.i16YAxis;
+		i16Value[2] = AccelRaw.i16ZAxis;
+
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			i32Sum[j]   += i16Value[j];
+			i64SumSq[j] += (int32_t)i16Value[j] * i16Value[j];
+		}
+
+		while(get_Ticks() < (ui32Ticks + 1));
+		ui32Ticks = get_Ticks(); // Update ticks
+	}
+
+	/* Stationarity check */
+	fOneG = 32768.0f / pICM20948->getSensorConfig().AccelFullScale.ui16Range;
+
+	for (uint8_t j = 0; j < 3; j++)
+	{
+		fVar = ((float)i64SumSq[j] - (float)i32Sum[j] * i32Sum[j] / ui16Samples) / (ui16Samples - 1);
+		if (fVar > (ACCELCAL_MAX_STD_DEV * fOneG) * (ACCELCAL_MAX_STD_DEV * fOneG)) {return 1;}
+	}
+
+	Mean.fXAxis = (float)i32Sum[0] / ui16Samples;
+	Mean.fYAxis = (float)i32Sum[1] / ui16Samples;
+	Mean.fZAxis = (float)i32Sum[2] / ui16Samples;
+
+	return addPosition(Mean, pICM20948->getSensorConfig().AccelFullScale);
+}
+
+
+/**
+  @brief  Adds an externally averaged position (e.g. from FIFO frames)
+  @param  Mean: Mean raw accelerometer values [counts of FullScale]
+  @retval  0: OK
+           1: Position is not axis-aligned
+          -1: Position buffer full
+**/
+int16_t ACCELCAL::addPosition(ICM20948_fVector_t Mean, ICM20948_FullScale_t FullScale)
+{
+	uint8_t ui8Orientation;
+	float fOneG = 32768.0f / FullScale.ui16Range;
+
+	if (ui8Positions >= ACCELCAL_MAX_POSITIONS) {return -1;}
+
+	Mean.fXAxis /= fOneG;
+	Mean.fYAxis /= fOneG;
+	Mean.fZAxis /= fOneG;
+
+	ui8Orientation = getOrientation(Mean);
+	if (ui8Orientation == 0) {return 1;}
+
+	Position[ui8Positions++] = Mean;
+	ui8Orientations |= ui8Orientation;
+
+	/* The kernel is built for the full scale of the captured data */
+	this->FullScale = FullScale;
+
+	return 0;
+}
+
+
+uint8_t ACCELCAL::getPositionCount(void)
+{
+	return ui8Positions;
+}
+
+
+/* Orientations (ACCELCAL_POS_X ... ACCELCAL_NEG_Z) that are still missing */
+uint8_t ACCELCAL::getMissingOrientations(void)
+{
+	return ACCELCAL_ALL & ~ui8Orientations;
+}
+
+
+/**
+  @brief  Solves M and b by least squares. For every output axis i the normal equations
+          sum(x * x^T) * w_i = sum(x * r_i) with x = [raw, 1] are solved (4x4, shared by all three axes).
+  @retval  0: OK
+          -1: Not all six orientations captured, singular system or parameters out of range
+**/
+int16_t ACCELCAL::solve(void)
+{
+	double dN[4][4], dB[4][3], dX[4], dRef[3];
+	double dPivot, dFactor, dTmp, dRes, dSumSq = 0.0;
+	ACCELCAL_Param_t NewParam;
+	uint8_t ui8Max;
+
+	if (ui8Orientations != ACCELCAL_ALL) {return -1;}
+
+	for (uint8_t i = 0; i < 4; i++)
+	{
+		for (uint8_t j = 0; j < 4; j++) {dN[i][j] = 0.0;}
+		for (uint8_t j = 0; j < 3; j++) {dB[i][j] = 0.0;}
+	}
+
+	for (uint8_t p = 0; p < ui8Positions; p++)
+	{
+		dX[0] = Position[p].fXAxis;
+		dX[1] = Position[p].fYAxis;
+		dX[2] = Position[p].fZAxis;
+		dX[3] = 1.0;
+
+		/* Reference: nearest axis, +-1g */
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			dRef[j] = 0.0;
+			if (std::fabs(dX[j]) >= ACCELCAL_MIN_ALIGN) {dRef[j] = (dX[j] > 0.0) ? 1.0 : -1.0;}
+		}
+
+		for (uint8_t i = 0; i < 4; i++)
+		{
+			for (uint8_t j = 0; j < 4; j++) {dN[i][j] += dX[i] * dX[j];}
+			for (uint8_t j = 0; j < 3; j++) {dB[i][j] += dX[i] * dRef[j];}
+		}
+	}
+
+	/* Gauss-Jordan elimination with partial pivoting */
+	for (uint8_t c = 0; c < 4; c++)
+	{
+		ui8Max = c;
+		for (uint8_t r = c + 1; r < 4; r++)
+		{
+			if (std::fabs(dN[r][c]) > std::fabs(dN[ui8Max][c])) {ui8Max = r;}
+		}
+
+		if (std::fabs(dN[ui8Max][c]) < 1e-9) {return -1;}
+
+		if (ui8Max != c)
+		{
+			for (uint8_t j = 0; j < 4; j++) {dTmp = dN[c][j]; dN[c][j] = dN[ui8Max][j]; dN[ui8Max][j] = dTmp;}
+			for (uint8_t j = 0; j < 3; j++) {dTmp = dB[c][j]; dB[c][j] = dB[ui8Max][j]; dB[ui8Max][j] = dTmp;}
+		}
+
+		dPivot = dN[c][c];
+		for (uint8_t j = 0; j < 4; j++) {dN[c][j] /= dPivot;}
+		for (uint8_t j = 0; j < 3; j++) {dB[c][j] /= dPivot;}
+
+		for (uint8_t r = 0; r < 4; r++)
+		{
+			if (r == c) {continue;}
+
+			dFactor = dN[r][c];
+			for (uint8_t j = 0; j < 4; j++) {dN[r][j] -= dFactor * dN[c][j];}
+			for (uint8_t j = 0; j < 3; j++) {dB[r][j] -= dFactor * dB[c][j];}
+		}
+	}
+
+	/* Column i of the solution holds row i of M and b_i */
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++) {NewParam.fMatrix[i][j] = dB[j][i];}
+		NewParam.fBias[i] = dB[3][i];
+	}
+
+	/* RMS residual of the fit */
+	for (uint8_t p = 0; p < ui8Positions; p++)
+	{
+		dX[0] = Position[p].fXAxis;
+		dX[1] = Position[p].fYAxis;
+		dX[2] = Position[p].fZAxis;
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			dRef[i] = 0.0;
+			if (std::fabs(dX[i]) >= ACCELCAL_MIN_ALIGN) {dRef[i] = (dX[i] > 0.0) ? 1.0 : -1.0;}
+		}
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			dRes = NewParam.fMatrix[i][0] * dX[0] + NewParam.fMatrix[i][1] * dX[1] + NewParam.fMatrix[i][2] * dX[2]
+				 + NewParam.fBias[i] - dRef[i];
+			dSumSq += dRes * dRes;
+		}
+	}
+	NewParam.fResidual = std::sqrt(dSumSq / ui8Positions);
+
+	return setParameters(&NewParam, FullScale);
+}
+
+
+void ACCELCAL::getParameters(ACCELCAL_Param_t *pParam)
+{
+	*pParam = Param;
+}
+
+
+/**
+  @brief  Loads stored parameters and builds the kernel for FullScale
+  @retval  0: OK
+          -1: Parameters out of range for the fixed-point kernel (the previous parameters are kept)
+**/
+int16_t ACCELCAL::setParameters(const ACCELCAL_Param_t *pParam, ICM20948_FullScale_t FullScale)
+{
+	ACCELCAL_Param_t OldParam = Param;
+	ICM20948_FullScale_t OldFullScale = this->FullScale;
+
+	Param = *pParam;
+	this->FullScale = FullScale;
+
+	if (buildKernel() != 0)
+	{
+		Param = OldParam;
+		this->FullScale = OldFullScale;
+		buildKernel();
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/* Rebuilds the kernel after a full scale change (M is dimensionless, b is converted to the new counts) */
+int16_t ACCELCAL::setFullScale(ICM20948_FullScale_t FullScale)
+{
+	return setParameters(&Param, FullScale);
+}
+
+
+/**
+  @brief  Applies the correction in place to the accelerometer data of ui16Count frames. The coefficients are
+          loaded once per batch, the loop body is integer multiply-accumulate only.
+**/
+void ACCELCAL::apply(ICM20948_Frame_t *pFrames, uint16_t ui16Count)
+{
+	const int32_t m00 = i16Matrix[0][0], m01 = i16Matrix[0][1], m02 = i16Matrix[0][2];
+	const int32_t m10 = i16Matrix[1][0], m11 = i16Matrix[1][1], m12 = i16Matrix[1][2];
+	const int32_t m20 = i16Matrix[2][0], m21 = i16Matrix[2][1], m22 = i16Matrix[2][2];
+	const int32_t b0  = i32Bias[0], b1 = i32Bias[1], b2 = i32Bias[2];
+
+	int32_t x, y, z;
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		x = pFrames[i].Accel.i16XAxis;
+		y = pFrames[i].Accel.i16YAxis;
+		z = pFrames[i].Accel.i16ZAxis;
+
+		pFrames[i].Accel.i16XAxis = saturate((m00 * x + m01 * y + m02 * z + b0) >> ACCELCAL_FRAC_BITS);
+		pFrames[i].Accel.i16YAxis = saturate((m10 * x + m11 * y + m12 * z + b1) >> ACCELCAL_FRAC_BITS);
+		pFrames[i].Accel.i16ZAxis = saturate((m20 * x + m21 * y + m22 * z + b2) >> ACCELCAL_FRAC_BITS);
+	}
+}
+
+
+ICM20948_i16Vector_t ACCELCAL::apply(ICM20948_i16Vector_t Raw)
+{
+	ICM20948_Frame_t Frame;
+
+	Frame.Accel = Raw;
+	apply(&Frame, 1);
+
+	return Frame.Accel;
+}
+
+
+/* Private methods */
+/* Orientation bit of an axis-aligned position, 0 if no axis is dominant */
+uint8_t ACCELCAL::getOrientation(ICM20948_fVector_t Mean)
+{
+	if (Mean.fXAxis >=  ACCELCAL_MIN_ALIGN) {return ACCELCAL_POS_X;}
+	if (Mean.fXAxis <= -ACCELCAL_MIN_ALIGN) {return ACCELCAL_NEG_X;}
+	if (Mean.fYAxis >=  ACCELCAL_MIN_ALIGN) {return ACCELCAL_POS_Y;}
+	if (Mean.fYAxis <= -ACCELCAL_MIN_ALIGN) {return ACCELCAL_NEG_Y;}
+	if (Mean.fZAxis >=  ACCELCAL_MIN_ALIGN) {return ACCELCAL_POS_Z;}
+	if (Mean.fZAxis <= -ACCELCAL_MIN_ALIGN) {return ACCELCAL_NEG_Z;}
+
+	return 0;
+}
+
+
+/* |row|_1 < 1.99 (Q14 coefficients fit into int16_t) and |b| < 1/2 range: |m * x| < 2^30 and |bias| < 2^28, the accumulator cannot overflow */
+int16_t ACCELCAL::buildKernel(void)
+{
+	float fOneG = 32768.0f / FullScale.ui16Range;
+	float fRowGain, fBias;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		fRowGain = std::fabs(Param.fMatrix[i][0]) + std::fabs(Param.fMatrix[i][1]) + std::fabs(Param.fMatrix[i][2]);
+		fBias    = Param.fBias[i] * fOneG;
+
+		if (!(fRowGain < ACCELCAL_MAX_ROW_GAIN) || !(std::fabs(fBias) < 16384.0f)) {return -1;}
+	}
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			i16Matrix[i][j] = (int16_t)std::lround(Param.fMatrix[i][j] * (1 << ACCELCAL_FRAC_BITS));
+		}
+
+		i32Bias[i] = std::lround(Param.fBias[i] * fOneG * (1 << ACCELCAL_FRAC_BITS)) + (1 << (ACCELCAL_FRAC_BITS - 1));
+	}
+
+	return 0;
+}
+
+
+inline int16_t ACCELCAL::saturate(int32_t i32Value)
+{
+	if (i32Value >  32767) {return  32767;}
+	if (i32Value < -32768) {return -32768;}
+
+	return (int16_t)i32Value;
+}
@@ -0,0 +1,266 @@
+/*
+ * allan.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "allan.hpp"
+#include <cmath>
+
+
+/* ALLAN class */
+ALLAN::ALLAN(float fSampleRate, uint8_t ui8Channels)
+{
+	this->fSampleRate = fSampleRate;
+
+	if (ui8Channels > ALLAN_MAX_CHANNELS) {ui8Channels = ALLAN_MAX_CHANNELS;}
+	this->ui8Channels = ui8Channels;
+
+	reset();
+}
+
+
+/* Public methods */
+void ALLAN::reset(void)
+{
+	ui64Samples = 0;
+
+	for (uint8_t c = 0; c < ALLAN_MAX_CHANNELS; c++)
+	{
+		fFirstSample[c] = 0.0;
+		dTheta[c]       = 0.0;
+	}
+
+	/* theta(0) = 0 is the first point of every octave */
+	for (uint8_t k = 0; k < ALLAN_MAX_OCTAVES; k++)
+	{
+		for (uint8_t c = 0; c < ALLAN_MAX_CHANNELS; c++)
+		{
+			dRing[k][c][0] = 0.0;
+			dSum[k][c]     = 0.0;
+		}
+
+		ui16Head[k]  = 1;
+		ui16Fill[k]  = 1;
+		ui32Count[k] = 0;
+	}
+}
+
+
+/**
+  @brief  Adds one stationary sample (ui8Channels values) to the running Allan variance
+  @param  pSample: Sample values in physical units (e.g. g or dps), the unit carries over to the results
+  @retval None
+**/
+void ALLAN::addSample(const float *pSample)
+{
+	uint16_t ui16Ring, ui16Dist, ui16New, ui16Mid, ui16Old;
+	double dDiff;
+
+	/* The first sample is used as constant bias estimate. The Allan variance is invariant to a constant
+	 * offset, but removing it keeps theta small and preserves the double precision over long captures. */
+	if (ui64Samples == 0)
+	{
+		for (uint8_t c = 0; c < ui8Channels; c++) {fFirstSample[c] = pSample[c];}
+	}
+
+	for (uint8_t c = 0; c < ui8Channels; c++)
+	{
+		dTheta[c] += (double)(pSample[c] - fFirstSample[c]) / fSampleRate;
+	}
+	ui64Samples++;
+
+	/* The strides of all octaves are powers of two. If the stride of octave k does not divide the sample
+	 * index, the strides of all higher octaves do not divide it either. */
+	for (uint8_t k = 0; k < ALLAN_MAX_OCTAVES; k++)
+	{
+		if ((ui64Samples & (getStride(k) - 1)) != 0) {break;}
+
+		ui16Dist = getDistance(k);
+		ui16Ring = 2 * ui16Dist + 1;
+
+		ui16New = ui16Head[k];
+		for (uint8_t c = 0; c < ui8Channels; c++) {dRing[k][c][ui16New] = dTheta[c];}
+
+		ui16Head[k] = (ui16New + 1) % ui16Ring;
+		if (ui16Fill[k] < ui16Ring) {ui16Fill[k]++;}
+
+		if (ui16Fill[k] == ui16Ring)
+		{
+			ui16Mid = (ui16New + ui16Ring - ui16Dist) % ui16Ring;
+			ui16Old = ui16Head[k]; // Oldest point is overwritten next
+
+			for (uint8_t c = 0; c < ui8Channels; c++)
+			{
+				dDiff = dRing[k][c][ui16New] - 2.0 * dRing[k][c][ui16Mid] + dRing[k][c][ui16Old];
+				dSum[k][c] += dDiff * dDiff;
+			}
+			ui32Count[k]++;
+		}
+	}
+}
+
+
+uint64_t ALLAN::getSampleCount(void)
+{
+	return ui64Samples;
+}
+
+
+uint8_t ALLAN::getOctaveCount(void)
+{
+	uint8_t k = 0;
+
+	while ((k < ALLAN_MAX_OCTAVES) && (ui32Count[k] > 0) && ((ui64Samples >> k) >= ALLAN_MIN_CLUSTERS)) {k++;}
+
+	return k;
+}
+
+
+/**
+  @brief  Returns the Allan deviation of one channel at cluster time tau = 2^ui8Octave / fSampleRate
+  @retval  0: OK
+          -1: Invalid channel or octave (not enough data yet)
+**/
+int16_t ALLAN::getPoint(uint8_t ui8Channel, uint8_t ui8Octave, ALLAN_Point_t *pPoint)
+{
+	double dTau;
+
+	if (ui8Channel >= ui8Channels || ui8Octave >= getOctaveCount()) {return -1;}
+
+	dTau = (double)((uint32_t)1 << ui8Octave) / fSampleRate;
+
+	pPoint->fTau       = dTau;
+	pPoint->fDeviation = std::sqrt(dSum[ui8Octave][ui8Channel] / (2.0 * dTau * dTau * ui32Count[ui8Octave]));
+	pPoint->ui32Count  = ui32Count[ui8Octave];
+
+	return 0;
+}
+
+
+/**
+  @brief  Allan deviation at an arbitrary cluster time (log-log interpolation between octaves)
+  @retval  0: OK
+          -1: Invalid channel or fTau outside the evaluated octaves
+**/
+int16_t ALLAN::getDeviationAt(uint8_t ui8Channel, float fTau, float *pDeviation)
+{
+	ALLAN_Point_t Lower, Upper;
+	float fWeight;
+
+	uint8_t ui8Octaves = getOctaveCount();
+
+	for (uint8_t k = 0; k < ui8Octaves; k++)
+	{
+		if (getPoint(ui8Channel, k, &Upper) != 0) {return -1;}
+
+		if (fTau <= Upper.fTau)
+		{
+			if (k == 0)
+			{
+				if (fTau < Upper.fTau) {return -1;}
+				*pDeviation = Upper.fDeviation;
+				return 0;
+			}
+
+			if (getPoint(ui8Channel, k - 1, &Lower) != 0) {return -1;}
+
+			fWeight = std::log(fTau / Lower.fTau) / std::log(Upper.fTau / Lower.fTau);
+			*pDeviation = std::exp((1.0 - fWeight) * std::log(Lower.fDeviation) + fWeight * std::log(Upper.fDeviation));
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+  @brief  Estimates the noise terms of one channel from the Allan deviation curve (IEEE Std 952, Annex C)
+          - Random walk:      point with local slope closest to -1/2, N = sigma(tau) * sqrt(tau)
+          - Bias instability: minimum of the curve,                   B = sigma_min / 0.664
+          - Rate random walk: point with local slope closest to +1/2, K = sigma(tau) * sqrt(3 / tau)
+          A term whose slope is not observed in the data (deviation of the slope > 0.25) is reported as 0.
+          With gyro data in dps, N * 60 is the angle random walk in deg/sqrt(h).
+  @retval  0: OK
+          -1: Invalid channel or less than three octaves available
+**/
+int16_t ALLAN::getNoiseParameters(uint8_t ui8Channel, ALLAN_NoiseParam_t *pParam)
+{
+	ALLAN_Point_t Point;
+
+	float fSlope;
+	float fBestRW  = 0.25, fBestRRW = 0.25;
+	float fMinDev  = INFINITY;
+
+	uint8_t ui8Octaves = getOctaveCount();
+
+	if (ui8Channel >= ui8Channels || ui8Octaves < 3) {return -1;}
+
+	pParam->fRandomWalk         = 0.0;
+	pParam->fBiasInstability    = 0.0;
+	pParam->fTauBiasInstability = 0.0;
+	pParam->fRateRandomWalk     = 0.0;
+
+	for (uint8_t k = 0; k < ui8Octaves; k++)
+	{
+		if (getPoint(ui8Channel, k, &Point) != 0) {return -1;}
+		fSlope = getSlope(ui8Channel, k);
+
+		if (std::fabs(fSlope + 0.5f) < fBestRW)
+		{
+			fBestRW = std::fabs(fSlope + 0.5f);
+			pParam->fRandomWalk = Point.fDeviation * std::sqrt(Point.fTau);
+		}
+
+		if (std::fabs(fSlope - 0.5f) < fBestRRW)
+		{
+			fBestRRW = std::fabs(fSlope - 0.5f);
+			pParam->fRateRandomWalk = Point.fDeviation * std::sqrt(3.0f / Point.fTau);
+		}
+
+		if (Point.fDeviation < fMinDev)
+		{
+			fMinDev = Point.fDeviation;
+			pParam->fBiasInstability    = Point.fDeviation / ALLAN_BIAS_INST_FACTOR;
+			pParam->fTauBiasInstability = Point.fTau;
+		}
+	}
+
+	return 0;
+}
+
+
+/* Private methods */
+inline uint32_t ALLAN::getStride(uint8_t ui8Octave)
+{
+	uint32_t ui32Cluster = (uint32_t)1 << ui8Octave;
+
+	return (ui32Cluster > ALLAN_DENSITY) ? (ui32Cluster / ALLAN_DENSITY) : 1;
+}
+
+
+/* Distance between theta(n) and theta(n-m) in stored points */
+inline uint16_t ALLAN::getDistance(uint8_t ui8Octave)
+{
+	uint32_t ui32Cluster = (uint32_t)1 << ui8Octave;
+
+	return (ui32Cluster > ALLAN_DENSITY) ? ALLAN_DENSITY : ui32Cluster;
+}
+
+
+/* Local slope of log(sigma) over log(tau), central difference (one-sided at the ends) */
+float ALLAN::getSlope(uint8_t ui8Channel, uint8_t ui8Octave)
+{
+	ALLAN_Point_t Lower, Upper;
+
+	uint8_t ui8Octaves = getOctaveCount();
+	uint8_t ui8Low  = (ui8Octave > 0) ? ui8Octave - 1 : 0;
+	uint8_t ui8High = (ui8Octave + 1 < ui8Octaves) ? ui8Octave + 1 : ui8Octave;
+
+	if (ui8Low == ui8High) {return 0.0;}
+	if (getPoint(ui8Channel, ui8Low, &Lower) != 0 || getPoint(ui8Channel, ui8High, &Upper) != 0) {return 0.0;}
+
+	return std::log(Upper.fDeviation / Lower.fDeviation) / std::log(Upper.fTau / Lower.fTau);
+}
@@ -0,0 +1,143 @@
+/*
+ * autorange.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "autorange.hpp"
+
+
+/* Full scale settings in ascending order (index = ui8Selection >> 1) */
+static const ICM20948_FullScale_t AUTORANGE_ACCEL_FS[4] = {ACCEL_FS_2G, ACCEL_FS_4G, ACCEL_FS_8G, ACCEL_FS_16G};
+static const ICM20948_FullScale_t AUTORANGE_GYRO_FS[4]  = {GYRO_FS_250DPS, GYRO_FS_500DPS, GYRO_FS_1000DPS, GYRO_FS_2000DPS};
+
+
+/* AUTORANGE class */
+AUTORANGE::AUTORANGE(ICM20948 *pICM20948, const AUTORANGE_Config_t *pConfig)
+{
+	this->pICM20948 = pICM20948;
+	ui32Switches    = 0;
+
+	if (init(pConfig) != 0) {init(&AUTORANGE_DEFAULT_CONFIG);}
+}
+
+
+/* Public methods */
+/**
+  @brief  Checks and applies a configuration (the switch count is kept)
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t AUTORANGE::init(const AUTORANGE_Config_t *pConfig)
+{
+	if (pConfig->i16UpThreshold <= 0 || pConfig->i16DownThreshold < 0) {return -1;}
+
+	/* After a switch up the peak is halved, it must not be below the down threshold already */
+	if (pConfig->i16DownThreshold >= pConfig->i16UpThreshold / 2) {return -1;}
+
+	if (pConfig->ui8AccelMin > pConfig->ui8AccelMax || pConfig->ui8AccelMax > 3) {return -1;}
+	if (pConfig->ui8GyroMin  > pConfig->ui8GyroMax  || pConfig->ui8GyroMax  > 3) {return -1;}
+
+	Config = *pConfig;
+
+	ui16AccelHold = 0;
+	ui16GyroHold  = 0;
+
+	return 0;
+}
+
+
+/**
+  @brief  Evaluates decoded frames and switches the full scale ranges if necessary
+  @retval >=0: Number of range switches
+           -1: Bus error
+**/
+int16_t AUTORANGE::process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count)
+{
+	uint8_t ui8Index;
+	int8_t  i8Step;
+	int16_t i16Switches = 0;
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		/* Frame was captured under an outdated range or while the new range took effect (old range counts) */
+		if (pFrames[i].ui8Epoch != pICM20948->getConfigEpoch()) {continue;}
+		if (pFrames[i].ui8Flags & ICM20948_FRAME_TRANSITION) {continue;}
+
+		if (Config.boAccel)
+		{
+			ui8Index = ICM20948_RANGE_ACCEL(pFrames[i].ui8Range) >> 1;
+			i8Step   = getStep(getPeak(&pFrames[i].Accel), ui8Index, Config.ui8AccelMin, Config.ui8AccelMax, &ui16AccelHold);
+
+			if (i8Step != 0)
+			{
+				if (pICM20948->setAccelFullScale(AUTORANGE_ACCEL_FS[ui8Index + i8Step]) != 0) {return -1;}
+				i16Switches++;
+				continue; // The remaining frames are of the old epoch
+			}
+		}
+
+		if (Config.boGyro)
+		{
+			ui8Index = ICM20948_RANGE_GYRO(pFrames[i].ui8Range) >> 1;
+			i8Step   = getStep(getPeak(&pFrames[i].Gyro), ui8Index, Config.ui8GyroMin, Config.ui8GyroMax, &ui16GyroHold);
+
+			if (i8Step != 0)
+			{
+				if (pICM20948->setGyroFullScale(AUTORANGE_GYRO_FS[ui8Index + i8Step]) != 0) {return -1;}
+				i16Switches++;
+			}
+		}
+	}
+
+	ui32Switches += i16Switches;
+
+	return i16Switches;
+}
+
+
+uint32_t AUTORANGE::getSwitchCount(void)
+{
+	return ui32Switches;
+}
+
+
+/* Private methods */
+inline int32_t AUTORANGE::getPeak(const ICM20948_i16Vector_t *pVector)
+{
+	int32_t i32Peak = abs((int32_t)pVector->i16XAxis);
+
+	if (abs((int32_t)pVector->i16YAxis) > i32Peak) {i32Peak = abs((int32_t)pVector->i16YAxis);}
+	if (abs((int32_t)pVector->i16ZAxis) > i32Peak) {i32Peak = abs((int32_t)pVector->i16ZAxis);}
+
+	return i32Peak;
+}
+
+
+/* Range step for one sample: up immediately, down after ui16DownHold quiet samples (one range at a time) */
+int8_t AUTORANGE::getStep(int32_t i32Peak, uint8_t ui8Index, uint8_t ui8Min, uint8_t ui8Max, uint16_t *pHold)
+{
+	int8_t i8Step = 0;
+
+	if (i32Peak >= Config.i16UpThreshold)
+	{
+		i8Step = (i32Peak >= 32767) ? 2 : 1;
+		if (ui8Index + i8Step > ui8Max) {i8Step = (ui8Index < ui8Max) ? (ui8Max - ui8Index) : 0;}
+		*pHold = 0;
+	}
+	else if (i32Peak < Config.i16DownThreshold)
+	{
+		if (++(*pHold) >= Config.ui16DownHold)
+		{
+			*pHold = 0;
+			if (ui8Index > ui8Min) {i8Step = -1;}
+		}
+	}
+	else {*pHold = 0;}
+
+	/* Outside of the allowed ranges (e.g. manual setting): back into the limits */
+	if (ui8Index + i8Step < ui8Min) {i8Step = ui8Min - ui8Index;}
+
+	return i8Step;
+}
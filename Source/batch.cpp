@@ -0,0 +1,354 @@
+/*
+ * batch.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "batch.hpp"
+
+#if defined (ICM20948_HOST)
+
+#include <new>
+#include <string.h>
+#include <thread>
+
+
+#define BATCH_RANGE(First,End)  (((uint64_t)(First) << 32) | (End))
+#define BATCH_FIRST(Range)      ((uint32_t)((Range) >> 32))
+#define BATCH_END(Range)        ((uint32_t)(Range))
+
+#define BATCH_SLICE             4096 // Frames per call of a kernel with 16-bit counts
+
+
+/* Kernels */
+static int16_t initDecimator(void *pState, const void *pContext)
+{
+	DECIMATOR *pDecimator = new (pState) DECIMATOR();
+
+	return pDecimator->init((const DECIMATOR_Config_t *)pContext);
+}
+
+
+static uint32_t processDecimator(void *pState, const ICM20948_Frame_t *pIn, uint32_t ui32Count, ICM20948_Frame_t *pOut)
+{
+	DECIMATOR *pDecimator = (DECIMATOR *)pState;
+	uint32_t ui32Out = 0;
+	uint16_t ui16Slice, ui16Out;
+
+	for (uint32_t i = 0; i < ui32Count; i += ui16Slice)
+	{
+		ui16Slice = (ui32Count - i > BATCH_SLICE) ? BATCH_SLICE : (uint16_t)(ui32Count - i);
+		pDecimator->process(&pIn[i], ui16Slice, &pOut[ui32Out], &ui16Out);
+		ui32Out += ui16Out;
+	}
+
+	return ui32Out;
+}
+
+
+static void releaseDecimator(void *pState)
+{
+	((DECIMATOR *)pState)->~DECIMATOR();
+}
+
+
+static int16_t initMean(void *pState, const void *pContext)
+{
+	(void)pContext;
+	memset(pState, 0, sizeof(BATCH_Mean_t));
+
+	return 0;
+}
+
+
+static uint32_t processMean(void *pState, const ICM20948_Frame_t *pIn, uint32_t ui32Count, ICM20948_Frame_t *pOut)
+{
+	BATCH_Mean_t *pMean = (BATCH_Mean_t *)pState;
+
+	(void)pOut;
+
+	for (uint32_t i = 0; i < ui32Count; i++)
+	{
+		pMean->i64AccelSum[0] += pIn[i].Accel.i16XAxis;
+		pMean->i64AccelSum[1] += pIn[i].Accel.i16YAxis;
+		pMean->i64AccelSum[2] += pIn[i].Accel.i16ZAxis;
+		pMean->i64GyroSum[0]  += pIn[i].Gyro.i16XAxis;
+		pMean->i64GyroSum[1]  += pIn[i].Gyro.i16YAxis;
+		pMean->i64GyroSum[2]  += pIn[i].Gyro.i16ZAxis;
+		pMean->i64TempSum     += pIn[i].i16Temperature;
+	}
+	pMean->ui64Count += ui32Count;
+
+	return 0;
+}
+
+
+static void mergeMean(void *pResult, const void *pState)
+{
+	BATCH_Mean_t *pSum = (BATCH_Mean_t *)pResult;
+	const BATCH_Mean_t *pMean = (const BATCH_Mean_t *)pState;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		pSum->i64AccelSum[i] += pMean->i64AccelSum[i];
+		pSum->i64GyroSum[i]  += pMean->i64GyroSum[i];
+	}
+	pSum->i64TempSum += pMean->i64TempSum;
+	pSum->ui64Count  += pMean->ui64Count;
+}
+
+
+/* BATCH class */
+BATCH::BATCH(uint16_t ui16Threads, uint32_t ui32ChunkSize) : ui32Steals(0)
+{
+	if (ui16Threads == 0) {ui16Threads = std::thread::hardware_concurrency();}
+	if (ui16Threads == 0) {ui16Threads = 1;}
+	if (ui32ChunkSize == 0) {ui32ChunkSize = BATCH_CHUNK_SIZE;}
+
+	this->ui16Threads   = ui16Threads;
+	this->ui32ChunkSize = ui32ChunkSize;
+
+	pKernel   = NULL;
+	pIn       = NULL;
+	pOut      = NULL;
+	ui64Count = 0;
+	ui32Chunk = 0;
+	ui32Warmup = 0;
+}
+
+
+/* Public methods */
+/**
+  @brief  Processes ui64Count frames with the kernel
+  @param  pOut:      Output frames (ui64Count entries, not overlapping pIn, the outputs of a chunk must not exceed its
+                     inputs), may be NULL if the kernel produces no frames
+          pOutCount: Number of output frames
+          pResult:   Merged result (pMerge() of the kernel), initialized by the caller
+  @retval  0: OK
+          -1: Invalid kernel or archive too large for the chunk size, pInit() of a chunk failed
+**/
+int16_t BATCH::run(const BATCH_Kernel_t *pKernel, const ICM20948_Frame_t *pIn, uint64_t ui64Count,
+		           ICM20948_Frame_t *pOut, uint64_t *pOutCount, void *pResult)
+{
+	std::vector<std::thread> Threads;
+	uint64_t ui64Chunks, ui64Out = 0;
+	uint32_t ui32PerWorker;
+	uint16_t ui16Workers;
+	int16_t  i16RetValue = 0;
+
+	*pOutCount = 0;
+
+	if (pKernel->ui32Alignment == 0 || pKernel->pInit == NULL || pKernel->pProcess == NULL) {return -1;}
+	if (ui64Count == 0) {return 0;}
+
+	/* Chunk size and warm-up are rounded up to multiples of the alignment */
+	ui32Chunk  = ((ui32ChunkSize + pKernel->ui32Alignment - 1) / pKernel->ui32Alignment) * pKernel->ui32Alignment;
+	ui32Warmup = ((pKernel->ui32Warmup + pKernel->ui32Alignment - 1) / pKernel->ui32Alignment) * pKernel->ui32Alignment;
+
+	ui64Chunks = (ui64Count + ui32Chunk - 1) / ui32Chunk;
+	if (ui64Chunks > 0xFFFFFFFF) {return -1;}
+
+	this->pKernel   = pKernel;
+	this->pIn       = pIn;
+	this->pOut      = pOut;
+	this->ui64Count = ui64Count;
+
+	ui8States.assign(ui64Chunks * pKernel->ui32StateSize, 0);
+	ui64OutCounts.assign(ui64Chunks, 0);
+	i16Errors.assign(ui64Chunks, 0);
+
+	/* Initial distribution: contiguous ranges of equal size */
+	ui16Workers   = (ui64Chunks < ui16Threads) ? (uint16_t)ui64Chunks : ui16Threads;
+	ui32PerWorker = (uint32_t)((ui64Chunks + ui16Workers - 1) / ui16Workers);
+	ui64Ranges    = std::vector<std::atomic<uint64_t>>(ui16Workers);
+
+	for (uint16_t w = 0; w < ui16Workers; w++)
+	{
+		uint64_t ui64First = (uint64_t)w * ui32PerWorker;
+		uint64_t ui64End   = ui64First + ui32PerWorker;
+
+		if (ui64First > ui64Chunks) {ui64First = ui64Chunks;}
+		if (ui64End   > ui64Chunks) {ui64End   = ui64Chunks;}
+		ui64Ranges[w].store(BATCH_RANGE(ui64First, ui64End), std::memory_order_relaxed);
+	}
+
+	for (uint16_t w = 1; w < ui16Workers; w++)
+	{
+		Threads.emplace_back(&BATCH::work, this, w);
+	}
+	work(0);
+
+	for (std::thread &Thread : Threads) {Thread.join();}
+
+	/* Deterministic merge in chunk order */
+	for (uint64_t c = 0; c < ui64Chunks; c++)
+	{
+		void *pState = &ui8States[c * pKernel->ui32StateSize];
+
+		if (i16Errors[c] != 0) {i16RetValue = -1;}
+
+		if (pOut != NULL && ui64OutCounts[c] > 0 && ui64Out != c * ui32Chunk)
+		{
+			memmove(&pOut[ui64Out], &pOut[c * ui32Chunk], ui64OutCounts[c] * sizeof(ICM20948_Frame_t));
+		}
+		ui64Out += ui64OutCounts[c];
+
+		if (pKernel->pMerge != NULL && pResult != NULL && i16Errors[c] == 0) {pKernel->pMerge(pResult, pState);}
+		if (pKernel->pRelease != NULL && i16Errors[c] == 0) {pKernel->pRelease(pState);}
+	}
+
+	*pOutCount = ui64Out;
+
+	return i16RetValue;
+}
+
+
+/* Number of ranges taken over from other workers in the last runs */
+uint32_t BATCH::getStealCount(void)
+{
+	return ui32Steals.load(std::memory_order_relaxed);
+}
+
+
+/* Decimation with a DECIMATOR per chunk (pContext: DECIMATOR_Config_t), the warm-up fills the filter memory */
+BATCH_Kernel_t BATCH::getDecimatorKernel(const DECIMATOR_Config_t *pConfig)
+{
+	BATCH_Kernel_t Kernel;
+
+	Kernel.pContext      = pConfig;
+	Kernel.ui32StateSize = sizeof(DECIMATOR);
+	Kernel.ui32Warmup    = pConfig->ui8CicRate * (pConfig->ui8CicOrder + pConfig->ui8FirTaps);
+	Kernel.ui32Alignment = pConfig->ui8CicRate * pConfig->ui8FirRate;
+	Kernel.pInit         = initDecimator;
+	Kernel.pProcess      = processDecimator;
+	Kernel.pMerge        = NULL;
+	Kernel.pRelease      = releaseDecimator;
+
+	return Kernel;
+}
+
+
+/* Sums of all frames (BATCH_Mean_t), e.g. for the mean values of a calibration */
+BATCH_Kernel_t BATCH::getMeanKernel(void)
+{
+	BATCH_Kernel_t Kernel;
+
+	Kernel.pContext      = NULL;
+	Kernel.ui32StateSize = sizeof(BATCH_Mean_t);
+	Kernel.ui32Warmup    = 0;
+	Kernel.ui32Alignment = 1;
+	Kernel.pInit         = initMean;
+	Kernel.pProcess      = processMean;
+	Kernel.pMerge        = mergeMean;
+	Kernel.pRelease      = NULL;
+
+	return Kernel;
+}
+
+
+/* Private methods */
+void BATCH::work(uint16_t ui16Worker)
+{
+	uint32_t ui32Index;
+
+	do
+	{
+		while (takeChunk(ui16Worker, &ui32Index))
+		{
+			processChunk(ui32Index);
+		}
+	}
+	while (stealRange(ui16Worker));
+}
+
+
+/* Takes the first chunk of the own range */
+bool BATCH::takeChunk(uint16_t ui16Worker, uint32_t *pChunk)
+{
+	uint64_t ui64Range = ui64Ranges[ui16Worker].load(std::memory_order_acquire);
+
+	while (BATCH_FIRST(ui64Range) < BATCH_END(ui64Range))
+	{
+		if (ui64Ranges[ui16Worker].compare_exchange_weak(ui64Range,
+				BATCH_RANGE(BATCH_FIRST(ui64Range) + 1, BATCH_END(ui64Range)), std::memory_order_acq_rel))
+		{
+			*pChunk = BATCH_FIRST(ui64Range);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/* Moves the back half of the largest range of another worker into the own (empty) range */
+bool BATCH::stealRange(uint16_t ui16Worker)
+{
+	uint64_t ui64Range, ui64Victim;
+	uint32_t ui32Size, ui32Largest, ui32Take;
+	uint16_t ui16Victim;
+
+	for (;;)
+	{
+		ui32Largest = 0;
+		ui16Victim  = 0;
+		ui64Victim  = 0;
+
+		for (uint16_t w = 0; w < ui64Ranges.size(); w++)
+		{
+			if (w == ui16Worker) {continue;}
+
+			ui64Range = ui64Ranges[w].load(std::memory_order_acquire);
+			ui32Size  = BATCH_END(ui64Range) - BATCH_FIRST(ui64Range);
+
+			if (BATCH_FIRST(ui64Range) < BATCH_END(ui64Range) && ui32Size > ui32Largest)
+			{
+				ui32Largest = ui32Size;
+				ui16Victim  = w;
+				ui64Victim  = ui64Range;
+			}
+		}
+
+		if (ui32Largest == 0) {return false;}
+
+		ui32Take = (ui32Largest + 1) / 2;
+
+		if (ui64Ranges[ui16Victim].compare_exchange_strong(ui64Victim,
+				BATCH_RANGE(BATCH_FIRST(ui64Victim), BATCH_END(ui64Victim) - ui32Take), std::memory_order_acq_rel))
+		{
+			ui64Ranges[ui16Worker].store(BATCH_RANGE(BATCH_END(ui64Victim) - ui32Take, BATCH_END(ui64Victim)),
+					std::memory_order_release);
+			ui32Steals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+}
+
+
+/* Warm-up with the frames before the chunk, then the chunk (outputs behind the input position of the chunk) */
+void BATCH::processChunk(uint32_t ui32Index)
+{
+	void *pState = &ui8States[(uint64_t)ui32Index * pKernel->ui32StateSize];
+	uint64_t ui64First = (uint64_t)ui32Index * ui32Chunk;
+	uint64_t ui64Warmup = (ui64First < ui32Warmup) ? ui64First : ui32Warmup;
+	uint64_t ui64Length = (ui64Count - ui64First < ui32Chunk) ? (ui64Count - ui64First) : ui32Chunk;
+	std::vector<ICM20948_Frame_t> Scratch;
+
+	if (pKernel->pInit(pState, pKernel->pContext) != 0)
+	{
+		i16Errors[ui32Index] = -1;
+		return;
+	}
+
+	if (ui64Warmup > 0)
+	{
+		Scratch.resize(ui64Warmup);
+		pKernel->pProcess(pState, &pIn[ui64First - ui64Warmup], (uint32_t)ui64Warmup, Scratch.data());
+	}
+
+	ui64OutCounts[ui32Index] = pKernel->pProcess(pState, &pIn[ui64First], (uint32_t)ui64Length,
+			(pOut != NULL) ? &pOut[ui64First] : NULL);
+}
+
+#endif /* ICM20948_HOST */
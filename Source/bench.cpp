@@ -0,0 +1,603 @@
+/*
+ * bench.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "bench.hpp"
+
+#if defined (ICM20948_HOST)
+
+#include <chrono>
+#include <string.h>
+
+
+/* Sample of the cases: 1g on Z, small gyroscope rates, 25 degC (big endian like the sensor) */
+static const uint8_t BENCH_SAMPLE[14] = {0x00, 0x10, 0xFF, 0xE0, 0x40, 0x00, 0x00, 0x05, 0xFF, 0xFB, 0x00, 0x02, 0x00, 0x00};
+
+/* DMP packet with ICM20948_DMP_ACCEL and ICM20948_DMP_GYRO (header, accel, gyro + bias, footer) */
+static const uint8_t BENCH_DMP_PACKET[22] = {0xC0, 0x00, 0x00, 0x10, 0xFF, 0xE0, 0x20, 0x00, 0x00, 0x05, 0xFF, 0xFB,
+                                             0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+
+/* Stand-in of the DMP firmware: the mock executes nothing, the upload and the verification are real */
+static const uint8_t BENCH_DMP_IMAGE[64] = {0};
+
+/* Decimation of the high-rate FIFO frames to a control rate */
+static const DECIMATOR_Config_t BENCH_DECIMATOR_CONFIG = {4500.0f, 3, 4, 4, 32, NULL, 100.0f};
+
+/* Register emulator that samples while the driver waits (one frame per millisecond of BENCH::getTicks()) */
+static ICM20948_MOCK *pSamplingMock = NULL;
+
+
+/* Cases */
+static int16_t runReadAllDataRaw(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->readAllDataRaw();
+}
+
+
+static int16_t runGetCorrectedAccelRaw(BENCH_Target_t *pTarget)
+{
+	volatile ICM20948_i16Vector_t Accel = pTarget->pDevice->getCorrectedAccelRaw();
+
+	(void)Accel;
+
+	return 0;
+}
+
+
+static int16_t runGetCorrectedGyroRaw(BENCH_Target_t *pTarget)
+{
+	volatile ICM20948_i16Vector_t Gyro = pTarget->pDevice->getCorrectedGyroRaw();
+
+	(void)Gyro;
+
+	return 0;
+}
+
+
+static int16_t runGetFrame(BENCH_Target_t *pTarget)
+{
+	pTarget->Frames[0] = pTarget->pDevice->getFrame();
+
+	return 0;
+}
+
+
+static int16_t setupLatest(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->setupLatest();
+}
+
+
+static int16_t runReadLatest(BENCH_Target_t *pTarget)
+{
+	uint32_t ui32Age;
+
+	pTarget->pMock->pushSample(pTarget->ui8Sample);
+
+	return (pTarget->pDevice->readLatest(&pTarget->Frames[0], &ui32Age) < 0) ? -1 : 0;
+}
+
+
+static int16_t setupFifo(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->enableFifo(true);
+}
+
+
+static int16_t runReadFifoFrames(BENCH_Target_t *pTarget)
+{
+	uint16_t ui16Frames;
+
+	for (uint8_t i = 0; i < BENCH_FRAMES; i++)
+	{
+		pTarget->pMock->pushSample(pTarget->ui8Sample);
+	}
+
+	if (pTarget->pDevice->readFifoFrames(pTarget->Frames, BENCH_FRAMES, &ui16Frames) != 0) {return -1;}
+
+	return (ui16Frames == BENCH_FRAMES) ? 0 : -1;
+}
+
+
+static int16_t teardownFifo(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->enableFifo(false);
+}
+
+
+static int16_t runResetFifo(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->resetFifo();
+}
+
+
+static int16_t runGetFifoCount(BENCH_Target_t *pTarget)
+{
+	uint16_t ui16Count;
+
+	return pTarget->pDevice->getFifoCount(&ui16Count);
+}
+
+
+static int16_t setupDmp(BENCH_Target_t *pTarget)
+{
+	if (pTarget->pDevice->loadDmpFirmware(BENCH_DMP_IMAGE, sizeof(BENCH_DMP_IMAGE)) != 0) {return -1;}
+
+	return pTarget->pDevice->enableDmp(ICM20948_DMP_ACCEL | ICM20948_DMP_GYRO, 0);
+}
+
+
+static int16_t runReadDmpPackets(BENCH_Target_t *pTarget)
+{
+	uint16_t ui16Packets;
+
+	for (uint8_t i = 0; i < BENCH_FRAMES; i++)
+	{
+		pTarget->pMock->pushFifo(BENCH_DMP_PACKET, sizeof(BENCH_DMP_PACKET));
+	}
+
+	if (pTarget->pDevice->readDmpPackets(pTarget->Packets, BENCH_FRAMES, &ui16Packets) != 0) {return -1;}
+
+	return (ui16Packets == BENCH_FRAMES) ? 0 : -1;
+}
+
+
+/* enableDmp() switched to the scaling of the DMP firmware */
+static int16_t teardownDmp(BENCH_Target_t *pTarget)
+{
+	if (pTarget->pDevice->disableDmp() != 0) {return -1;}
+	if (pTarget->pDevice->setAccelFullScale(ACCEL_FS_2G) != 0) {return -1;}
+
+	return pTarget->pDevice->setGyroFullScale(GYRO_FS_250DPS);
+}
+
+
+static int16_t runTakeSnapshot(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->takeSnapshot(&pTarget->Snapshot);
+}
+
+
+static int16_t setupSnapshot(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->takeSnapshot(&pTarget->Snapshot);
+}
+
+
+/* Nothing differs, the operation is the comparison of all configuration registers */
+static int16_t runRestoreSnapshot(BENCH_Target_t *pTarget)
+{
+	uint8_t ui8Restored;
+
+	if (pTarget->pDevice->restoreSnapshot(&pTarget->Snapshot, &ui8Restored) != 0) {return -1;}
+
+	return (ui8Restored == 0) ? 0 : -1;
+}
+
+
+/* Restart of the MCU: a second driver object on the same sensor takes over the configuration */
+static int16_t runWarmInit(BENCH_Target_t *pTarget)
+{
+	ICM20948 Device(pTarget->pMock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3,
+			        &pTarget->Snapshot);
+
+	return Device.isWarmStart() ? 0 : -1;
+}
+
+
+static int16_t runExeSelfTest(BENCH_Target_t *pTarget)
+{
+	ICM20948_SelfTest_t Result;
+	int16_t i16RetValue;
+
+	/* The windows are filled during the settling times. The emulator does not respond to the actuation,
+	 * failed axes are a result, not an error of the case. */
+	pSamplingMock = pTarget->pMock;
+	i16RetValue   = pTarget->pDevice->exeSelfTest(&Result);
+	pSamplingMock = NULL;
+
+	return (i16RetValue < 0) ? -1 : 0;
+}
+
+
+static int16_t runGetConfigEpoch(BENCH_Target_t *pTarget)
+{
+	volatile uint8_t ui8Epoch = pTarget->pDevice->getConfigEpoch();
+
+	(void)ui8Epoch;
+
+	return 0;
+}
+
+
+/* Every call is a range switch and starts a new configuration epoch */
+static int16_t runSetAccelFullScale(BENCH_Target_t *pTarget)
+{
+	if (pTarget->pDevice->getSensorConfig().AccelFullScale.ui8Selection == ACCEL_FS_2G.ui8Selection)
+	{
+		return pTarget->pDevice->setAccelFullScale(ACCEL_FS_4G);
+	}
+
+	return pTarget->pDevice->setAccelFullScale(ACCEL_FS_2G);
+}
+
+
+static int16_t teardownFullScale(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->setAccelFullScale(ACCEL_FS_2G);
+}
+
+
+static int16_t setupFrames(BENCH_Target_t *pTarget)
+{
+	ICM20948_Frame_t Frame;
+
+	if (pTarget->pDevice->readAllDataRaw() != 0) {return -1;}
+
+	Frame = pTarget->pDevice->getFrame();
+
+	for (uint8_t i = 0; i < BENCH_FRAMES; i++)
+	{
+		pTarget->Frames[i] = Frame;
+	}
+
+	return 0;
+}
+
+
+static int16_t runConvertFrames(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->convertFrames(pTarget->Frames, BENCH_FRAMES, pTarget->fFrames);
+}
+
+
+static int16_t runCorrectGyro(BENCH_Target_t *pTarget)
+{
+	pTarget->pDevice->correctGyro(pTarget->Frames, BENCH_FRAMES);
+
+	return 0;
+}
+
+
+static int16_t setupSimFrames(BENCH_Target_t *pTarget)
+{
+	pTarget->pSimulator->generate(pTarget->Frames, BENCH_FRAMES);
+
+	return 0;
+}
+
+
+/* ns per input frame = ns/op / BENCH_FRAMES (one output per 16 inputs) */
+static int16_t runDecimatorProcess(BENCH_Target_t *pTarget)
+{
+	uint16_t ui16Outputs;
+
+	pTarget->pDecimator->process(pTarget->Frames, BENCH_FRAMES, pTarget->Outputs, &ui16Outputs);
+
+	return (ui16Outputs == 1) ? 0 : -1;
+}
+
+
+/* Response at the cutoff frequency */
+static int16_t runDecimatorResponse(BENCH_Target_t *pTarget)
+{
+	volatile float fMagnitude = pTarget->pDecimator->getFrequencyResponse(100.0f);
+
+	(void)fMagnitude;
+
+	return 0;
+}
+
+
+/* Detectors of the producer and the event queue of the consumer */
+static int16_t runMotionProcess(BENCH_Target_t *pTarget)
+{
+	MOTION_Event_t Event;
+
+	pTarget->pMotion->process(pTarget->Frames, BENCH_FRAMES, 0);
+
+	while (pTarget->pMotion->getEvent(&Event) == 1) {}
+
+	return 0;
+}
+
+
+/* Publication of the acquisition thread (no reader), the timestamp stands for the clock of the thread */
+static int16_t runSeqframePublish(BENCH_Target_t *pTarget)
+{
+	static uint64_t ui64Timestamp = 0;
+
+	pTarget->pSeqframe->publish(&pTarget->Frames[0], ++ui64Timestamp);
+
+	return 0;
+}
+
+
+static int16_t setupSeqframe(BENCH_Target_t *pTarget)
+{
+	pTarget->pSeqframe->publish(&pTarget->Frames[0], 0);
+
+	return 0;
+}
+
+
+/* Copy of a consumer thread without contention */
+static int16_t runSeqframeRead(BENCH_Target_t *pTarget)
+{
+	SEQFRAME_Sample_t Sample;
+
+	return (pTarget->pSeqframe->read(&Sample) == 0) ? 0 : -1;
+}
+
+
+static int16_t runCalculateMeanValues(BENCH_Target_t *pTarget)
+{
+	return pTarget->pDevice->calculateMeanValues();
+}
+
+
+static int16_t runCheckCalibration(BENCH_Target_t *pTarget)
+{
+	/* A failed check is a result, not an error of the case */
+	return (pTarget->pDevice->checkCalibration() < 0) ? -1 : 0;
+}
+
+
+static int16_t runConvIntToStr(BENCH_Target_t *pTarget)
+{
+	return pTarget->pConvert->convIntToStr(-123456).empty() ? -1 : 0;
+}
+
+
+static int16_t runConvFloatToStr(BENCH_Target_t *pTarget)
+{
+	return pTarget->pConvert->convFloatToStr(-12.3456f).empty() ? -1 : 0;
+}
+
+
+static int16_t runConvUintToFloat(BENCH_Target_t *pTarget)
+{
+	volatile float fValue = pTarget->pConvert->convUintToFloat(0x41460000);
+
+	(void)fValue;
+
+	return 0;
+}
+
+
+static const BENCH_Case_t BENCH_CASES[] =
+{
+	{"readAllDataRaw",             100000, NULL,           runReadAllDataRaw,       NULL},
+	{"getCorrectedAccelRaw",      1000000, NULL,           runGetCorrectedAccelRaw, NULL},
+	{"getCorrectedGyroRaw",       1000000, NULL,           runGetCorrectedGyroRaw,  NULL},
+	{"getFrame",                  1000000, NULL,           runGetFrame,             NULL},
+	{"readLatest",                 100000, setupLatest,    runReadLatest,           NULL},
+	{"readFifoFrames/16",           10000, setupFifo,      runReadFifoFrames,       teardownFifo},
+	{"resetFifo",                  100000, setupFifo,      runResetFifo,            teardownFifo},
+	{"getFifoCount",               100000, setupFifo,      runGetFifoCount,         teardownFifo},
+	{"readDmpPackets/16",           10000, setupDmp,       runReadDmpPackets,       teardownDmp},
+	{"convertFrames/16",           100000, setupFrames,    runConvertFrames,        NULL},
+	{"correctGyro/16",             100000, setupFrames,    runCorrectGyro,          NULL},
+	{"getConfigEpoch",            1000000, NULL,           runGetConfigEpoch,       NULL},
+	{"setAccelFullScale",          100000, NULL,           runSetAccelFullScale,    teardownFullScale},
+	{"takeSnapshot",                10000, NULL,           runTakeSnapshot,         NULL},
+	{"restoreSnapshot",             10000, setupSnapshot,  runRestoreSnapshot,      NULL},
+	{"warmInit",                    10000, setupSnapshot,  runWarmInit,             NULL},
+	{"exeSelfTest",                   100, NULL,           runExeSelfTest,          NULL},
+	{"DECIMATOR::process/16",      100000, setupSimFrames, runDecimatorProcess,     NULL},
+	{"DECIMATOR::freqResponse",     10000, NULL,           runDecimatorResponse,    NULL},
+	{"MOTION::process/16",         100000, setupSimFrames, runMotionProcess,        NULL},
+	{"SEQFRAME::publish",         1000000, NULL,           runSeqframePublish,      NULL},
+	{"SEQFRAME::read",            1000000, setupSeqframe,  runSeqframeRead,         NULL},
+	{"calculateMeanValues",            10, NULL,           runCalculateMeanValues,  NULL},
+	{"checkCalibration",              100, NULL,           runCheckCalibration,     NULL},
+	{"CONVERT::convIntToStr",      100000, NULL,           runConvIntToStr,         NULL},
+	{"CONVERT::convFloatToStr",    100000, NULL,           runConvFloatToStr,       NULL},
+	{"CONVERT::convUintToFloat",  1000000, NULL,           runConvUintToFloat,      NULL}
+};
+
+
+/* BENCH class */
+BENCH::BENCH(void) : Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3)
+{
+	Target.pMock    = &Mock;
+	Target.pDevice  = &Device;
+	Target.pConvert = &Convert;
+	Target.pDecimator = &Decimator;
+	Target.pSimulator = &Simulator;
+	Target.pMotion    = &Motion;
+	Target.pSeqframe  = &Seqframe;
+	memcpy(Target.ui8Sample, BENCH_SAMPLE, sizeof(Target.ui8Sample));
+
+	Mock.setSensorData(BENCH_SAMPLE);
+	Decimator.init(&BENCH_DECIMATOR_CONFIG);
+
+	ui16Results = 0;
+}
+
+
+/* Public methods */
+/**
+  @brief  Runs all built-in cases (the results of a previous run are discarded)
+  @retval Number of failed cases
+**/
+uint16_t BENCH::run(void)
+{
+	uint16_t ui16Failed = 0;
+
+	ui16Results = 0;
+
+	for (uint16_t i = 0; i < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]); i++)
+	{
+		if (runCase(&BENCH_CASES[i]) != 0) {ui16Failed++;}
+	}
+
+	return ui16Failed;
+}
+
+
+/**
+  @brief  Runs a case and appends its result
+  @retval  0: OK
+          -1: Result table full, setup or an operation failed (no result)
+**/
+int16_t BENCH::runCase(const BENCH_Case_t *pCase)
+{
+	BENCH_Result_t *pResult;
+	std::chrono::steady_clock::time_point Start, End;
+	uint32_t ui32Transactions, ui32Bytes;
+	double   dNs, dMinNs = 0.0;
+	int16_t  i16RetValue = 0;
+
+	if (ui16Results >= BENCH_MAX_RESULTS || pCase->ui32Iterations == 0) {return -1;}
+
+	if (pCase->pSetup != NULL && pCase->pSetup(&Target) != 0) {return -1;}
+
+	/* Warm-up (caches, branch predictors, FIFO and epoch state) */
+	for (uint32_t i = 0; i < pCase->ui32Iterations / 10 && i16RetValue == 0; i++)
+	{
+		i16RetValue = pCase->pRun(&Target);
+	}
+
+	/* The counters are the same in every round */
+	for (uint8_t ui8Round = 0; ui8Round < BENCH_ROUNDS && i16RetValue == 0; ui8Round++)
+	{
+		Mock.resetCounters();
+
+		Start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < pCase->ui32Iterations && i16RetValue == 0; i++)
+		{
+			i16RetValue = pCase->pRun(&Target);
+		}
+
+		End = std::chrono::steady_clock::now();
+
+		dNs = std::chrono::duration<double, std::nano>(End - Start).count();
+		if (ui8Round == 0 || dNs < dMinNs) {dMinNs = dNs;}
+	}
+
+	ui32Transactions = Mock.ui32Transactions;
+	ui32Bytes        = Mock.ui32BytesRead + Mock.ui32BytesWritten;
+
+	if (pCase->pTeardown != NULL && pCase->pTeardown(&Target) != 0) {i16RetValue = -1;}
+
+	if (i16RetValue != 0) {return -1;}
+
+	pResult = &Results[ui16Results++];
+	strncpy(pResult->cName, pCase->pName, BENCH_NAME_SIZE - 1);
+	pResult->cName[BENCH_NAME_SIZE - 1] = '\0';
+	pResult->ui32Iterations     = pCase->ui32Iterations;
+	pResult->dNsPerOp           = dMinNs / pCase->ui32Iterations;
+	pResult->dTransactionsPerOp = (double)ui32Transactions / pCase->ui32Iterations;
+	pResult->dBytesPerOp        = (double)ui32Bytes / pCase->ui32Iterations;
+
+	return 0;
+}
+
+
+/* Results of the current run (valid until the next run()) */
+uint16_t BENCH::getResults(const BENCH_Result_t **ppResults)
+{
+	*ppResults = Results;
+
+	return ui16Results;
+}
+
+
+/* CSV with a header line: name,iterations,ns_per_op,transactions_per_op,bytes_per_op */
+void BENCH::writeResults(FILE *pFile)
+{
+	fprintf(pFile, "name,iterations,ns_per_op,transactions_per_op,bytes_per_op\n");
+
+	for (uint16_t i = 0; i < ui16Results; i++)
+	{
+		fprintf(pFile, "%s,%u,%.2f,%.3f,%.3f\n", Results[i].cName, Results[i].ui32Iterations,
+				Results[i].dNsPerOp, Results[i].dTransactionsPerOp, Results[i].dBytesPerOp);
+	}
+}
+
+
+/**
+  @brief  Compares the current results with a baseline written by writeResults()
+  @param  dTolerance: Allowed relative increase of ns/op (0.2: 20%)
+          pReport:    One line per compared case (NULL: no report)
+  @retval >= 0: Number of regressions (more transactions or bytes per operation, ns/op above the tolerance,
+                baseline entry without a result in this run)
+          -1:   No baseline entries
+**/
+int16_t BENCH::compareBaseline(FILE *pBaseline, double dTolerance, FILE *pReport)
+{
+	char   cLine[128];
+	char   cName[BENCH_NAME_SIZE];
+	unsigned int uiIterations;
+	double dNs, dTransactions, dBytes;
+	const BENCH_Result_t *pResult;
+	uint16_t ui16Entries = 0;
+	int16_t  i16Regressions = 0;
+	bool     boRegression;
+
+	while (fgets(cLine, sizeof(cLine), pBaseline) != NULL)
+	{
+		/* The header and invalid lines are skipped */
+		if (sscanf(cLine, "%31[^,],%u,%lf,%lf,%lf", cName, &uiIterations, &dNs, &dTransactions, &dBytes) != 5) {continue;}
+
+		ui16Entries++;
+
+		/* A case that is not measured any more (removed or failed) is a regression as well */
+		pResult = findResult(cName);
+		if (pResult == NULL)
+		{
+			i16Regressions++;
+			if (pReport != NULL) {fprintf(pReport, "%-26s missing in this run  REGRESSION\n", cName);}
+			continue;
+		}
+
+		/* Counters are exact (a small epsilon for the printed decimals) */
+		boRegression = (pResult->dTransactionsPerOp > dTransactions + 0.001) ||
+					   (pResult->dBytesPerOp > dBytes + 0.001) ||
+					   (pResult->dNsPerOp > dNs * (1.0 + dTolerance));
+
+		if (boRegression) {i16Regressions++;}
+
+		if (pReport != NULL)
+		{
+			fprintf(pReport, "%-26s %10.2f ns (%+6.1f%%) %8.3f tx (%+.3f) %9.3f B (%+.3f)%s\n", cName,
+					pResult->dNsPerOp, (dNs > 0.0) ? (pResult->dNsPerOp / dNs - 1.0) * 100.0 : 0.0,
+					pResult->dTransactionsPerOp, pResult->dTransactionsPerOp - dTransactions,
+					pResult->dBytesPerOp, pResult->dBytesPerOp - dBytes, boRegression ? "  REGRESSION" : "");
+		}
+	}
+
+	if (ui16Entries == 0) {return -1;}
+
+	return i16Regressions;
+}
+
+
+/* Deterministic time base for get_Ticks(): one millisecond per BENCH_TICK_CALLS calls */
+uint32_t BENCH::getTicks(void)
+{
+	static uint32_t ui32Calls = 0;
+
+	if (pSamplingMock != NULL && ui32Calls % BENCH_TICK_CALLS == 0) {pSamplingMock->pushSample(BENCH_SAMPLE);}
+
+	return ui32Calls++ / BENCH_TICK_CALLS;
+}
+
+
+/* Private methods */
+const BENCH_Result_t *BENCH::findResult(const char *pName)
+{
+	for (uint16_t i = 0; i < ui16Results; i++)
+	{
+		if (strcmp(Results[i].cName, pName) == 0) {return &Results[i];}
+	}
+
+	return NULL;
+}
+
+#endif /* ICM20948_HOST */
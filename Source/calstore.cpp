@@ -0,0 +1,346 @@
+/*
+ * calstore.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "calstore.hpp"
+#include "checksum.hpp"
+#include <stdio.h>
+#include <string.h>
+
+#if defined (STM32F411xE)
+	#include "stm32f4xx.h"
+#elif defined (STM32H743xx)
+	#include "stm32h7xx.h"
+#endif
+
+
+#if defined (STM32F411xE) || defined (STM32H743xx)
+/* CALSTORE_FLASH class */
+CALSTORE_FLASH::CALSTORE_FLASH(uint32_t ui32Address, uint8_t ui8Sector)
+{
+	this->ui32Address = ui32Address;
+	this->ui8Sector   = ui8Sector;
+}
+
+
+int16_t CALSTORE_FLASH::read(uint8_t *pData, uint16_t ui16Size)
+{
+	memcpy(pData, (const void *)ui32Address, ui16Size);
+
+	return 0;
+}
+
+
+/**
+  @brief  Erases the sector and programs the record (register level, see reference manual "Embedded Flash memory")
+  @retval  0: OK
+          -1: Flash operation failed
+**/
+int16_t CALSTORE_FLASH::write(const uint8_t *pData, uint16_t ui16Size)
+{
+	int16_t i16RetValue = 0;
+
+#if defined (STM32F411xE)
+	uint32_t ui32Word;
+
+	/* Unlock flash control register */
+	if (FLASH->CR & FLASH_CR_LOCK)
+	{
+		FLASH->KEYR = 0x45670123;
+		FLASH->KEYR = 0xCDEF89AB;
+	}
+	if (waitReady() != 0) {FLASH->CR |= FLASH_CR_LOCK; return -1;}
+
+	/* Sector erase with 32-bit parallelism (VDD = 2.7...3.6V) */
+	FLASH->CR = (FLASH->CR & ~(FLASH_CR_PSIZE | FLASH_CR_SNB)) | FLASH_CR_PSIZE_1 | FLASH_CR_SER
+			  | ((uint32_t)ui8Sector << FLASH_CR_SNB_Pos);
+	FLASH->CR |= FLASH_CR_STRT;
+	i16RetValue = waitReady();
+	FLASH->CR &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+
+	/* Program word by word */
+	for (uint16_t i = 0; (i < ui16Size) && (i16RetValue == 0); i += 4)
+	{
+		ui32Word = 0xFFFFFFFF;
+		memcpy(&ui32Word, &pData[i], (ui16Size - i < 4) ? (ui16Size - i) : 4);
+
+		FLASH->CR |= FLASH_CR_PG;
+		*(volatile uint32_t *)(ui32Address + i) = ui32Word;
+		i16RetValue = waitReady();
+		FLASH->CR &= ~FLASH_CR_PG;
+	}
+
+	FLASH->CR |= FLASH_CR_LOCK;
+
+#elif defined (STM32H743xx)
+	uint32_t ui32FlashWord[8]; // The STM32H7 programs flash words of 256 bits
+
+	/* Unlock flash control register of bank 1 */
+	if (FLASH->CR1 & FLASH_CR_LOCK)
+	{
+		FLASH->KEYR1 = 0x45670123;
+		FLASH->KEYR1 = 0xCDEF89AB;
+	}
+	if (waitReady() != 0) {FLASH->CR1 |= FLASH_CR_LOCK; return -1;}
+
+	/* Sector erase with 32-bit parallelism */
+	FLASH->CR1 = (FLASH->CR1 & ~(FLASH_CR_PSIZE | FLASH_CR_SNB)) | FLASH_CR_PSIZE_1 | FLASH_CR_SER
+			   | ((uint32_t)ui8Sector << FLASH_CR_SNB_Pos);
+	FLASH->CR1 |= FLASH_CR_START;
+	i16RetValue = waitReady();
+	FLASH->CR1 &= ~(FLASH_CR_SER | FLASH_CR_SNB);
+
+	/* Program flash word by flash word (the write of the 8th word starts the programming) */
+	for (uint16_t i = 0; (i < ui16Size) && (i16RetValue == 0); i += 32)
+	{
+		memset(ui32FlashWord, 0xFF, sizeof(ui32FlashWord));
+		memcpy(ui32FlashWord, &pData[i], (ui16Size - i < 32) ? (ui16Size - i) : 32);
+
+		FLASH->CR1 |= FLASH_CR_PG;
+		for (uint8_t j = 0; j < 8; j++)
+		{
+			*(volatile uint32_t *)(ui32Address + i + 4 * j) = ui32FlashWord[j];
+		}
+		i16RetValue = waitReady();
+		FLASH->CR1 &= ~FLASH_CR_PG;
+	}
+
+	FLASH->CR1 |= FLASH_CR_LOCK;
+
+	/* The record is read back through the data cache */
+	SCB_InvalidateDCache_by_Addr((uint32_t *)ui32Address, ui16Size);
+#endif
+
+	return i16RetValue;
+}
+
+
+int16_t CALSTORE_FLASH::waitReady(void)
+{
+#if defined (STM32F411xE)
+	while (FLASH->SR & FLASH_SR_BSY);
+
+	if (FLASH->SR & (FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR))
+	{
+		/* Error flags are cleared by writing 1 */
+		FLASH->SR = FLASH_SR_WRPERR | FLASH_SR_PGAERR | FLASH_SR_PGPERR | FLASH_SR_PGSERR;
+		return -1;
+	}
+#elif defined (STM32H743xx)
+	while (FLASH->SR1 & (FLASH_SR_BSY | FLASH_SR_QW));
+
+	if (FLASH->SR1 & (FLASH_SR_WRPERR | FLASH_SR_PGSERR | FLASH_SR_STRBERR | FLASH_SR_INCERR | FLASH_SR_OPERR))
+	{
+		FLASH->CCR1 = FLASH_CCR_CLR_WRPERR | FLASH_CCR_CLR_PGSERR | FLASH_CCR_CLR_STRBERR
+				    | FLASH_CCR_CLR_INCERR | FLASH_CCR_CLR_OPERR;
+		return -1;
+	}
+	FLASH->CCR1 = FLASH_CCR_CLR_EOP;
+#endif
+
+	return 0;
+}
+#endif
+
+
+/* CALSTORE_FILE class */
+CALSTORE_FILE::CALSTORE_FILE(const char *pPath)
+{
+	this->pPath = pPath;
+}
+
+
+int16_t CALSTORE_FILE::read(uint8_t *pData, uint16_t ui16Size)
+{
+	FILE *pFile = fopen(pPath, "rb");
+
+	if (pFile == NULL) {return -1;}
+
+	if (fread(pData, 1, ui16Size, pFile) != ui16Size) {fclose(pFile); return -1;}
+	fclose(pFile);
+
+	return 0;
+}
+
+
+int16_t CALSTORE_FILE::write(const uint8_t *pData, uint16_t ui16Size)
+{
+	FILE *pFile = fopen(pPath, "wb");
+
+	if (pFile == NULL) {return -1;}
+
+	if (fwrite(pData, 1, ui16Size, pFile) != ui16Size) {fclose(pFile); return -1;}
+	if (fclose(pFile) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/* CALSTORE class */
+CALSTORE::CALSTORE(CALSTORE_BACKEND *pBackend)
+{
+	this->pBackend = pBackend;
+}
+
+
+/* Public methods */
+/**
+  @brief  Reads and validates the stored calibration record
+  @retval  0: OK
+          -1: Backend error, invalid magic/version/size or CRC mismatch
+**/
+int16_t CALSTORE::load(ICM20948_CalRecord_t *pRecord)
+{
+	uint8_t ui8Buffer[CALSTORE_RECORD_SIZE];
+
+	if (pBackend->read(ui8Buffer, CALSTORE_RECORD_SIZE) != 0) {return -1;}
+	if (deserialize(ui8Buffer, pRecord) != 0) {return -1;}
+
+	return 0;
+}
+
+
+int16_t CALSTORE::save(const ICM20948_CalRecord_t *pRecord)
+{
+	uint8_t ui8Buffer[CALSTORE_RECORD_SIZE];
+
+	serialize(pRecord, ui8Buffer);
+	if (pBackend->write(ui8Buffer, CALSTORE_RECORD_SIZE) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/**
+  @brief  Startup with stored calibration (sensor must be at rest, board +Z up)
+          1. Load the stored record and apply it, if it matches the sensor configuration
+          2. Check the stored offsets with a short mean value window and the temperature difference
+          3. Only if one of the steps fails, the full calibration is executed and the new record is stored
+**/
+CALSTORE_RetCode_t CALSTORE::warmStart(ICM20948 *pICM20948)
+{
+	ICM20948_CalRecord_t Record;
+	bool boValid = false;
+
+	if (load(&Record) == 0 && pICM20948->setCalibrationRecord(&Record) == 0)
+	{
+		if (pICM20948->readAllDataRaw() != 0) {return CALSTORE_GEN_FAIL;}
+
+		if (abs(pICM20948->getTemperatureRaw() - Record.i16Temperature) <= ICM20948_CALCHECK_TEMP)
+		{
+			if (pICM20948->checkCalibration() == 0) {boValid = true;}
+		}
+	}
+
+	if (boValid) {return CALSTORE_RESTORED;}
+
+	/* Fall back to full calibration */
+	if (pICM20948->exeCalibration() != 0) {return CALSTORE_CAL_FAIL;}
+
+	pICM20948->getCalibrationRecord(&Record);
+	if (save(&Record) != 0) {return CALSTORE_GEN_FAIL;}
+
+	return CALSTORE_RECALIBRATED;
+}
+
+
+void CALSTORE::serialize(const ICM20948_CalRecord_t *pRecord, uint8_t *pBuffer)
+{
+	CHECKSUM Checksum;
+
+	putU32(&pBuffer[0], CALSTORE_MAGIC);
+	putU16(&pBuffer[4], CALSTORE_VERSION);
+	putU16(&pBuffer[6], CALSTORE_RECORD_SIZE);
+
+	putU16(&pBuffer[ 8], pRecord->AccelOffset.i16XAxis);
+	putU16(&pBuffer[10], pRecord->AccelOffset.i16YAxis);
+	putU16(&pBuffer[12], pRecord->AccelOffset.i16ZAxis);
+	putU16(&pBuffer[14], pRecord->GyroOffset.i16XAxis);
+	putU16(&pBuffer[16], pRecord->GyroOffset.i16YAxis);
+	putU16(&pBuffer[18], pRecord->GyroOffset.i16ZAxis);
+
+	putU16(&pBuffer[20], pRecord->i16Temperature);
+	pBuffer[22] = pRecord->ui8AccelFullScale;
+	pBuffer[23] = pRecord->ui8GyroFullScale;
+	putU16(&pBuffer[24], pRecord->ui16AccelDiv);
+	pBuffer[26] = pRecord->ui8GyroDiv;
+	pBuffer[27] = (pRecord->boAccelFCHOICE ? 0x01 : 0x00) | (pRecord->boGyroFCHOICE ? 0x02 : 0x00);
+	pBuffer[28] = pRecord->AccelDLPF;
+	pBuffer[29] = pRecord->GyroDLPF;
+	pBuffer[30] = pRecord->ui8MountX;
+	pBuffer[31] = pRecord->ui8MountY;
+	pBuffer[32] = pRecord->ui8MountZ;
+	pBuffer[33] = 0x00;
+	putU16(&pBuffer[34], 0x0000);
+
+	putU32(&pBuffer[36], Checksum.calcCRC32(pBuffer, CALSTORE_RECORD_SIZE - 4));
+}
+
+
+/**
+  @retval  0: OK
+          -1: Invalid magic, version or size, CRC mismatch
+**/
+int16_t CALSTORE::deserialize(const uint8_t *pBuffer, ICM20948_CalRecord_t *pRecord)
+{
+	CHECKSUM Checksum;
+
+	if (getU32(&pBuffer[0]) != CALSTORE_MAGIC)       {return -1;}
+	if (getU16(&pBuffer[4]) != CALSTORE_VERSION)     {return -1;}
+	if (getU16(&pBuffer[6]) != CALSTORE_RECORD_SIZE) {return -1;}
+	if (getU32(&pBuffer[36]) != Checksum.calcCRC32(pBuffer, CALSTORE_RECORD_SIZE - 4)) {return -1;}
+
+	pRecord->AccelOffset.i16XAxis = getU16(&pBuffer[ 8]);
+	pRecord->AccelOffset.i16YAxis = getU16(&pBuffer[10]);
+	pRecord->AccelOffset.i16ZAxis = getU16(&pBuffer[12]);
+	pRecord->GyroOffset.i16XAxis  = getU16(&pBuffer[14]);
+	pRecord->GyroOffset.i16YAxis  = getU16(&pBuffer[16]);
+	pRecord->GyroOffset.i16ZAxis  = getU16(&pBuffer[18]);
+
+	pRecord->i16Temperature    = getU16(&pBuffer[20]);
+	pRecord->ui8AccelFullScale = pBuffer[22];
+	pRecord->ui8GyroFullScale  = pBuffer[23];
+	pRecord->ui16AccelDiv      = getU16(&pBuffer[24]);
+	pRecord->ui8GyroDiv        = pBuffer[26];
+	pRecord->boAccelFCHOICE    = (pBuffer[27] & 0x01) != 0;
+	pRecord->boGyroFCHOICE     = (pBuffer[27] & 0x02) != 0;
+	pRecord->AccelDLPF         = (ICM20948_DLPF_t)pBuffer[28];
+	pRecord->GyroDLPF          = (ICM20948_DLPF_t)pBuffer[29];
+	pRecord->ui8MountX         = pBuffer[30];
+	pRecord->ui8MountY         = pBuffer[31];
+	pRecord->ui8MountZ         = pBuffer[32];
+
+	return 0;
+}
+
+
+/* Private methods */
+void CALSTORE::putU16(uint8_t *pBuffer, uint16_t ui16Value)
+{
+	pBuffer[0] = ui16Value;
+	pBuffer[1] = ui16Value >> 8;
+}
+
+
+void CALSTORE::putU32(uint8_t *pBuffer, uint32_t ui32Value)
+{
+	pBuffer[0] = ui32Value;
+	pBuffer[1] = ui32Value >> 8;
+	pBuffer[2] = ui32Value >> 16;
+	pBuffer[3] = ui32Value >> 24;
+}
+
+
+uint16_t CALSTORE::getU16(const uint8_t *pBuffer)
+{
+	return pBuffer[0] | (pBuffer[1] << 8);
+}
+
+
+uint32_t CALSTORE::getU32(const uint8_t *pBuffer)
+{
+	return pBuffer[0] | (pBuffer[1] << 8) | ((uint32_t)pBuffer[2] << 16) | ((uint32_t)pBuffer[3] << 24);
+}
@@ -0,0 +1,39 @@
+/*
+ * checksum.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "checksum.hpp"
+
+
+/* Nibble table of the reflected CRC-32 polynomial 0xEDB88320 (16 entries instead of 256 to save flash) */
+static const uint32_t ui32CRC32Table[16] =
+{
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+
+/* Public methods */
+/**
+  @brief  CRC-32 (IEEE 802.3, as used by zlib), can be continued over several blocks
+  @param  pData:      Data block
+          ui32Length: Number of bytes
+          ui32CRC:    CRC of the previous blocks (0 for the first block)
+  @retval CRC-32
+**/
+uint32_t CHECKSUM::calcCRC32(const uint8_t *pData, uint32_t ui32Length, uint32_t ui32CRC)
+{
+	ui32CRC = ~ui32CRC;
+
+	for (uint32_t i = 0; i < ui32Length; i++)
+	{
+		ui32CRC ^= pData[i];
+		ui32CRC = (ui32CRC >> 4) ^ ui32CRC32Table[ui32CRC & 0x0F];
+		ui32CRC = (ui32CRC >> 4) ^ ui32CRC32Table[ui32CRC & 0x0F];
+	}
+
+	return ~ui32CRC;
+}
@@ -0,0 +1,346 @@
+/*
+ * decimator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "decimator.hpp"
+#include <cmath>
+#include <string.h>
+
+
+/* DECIMATOR class */
+DECIMATOR::DECIMATOR(void)
+{
+	memset(&Config, 0, sizeof(Config));
+	Config.ui8CicRate = 1;
+	Config.ui8FirRate = 1;
+
+	ui8CicShift = 0;
+
+	reset();
+}
+
+
+/* Public methods */
+/**
+  @brief  Checks and applies a configuration, designs the FIR filter if no coefficients are given
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t DECIMATOR::init(const DECIMATOR_Config_t *pConfig)
+{
+	uint8_t ui8Log2Rate = 0;
+
+	if (pConfig->fInputRate <= 0.0) {return -1;}
+	if (pConfig->ui8CicOrder > DECIMATOR_MAX_CIC_ORDER || pConfig->ui8FirTaps > DECIMATOR_MAX_TAPS) {return -1;}
+	if (pConfig->ui8CicRate == 0 || (pConfig->ui8CicRate & (pConfig->ui8CicRate - 1)) != 0) {return -1;}
+	if (pConfig->ui8FirRate == 0) {return -1;}
+
+	/* A bypassed stage must not decimate */
+	if (pConfig->ui8CicOrder == 0 && pConfig->ui8CicRate != 1) {return -1;}
+	if (pConfig->ui8FirTaps == 0 && pConfig->ui8FirRate != 1) {return -1;}
+
+	while (((uint16_t)1 << ui8Log2Rate) < pConfig->ui8CicRate) {ui8Log2Rate++;}
+	if (pConfig->ui8CicOrder * ui8Log2Rate > DECIMATOR_MAX_CIC_SHIFT) {return -1;}
+
+	if (pConfig->ui8FirTaps > 0)
+	{
+		if (pConfig->pFirCoeffs != NULL)
+		{
+			memcpy(i16Coeffs, pConfig->pFirCoeffs, pConfig->ui8FirTaps * sizeof(int16_t));
+		}
+		else if (designFir(pConfig->ui8FirTaps, pConfig->fFirCutoff, pConfig->fInputRate / pConfig->ui8CicRate,
+				i16Coeffs) != 0)
+		{
+			return -1;
+		}
+	}
+
+	Config = *pConfig;
+	Config.pFirCoeffs = i16Coeffs;
+	ui8CicShift = pConfig->ui8CicOrder * ui8Log2Rate;
+
+	reset();
+
+	return 0;
+}
+
+
+void DECIMATOR::reset(void)
+{
+	memset(ui32Integrator, 0, sizeof(ui32Integrator));
+	memset(ui32Comb, 0, sizeof(ui32Comb));
+	memset(i16Delay, 0, sizeof(i16Delay));
+
+	ui8CicCount   = 0;
+	ui8DelayIndex = 0;
+	ui8FirCount   = 0;
+
+	ui8Epoch             = 0;
+	ui8Flags             = 0;
+	ui16TransitionInputs = 0;
+}
+
+
+/**
+  @brief  Feeds ui16InCount input frames through the cascade
+  @param  pOut: Output frames, at least ui16InCount / (ui8CicRate * ui8FirRate) + 1 entries
+          pOutCount: Number of output frames written
+  @retval None
+**/
+void DECIMATOR::process(const ICM20948_Frame_t *pIn, uint16_t ui16InCount, ICM20948_Frame_t *pOut, uint16_t *pOutCount)
+{
+	int16_t i16In[DECIMATOR_CHANNELS], i16Cic[DECIMATOR_CHANNELS], i16Out[DECIMATOR_CHANNELS];
+	uint16_t ui16Out = 0;
+
+	for (uint16_t i = 0; i < ui16InCount; i++)
+	{
+		i16In[0] = pIn[i].Accel.i16XAxis;
+		i16In[1] = pIn[i].Accel.i16YAxis;
+		i16In[2] = pIn[i].Accel.i16ZAxis;
+		i16In[3] = pIn[i].Gyro.i16XAxis;
+		i16In[4] = pIn[i].Gyro.i16YAxis;
+		i16In[5] = pIn[i].Gyro.i16ZAxis;
+
+		if (pIn[i].ui8Epoch != ui8Epoch)
+		{
+			ui8Epoch = pIn[i].ui8Epoch;
+			ui16TransitionInputs = Config.ui8CicRate * (Config.ui8CicOrder + Config.ui8FirTaps);
+		}
+
+		ui8Flags |= pIn[i].ui8Flags;
+		if (ui16TransitionInputs > 0)
+		{
+			ui16TransitionInputs--;
+			ui8Flags |= ICM20948_FRAME_TRANSITION;
+		}
+
+		if (!processCic(i16In, i16Cic)) {continue;}
+		if (!processFir(i16Cic, i16Out)) {continue;}
+
+		pOut[ui16Out].Accel.i16XAxis  = i16Out[0];
+		pOut[ui16Out].Accel.i16YAxis  = i16Out[1];
+		pOut[ui16Out].Accel.i16ZAxis  = i16Out[2];
+		pOut[ui16Out].Gyro.i16XAxis   = i16Out[3];
+		pOut[ui16Out].Gyro.i16YAxis   = i16Out[4];
+		pOut[ui16Out].Gyro.i16ZAxis   = i16Out[5];
+		pOut[ui16Out].i16Temperature  = pIn[i].i16Temperature;
+		pOut[ui16Out].ui8Epoch        = ui8Epoch;
+		pOut[ui16Out].ui8Flags        = ui8Flags;
+		pOut[ui16Out].ui8Range        = pIn[i].ui8Range;
+		ui16Out++;
+
+		ui8Flags = 0;
+	}
+
+	*pOutCount = ui16Out;
+}
+
+
+float DECIMATOR::getOutputRate(void)
+{
+	return Config.fInputRate / (Config.ui8CicRate * Config.ui8FirRate);
+}
+
+
+/**
+  @brief  Group delay of the cascade [s]. CIC: N * (R - 1) / 2 input samples, FIR: (taps - 1) / 2 samples at the
+          FIR input rate (linear phase, valid for symmetric coefficients).
+**/
+float DECIMATOR::getGroupDelay(void)
+{
+	float fDelay;
+
+	fDelay = Config.ui8CicOrder * (Config.ui8CicRate - 1) / (2.0f * Config.fInputRate);
+
+	if (Config.ui8FirTaps > 0)
+	{
+		fDelay += (Config.ui8FirTaps - 1) * Config.ui8CicRate / (2.0f * Config.fInputRate);
+	}
+
+	return fDelay;
+}
+
+
+/**
+  @brief  Magnitude response of the cascade at fFreq [Hz] (linear, 1.0 = unity gain). Frequencies above half
+          the output rate show the attenuation of the components that alias into the output band.
+**/
+float DECIMATOR::getFrequencyResponse(float fFreq)
+{
+	float fMag = 1.0, fCic, fRe = 0.0, fIm = 0.0, fOmega;
+
+	/* CIC: |sin(pi * f * R / fs) / (R * sin(pi * f / fs))|^N */
+	if (Config.ui8CicOrder > 0)
+	{
+		fOmega = (float)M_PI * fFreq / Config.fInputRate;
+
+		if (std::fabs(std::sin(fOmega)) > 1e-6f)
+		{
+			fCic = std::fabs(std::sin(fOmega * Config.ui8CicRate) / (Config.ui8CicRate * std::sin(fOmega)));
+			fMag = std::pow(fCic, Config.ui8CicOrder);
+		}
+	}
+
+	/* FIR: |sum(h[k] * exp(-j * 2 * pi * f * k / fs_fir))| */
+	if (Config.ui8FirTaps > 0)
+	{
+		fOmega = 2.0f * (float)M_PI * fFreq * Config.ui8CicRate / Config.fInputRate;
+
+		for (uint8_t k = 0; k < Config.ui8FirTaps; k++)
+		{
+			fRe += i16Coeffs[k] * std::cos(fOmega * k);
+			fIm -= i16Coeffs[k] * std::sin(fOmega * k);
+		}
+
+		fMag *= std::sqrt(fRe * fRe + fIm * fIm) / 32768.0f;
+	}
+
+	return fMag;
+}
+
+
+/**
+  @brief  Lowpass design (Blackman windowed sinc), Q15 coefficients with a DC gain of exactly 1.0. The window
+          spans ui8Taps + 2 points and its zero end points are left out, so the outer taps contribute.
+  @retval  0: OK
+          -1: Invalid number of taps, cutoff frequency (must be below fSampleRate / 2) or a coefficient outside
+              of Q15 (cutoff close to fSampleRate / 2 with few taps)
+**/
+int16_t DECIMATOR::designFir(uint8_t ui8Taps, float fCutoff, float fSampleRate, int16_t *pCoeffs)
+{
+	float fH[DECIMATOR_MAX_TAPS];
+	float fSum = 0.0, fFc, fX, fWindow;
+	int32_t i32Coeff, i32Sum = 0;
+	uint8_t ui8Center = (ui8Taps - 1) / 2;
+
+	if (ui8Taps < DECIMATOR_MIN_DESIGN || ui8Taps > DECIMATOR_MAX_TAPS) {return -1;}
+	if (fCutoff <= 0.0 || fCutoff >= fSampleRate / 2.0) {return -1;}
+
+	fFc = fCutoff / fSampleRate;
+
+	for (uint8_t k = 0; k < ui8Taps; k++)
+	{
+		fX = k - (ui8Taps - 1) / 2.0f;
+
+		fH[k] = (fX == 0.0f) ? (2.0f * fFc) : (std::sin(2.0f * (float)M_PI * fFc * fX) / ((float)M_PI * fX));
+
+		fWindow = 0.42f - 0.5f * std::cos(2.0f * (float)M_PI * (k + 1) / (ui8Taps + 1))
+				+ 0.08f * std::cos(4.0f * (float)M_PI * (k + 1) / (ui8Taps + 1));
+		fH[k] *= fWindow;
+
+		fSum += fH[k];
+	}
+
+	for (uint8_t k = 0; k < ui8Taps; k++)
+	{
+		i32Coeff = std::lround(fH[k] / fSum * 32768.0f);
+		if (i32Coeff > 32767 || i32Coeff < -32768) {return -1;}
+
+		pCoeffs[k] = (int16_t)i32Coeff;
+		i32Sum    += i32Coeff;
+	}
+
+	/* Rounding error goes into the center tap */
+	i32Coeff = pCoeffs[ui8Center] + 32768 - i32Sum;
+	if (i32Coeff > 32767 || i32Coeff < -32768) {return -1;}
+
+	pCoeffs[ui8Center] = (int16_t)i32Coeff;
+
+	return 0;
+}
+
+
+/* Private methods */
+/* CIC decimator (differential delay 1). The integrators wrap around, the result is exact as long as the output
+ * fits into 16 + ui8CicShift bits. Gain R^N is removed by the shift. */
+inline bool DECIMATOR::processCic(const int16_t *pIn, int16_t *pOut)
+{
+	uint32_t ui32Value, ui32Previous;
+
+	if (Config.ui8CicOrder == 0)
+	{
+		memcpy(pOut, pIn, DECIMATOR_CHANNELS * sizeof(int16_t));
+		return true;
+	}
+
+	for (uint8_t c = 0; c < DECIMATOR_CHANNELS; c++)
+	{
+		ui32Value = (uint32_t)(int32_t)pIn[c];
+
+		for (uint8_t n = 0; n < Config.ui8CicOrder; n++)
+		{
+			ui32Integrator[c][n] += ui32Value;
+			ui32Value = ui32Integrator[c][n];
+		}
+	}
+
+	if (++ui8CicCount < Config.ui8CicRate) {return false;}
+	ui8CicCount = 0;
+
+	for (uint8_t c = 0; c < DECIMATOR_CHANNELS; c++)
+	{
+		ui32Value = ui32Integrator[c][Config.ui8CicOrder - 1];
+
+		for (uint8_t n = 0; n < Config.ui8CicOrder; n++)
+		{
+			ui32Previous     = ui32Comb[c][n];
+			ui32Comb[c][n]   = ui32Value;
+			ui32Value       -= ui32Previous;
+		}
+
+		pOut[c] = (int16_t)((int32_t)ui32Value >> ui8CicShift);
+	}
+
+	return true;
+}
+
+
+/* Decimating FIR filter. New samples are written to i16Delay[c][i] and i16Delay[c][i + taps], so the newest
+ * ui8FirTaps samples are always contiguous starting at ui8DelayIndex (newest first). */
+inline bool DECIMATOR::processFir(const int16_t *pIn, int16_t *pOut)
+{
+	const int16_t *pWindow;
+	int64_t i64Acc;
+	int32_t i32Value;
+
+	uint8_t ui8Taps = Config.ui8FirTaps;
+
+	if (ui8Taps == 0)
+	{
+		memcpy(pOut, pIn, DECIMATOR_CHANNELS * sizeof(int16_t));
+		return true;
+	}
+
+	ui8DelayIndex = (ui8DelayIndex == 0) ? (ui8Taps - 1) : (ui8DelayIndex - 1);
+
+	for (uint8_t c = 0; c < DECIMATOR_CHANNELS; c++)
+	{
+		i16Delay[c][ui8DelayIndex]           = pIn[c];
+		i16Delay[c][ui8DelayIndex + ui8Taps] = pIn[c];
+	}
+
+	if (++ui8FirCount < Config.ui8FirRate) {return false;}
+	ui8FirCount = 0;
+
+	for (uint8_t c = 0; c < DECIMATOR_CHANNELS; c++)
+	{
+		pWindow = &i16Delay[c][ui8DelayIndex];
+		i64Acc  = 1 << 14; // Rounding
+
+		for (uint8_t k = 0; k < ui8Taps; k++)
+		{
+			i64Acc += (int32_t)i16Coeffs[k] * pWindow[k];
+		}
+
+		i32Value = (int32_t)(i64Acc >> 15);
+		if (i32Value >  32767) {i32Value =  32767;}
+		if (i32Value < -32768) {i32Value = -32768;}
+
+		pOut[c] = (int16_t)i32Value;
+	}
+
+	return true;
+}
@@ -0,0 +1,194 @@
+/*
+ * fsync.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "fsync.hpp"
+
+
+static_assert((FSYNC_MAX_WINDOW & (FSYNC_MAX_WINDOW - 1)) == 0, "FSYNC_MAX_WINDOW must be a power of two");
+static_assert((FSYNC_QUEUE_SIZE & (FSYNC_QUEUE_SIZE - 1)) == 0, "FSYNC_QUEUE_SIZE must be a power of two");
+
+
+/* FSYNC class */
+FSYNC::FSYNC(const FSYNC_Config_t *pConfig) : ui16Head(0), ui16Tail(0), ui32Dropped(0)
+{
+	if (init(pConfig) != 0) {init(&FSYNC_DEFAULT_CONFIG);}
+}
+
+
+/* Public methods */
+/**
+  @brief  Checks and applies a configuration (the window queue is kept)
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t FSYNC::init(const FSYNC_Config_t *pConfig)
+{
+	if (pConfig->ui32SamplePeriod == 0 || pConfig->ui32SamplePeriod > 1000000) {return -1;}
+	if ((uint32_t)pConfig->ui16Before + 1 + pConfig->ui16After > FSYNC_MAX_WINDOW) {return -1;}
+
+	Config = *pConfig;
+
+	reset();
+
+	return 0;
+}
+
+
+/* Clears the history and the pending triggers (the window queue is kept) */
+void FSYNC::reset(void)
+{
+	ui32Samples  = 0;
+	ui32Triggers = 0;
+	ui8Pending   = 0;
+}
+
+
+/**
+  @brief  Adds frames in sample order (burst reads or FIFO batches without gaps)
+  @param  ui16Delay: getFsyncDelay() after reading the frames, it is used for all triggers of this call
+                     (exact for the last one, several triggers per call only occur with long FIFO batches)
+  @retval Number of completed windows
+**/
+uint16_t FSYNC::process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, uint16_t ui16Delay)
+{
+	uint16_t ui16Windows = 0;
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		History[ui32Samples & (FSYNC_MAX_WINDOW - 1)] = pFrames[i];
+
+		if (pFrames[i].ui8Flags & ICM20948_FRAME_FSYNC)
+		{
+			ui32Triggers++;
+
+			if (ui8Pending < FSYNC_MAX_PENDING)
+			{
+				ui32PendingTrigger[ui8Pending] = ui32Triggers;
+				ui32PendingSample[ui8Pending]  = ui32Samples;
+				ui16PendingDelay[ui8Pending]   = ui16Delay;
+				ui8Pending++;
+			}
+			else
+			{
+				ui32Dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		ui32Samples++;
+
+		/* The oldest pending trigger is complete with its ui16After-th frame */
+		if (ui8Pending > 0 && ui32Samples - ui32PendingSample[0] > Config.ui16After)
+		{
+			if (pushWindow(ui32PendingTrigger[0], ui32PendingSample[0], ui16PendingDelay[0])) {ui16Windows++;}
+
+			ui8Pending--;
+			for (uint8_t j = 0; j < ui8Pending; j++)
+			{
+				ui32PendingTrigger[j] = ui32PendingTrigger[j + 1];
+				ui32PendingSample[j]  = ui32PendingSample[j + 1];
+				ui16PendingDelay[j]   = ui16PendingDelay[j + 1];
+			}
+		}
+	}
+
+	return ui16Windows;
+}
+
+
+/**
+  @brief  Takes the oldest completed window from the queue
+  @retval  1: *pWindow is valid
+           0: No window
+**/
+int16_t FSYNC::getWindow(FSYNC_Window_t *pWindow)
+{
+	uint16_t ui16Index = ui16Tail.load(std::memory_order_relaxed);
+	const FSYNC_Window_t *pSource;
+
+	if (ui16Index == ui16Head.load(std::memory_order_acquire)) {return 0;}
+
+	/* Only the valid frames are copied */
+	pSource = &Queue[ui16Index & (FSYNC_QUEUE_SIZE - 1)];
+	pWindow->ui32Trigger      = pSource->ui32Trigger;
+	pWindow->ui32Sample       = pSource->ui32Sample;
+	pWindow->ui16Delay        = pSource->ui16Delay;
+	pWindow->ui16Frames       = pSource->ui16Frames;
+	pWindow->ui16TriggerIndex = pSource->ui16TriggerIndex;
+	pWindow->ui8Flags         = pSource->ui8Flags;
+
+	for (uint16_t i = 0; i < pSource->ui16Frames; i++)
+	{
+		pWindow->Frames[i] = pSource->Frames[i];
+	}
+
+	ui16Tail.store(ui16Index + 1, std::memory_order_release);
+
+	return 1;
+}
+
+
+/* Triggers since reset() (including dropped ones) */
+uint32_t FSYNC::getTriggers(void)
+{
+	return ui32Triggers;
+}
+
+
+/* Triggers lost because of a full queue or too many pending triggers */
+uint32_t FSYNC::getDropped(void)
+{
+	return ui32Dropped.load(std::memory_order_relaxed);
+}
+
+
+/* Private methods */
+bool FSYNC::pushWindow(uint32_t ui32Trigger, uint32_t ui32Sample, uint16_t ui16Delay)
+{
+	uint16_t ui16Index = ui16Head.load(std::memory_order_relaxed);
+	FSYNC_Window_t *pWindow;
+	uint32_t ui32First;
+
+	if ((uint16_t)(ui16Index - ui16Tail.load(std::memory_order_acquire)) >= FSYNC_QUEUE_SIZE)
+	{
+		ui32Dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	pWindow = &Queue[ui16Index & (FSYNC_QUEUE_SIZE - 1)];
+	pWindow->ui8Flags = 0;
+
+	if (ui32Sample >= Config.ui16Before)
+	{
+		ui32First = ui32Sample - Config.ui16Before;
+	}
+	else
+	{
+		ui32First = 0;
+		pWindow->ui8Flags = FSYNC_WINDOW_TRUNCATED;
+	}
+
+	pWindow->ui32Trigger      = ui32Trigger;
+	pWindow->ui32Sample       = ui32Sample;
+	pWindow->ui16Delay        = ui16Delay;
+	pWindow->ui16Frames       = ui32Sample + Config.ui16After + 1 - ui32First;
+	pWindow->ui16TriggerIndex = ui32Sample - ui32First;
+
+	for (uint16_t i = 0; i < pWindow->ui16Frames; i++)
+	{
+		pWindow->Frames[i].Frame     = History[(ui32First + i) & (FSYNC_MAX_WINDOW - 1)];
+		pWindow->Frames[i].i32Offset = ((int32_t)i - pWindow->ui16TriggerIndex) * (int32_t)Config.ui32SamplePeriod + ui16Delay;
+
+		if (i != pWindow->ui16TriggerIndex && (pWindow->Frames[i].Frame.ui8Flags & ICM20948_FRAME_FSYNC))
+		{
+			pWindow->ui8Flags |= FSYNC_WINDOW_OVERLAP;
+		}
+	}
+
+	ui16Head.store(ui16Index + 1, std::memory_order_release);
+
+	return true;
+}
@@ -0,0 +1,203 @@
+/*
+ * gyrobias.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "gyrobias.hpp"
+#include <cmath>
+
+
+/* GYROBIAS class */
+GYROBIAS::GYROBIAS(ICM20948 *pICM20948, const GYROBIAS_Config_t *pConfig)
+{
+	this->pICM20948 = pICM20948;
+	Config = *pConfig;
+	ui32Updates = 0;
+
+	init();
+}
+
+
+/* Public methods */
+/**
+  @brief  Converts the thresholds for the current full scale settings and starts the estimator at the current
+          gyro offset of the driver. Must be called again after a full scale change or a calibration.
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t GYROBIAS::init(void)
+{
+	ICM20948_SensorConfig_t SensorConfig = pICM20948->getSensorConfig();
+	float fAccelCounts, fGyroCounts, fLimit;
+	uint32_t ui32N2;
+
+	reset();
+
+	ui8Epoch = pICM20948->getConfigEpoch();
+
+	ui64AccelVarLimit = 0;
+	ui64GyroVarLimit  = 0;
+	ui32GyroSumLimit  = 0;
+
+	pICM20948->getGyroOffset(&Offset);
+	i64Bias[0] = -(int64_t)Offset.i16XAxis << 16;
+	i64Bias[1] = -(int64_t)Offset.i16YAxis << 16;
+	i64Bias[2] = -(int64_t)Offset.i16ZAxis << 16;
+
+	if (Config.ui16Window < 2 || Config.ui16Window > GYROBIAS_MAX_WINDOW || Config.ui8EmaShift > 24) {return -1;}
+
+	fAccelCounts = 32768.0f / SensorConfig.AccelFullScale.ui16Range; // Counts per g
+	fGyroCounts  = 32768.0f / SensorConfig.GyroFullScale.ui16Range;  // Counts per dps
+	ui32N2       = (uint32_t)Config.ui16Window * Config.ui16Window;
+
+	fLimit = Config.fAccelStdDev * fAccelCounts;
+	ui64AccelVarLimit = (uint64_t)(fLimit * fLimit) * ui32N2;
+
+	fLimit = Config.fGyroStdDev * fGyroCounts;
+	ui64GyroVarLimit = (uint64_t)(fLimit * fLimit) * ui32N2;
+
+	ui32GyroSumLimit = (uint32_t)(Config.fGyroMaxRate * fGyroCounts * Config.ui16Window);
+
+	return 0;
+}
+
+
+/* Clears the window (the bias estimate is kept) */
+void GYROBIAS::reset(void)
+{
+	ui32AccelSum   = 0;
+	ui32GyroSum    = 0;
+	ui64AccelSumSq = 0;
+	ui64GyroSumSq  = 0;
+	ui16Head       = 0;
+	ui16Fill       = 0;
+
+	ui16Stationary = 0;
+	boStationary   = false;
+}
+
+
+/**
+  @brief  Feeds raw (uncorrected) frames into the detector and the estimator
+  @retval  0: Gyro offset unchanged
+           1: New gyro offset pushed to the driver
+**/
+int16_t GYROBIAS::update(const ICM20948_Frame_t *pFrames, uint16_t ui16Count)
+{
+	ICM20948_i16Vector_t NewOffset;
+	uint16_t ui16Accel, ui16Gyro, ui16Old;
+	uint16_t ui16N = Config.ui16Window;
+	int64_t  i64Raw[3];
+	int16_t  i16RetValue = 0;
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		if (pFrames[i].ui8Epoch != ui8Epoch) {init();}
+
+		if (pFrames[i].ui8Flags & ICM20948_FRAME_TRANSITION)
+		{
+			boStationary   = false;
+			ui16Stationary = 0;
+			continue;
+		}
+
+		ui16Accel = getNorm(pFrames[i].Accel.i16XAxis, pFrames[i].Accel.i16YAxis, pFrames[i].Accel.i16ZAxis);
+		ui16Gyro  = getNorm((int16_t)(pFrames[i].Gyro.i16XAxis + Offset.i16XAxis),
+				            (int16_t)(pFrames[i].Gyro.i16YAxis + Offset.i16YAxis),
+				            (int16_t)(pFrames[i].Gyro.i16ZAxis + Offset.i16ZAxis));
+
+		/* Sliding window: remove the oldest value, add the newest */
+		if (ui16Fill == ui16N)
+		{
+			ui16Old = ui16AccelNorm[ui16Head];
+			ui32AccelSum   -= ui16Old;
+			ui64AccelSumSq -= (uint32_t)ui16Old * ui16Old;
+
+			ui16Old = ui16GyroNorm[ui16Head];
+			ui32GyroSum    -= ui16Old;
+			ui64GyroSumSq  -= (uint32_t)ui16Old * ui16Old;
+		}
+		else {ui16Fill++;}
+
+		ui16AccelNorm[ui16Head] = ui16Accel;
+		ui16GyroNorm[ui16Head]  = ui16Gyro;
+		ui32AccelSum   += ui16Accel;
+		ui64AccelSumSq += (uint32_t)ui16Accel * ui16Accel;
+		ui32GyroSum    += ui16Gyro;
+		ui64GyroSumSq  += (uint32_t)ui16Gyro * ui16Gyro;
+
+		ui16Head = (ui16Head + 1 < ui16N) ? (ui16Head + 1) : 0;
+
+		/* N^2 * variance = N * sum(x^2) - sum(x)^2 */
+		boStationary = (ui16Fill == ui16N)
+				&& (ui16N * ui64AccelSumSq - (uint64_t)ui32AccelSum * ui32AccelSum <= ui64AccelVarLimit)
+				&& (ui16N * ui64GyroSumSq  - (uint64_t)ui32GyroSum  * ui32GyroSum  <= ui64GyroVarLimit)
+				&& (ui32GyroSum <= ui32GyroSumLimit);
+
+		if (!boStationary)
+		{
+			ui16Stationary = 0;
+			continue;
+		}
+
+		i64Raw[0] = (int64_t)pFrames[i].Gyro.i16XAxis << 16;
+		i64Raw[1] = (int64_t)pFrames[i].Gyro.i16YAxis << 16;
+		i64Raw[2] = (int64_t)pFrames[i].Gyro.i16ZAxis << 16;
+
+		for (uint8_t j = 0; j < 3; j++)
+		{
+			i64Bias[j] += (i64Raw[j] - i64Bias[j]) >> Config.ui8EmaShift;
+		}
+
+		if (++ui16Stationary < Config.ui16PushInterval) {continue;}
+		ui16Stationary = 0;
+
+		NewOffset.i16XAxis = -(int16_t)((i64Bias[0] + 0x8000) >> 16);
+		NewOffset.i16YAxis = -(int16_t)((i64Bias[1] + 0x8000) >> 16);
+		NewOffset.i16ZAxis = -(int16_t)((i64Bias[2] + 0x8000) >> 16);
+
+		if (NewOffset.i16XAxis != Offset.i16XAxis || NewOffset.i16YAxis != Offset.i16YAxis
+				|| NewOffset.i16ZAxis != Offset.i16ZAxis)
+		{
+			Offset = NewOffset;
+			pICM20948->setGyroOffset(Offset);
+			ui32Updates++;
+			i16RetValue = 1;
+		}
+	}
+
+	return i16RetValue;
+}
+
+
+bool GYROBIAS::isStationary(void)
+{
+	return boStationary;
+}
+
+
+/* Number of offset updates pushed to the driver */
+uint32_t GYROBIAS::getUpdateCount(void)
+{
+	return ui32Updates;
+}
+
+
+void GYROBIAS::getBiasEstimate(ICM20948_fVector_t *pBias)
+{
+	pBias->fXAxis = i64Bias[0] / 65536.0f;
+	pBias->fYAxis = i64Bias[1] / 65536.0f;
+	pBias->fZAxis = i64Bias[2] / 65536.0f;
+}
+
+
+/* Private methods */
+/* Euclidean norm, max. sqrt(3) * 32768 < 65536 */
+inline uint16_t GYROBIAS::getNorm(int32_t i32X, int32_t i32Y, int32_t i32Z)
+{
+	uint32_t ui32Sq = (uint32_t)(i32X * i32X) + (uint32_t)(i32Y * i32Y) + (uint32_t)(i32Z * i32Z);
+
+	return (uint16_t)std::sqrt((float)ui32Sq);
+}
@@ -7,23 +7,240 @@
 
 #include "icm20948.hpp"
 #include "icm20948reg.hpp"
+#include "checksum.hpp"
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
 
 
 extern "C" uint32_t get_Ticks(void);
 
 
+/* Mounting orientation: the axes must be a permutation, the signs must keep the frame right-handed */
+#define ICM20948_MOUNT_AXIS(Code)   ((Code) & ~ICM20948_AXIS_NEG)
+#define ICM20948_MOUNT_SIGN(Code)   (((Code) & ICM20948_AXIS_NEG) ? -1 : 1)
+
+static_assert(ICM20948_MOUNT_AXIS(ICM20948_MOUNT_X) <= 2 && ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Y) <= 2 &&
+			  ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Z) <= 2, "ICM20948_MOUNT_x must be an ICM20948_AXIS_... value");
+static_assert(ICM20948_MOUNT_AXIS(ICM20948_MOUNT_X) != ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Y) &&
+			  ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Y) != ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Z) &&
+			  ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Z) != ICM20948_MOUNT_AXIS(ICM20948_MOUNT_X),
+			  "Each sensor axis must be used once by ICM20948_MOUNT_x");
+/* Determinant +1: even permutation (Y follows X cyclically) with an even number of negations or vice versa */
+static_assert(((ICM20948_MOUNT_AXIS(ICM20948_MOUNT_Y) + 3 - ICM20948_MOUNT_AXIS(ICM20948_MOUNT_X)) % 3 == 1 ? 1 : -1) *
+			  ICM20948_MOUNT_SIGN(ICM20948_MOUNT_X) * ICM20948_MOUNT_SIGN(ICM20948_MOUNT_Y) *
+			  ICM20948_MOUNT_SIGN(ICM20948_MOUNT_Z) == 1, "ICM20948_MOUNT_x is a reflection, not a rotation");
+
+
+/* Same rules for setMount() */
+static inline bool isValidMount(uint8_t ui8X, uint8_t ui8Y, uint8_t ui8Z)
+{
+	if (ICM20948_MOUNT_AXIS(ui8X) > 2 || ICM20948_MOUNT_AXIS(ui8Y) > 2 || ICM20948_MOUNT_AXIS(ui8Z) > 2) {return false;}
+	if (ICM20948_MOUNT_AXIS(ui8X) == ICM20948_MOUNT_AXIS(ui8Y) || ICM20948_MOUNT_AXIS(ui8Y) == ICM20948_MOUNT_AXIS(ui8Z) ||
+		ICM20948_MOUNT_AXIS(ui8Z) == ICM20948_MOUNT_AXIS(ui8X)) {return false;}
+
+	return (((ICM20948_MOUNT_AXIS(ui8Y) + 3 - ICM20948_MOUNT_AXIS(ui8X)) % 3 == 1) ? 1 : -1) *
+		   ICM20948_MOUNT_SIGN(ui8X) * ICM20948_MOUNT_SIGN(ui8Y) * ICM20948_MOUNT_SIGN(ui8Z) == 1;
+}
+
+
+/* Sensor frame (self-test) */
+static const uint8_t ICM20948_SENSOR_FRAME[3] = {ICM20948_AXIS_PX, ICM20948_AXIS_PY, ICM20948_AXIS_PZ};
+
+
+/* Board axis from big endian sensor data (pData[0...5]), -32768 saturates to 32767 when negated */
+static inline int16_t decodeAxis(const uint8_t *pData, uint8_t ui8Code)
+{
+	const uint8_t ui8Index = ICM20948_MOUNT_AXIS(ui8Code) * 2;
+	int16_t i16Value = (pData[ui8Index] << 8) | pData[ui8Index + 1];
+
+	if ((ui8Code & ICM20948_AXIS_NEG) == 0) {return i16Value;}
+
+	return (i16Value == INT16_MIN) ? INT16_MAX : -i16Value;
+}
+
+
+/* Accelerometer or gyroscope vector, pMount: ICM20948_AXIS_... of the X, Y and Z axes (board or sensor frame) */
+static inline void decodeVector(const uint8_t *pData, const uint8_t *pMount, ICM20948_i16Vector_t *pVector)
+{
+	pVector->i16XAxis = decodeAxis(pData, pMount[0]);
+	pVector->i16YAxis = decodeAxis(pData, pMount[1]);
+	pVector->i16ZAxis = decodeAxis(pData, pMount[2]);
+}
+
+
+/* Contiguous blocks of configuration registers (banks 0...3), read with one burst each.
+ * Bit i of ui32Mask marks register ui8StartAddr + i as compared/restored (reserved registers
+ * and FIFO_RST are skipped). The sum of all lengths is ICM20948_SNAPSHOT_SIZE. */
+typedef struct
+{
+	uint8_t  ui8Bank;
+	uint8_t  ui8StartAddr;
+	uint8_t  ui8Length;
+	uint32_t ui32Mask;
+}ICM20948_RegBlock_t;
+
+static const ICM20948_RegBlock_t ICM20948_REG_BLOCKS[] =
+{
+	{0, ICM20948_USER_CTRL,          5, 0x0000001D}, // USER_CTRL, LP_CONFIG, PWR_MGMT_1, PWR_MGMT_2
+	{0, ICM20948_INT_PIN_CFG,        5, 0x0000001F}, // INT_PIN_CFG, INT_ENABLE...INT_ENABLE_3
+	{0, ICM20948_FIFO_EN_1,          4, 0x0000000B}, // FIFO_EN_1, FIFO_EN_2, FIFO_MODE
+	{0, ICM20948_FIFO_CFG,           1, 0x00000001}, // FIFO_CFG
+	{1, ICM20948_XA_OFFS_H,          8, 0x000000DB}, // XA_OFFS_H/L, YA_OFFS_H/L, ZA_OFFS_H/L
+	{1, ICM20948_TIMEBASE_CORR_PLL,  1, 0x00000001}, // TIMEBASE_CORR_PLL
+	{2, ICM20948_GYRO_SMPLRT_DIV,   22, 0x003F03FF}, // GYRO_SMPLRT_DIV...ODR_ALIGN_EN, ACCEL_SMPLRT_DIV_1...ACCEL_CONFIG_2
+	{2, ICM20948_FSYNC_CONFIG,       3, 0x00000007}, // FSYNC_CONFIG, TEMP_CONFIG, MOD_CTRL_USR
+	{3, ICM20948_I2C_MST_ODR_CFG,   11, 0x000007FF}  // I2C_MST_ODR_CFG...I2C_SLV1_DO
+};
+
+constexpr uint8_t ICM20948_REG_BLOCK_COUNT = sizeof(ICM20948_REG_BLOCKS) / sizeof(ICM20948_RegBlock_t);
+
+typedef struct
+{
+	uint8_t ui8Offset;   // Burst window within ui8DataArray[] (register address - ICM20948_ACCEL_XOUT_H)
+	uint8_t ui8Length;
+	uint8_t ui8PwrMgmt2; // Disabled sensors (PWR_MGMT_2)
+	bool    boTemp;      // Temperature sensor enabled
+}ICM20948_ProfileCfg_t;
+
+/* Indexed by ICM20948_Profile_t */
+static const ICM20948_ProfileCfg_t ICM20948_PROFILES[] =
+{
+	{0, 14, 0x00,                   true },  // ICM20948_PROFILE_FULL
+	{0, 12, 0x00,                   false},  // ICM20948_PROFILE_MOTION
+	{0,  6, ICM20948_DISABLE_GYRO,  false},  // ICM20948_PROFILE_ACCEL
+	{6,  6, ICM20948_DISABLE_ACCEL, false}   // ICM20948_PROFILE_GYRO
+};
+
+/* Index of the LSB that carries the FSYNC status in ui8DataArray[] and in a FIFO frame (ICM20948_FsyncLatch_t, 0xFF: off) */
+static const uint8_t ICM20948_FSYNC_LSB[] = {0xFF, 13, 7, 9, 11, 1, 3, 5};
+
+/* Data of a DMP packet in the order of the header bits (MSB first) */
+typedef struct
+{
+	uint16_t ui16Bit;
+	uint8_t  ui8Length;
+}ICM20948_DmpField_t;
+
+static const ICM20948_DmpField_t ICM20948_DMP_FIELDS[] =
+{
+	{ICM20948_DMP_ACCEL,          6},
+	{ICM20948_DMP_GYRO,          12},
+	{ICM20948_DMP_CPASS,          6},
+	{ICM20948_DMP_ALS,            8},
+	{ICM20948_DMP_QUAT6,         12},
+	{ICM20948_DMP_QUAT9,         14},
+	{ICM20948_DMP_PQUAT6,         6},
+	{ICM20948_DMP_GEOMAG,        14},
+	{ICM20948_DMP_PRESSURE,       6},
+	{ICM20948_DMP_GYRO_CALIBR,   12},
+	{ICM20948_DMP_CPASS_CALIBR,  12},
+	{ICM20948_DMP_STEP_DETECTOR,  4}
+};
+
+static const ICM20948_DmpField_t ICM20948_DMP_FIELDS2[] =
+{
+	{ICM20948_DMP_HDR2_ACCEL_ACCURACY, 2},
+	{ICM20948_DMP_HDR2_GYRO_ACCURACY,  2},
+	{ICM20948_DMP_HDR2_CPASS_ACCURACY, 2},
+	{ICM20948_DMP_HDR2_FSYNC,          2},
+	{ICM20948_DMP_HDR2_PICKUP,         2},
+	{ICM20948_DMP_HDR2_BATCH_MODE,     0},
+	{ICM20948_DMP_HDR2_ACT_RECOG,      6},
+	{ICM20948_DMP_HDR2_SECONDARY,      2}
+};
+
+/* All other header bits are undefined, a packet stream that contains them is out of sync */
+constexpr uint16_t ICM20948_DMP_HEADER_MASK  {0xFFF8};
+constexpr uint16_t ICM20948_DMP_HEADER2_MASK {0x7DC0};
+
+/* Outputs of enableDmp() (the compass based outputs need the I2C master and a magnetometer) */
+constexpr uint16_t ICM20948_DMP_SUPPORTED    {ICM20948_DMP_ACCEL | ICM20948_DMP_GYRO | ICM20948_DMP_QUAT6 |
+                                              ICM20948_DMP_PQUAT6 | ICM20948_DMP_GYRO_CALIBR};
+
+/* The remaining bytes of a packet always fit into the buffer */
+static_assert(ICM20948_DMP_BUFFER_SIZE > ICM20948_DMP_MAX_PACKET, "ICM20948_DMP_BUFFER_SIZE is too small");
+
+/* A self-test window must fit into the FIFO */
+static_assert(ICM20948_ST_SAMPLES * ICM20948_FIFO_FRAME_SIZE <= ICM20948_FIFO_SIZE, "ICM20948_ST_SAMPLES is too large");
+
+/* Index arithmetic of the gap log (uint8_t head) */
+static_assert((ICM20948_GAP_LOG_SIZE & (ICM20948_GAP_LOG_SIZE - 1)) == 0 && ICM20948_GAP_LOG_SIZE <= 128,
+		"ICM20948_GAP_LOG_SIZE must be a power of two <= 128");
+
+/* readFifoFrames() decodes in place */
+static_assert(sizeof(ICM20948_Frame_t) >= ICM20948_FIFO_FRAME_SIZE, "ICM20948_Frame_t is smaller than a FIFO frame");
+
+
 /* ICM20948 class */
-ICM20948::ICM20948(SPI *pSPI, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
-		           ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF)
+ICM20948::ICM20948(ICM20948_Port_t *pPort, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+		           ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF) : Bus(pPort), ui32GyroOffsetSequence(0), ui32GyroOffsetXY(0), ui32GyroOffsetZ(0),
+				   ui32GyroOffsetLastXY(0), ui32GyroOffsetLastZ(0)
 {
-	this->pSPI = pSPI;
+	ICM20948_SensorConfig.boUseSPI = ICM20948_Bus_t::boSPI;
+	boWarmStart = false;
+	ui8Mount[0] = ICM20948_MOUNT_X;
+	ui8Mount[1] = ICM20948_MOUNT_Y;
+	ui8Mount[2] = ICM20948_MOUNT_Z;
+
+	init(ACCEL_FS, GYRO_FS, ACCEL_SR, GYRO_SR, DLPF);
+}
 
-	ICM20948_SensorConfig.boUseSPI = true;
+
+/* Constructor for a restart of the MCU only (watchdog, brown-out): if the snapshot is valid and was taken
+ * with the same configuration, the sensor is not reset, otherwise the normal initialization is executed. */
+ICM20948::ICM20948(ICM20948_Port_t *pPort, ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+		           ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF,
+				   const ICM20948_RegSnapshot_t *pSnapshot) : Bus(pPort), ui32GyroOffsetSequence(0), ui32GyroOffsetXY(0), ui32GyroOffsetZ(0),
+				   ui32GyroOffsetLastXY(0), ui32GyroOffsetLastZ(0)
+{
+	ICM20948_SensorConfig.boUseSPI = ICM20948_Bus_t::boSPI;
+	boWarmStart = false;
+	ui8Mount[0] = ICM20948_MOUNT_X;
+	ui8Mount[1] = ICM20948_MOUNT_Y;
+	ui8Mount[2] = ICM20948_MOUNT_Z;
+
+	if (pSnapshot != NULL &&
+		IS_VALID_FULL_SCALE(pSnapshot->SensorConfig.AccelFullScale, ACCEL_FS) &&
+		IS_VALID_FULL_SCALE(pSnapshot->SensorConfig.GyroFullScale, GYRO_FS) &&
+		IS_VALID_ACCEL_SAMPLE_RATE(pSnapshot->SensorConfig.AccelSampleRate, ACCEL_SR) &&
+		IS_VALID_GYRO_SAMPLE_RATE(pSnapshot->SensorConfig.GyroSampleRate, GYRO_SR) &&
+		pSnapshot->SensorConfig.AccelDLPF == DLPF && pSnapshot->SensorConfig.GyroDLPF == DLPF)
+	{
+		if (warmInit(pSnapshot) == ICM20948_RET_OK)
+		{
+			boWarmStart = true;
+			return;
+		}
+	}
 
 	init(ACCEL_FS, GYRO_FS, ACCEL_SR, GYRO_SR, DLPF);
 }
 
 
+/* Constructor without initialization, the sensor is not accessed before ICM20948_ASYNC::init() */
+ICM20948::ICM20948(ICM20948_Port_t *pPort) : Bus(pPort), ui32GyroOffsetSequence(0), ui32GyroOffsetXY(0), ui32GyroOffsetZ(0),
+				   ui32GyroOffsetLastXY(0), ui32GyroOffsetLastZ(0)
+{
+	ICM20948_SensorConfig.boUseSPI   = ICM20948_Bus_t::boSPI;
+	ICM20948_SensorConfig.boStatusOK = false;
+	ui8Mount[0]     = ICM20948_MOUNT_X;
+	ui8Mount[1]     = ICM20948_MOUNT_Y;
+	ui8Mount[2]     = ICM20948_MOUNT_Z;
+	boWarmStart     = false;
+	boShadowValid   = false;
+	boLatestReady   = false;
+	boDmpLoaded     = false;
+	ui32TrackHz     = 0;
+	ui8SelfTestStep = 0;
+}
+
+
+ICM20948::~ICM20948(void)
+{
+}
+
+
 /* Public methods */
 ICM20948_SensorConfig_t ICM20948::getSensorConfig(void)
 {
@@ -53,8 +270,11 @@ int16_t ICM20948::setAccelFullScale(ICM20948_FullScale_t FullScale)
 	/* Check argument FullScale */
 	if (!isValidAccelFullScale(FullScale)) {return -1;}
 
-	if (changeRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_FS_SEL, FullScale.ui8Selection) != 0) {return -1;}
+	if (beginEpoch() != 0) {return -1;}
+
+	if (changeShadowRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_FS_SEL, FullScale.ui8Selection, &ui8AccelConfig) != 0) {return -1;}
 	ICM20948_SensorConfig.AccelFullScale = FullScale;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -65,6 +285,7 @@ int16_t ICM20948::getAccelFullScale(ICM20948_FullScale_t *FullScale)
 	uint8_t ui8Data;
 
 	if (readRegister8(2, ICM20948_ACCEL_CONFIG, &ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 	ui8Data &= ICM20948_ACCEL_FS_SEL;
 
 	if      (ui8Data == ACCEL_FS_2G.ui8Selection) {*FullScale = ACCEL_FS_2G;}
@@ -81,8 +302,11 @@ int16_t ICM20948::setGyroFullScale(ICM20948_FullScale_t FullScale)
 	/* Check argument FullScale */
 	if (!isValidGyroFullScale(FullScale)) {return -1;}
 
-	if (changeRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_FS_SEL, FullScale.ui8Selection) != 0) {return -1;}
+	if (beginEpoch() != 0) {return -1;}
+
+	if (changeShadowRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_FS_SEL, FullScale.ui8Selection, &ui8GyroConfig1) != 0) {return -1;}
 	ICM20948_SensorConfig.GyroFullScale = FullScale;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -93,6 +317,7 @@ int16_t ICM20948::getGyroFullScale(ICM20948_FullScale_t *FullScale)
 	uint8_t ui8Data;
 
 	if (readRegister8(2, ICM20948_GYRO_CONFIG_1, &ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 	ui8Data &= ICM20948_GYRO_FS_SEL;
 
 	if      (ui8Data == GYRO_FS_250DPS.ui8Selection)  {*FullScale = GYRO_FS_250DPS;}
@@ -109,11 +334,16 @@ int16_t ICM20948::setAccelSampleRate(ICM20948_AccelSampleRate_t SampleRate)
 	/* Check argument SampleRate */
 	if (!isValidAccelSampleRate(SampleRate)) {return -1;}
 
+	/* The FIFO frames interleave both sensors one to one */
+	if (ICM20948_SensorConfig.boFifoEnabled && !isEqualSampleRate(SampleRate, ICM20948_SensorConfig.GyroSampleRate)) {return -1;}
+
+	if (beginEpoch() != 0) {return -1;}
+
 	if (writeRegister16(2, ICM20948_ACCEL_SMPLRT_DIV_1, SampleRate.ui16Div) != 0) {return -1;}
 
 	/* Sample rate <= 1125Hz --> DLPF is enabled  (FCHOICE = true)
 	 * Sample rate  = 4500Hz --> DLPF is disabled (FCHOICE = false) */
-	if (changeRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_FCHOICE, (uint8_t)SampleRate.boFCHOICE) != 0) {return -1;}
+	if (changeShadowRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_FCHOICE, (uint8_t)SampleRate.boFCHOICE, &ui8AccelConfig) != 0) {return -1;}
 
 //	if (SampleRate.boFCHOICE)
 //	{
@@ -127,6 +357,7 @@ int16_t ICM20948::setAccelSampleRate(ICM20948_AccelSampleRate_t SampleRate)
 //	}
 
 	ICM20948_SensorConfig.AccelSampleRate = SampleRate;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -141,6 +372,7 @@ int16_t ICM20948::getAccelSampleRate(ICM20948_AccelSampleRate_t *SampleRate)
 
 	if (readRegister16(2, ICM20948_ACCEL_SMPLRT_DIV_1, &ui16Div) != 0) {return -1;}
 	if (readRegister8(2, ICM20948_ACCEL_CONFIG, &ui8Aux) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 
 	if (ui8Aux & ICM20948_ACCEL_FCHOICE) {boFCHOICE = true;}
 
@@ -178,11 +410,16 @@ int16_t ICM20948::setGyroSampleRate(ICM20948_GyroSampleRate_t SampleRate)
 	/* Check argument SampleRate */
 	if (!isValidGyroSampleRate(SampleRate)) {return -1;}
 
+	/* The FIFO frames interleave both sensors one to one */
+	if (ICM20948_SensorConfig.boFifoEnabled && !isEqualSampleRate(ICM20948_SensorConfig.AccelSampleRate, SampleRate)) {return -1;}
+
+	if (beginEpoch() != 0) {return -1;}
+
 	if (writeRegister8(2, ICM20948_GYRO_SMPLRT_DIV, SampleRate.ui8Div) != 0) {return -1;}
 
 	/* Sample rate <= 1125Hz --> DLPF is enabled  (FCHOICE = true)
 	 * Sample rate  = 4500Hz --> DLPF is disabled (FCHOICE = false) */
-	if (changeRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_FCHOICE, (uint8_t)SampleRate.boFCHOICE) != 0) {return -1;}
+	if (changeShadowRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_FCHOICE, (uint8_t)SampleRate.boFCHOICE, &ui8GyroConfig1) != 0) {return -1;}
 
 //	if (SampleRate.boFCHOICE)
 //	{
@@ -196,6 +433,7 @@ int16_t ICM20948::setGyroSampleRate(ICM20948_GyroSampleRate_t SampleRate)
 //	}
 
 	ICM20948_SensorConfig.GyroSampleRate = SampleRate;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -210,6 +448,7 @@ int16_t ICM20948::getGyroSampleRate(ICM20948_GyroSampleRate_t *SampleRate)
 
 	if (readRegister8(2, ICM20948_GYRO_SMPLRT_DIV, &ui8Div) != 0) {return -1;}
 	if (readRegister8(2, ICM20948_GYRO_CONFIG_1, &ui8Aux) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 
 	if (ui8Aux & ICM20948_GYRO_FCHOICE) {boFCHOICE = true;}
 
@@ -247,8 +486,11 @@ int16_t ICM20948::setAccelDLPF(ICM20948_DLPF_t DLPF)
 	/* Check argument DLPF */
 	if (!isValidDLPF(DLPF)) {return -1;}
 
-	if (changeRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_DLPFCFG, DLPF) != 0) {return -1;}
+	if (beginEpoch() != 0) {return -1;}
+
+	if (changeShadowRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_ACCEL_DLPFCFG, DLPF, &ui8AccelConfig) != 0) {return -1;}
 	ICM20948_SensorConfig.AccelDLPF = DLPF;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -259,6 +501,7 @@ int16_t ICM20948::getAccelDLPF(ICM20948_DLPF_t *pDLPF)
 	uint8_t ui8Data;
 
 	if (readRegister8(2, ICM20948_ACCEL_CONFIG, &ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 	ui8Data &= ICM20948_ACCEL_DLPFCFG;
 
 	if      (ui8Data == ICM20948_DLPF_0) {*pDLPF = ICM20948_DLPF_0;}
@@ -279,8 +522,11 @@ int16_t ICM20948::setGyroDLPF(ICM20948_DLPF_t DLPF)
 	/* Check argument DLPF */
 	if (!isValidDLPF(DLPF)) {return -1;}
 
-	if (changeRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_DLPFCFG, DLPF) != 0) {return -1;}
+	if (beginEpoch() != 0) {return -1;}
+
+	if (changeShadowRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_GYRO_DLPFCFG, DLPF, &ui8GyroConfig1) != 0) {return -1;}
 	ICM20948_SensorConfig.GyroDLPF = DLPF;
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
@@ -291,6 +537,7 @@ int16_t ICM20948::getGyroDLPF(ICM20948_DLPF_t *pDLPF)
 	uint8_t ui8Data;
 
 	if (readRegister8(2, ICM20948_GYRO_CONFIG_1, &ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 	ui8Data &= ICM20948_GYRO_DLPFCFG;
 
 	if      (ui8Data == ICM20948_DLPF_0) {*pDLPF = ICM20948_DLPF_0;}
@@ -330,11 +577,14 @@ void ICM20948::resetAccelOffset(void)
 }
 
 
+/* Takes effect atomically for the sample path (all three axes of a sample use the same offset) */
 void ICM20948::setGyroOffset(ICM20948_i16Vector_t Offset)
 {
 	GyroOffset.i16XAxis = Offset.i16XAxis;
 	GyroOffset.i16YAxis = Offset.i16YAxis;
 	GyroOffset.i16ZAxis = Offset.i16ZAxis;
+
+	publishGyroOffset();
 }
 
 
@@ -351,388 +601,2311 @@ void ICM20948::resetGyroOffset(void)
 	GyroOffset.i16XAxis = 0x0000;
 	GyroOffset.i16YAxis = 0x0000;
 	GyroOffset.i16ZAxis = 0x0000;
-}
-
-
-int16_t ICM20948::readAllDataRaw(void)
-{
-	/* Byte includes R/W-bit (read = 1) and 7-bit memory/register address */
-	uint8_t ui8Data = 0x80 | ICM20948_ACCEL_XOUT_H;
-
-	if (switchBank(0) != 0) {return -1;}
-
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(&ui8Data, 1) != 0)     {pSPI->disableNSS(); return -1;}
-	if (pSPI->receiveSPI(ui8DataArray, 14) != 0) {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
 
-	//if (pSPI->readBurst(ICM20948_ACCEL_XOUT_H, 14, ui8DataArray) != 0) {return -1;}
-
-	return 0;
+	publishGyroOffset();
 }
 
 
-ICM20948_i16Vector_t ICM20948::getAccelRaw(void)
+/* Adds the gyro offset to decoded frames. The offset is loaded once, so a batch is never mixed across an
+ * offset update. */
+void ICM20948::correctGyro(ICM20948_Frame_t *pFrames, uint16_t ui16Count)
 {
-	ICM20948_i16Vector_t AccelRaw;
+	const ICM20948_i16Vector_t Offset = loadGyroOffset();
 
-	AccelRaw.i16XAxis = (ui8DataArray[0] << 8) | ui8DataArray[1];
-	AccelRaw.i16YAxis = (ui8DataArray[2] << 8) | ui8DataArray[3];
-	AccelRaw.i16ZAxis = (ui8DataArray[4] << 8) | ui8DataArray[5];
-
-	return AccelRaw;
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		pFrames[i].Gyro.i16XAxis += Offset.i16XAxis;
+		pFrames[i].Gyro.i16YAxis += Offset.i16YAxis;
+		pFrames[i].Gyro.i16ZAxis += Offset.i16ZAxis;
+	}
 }
 
 
-ICM20948_i16Vector_t ICM20948::getCorrectedAccelRaw(void)
+int16_t ICM20948::readAllDataRaw(void)
 {
-	ICM20948_i16Vector_t CorrectedAccelRaw;
+	uint8_t  ui8Buffer[ICM20948_ACCEL_XOUT_H - ICM20948_INT_STATUS_1 + 14];
+	uint8_t  ui8Start = ICM20948_DELAY_TIMEH; // First register of the burst
+	uint8_t  ui8DataStart;                    // Index of ACCEL_XOUT_H in ui8Buffer[]
+	uint32_t ui32Time = 0;
 
-	CorrectedAccelRaw.i16XAxis = ((ui8DataArray[0] << 8) | ui8DataArray[1]) + AccelOffset.i16XAxis;
-	CorrectedAccelRaw.i16YAxis = ((ui8DataArray[2] << 8) | ui8DataArray[3]) + AccelOffset.i16YAxis;
-	CorrectedAccelRaw.i16ZAxis = ((ui8DataArray[4] << 8) | ui8DataArray[5]) + AccelOffset.i16ZAxis;
+	boDataRepeated = false;
 
-	return CorrectedAccelRaw;
-}
+	if (ICM20948_SensorConfig.Fsync == ICM20948_FSYNC_OFF && ui32TrackHz == 0)
+	{
+		if (readBurst(0, ICM20948_ACCEL_XOUT_H + ui8BurstOffset, &ui8DataArray[ui8BurstOffset], ui8BurstLength,
+				ICM20948_SPEED_BURST) != 0) {return -1;}
+	}
+	else
+	{
+		/* The status (continuity tracking) and DELAY_TIMEH/L (FSYNC) precede the sensor data, the same burst reads all */
+		if (ui32TrackHz != 0) {ui8Start = ICM20948_INT_STATUS_1;}
+		ui8DataStart = ICM20948_ACCEL_XOUT_H - ui8Start;
 
+		if (ui32TrackHz != 0) {ui32Time = pTrackTimestamp();}
 
-ICM20948_i16Vector_t ICM20948::getGyroRaw(void)
-{
-	ICM20948_i16Vector_t GyroRaw;
+		if (readBurst(0, ui8Start, ui8Buffer, ui8DataStart + ui8BurstOffset + ui8BurstLength,
+				ICM20948_SPEED_BURST) != 0) {return -1;}
 
-	GyroRaw.i16XAxis = (ui8DataArray[ 6] << 8) | ui8DataArray[ 7];
-	GyroRaw.i16YAxis = (ui8DataArray[ 8] << 8) | ui8DataArray[ 9];
-	GyroRaw.i16ZAxis = (ui8DataArray[10] << 8) | ui8DataArray[11];
+		if (ui32TrackHz != 0)
+		{
+			checkOverflow(ui32Time, ui8Buffer[ICM20948_INT_STATUS_2 - ICM20948_INT_STATUS_1]);
+
+			/* A cleared status alone is no duplicate: readLatest() or a status read may have cleared it */
+			boDataRepeated = (ui8Buffer[0] & ICM20948_RAW_DATA_0_RDY_INT) == 0 &&
+					         memcmp(&ui8DataArray[ui8BurstOffset], &ui8Buffer[ui8DataStart + ui8BurstOffset], ui8BurstLength) == 0;
+
+			if (boDataRepeated)
+			{
+				ContinuityStats.ui32Duplicates++;
+				logGap(ui32Time, ICM20948_GAP_DUPLICATE, 1);
+			}
+			else
+			{
+				checkContinuity(ui32Time, 1, 0);
+			}
+		}
 
-	return GyroRaw;
-}
+		memcpy(&ui8DataArray[ui8BurstOffset], &ui8Buffer[ui8DataStart + ui8BurstOffset], ui8BurstLength);
+	}
 
+	ui8DataEpoch = ui8Epoch;
+	ui8DataFlags = 0;
 
-ICM20948_i16Vector_t ICM20948::getCorrectedGyroRaw(void)
-{
-	ICM20948_i16Vector_t CorrectedGyroRaw;
+	if (ui8RegisterSettle > 0)
+	{
+		ui8RegisterSettle--;
+		ui8DataFlags = ICM20948_FRAME_TRANSITION;
+	}
 
-	CorrectedGyroRaw.i16XAxis = ((ui8DataArray[ 6] << 8) | ui8DataArray[ 7]) + GyroOffset.i16XAxis;
-	CorrectedGyroRaw.i16YAxis = ((ui8DataArray[ 8] << 8) | ui8DataArray[ 9]) + GyroOffset.i16YAxis;
-	CorrectedGyroRaw.i16ZAxis = ((ui8DataArray[10] << 8) | ui8DataArray[11]) + GyroOffset.i16ZAxis;
+	if (ICM20948_SensorConfig.Fsync != ICM20948_FSYNC_OFF && latchFsync(ui8DataArray, 14) != 0)
+	{
+		ui8DataFlags  |= ICM20948_FRAME_FSYNC;
+		ui16FsyncDelay = (ui8Buffer[ICM20948_DELAY_TIMEH - ui8Start] << 8) | ui8Buffer[ICM20948_DELAY_TIMEL - ui8Start];
+	}
 
-	return CorrectedGyroRaw;
+	return 0;
 }
 
 
-int16_t ICM20948::calculateMeanValues(void)
+/**
+  @brief  Selects the burst window of readAllDataRaw() and powers down the sensors that are not used.
+          The data of disabled sensors reads as 0. The FIFO stores accelerometer and gyroscope data,
+          therefore ICM20948_PROFILE_ACCEL and ICM20948_PROFILE_GYRO are rejected while the FIFO is enabled
+          (the same applies to the DMP). A profile whose window does not contain the FSYNC latch register
+          (setupFsync()) is rejected as well.
+  @retval  0: OK
+          -1: Invalid profile, profile not possible with the FIFO, DMP or FSYNC configuration, or bus error
+**/
+int16_t ICM20948::setAcquisitionProfile(ICM20948_Profile_t Profile)
 {
-	ICM20948_i16Vector_t CorrectedAccelRaw; // Corrected raw measurement data from accelerometer
-	ICM20948_i16Vector_t CorrectedGyroRaw;  // Corrected raw measurement data from gyroscope
-
-	ICM20948_i32Vector_t CorrectedAccelRawSum;
-	ICM20948_i32Vector_t CorrectedGyroRawSum;
-
-	uint32_t ui32Ticks;
+	const ICM20948_ProfileCfg_t *pCfg;
 
-	/* Initialization */
-	CorrectedAccelRawSum.i32XAxis = 0;
-	CorrectedAccelRawSum.i32YAxis = 0;
-	CorrectedAccelRawSum.i32ZAxis = 0;
-	CorrectedGyroRawSum.i32XAxis  = 0;
-	CorrectedGyroRawSum.i32YAxis  = 0;
-	CorrectedGyroRawSum.i32ZAxis  = 0;
+	if ((uint8_t)Profile >= sizeof(ICM20948_PROFILES) / sizeof(ICM20948_ProfileCfg_t)) {return -1;}
+	if ((ICM20948_SensorConfig.boFifoEnabled || ICM20948_SensorConfig.boDmpEnabled) &&
+		Profile != ICM20948_PROFILE_FULL && Profile != ICM20948_PROFILE_MOTION) {return -1;}
 
-	ui32Ticks = get_Ticks();
+	/* The FSYNC status would no longer be read */
+	if (!isFsyncInWindow(ICM20948_SensorConfig.Fsync, Profile)) {return -1;}
 
-	while(get_Ticks() < (ui32Ticks + 1));
-	ui32Ticks = get_Ticks(); // Update ticks
+	pCfg = &ICM20948_PROFILES[Profile];
 
-	for (uint16_t i = 0; i < 100 + SAMPLES_MEAN_VALUE; i++)
-	{
-		if (readAllDataRaw() != 0) {return -1;}
+	if (beginEpoch() != 0) {return -1;}
 
-		if (i >= 100)
-		{
-			CorrectedAccelRaw = getCorrectedAccelRaw();
-			CorrectedGyroRaw  = getCorrectedGyroRaw();
-
-			CorrectedAccelRawSum.i32XAxis += CorrectedAccelRaw.i16XAxis;
-			CorrectedAccelRawSum.i32YAxis += CorrectedAccelRaw.i16YAxis;
-			CorrectedAccelRawSum.i32ZAxis += CorrectedAccelRaw.i16ZAxis;
-			CorrectedGyroRawSum.i32XAxis  += CorrectedGyroRaw.i16XAxis;
-			CorrectedGyroRawSum.i32YAxis  += CorrectedGyroRaw.i16YAxis;
-			CorrectedGyroRawSum.i32ZAxis  += CorrectedGyroRaw.i16ZAxis;
-		}
+	if (changeRegister8(0, ICM20948_PWR_MGMT_2, ICM20948_DISABLE_ACCEL | ICM20948_DISABLE_GYRO, pCfg->ui8PwrMgmt2) != 0) {return -1;}
+	if (changeRegister8(0, ICM20948_PWR_MGMT_1, ICM20948_TEMP_DIS, pCfg->boTemp ? 0x00 : ICM20948_TEMP_DIS) != 0) {return -1;}
 
-		/* We need a delay of 1ms to get a process sample rate of 1000Hz
-		 * (both accelerometer and gyroscope sample rate must be 1125Hz) */
-		while(get_Ticks() < (ui32Ticks + 1));
-		ui32Ticks = get_Ticks(); // Update ticks
-	}
+	ICM20948_SensorConfig.Profile = Profile;
+	setBurstWindow();
 
-	CorrectedAccelMean.i16XAxis = CorrectedAccelRawSum.i32XAxis / SAMPLES_MEAN_VALUE;
-	CorrectedAccelMean.i16YAxis = CorrectedAccelRawSum.i32YAxis / SAMPLES_MEAN_VALUE;
-	CorrectedAccelMean.i16ZAxis = CorrectedAccelRawSum.i32ZAxis / SAMPLES_MEAN_VALUE;
-	CorrectedGyroMean.i16XAxis  = CorrectedGyroRawSum.i32XAxis  / SAMPLES_MEAN_VALUE;
-	CorrectedGyroMean.i16YAxis  = CorrectedGyroRawSum.i32YAxis  / SAMPLES_MEAN_VALUE;
-	CorrectedGyroMean.i16ZAxis  = CorrectedGyroRawSum.i32ZAxis  / SAMPLES_MEAN_VALUE;
+	/* Sensors that were switched on need their start-up time, these samples are marked as transitional */
+	if (commitEpoch() != 0) {return -1;}
 
 	return 0;
 }
 
 
-int16_t ICM20948::exeCalibration(void)
+/**
+  @brief  Configures the FSYNC input (frame sync pulse of a camera or LiDAR). The sensor latches an FSYNC edge
+          into the LSB of the selected output register of the next sample: readAllDataRaw(), readLatest() and
+          readFifoFrames() mark this frame with ICM20948_FRAME_FSYNC and clear the LSB. DELAY_TIME measures the
+          time from the edge to this sample, see getFsyncDelay().
+  @param  Latch: Output register of the FSYNC status, it must be in the burst window of the acquisition profile
+                 (ICM20948_FSYNC_TEMP: register reads only), ICM20948_FSYNC_OFF disables FSYNC
+  @param  boActiveLow: FSYNC is active low (ACTL_FSYNC)
+  @retval  0: OK
+          -1: Invalid latch, latch outside the burst window or bus error
+**/
+int16_t ICM20948::setupFsync(ICM20948_FsyncLatch_t Latch, bool boActiveLow)
 {
-	int16_t i16Aux;
+	uint8_t ui8Data;
 
-	uint8_t ui8Ready; /* Variable counts the calibrated sensor axes
-	                     (its value is 6 if all accelerometer and gyroscope axes are calibrated) */
+	if (Latch > ICM20948_FSYNC_ACCEL_Z) {return -1;}
+	if (!isFsyncInWindow(Latch, ICM20948_SensorConfig.Profile)) {return -1;}
 
-	uint32_t ui32Debug;
+	if (readRegister8(0, ICM20948_INT_PIN_CFG, &ui8Data) != 0) {return -1;}
+	if (boActiveLow) {ui8Data |= ICM20948_ACTL_FSYNC;}
+	else             {ui8Data &= ~ICM20948_ACTL_FSYNC;}
+	if (writeRegister8(0, ICM20948_INT_PIN_CFG, ui8Data) != 0) {return -1;}
 
-	if      (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_2G.ui8Selection) {i16Aux = 16384;}
-	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_4G.ui8Selection) {i16Aux =  8192;}
-	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_8G.ui8Selection) {i16Aux =  4096;}
-	else                                                                                    {i16Aux =  2048;}
+	ui8Data = (Latch == ICM20948_FSYNC_OFF) ? 0x00 : (ICM20948_DELAY_TIME_EN | (Latch & ICM20948_EXT_SYNC_SET));
+	if (writeRegister8(2, ICM20948_FSYNC_CONFIG, ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
 
-	/* Calculate the CorrectedAccelMean and CorrectedGyroMean values */
-	if (calculateMeanValues() != 0) {return -1;}
+	ICM20948_SensorConfig.Fsync = Latch;
+	ui16FsyncDelay = 0;
 
-	/* Calculate the new AccelOffset and GyroOffset values which are used in the first iteration (i = 0) */
-	AccelOffset.i16XAxis = -CorrectedAccelMean.i16XAxis / i16AccelPrec;
-	AccelOffset.i16YAxis = -CorrectedAccelMean.i16YAxis / i16AccelPrec;
-	AccelOffset.i16ZAxis = (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;
-	GyroOffset.i16XAxis  = -CorrectedGyroMean.i16XAxis / i16GyroPrec;
-	GyroOffset.i16YAxis  = -CorrectedGyroMean.i16YAxis / i16GyroPrec;
-	GyroOffset.i16ZAxis  = -CorrectedGyroMean.i16ZAxis / i16GyroPrec;
+	return 0;
+}
 
-	for (uint8_t i = 0; i < MAX_ITERATIONS; i++)
-	{
-		ui8Ready = 0;
 
-		if (calculateMeanValues() != 0) {return -1;}
+/* Delay [us] from the last FSYNC edge to the frame marked with ICM20948_FRAME_FSYNC (captured with this frame,
+ * with the FIFO it belongs to the last marked frame of the last readFifoFrames()) */
+uint16_t ICM20948::getFsyncDelay(void)
+{
+	return ui16FsyncDelay;
+}
 
-		if (abs(CorrectedAccelMean.i16XAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16XAxis = AccelOffset.i16XAxis - CorrectedAccelMean.i16XAxis / i16AccelPrec;}
+/**
+  @brief  Multi-rate mode of readLatest() for different accelerometer and gyroscope sample rates. ODR_ALIGN_EN
+          aligns the start of both sample clocks to the write of the sample rate dividers. The slower sensor
+          samples with every ui8RateRatio-th tick of the faster one: readLatest() reads it only then (a shorter
+          burst otherwise) and marks the frames with ICM20948_FRAME_ACCEL_FRESH / ICM20948_FRAME_GYRO_FRESH.
+          The frames are merged on the clock of the faster sensor, getSampleTick() numbers them. Separate streams
+          are the frames with the respective flag, the time of a sample is tick * period of the faster sensor.
+          Any later configuration change ends the mode.
+  @param  AccelSR, GyroSR: Sample rates with DLPF (<= 1125Hz), the slower period must be a multiple of the faster one
+  @param  ui32Period: Period of the faster sensor in units of the time base of setupLatest(). If it is not 0,
+                      samples missed by late calls are counted in the ticks (the time base must resolve it)
+  @retval  0: OK
+          -1: setupLatest() not called, FIFO or DMP enabled, a sensor is off (acquisition profile),
+              invalid rates or bus error
+**/
+int16_t ICM20948::setupMultiRate(ICM20948_AccelSampleRate_t AccelSR, ICM20948_GyroSampleRate_t GyroSR, uint32_t ui32Period)
+{
+	uint8_t  ui8Data;
+	uint16_t ui16AccelPeriod, ui16GyroPeriod;
+
+	if (!boLatestReady || ICM20948_SensorConfig.boFifoEnabled || ICM20948_SensorConfig.boDmpEnabled) {return -1;}
+	if (ICM20948_SensorConfig.Profile != ICM20948_PROFILE_FULL &&
+		ICM20948_SensorConfig.Profile != ICM20948_PROFILE_MOTION) {return -1;}
+	if (!AccelSR.boFCHOICE || !GyroSR.boFCHOICE) {return -1;}
+
+	/* Periods in ticks of the 1125Hz base clock */
+	ui16AccelPeriod = AccelSR.ui16Div + 1;
+	ui16GyroPeriod  = GyroSR.ui8Div + 1;
+	if (ui16AccelPeriod % ui16GyroPeriod != 0 && ui16GyroPeriod % ui16AccelPeriod != 0) {return -1;}
+
+	/* Both dividers are written after ODR_ALIGN_EN (the accelerometer last, this aligns both clocks) */
+	if (writeRegister8(2, ICM20948_ODR_ALIGN_EN, ICM20948_ODR_ALIGN) != 0) {return -1;}
+	if (setGyroSampleRate(GyroSR) != 0) {return -1;}
+	if (setAccelSampleRate(AccelSR) != 0) {return -1;}
+
+	/* Clear a data ready status from before the alignment */
+	if (readRegister8(0, ICM20948_INT_STATUS_1, &ui8Data) != 0) {return -1;}
+
+	boAccelSlow = ui16AccelPeriod >= ui16GyroPeriod;
+	ui8RateRatio = boAccelSlow ? (ui16AccelPeriod / ui16GyroPeriod) : (ui16GyroPeriod / ui16AccelPeriod);
+	ui32RateTick   = 0;
+	ui32RateTime   = 0;
+	ui32SlowSlot   = 0;
+	ui32TickPeriod = ui32Period;
+
+	return 0;
+}
 
-		if (abs(CorrectedAccelMean.i16YAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16YAxis = AccelOffset.i16YAxis - CorrectedAccelMean.i16YAxis / i16AccelPrec;}
 
-		if (abs(i16Aux - CorrectedAccelMean.i16ZAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16ZAxis = AccelOffset.i16ZAxis + (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;}
+/* Tick of the faster sensor of the last new sample of readLatest() in multi-rate mode */
+uint32_t ICM20948::getSampleTick(void)
+{
+	return ui32RateTick;
+}
+
 
-		if (abs(CorrectedGyroMean.i16XAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16XAxis = GyroOffset.i16XAxis - CorrectedGyroMean.i16XAxis / i16GyroPrec;}
+/**
+  @brief  Prepares readLatest(): enables the data ready status (RAW_DATA_0_RDY_EN, the INT pin signals it as
+          well), clears a pending status and resets the statistics
+  @param  pTimestamp: Time base of the sample age and the statistics, e.g. a cycle counter (NULL: get_Ticks())
+  @retval  0: OK
+          -1: Bus error
+**/
+int16_t ICM20948::setupLatest(uint32_t (*pTimestamp)(void))
+{
+	uint8_t ui8Data;
 
-		if (abs(CorrectedGyroMean.i16YAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16YAxis = GyroOffset.i16YAxis - CorrectedGyroMean.i16YAxis / i16GyroPrec;}
+	boLatestReady = false;
 
-		if (abs(CorrectedGyroMean.i16ZAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16ZAxis = GyroOffset.i16ZAxis - CorrectedGyroMean.i16ZAxis / i16GyroPrec;}
+	if (setRegister8Bit(0, ICM20948_INT_ENABLE_1, ICM20948_RAW_DATA_0_RDY_EN) != 0) {return -1;}
+	if (readRegister8(0, ICM20948_INT_STATUS_1, &ui8Data) != 0) {return -1;}
 
-		if (ui8Ready == 6) {
-			ui32Debug = 0;
-			return 0;
-		}
-		ui32Debug = 0;
-	}
+	pGetTimestamp = (pTimestamp != NULL) ? pTimestamp : get_Ticks;
+	resetLatencyStats();
 
-	/* If we get here, the calibration process was not successful */
-	ui32Debug = 0;
+	ui32LastCall     = pGetTimestamp();
+	ui32LastInterval = 0;
+	ui32DataTime     = ui32LastCall;
+	boLatestReady    = true;
 
-	return -2;
+	return 0;
 }
 
 
 /**
-  @brief  Calculates a single iteration of the calibration procedure
-  @param  ui8Iteration (between 0 and MAX_ITERATIONS-1)
-  @retval  0: All 6 axes are calibrated
-           1: Less than 6 axes are calibrated, but ui8Iteration < MAX_ITERATIONS
-          -1: An error during the function call 'calculateMeanValues' occurred (should not happen)
-          -2: ui8Iteration >= MAX_ITERATIONS --> Calibration not succeeded
+  @brief  Reads the most recent sample with a single burst from INT_STATUS_1 to the end of the burst window of
+          the acquisition profile (max. 33 bytes, user bank 0 is kept selected by all configuration methods).
+          RAW_DATA_0_RDY_INT tells whether the sensor registers were updated since the previous call. The burst
+          clears INT_STATUS_2 and INT_STATUS_3 as well (FIFO overflow and watermark status).
+  @param  pFrame: Latest sample (unchanged data if there is no new sample)
+          pAge:   Upper bound of the sample age in timestamp units (the sample became ready after the call that
+                  preceded its first detection)
+  @retval  1: New sample
+           0: No new sample since the previous call
+          -1: Bus error or setupLatest() not called
 **/
-int16_t ICM20948::exeCalibrationSingleIteration(uint8_t ui8Iteration, uint8_t *pReady)
+int16_t ICM20948::readLatest(ICM20948_Frame_t *pFrame, uint32_t *pAge)
 {
-	int16_t i16Aux;
+	const uint8_t ui8DataStart = ICM20948_ACCEL_XOUT_H - ICM20948_INT_STATUS_1; // Index of ACCEL_XOUT_H in ui8Buffer[]
+	uint8_t  ui8Buffer[ICM20948_ACCEL_XOUT_H - ICM20948_INT_STATUS_1 + 14];
+	uint32_t ui32Start, ui32Latency, ui32Interval, ui32Jitter, ui32Ticks, ui32TrackTime = 0;
+	uint8_t  ui8Offset, ui8Length;
+	bool     boNew, boSlowRead;
 
-	uint8_t ui8Ready = 0; /* Variable counts the calibrated sensor axes
-	                         (its value is 6 if all accelerometer and gyroscope axes are calibrated) */
-	*pReady = ui8Ready;
+	if (!boLatestReady) {return -1;}
 
-	if      (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_2G.ui8Selection) {i16Aux = 16384;}
-	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_4G.ui8Selection) {i16Aux =  8192;}
-	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_8G.ui8Selection) {i16Aux =  4096;}
-	else                                                                                    {i16Aux =  2048;}
+	ui32Start = pGetTimestamp();
 
-	if (ui8Iteration == 0)
+	if (ui8CurrentBank != 0)
 	{
-		/* Calculate the CorrectedAccelMean and CorrectedGyroMean values */
-		if (calculateMeanValues() != 0) {return -1;}
+		LatencyStats.ui32BankSwitches++;
+		if (switchBank(0) != 0) {return -1;}
+	}
 
-		/* Calculate the new AccelOffset and GyroOffset values which are used in the first iteration (i = 0) */
-		AccelOffset.i16XAxis = -CorrectedAccelMean.i16XAxis / i16AccelPrec;
-		AccelOffset.i16YAxis = -CorrectedAccelMean.i16YAxis / i16AccelPrec;
-		AccelOffset.i16ZAxis = (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;
-		GyroOffset.i16XAxis  = -CorrectedGyroMean.i16XAxis / i16GyroPrec;
-		GyroOffset.i16YAxis  = -CorrectedGyroMean.i16YAxis / i16GyroPrec;
-		GyroOffset.i16ZAxis  = -CorrectedGyroMean.i16ZAxis / i16GyroPrec;
+	/* Multi-rate mode: the slower sensor is only read if its next sample is due (or overdue) */
+	ui8Offset  = ui8BurstOffset;
+	ui8Length  = ui8BurstLength;
+	boSlowRead = (ui8RateRatio == 0) || ((ui32RateTick + 1) / ui8RateRatio != ui32SlowSlot);
+
+	if (!boSlowRead)
+	{
+		ui8Offset = boAccelSlow ? 6 : 0; // Gyroscope (bytes 6...11) or accelerometer (bytes 0...5)
+		ui8Length = 6;
 	}
 
-	if (ui8Iteration < MAX_ITERATIONS)
+	if (ui32TrackHz != 0) {ui32TrackTime = pTrackTimestamp();}
+
+	if (Bus.readBurst(ICM20948_INT_STATUS_1, ui8Buffer, ui8DataStart + ui8Offset + ui8Length,
+			ICM20948_SPEED_BURST) != 0) {return -1;}
+
+	boNew = (ui8Buffer[0] & ICM20948_RAW_DATA_0_RDY_INT) != 0;
+
+	if (ui32TrackHz != 0)
 	{
-		if (calculateMeanValues() != 0) {return -1;}
+		checkOverflow(ui32TrackTime, ui8Buffer[ICM20948_INT_STATUS_2 - ICM20948_INT_STATUS_1]);
+		if (boNew) {checkContinuity(ui32TrackTime, 1, 0);}
+	}
 
-		if (abs(CorrectedAccelMean.i16XAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16XAxis = AccelOffset.i16XAxis - CorrectedAccelMean.i16XAxis / i16AccelPrec;}
+	if (boNew)
+	{
+		memcpy(&ui8DataArray[ui8Offset], &ui8Buffer[ui8DataStart + ui8Offset], ui8Length);
+
+		ui8DataEpoch = ui8Epoch;
+		ui8DataFlags = 0;
 
-		if (abs(CorrectedAccelMean.i16YAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16YAxis = AccelOffset.i16YAxis - CorrectedAccelMean.i16YAxis / i16AccelPrec;}
+		if (ui8RegisterSettle > 0)
+		{
+			ui8RegisterSettle--;
+			ui8DataFlags = ICM20948_FRAME_TRANSITION;
+		}
 
-		if (abs(i16Aux - CorrectedAccelMean.i16ZAxis) <= i16AccelPrec) {ui8Ready++;}
-		else {AccelOffset.i16ZAxis = AccelOffset.i16ZAxis + (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;}
+		/* The buffer starts at INT_STATUS_1 and contains DELAY_TIMEH/L */
+		if (ICM20948_SensorConfig.Fsync != ICM20948_FSYNC_OFF && latchFsync(ui8DataArray, 14) != 0)
+		{
+			ui8DataFlags  |= ICM20948_FRAME_FSYNC;
+			ui16FsyncDelay = (ui8Buffer[ICM20948_DELAY_TIMEH - ICM20948_INT_STATUS_1] << 8) |
+					          ui8Buffer[ICM20948_DELAY_TIMEL - ICM20948_INT_STATUS_1];
+		}
 
-		if (abs(CorrectedGyroMean.i16XAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16XAxis = GyroOffset.i16XAxis - CorrectedGyroMean.i16XAxis / i16GyroPrec;}
+		if (ui8RateRatio != 0)
+		{
+			/* Samples missed since the last new one are estimated from the middles of the intervals between two
+			 * calls in which both samples became ready (rounded). The lower bounds alone are biased by one tick
+			 * after a call without a new sample. */
+			ui32Ticks = 1;
+			if (ui32TickPeriod != 0 && ui32RateTick != 0)
+			{
+				ui32Ticks = (ui32LastCall + ui32Start - ui32RateTime + ui32TickPeriod) / (2 * ui32TickPeriod);
+				if (ui32Ticks == 0) {ui32Ticks = 1;}
+			}
+			ui32RateTick += ui32Ticks;
+			ui32RateTime  = ui32LastCall + ui32Start;
+
+			ui8DataFlags |= boAccelSlow ? ICM20948_FRAME_GYRO_FRESH : ICM20948_FRAME_ACCEL_FRESH;
+
+			if (boSlowRead && ui32RateTick / ui8RateRatio != ui32SlowSlot)
+			{
+				ui32SlowSlot  = ui32RateTick / ui8RateRatio;
+				ui8DataFlags |= boAccelSlow ? ICM20948_FRAME_ACCEL_FRESH : ICM20948_FRAME_GYRO_FRESH;
+			}
+		}
 
-		if (abs(CorrectedGyroMean.i16YAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16YAxis = GyroOffset.i16YAxis - CorrectedGyroMean.i16YAxis / i16GyroPrec;}
+		ui32DataTime = ui32LastCall;
+		LatencyStats.ui32NewSamples++;
+	}
 
-		if (abs(CorrectedGyroMean.i16ZAxis) <= i16GyroPrec) {ui8Ready++;}
-		else {GyroOffset.i16ZAxis = GyroOffset.i16ZAxis - CorrectedGyroMean.i16ZAxis / i16GyroPrec;}
+	*pFrame = getFrame();
 
-		*pReady = ui8Ready;
+	/* Statistics (unsigned differences are correct across a wrap-around of the time base) */
+	ui32Latency = pGetTimestamp() - ui32Start;
+	*pAge = ui32Start + ui32Latency - ui32DataTime;
 
-		if (ui8Ready == 6) {return 0;}
-		else               {return 1;}
+	ui32Interval = ui32Start - ui32LastCall;
+	if (LatencyStats.ui32Calls > 0)
+	{
+		ui32Jitter = (ui32Interval > ui32LastInterval) ? (ui32Interval - ui32LastInterval) : (ui32LastInterval - ui32Interval);
+		LatencyStats.ui32JitterHist[getHistogramBin(ui32Jitter)]++;
+		if (ui32Jitter > LatencyStats.ui32JitterMax) {LatencyStats.ui32JitterMax = ui32Jitter;}
 	}
+	ui32LastInterval = ui32Interval;
+	ui32LastCall     = ui32Start;
 
-	return -2;
+	LatencyStats.ui32Calls++;
+	LatencyStats.ui32LatencyHist[getHistogramBin(ui32Latency)]++;
+	if (ui32Latency > LatencyStats.ui32LatencyMax) {LatencyStats.ui32LatencyMax = ui32Latency;}
+	if (*pAge > LatencyStats.ui32AgeMax)           {LatencyStats.ui32AgeMax = *pAge;}
+
+	return boNew ? 1 : 0;
 }
 
 
-// Debug methods
-int16_t ICM20948::setDebugFunction8(uint8_t ui8Data)
+void ICM20948::getLatencyStats(ICM20948_LatencyStats_t *pStats)
 {
-	if (writeRegister8(1, ICM20948_XA_OFFS_H, ui8Data) != 0) {return -1;}
-
-	return 0;
+	*pStats = LatencyStats;
 }
 
 
-int16_t ICM20948::setDebugFunction16(uint16_t ui16Data)
+void ICM20948::resetLatencyStats(void)
 {
-	if (writeRegister16(1, ICM20948_XA_OFFS_H, ui16Data) != 0) {return -1;}
-
-	return 0;
+	memset(&LatencyStats, 0, sizeof(ICM20948_LatencyStats_t));
 }
 
 
-int16_t ICM20948::getDebugFunction16(uint16_t *pData)
+/**
+  @brief  Starts the continuity tracking of the acquisition paths readAllDataRaw(), readLatest() and readFifoFrames():
+          - Duplicates: readAllDataRaw() read the previous sample again (no data ready and unchanged data), it reads
+            the status with the burst from INT_STATUS_1 (19 bytes more). readLatest() returns 0 in this case.
+          - Missed samples: samples expected at the configured sample rate (the faster sensor) since the start
+            versus the samples delivered (and the frames left in the FIFO). A sensor ahead of the model moves the
+            start, a sensor clock slower than nominal shows up as missed samples at a constant rate.
+          - FIFO overflows: FIFO_OVERFLOW_INT (INT_STATUS_2, the INT pin signals it as well)
+          Only one acquisition path may be used. A configuration change restarts the model at the new sample rate.
+  @param  ui32TimestampHz: Frequency of the time base, its resolution should be well below the sample period
+                           (e.g. a 1MHz timer or the cycle counter, the 1ms of get_Ticks() are too coarse at 1125Hz)
+          pTimestamp:      Time base (NULL: get_Ticks(), ui32TimestampHz must be 1000)
+  @retval  0: OK
+          -1: ui32TimestampHz is 0 or bus error
+**/
+int16_t ICM20948::setupContinuity(uint32_t ui32TimestampHz, uint32_t (*pTimestamp)(void))
 {
-	if (readRegister16(1, ICM20948_XA_OFFS_H, pData) != 0) {return -1;}
+	uint8_t ui8Data;
+
+	ui32TrackHz = 0;
+
+	if (ui32TimestampHz == 0) {return -1;}
+
+	if (setRegister8Bit(0, ICM20948_INT_ENABLE_1, ICM20948_RAW_DATA_0_RDY_EN) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_INT_ENABLE_2, ICM20948_FIFO_OVERFLOW_EN) != 0) {return -1;}
+
+	/* Clear the status of samples and overflows from before the start */
+	if (readRegister8(0, ICM20948_INT_STATUS_1, &ui8Data) != 0) {return -1;}
+	if (readRegister8(0, ICM20948_INT_STATUS_2, &ui8Data) != 0) {return -1;}
+
+	pTrackTimestamp = (pTimestamp != NULL) ? pTimestamp : get_Ticks;
+	ui32TrackHz     = ui32TimestampHz;
+	resetContinuityStats();
+	anchorContinuity();
 
 	return 0;
 }
 
 
-/* Private methods */
-ICM20948_RetCode_t ICM20948::init(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
-		                          ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR,
-								  ICM20948_DLPF_t DLPF)
+void ICM20948::getContinuityStats(ICM20948_ContinuityStats_t *pStats)
 {
-	uint8_t ui8Data;
-	int16_t i16RetValue;
+	*pStats = ContinuityStats;
+}
 
-	uint32_t ui32StartTicks;
 
-	ICM20948_SensorConfig.boStatusOK = false;
-	ICM20948_SensorConfig.boSleep    = true;
+/**
+  @brief  Takes the entries of the gap log, oldest first
+  @param  pGaps:      Array of ui8MaxGaps entries
+  @retval Number of entries
+**/
+uint8_t ICM20948::readGapLog(ICM20948_Gap_t *pGaps, uint8_t ui8MaxGaps)
+{
+	uint8_t ui8Count = (ui8GapCount < ui8MaxGaps) ? ui8GapCount : ui8MaxGaps;
+	uint8_t ui8First = (uint8_t)(ui8GapHead - ui8GapCount);
+
+	for (uint8_t i = 0; i < ui8Count; i++)
+	{
+		pGaps[i] = GapLog[(uint8_t)(ui8First + i) & (ICM20948_GAP_LOG_SIZE - 1)];
+	}
+
+	ui8GapCount -= ui8Count;
+
+	return ui8Count;
+}
+
+
+/* Clears the counters and the gap log, the model keeps running */
+void ICM20948::resetContinuityStats(void)
+{
+	memset(&ContinuityStats, 0, sizeof(ICM20948_ContinuityStats_t));
+	ui8GapHead  = 0;
+	ui8GapCount = 0;
+}
+
+
+/**
+  @brief  Enables the FIFO in stream mode with accelerometer and gyroscope data (ICM20948_FIFO_FRAME_SIZE bytes per frame).
+          Not possible while the DMP is enabled (the DMP writes its own packets into the FIFO).
+          The decoding assumes one accelerometer sample per gyroscope sample, the sample rates must be equal
+          (same divider, DLPF enabled: ACCEL_SR_4500_HZ and GYRO_SR_9000_HZ are not possible) and stay equal
+          while the FIFO is enabled.
+  @retval  0: OK
+          -1: Bus error, DMP enabled, profile without both sensors or unequal sample rates
+**/
+int16_t ICM20948::enableFifo(bool boEnable)
+{
+	if (boEnable)
+	{
+		if (ICM20948_SensorConfig.boDmpEnabled) {return -1;}
+
+		if (!isEqualSampleRate(ICM20948_SensorConfig.AccelSampleRate, ICM20948_SensorConfig.GyroSampleRate)) {return -1;}
+
+		/* The FIFO frame always holds accelerometer and gyroscope data */
+		if (ICM20948_PROFILES[ICM20948_SensorConfig.Profile].ui8PwrMgmt2 != 0x00) {return -1;}
+
+		if (writeRegister8(0, ICM20948_FIFO_MODE, 0x00) != 0) {return -1;}
+		if (writeRegister8(0, ICM20948_FIFO_EN_2, ICM20948_ACCEL_FIFO_EN | ICM20948_GYRO_FIFO_EN) != 0) {return -1;}
+		if (resetFifo() != 0) {return -1;}
+		if (setRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_FIFO_EN) != 0) {return -1;}
+	}
+	else
+	{
+		if (clearRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_FIFO_EN) != 0) {return -1;}
+		if (writeRegister8(0, ICM20948_FIFO_EN_2, 0x00) != 0) {return -1;}
+	}
+
+	ICM20948_SensorConfig.boFifoEnabled = boEnable;
+
+	return 0;
+}
+
+
+int16_t ICM20948::resetFifo(void)
+{
+	/* FIFO_RESET must be asserted and de-asserted */
+	if (writeRegister8(0, ICM20948_FIFO_RST, ICM20948_FIFO_RESET) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_FIFO_RST, 0x00) != 0) {return -1;}
+
+	/* No frames of older epochs left */
+	for (uint8_t i = 0; i < ICM20948_EPOCH_HISTORY; i++) {ui16EpochFrames[i] = 0;}
+	ui8FifoEpoch  = ui8Epoch;
+	ui8FifoSettle = 0;
+
+	return 0;
+}
+
+
+/* Number of bytes in the FIFO */
+int16_t ICM20948::getFifoCount(uint16_t *pCount)
+{
+	uint8_t ui8Array[2];
+
+	if (readBurst(0, ICM20948_FIFO_COUNTH, ui8Array, 2, ICM20948_SPEED_BURST) != 0) {return -1;}
+
+	*pCount = ((ui8Array[0] << 8) | ui8Array[1]) & 0x1FFF;
+
+	return 0;
+}
+
+
+/**
+  @brief  Reads all complete frames in the FIFO (max. ui16MaxFrames) with one burst and decodes them
+  @param  pFrames:     Frame array
+          pFrameCount: Number of frames read
+  @retval  0: OK
+          -1: Bus error or DMP enabled
+**/
+int16_t ICM20948::readFifoFrames(ICM20948_Frame_t *pFrames, uint16_t ui16MaxFrames, uint16_t *pFrameCount)
+{
+	uint8_t ui8Raw[ICM20948_FIFO_FRAME_SIZE];
+	uint8_t *pRaw = (uint8_t *)pFrames;
+	uint8_t ui8Delay[2];
+	uint8_t ui8Status2;
+	uint16_t ui16Count, ui16Available;
+	uint32_t ui32TrackTime = 0;
+	bool boFsync = false;
+
+	*pFrameCount = 0;
+
+	if (ICM20948_SensorConfig.boDmpEnabled) {return -1;}
+
+	if (ui32TrackHz != 0)
+	{
+		ui32TrackTime = pTrackTimestamp();
+		if (readRegister8(0, ICM20948_INT_STATUS_2, &ui8Status2) != 0) {return -1;}
+		checkOverflow(ui32TrackTime, ui8Status2);
+	}
+
+	if (getFifoCount(&ui16Count) != 0) {return -1;}
+
+	ui16Available = ui16Count / ICM20948_FIFO_FRAME_SIZE;
+	ui16Count     = (ui16Available > ui16MaxFrames) ? ui16MaxFrames : ui16Available;
+
+	/* The frames left in the FIFO are expected samples as well */
+	if (ui32TrackHz != 0) {checkContinuity(ui32TrackTime, ui16Count, ui16Available - ui16Count);}
+
+	if (ui16Count == 0) {return 0;}
+
+	/* The raw frames are read into the frame array itself ... */
+	if (readBurst(0, ICM20948_FIFO_R_W, pRaw, ui16Count * ICM20948_FIFO_FRAME_SIZE, ICM20948_SPEED_BURST) != 0) {return -1;}
+
+	/* ... and decoded from the last to the first frame, because a decoded frame is larger than a raw frame */
+	for (int16_t i = ui16Count - 1; i >= 0; i--)
+	{
+		memcpy(ui8Raw, &pRaw[i * ICM20948_FIFO_FRAME_SIZE], ICM20948_FIFO_FRAME_SIZE);
+		pFrames[i].ui8Flags = 0;
+
+		if (ICM20948_SensorConfig.Fsync != ICM20948_FSYNC_OFF && latchFsync(ui8Raw, ICM20948_FIFO_FRAME_SIZE) != 0)
+		{
+			pFrames[i].ui8Flags = ICM20948_FRAME_FSYNC;
+			boFsync = true;
+		}
+
+		decodeFrame(ui8Raw, &pFrames[i]);
+		pFrames[i].i16Temperature = 0;
+	}
+
+	/* Epochs in FIFO order: the frames counted at a reconfiguration belong to the previous epoch */
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		while (ui8FifoEpoch != ui8Epoch && ui16EpochFrames[ui8FifoEpoch & (ICM20948_EPOCH_HISTORY - 1)] == 0)
+		{
+			ui8FifoEpoch++;
+			ui8FifoSettle = ICM20948_EPOCH_SETTLE;
+		}
+
+		pFrames[i].ui8Epoch = ui8FifoEpoch;
+		pFrames[i].ui8Range = EpochConfig[ui8FifoEpoch & (ICM20948_EPOCH_HISTORY - 1)].ui8Range;
+
+		if (ui8FifoEpoch != ui8Epoch)
+		{
+			ui16EpochFrames[ui8FifoEpoch & (ICM20948_EPOCH_HISTORY - 1)]--;
+		}
+		else if (ui8FifoSettle > 0)
+		{
+			ui8FifoSettle--;
+			pFrames[i].ui8Flags |= ICM20948_FRAME_TRANSITION;
+		}
+	}
+
+	/* DELAY_TIME is not stored in the FIFO, it belongs to the last FSYNC edge of the batch */
+	if (boFsync)
+	{
+		if (readBurst(0, ICM20948_DELAY_TIMEH, ui8Delay, 2, ICM20948_SPEED_READ) != 0) {return -1;}
+		ui16FsyncDelay = (ui8Delay[0] << 8) | ui8Delay[1];
+	}
+
+	*pFrameCount = ui16Count;
+
+	return 0;
+}
+
+
+/**
+  @brief  Uploads the DMP firmware in bursts of ICM20948_DMP_CHUNK_SIZE bytes, every burst is read back and
+          compared. The image is not part of the driver (e.g. dmp3a image of the InvenSense eMD package).
+  @param  pImage:   Firmware image, loaded to ICM20948_DMP_LOAD_START
+          ui16Size: Size of the image in bytes
+  @retval  0: OK
+          -1: Invalid image size, DMP running, sensor in sleep mode, bus error or verification failed
+**/
+int16_t ICM20948::loadDmpFirmware(const uint8_t *pImage, uint16_t ui16Size)
+{
+	uint8_t  ui8Verify[ICM20948_DMP_CHUNK_SIZE];
+	uint16_t ui16Addr = ICM20948_DMP_LOAD_START;
+	uint8_t  ui8Length;
+
+	boDmpLoaded = false;
+
+	if (pImage == NULL || ui16Size == 0 || ui16Size > ICM20948_DMP_MEMORY_SIZE - ICM20948_DMP_LOAD_START) {return -1;}
+	if (ICM20948_SensorConfig.boDmpEnabled || ICM20948_SensorConfig.boSleep) {return -1;}
+
+	for (uint16_t i = 0; i < ui16Size; i += ui8Length)
+	{
+		/* A burst must not cross a bank of the DMP memory */
+		ui8Length = ICM20948_DMP_CHUNK_SIZE;
+		if (ui8Length > ui16Size - i)                {ui8Length = ui16Size - i;}
+		if (ui8Length > 0x100 - (ui16Addr & 0x00FF)) {ui8Length = 0x100 - (ui16Addr & 0x00FF);}
+
+		if (writeDmpMemory(ui16Addr, &pImage[i], ui8Length) != 0) {return -1;}
+		if (readDmpMemory(ui16Addr, ui8Verify, ui8Length) != 0) {return -1;}
+		if (memcmp(ui8Verify, &pImage[i], ui8Length) != 0) {return -1;}
+
+		ui16Addr += ui8Length;
+	}
+
+	if (writeRegister16(2, ICM20948_PRGM_START_ADDRH, ICM20948_DMP_START_ADDR) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
+
+	boDmpLoaded = true;
+
+	return 0;
+}
+
+
+/**
+  @brief  Configures and starts the DMP, its packets are read from the FIFO with readDmpPackets(). The full
+          scales are set to ACCEL_FS_4G and GYRO_FS_2000DPS (scaling of the DMP firmware), the DMP runs with
+          the gyro sample rate. disableDmp() restores the previous full scales.
+  @param  ui16Outputs: ICM20948_DMP_ACCEL, ICM20948_DMP_GYRO, ICM20948_DMP_QUAT6, ICM20948_DMP_PQUAT6 and/or
+                       ICM20948_DMP_GYRO_CALIBR
+          ui16OdrDiv:  Output rate = gyro sample rate / (ui16OdrDiv + 1)
+  @retval  0: OK
+          -1: Firmware not loaded, frame FIFO enabled, output not supported, a sensor disabled by the
+              acquisition profile, DLPF disabled or bus error
+**/
+int16_t ICM20948::enableDmp(uint16_t ui16Outputs, uint16_t ui16OdrDiv)
+{
+	uint16_t ui16Header2 = 0;
+	uint16_t ui16Ready   = 0;
+	uint16_t ui16Events  = 0;
+	uint8_t  ui8Pll;
+	uint64_t ui64GyroSF;
+
+	if (!boDmpLoaded || ICM20948_SensorConfig.boFifoEnabled) {return -1;}
+	if (ui16Outputs == 0 || (ui16Outputs & ~ICM20948_DMP_SUPPORTED) != 0) {return -1;}
+	if (ICM20948_PROFILES[ICM20948_SensorConfig.Profile].ui8PwrMgmt2 != 0x00) {return -1;}
+	if (!ICM20948_SensorConfig.AccelSampleRate.boFCHOICE || !ICM20948_SensorConfig.GyroSampleRate.boFCHOICE) {return -1;}
+
+	/* Scaling expected by the DMP firmware */
+	DmpAccelFullScale = ICM20948_SensorConfig.AccelFullScale;
+	DmpGyroFullScale  = ICM20948_SensorConfig.GyroFullScale;
+	if (setAccelFullScale(ACCEL_FS_4G) != 0) {return -1;}
+	if (setGyroFullScale(GYRO_FS_2000DPS) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_ACC_SCALE, ICM20948_DMP_ACC_SCALE_4G, 4) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_ACC_SCALE2, ICM20948_DMP_ACC_SCALE2_4G, 4) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_GYRO_FULLSCALE, ICM20948_DMP_GYRO_FS_2000DPS, 4) != 0) {return -1;}
+
+	/* Gyro scale factor of the DMP integration, depends on the gyro sample rate divider and on the trim of
+	 * the internal oscillator (TIMEBASE_CORR_PLL, bit 7 is the sign) */
+	if (readRegister8(1, ICM20948_TIMEBASE_CORR_PLL, &ui8Pll) != 0) {return -1;}
+	ui64GyroSF = 264446880937391ULL * 16 * (1 + ICM20948_SensorConfig.GyroSampleRate.ui8Div);
+	if (ui8Pll & 0x80) {ui64GyroSF /= (1270 - (ui8Pll & 0x7F));}
+	else               {ui64GyroSF /= (1270 + ui8Pll);}
+	ui64GyroSF /= 100000;
+	if (ui64GyroSF > 0x7FFFFFFF) {ui64GyroSF = 0x7FFFFFFF;}
+	if (writeDmpRegister(ICM20948_DMP_GYRO_SF, (uint32_t)ui64GyroSF, 4) != 0) {return -1;}
+
+	/* Sensors the DMP waits for, calibration and accuracy of the fusion outputs */
+	if (ui16Outputs & (ICM20948_DMP_ACCEL | ICM20948_DMP_QUAT6 | ICM20948_DMP_PQUAT6))
+	{
+		ui16Ready |= ICM20948_DMP_RDY_ACCEL;
+	}
+	if (ui16Outputs & (ICM20948_DMP_GYRO | ICM20948_DMP_QUAT6 | ICM20948_DMP_PQUAT6 | ICM20948_DMP_GYRO_CALIBR))
+	{
+		ui16Ready |= ICM20948_DMP_RDY_GYRO;
+	}
+	if (ui16Outputs & (ICM20948_DMP_QUAT6 | ICM20948_DMP_PQUAT6))
+	{
+		ui16Events  |= ICM20948_DMP_EVENT_ACCEL_CALIBR | ICM20948_DMP_EVENT_GYRO_CALIBR;
+		ui16Header2 |= ICM20948_DMP_HDR2_ACCEL_ACCURACY | ICM20948_DMP_HDR2_GYRO_ACCURACY;
+	}
+	if (ui16Outputs & ICM20948_DMP_GYRO_CALIBR)
+	{
+		ui16Events  |= ICM20948_DMP_EVENT_GYRO_CALIBR;
+		ui16Header2 |= ICM20948_DMP_HDR2_GYRO_ACCURACY;
+	}
+
+	/* The DMP writes its packets into the FIFO, the sensor data is not written by the FIFO itself */
+	if (writeRegister8(0, ICM20948_FIFO_EN_1, 0x00) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_FIFO_EN_2, 0x00) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_FIFO_MODE, 0x00) != 0) {return -1;}
+
+	if (writeDmpRegister(ICM20948_DMP_DATA_OUT_CTL1, ui16Outputs | (ui16Header2 ? ICM20948_DMP_HEADER2 : 0), 2) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_DATA_OUT_CTL2, ui16Header2, 2) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_DATA_INTR_CTL, ui16Outputs, 2) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_MOTION_EVENT_CTL, ui16Events, 2) != 0) {return -1;}
+	if (writeDmpRegister(ICM20948_DMP_DATA_RDY_STATUS, ui16Ready, 2) != 0) {return -1;}
+
+	if ((ui16Outputs & ICM20948_DMP_ACCEL) && writeDmpRegister(ICM20948_DMP_ODR_ACCEL, ui16OdrDiv, 2) != 0) {return -1;}
+	if ((ui16Outputs & ICM20948_DMP_GYRO) && writeDmpRegister(ICM20948_DMP_ODR_GYRO, ui16OdrDiv, 2) != 0) {return -1;}
+	if ((ui16Outputs & ICM20948_DMP_QUAT6) && writeDmpRegister(ICM20948_DMP_ODR_QUAT6, ui16OdrDiv, 2) != 0) {return -1;}
+	if ((ui16Outputs & ICM20948_DMP_PQUAT6) && writeDmpRegister(ICM20948_DMP_ODR_PQUAT6, ui16OdrDiv, 2) != 0) {return -1;}
+	if ((ui16Outputs & ICM20948_DMP_GYRO_CALIBR) && writeDmpRegister(ICM20948_DMP_ODR_GYRO_CALIBR, ui16OdrDiv, 2) != 0) {return -1;}
+
+	/* Start with an empty FIFO at a packet boundary */
+	if (resetFifo() != 0) {return -1;}
+	ui16DmpBuffered = 0;
+
+	if (changeRegister8(0, ICM20948_USER_CTRL, ICM20948_DMP_EN | ICM20948_FIFO_EN | ICM20948_DMP_RST,
+			            ICM20948_DMP_EN | ICM20948_FIFO_EN | ICM20948_DMP_RST) != 0) {return -1;}
+
+	ICM20948_SensorConfig.boDmpEnabled = true;
+
+	return 0;
+}
+
+
+/**
+  @brief  Stops the DMP, if it was running the full scales that were set before enableDmp() are restored
+  @retval  0: OK
+          -1: Bus error
+**/
+int16_t ICM20948::disableDmp(void)
+{
+	const bool boWasEnabled = ICM20948_SensorConfig.boDmpEnabled;
+
+	if (changeRegister8(0, ICM20948_USER_CTRL, ICM20948_DMP_EN | ICM20948_FIFO_EN, 0x00) != 0) {return -1;}
+	if (resetFifo() != 0) {return -1;}
+	ui16DmpBuffered = 0;
+
+	ICM20948_SensorConfig.boDmpEnabled = false;
+
+	if (boWasEnabled)
+	{
+		if (setAccelFullScale(DmpAccelFullScale) != 0) {return -1;}
+		if (setGyroFullScale(DmpGyroFullScale) != 0) {return -1;}
+	}
+
+	return 0;
+}
+
+
+/**
+  @brief  Reads the DMP packets in the FIFO (max. ui16MaxPackets) with as few bursts as possible and decodes
+          them. An incomplete packet at the end is kept until the next call. If the packet stream is out of sync
+          (undefined header bits, e.g. after a FIFO overflow), the FIFO is reset.
+  @param  pPackets:     Packet array
+          pPacketCount: Number of packets read
+  @retval  0: OK
+          -1: DMP not enabled, bus error or packet stream out of sync
+**/
+int16_t ICM20948::readDmpPackets(ICM20948_DmpPacket_t *pPackets, uint16_t ui16MaxPackets, uint16_t *pPacketCount)
+{
+	uint16_t ui16Fifo;
+	uint16_t ui16Offset;
+	uint16_t ui16Length;
+	int16_t  i16PacketLength;
+
+	*pPacketCount = 0;
+
+	if (!ICM20948_SensorConfig.boDmpEnabled) {return -1;}
+
+	if (getFifoCount(&ui16Fifo) != 0) {return -1;}
+
+	while (true)
+	{
+		/* Decode all complete packets in the buffer ... */
+		ui16Offset = 0;
+		while (*pPacketCount < ui16MaxPackets)
+		{
+			i16PacketLength = getDmpPacketLength(&ui8DmpBuffer[ui16Offset], ui16DmpBuffered - ui16Offset);
+
+			if (i16PacketLength < 0)
+			{
+				ui16DmpBuffered = 0;
+				resetFifo();
+				return -1;
+			}
+			if (i16PacketLength == 0) {break;}
+
+			decodeDmpPacket(&ui8DmpBuffer[ui16Offset], &pPackets[*pPacketCount]);
+			(*pPacketCount)++;
+			ui16Offset += i16PacketLength;
+		}
+
+		/* ... and keep the rest */
+		ui16DmpBuffered -= ui16Offset;
+		memmove(ui8DmpBuffer, &ui8DmpBuffer[ui16Offset], ui16DmpBuffered);
+
+		if (*pPacketCount >= ui16MaxPackets || ui16Fifo == 0) {break;}
+
+		/* Refill the buffer (there is always room for more than the rest of a packet) */
+		ui16Length = ICM20948_DMP_BUFFER_SIZE - ui16DmpBuffered;
+		if (ui16Length > ui16Fifo) {ui16Length = ui16Fifo;}
+
+		if (readBurst(0, ICM20948_FIFO_R_W, &ui8DmpBuffer[ui16DmpBuffered], ui16Length, ICM20948_SPEED_BURST) != 0) {return -1;}
+		ui16DmpBuffered += ui16Length;
+		ui16Fifo        -= ui16Length;
+	}
+
+	return 0;
+}
+
+
+/* Unit quaternion of a packet with ICM20948_DMP_QUAT6. Q0 is not transmitted, the DMP keeps it positive. */
+void ICM20948::getDmpQuaternion(const ICM20948_DmpPacket_t *pPacket, ICM20948_Quaternion_t *pQuat)
+{
+	const float fQ30 = 1.0f / 1073741824.0f;
+	float fSum;
+
+	pQuat->fX = pPacket->Quat6.i32XAxis * fQ30;
+	pQuat->fY = pPacket->Quat6.i32YAxis * fQ30;
+	pQuat->fZ = pPacket->Quat6.i32ZAxis * fQ30;
+
+	fSum = 1.0f - (pQuat->fX * pQuat->fX + pQuat->fY * pQuat->fY + pQuat->fZ * pQuat->fZ);
+	pQuat->fW = (fSum > 0.0f) ? sqrtf(fSum) : 0.0f;
+}
+
+
+ICM20948_i16Vector_t ICM20948::getAccelRaw(void)
+{
+	ICM20948_i16Vector_t AccelRaw;
+
+	decodeVector(&ui8DataArray[0], ui8Mount, &AccelRaw);
+
+	return AccelRaw;
+}
+
+
+ICM20948_i16Vector_t ICM20948::getCorrectedAccelRaw(void)
+{
+	ICM20948_i16Vector_t CorrectedAccelRaw;
+
+	decodeVector(&ui8DataArray[0], ui8Mount, &CorrectedAccelRaw);
+
+	CorrectedAccelRaw.i16XAxis += AccelOffset.i16XAxis;
+	CorrectedAccelRaw.i16YAxis += AccelOffset.i16YAxis;
+	CorrectedAccelRaw.i16ZAxis += AccelOffset.i16ZAxis;
+
+	return CorrectedAccelRaw;
+}
+
+
+ICM20948_i16Vector_t ICM20948::getGyroRaw(void)
+{
+	ICM20948_i16Vector_t GyroRaw;
+
+	decodeVector(&ui8DataArray[6], ui8Mount, &GyroRaw);
+
+	return GyroRaw;
+}
+
+
+ICM20948_i16Vector_t ICM20948::getCorrectedGyroRaw(void)
+{
+	ICM20948_i16Vector_t CorrectedGyroRaw;
+
+	const ICM20948_i16Vector_t Offset = loadGyroOffset();
+
+	decodeVector(&ui8DataArray[6], ui8Mount, &CorrectedGyroRaw);
+
+	CorrectedGyroRaw.i16XAxis += Offset.i16XAxis;
+	CorrectedGyroRaw.i16YAxis += Offset.i16YAxis;
+	CorrectedGyroRaw.i16ZAxis += Offset.i16ZAxis;
+
+	return CorrectedGyroRaw;
+}
+
+
+int16_t ICM20948::getTemperatureRaw(void)
+{
+	return (ui8DataArray[12] << 8) | ui8DataArray[13];
+}
+
+
+/* Decoded raw data of the last readAllDataRaw() call */
+ICM20948_Frame_t ICM20948::getFrame(void)
+{
+	ICM20948_Frame_t Frame;
+
+	decodeFrame(ui8DataArray, &Frame);
+	Frame.i16Temperature = getTemperatureRaw();
+	Frame.ui8Epoch       = ui8DataEpoch;
+	Frame.ui8Flags       = ui8DataFlags;
+	Frame.ui8Range       = EpochConfig[ui8DataEpoch & (ICM20948_EPOCH_HISTORY - 1)].ui8Range;
+
+	return Frame;
+}
+
+
+uint8_t ICM20948::getConfigEpoch(void)
+{
+	return ui8Epoch;
+}
+
+
+/**
+  @brief  Converts frames to g and dps with the scale factors of the epoch each frame was captured under
+  @retval  0: OK
+          -1: At least one frame has an epoch that is no longer in the history (converted to 0, ICM20948_FRAME_STALE_EPOCH)
+**/
+int16_t ICM20948::convertFrames(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, ICM20948_fFrame_t *pOut)
+{
+	const ICM20948_EpochConfig_t *pConfig;
+	float fAccel, fGyro;
+	int16_t i16RetValue = 0;
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		pConfig = &EpochConfig[pFrames[i].ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)];
+
+		pOut[i].ui8Epoch = pFrames[i].ui8Epoch;
+		pOut[i].ui8Flags = pFrames[i].ui8Flags;
+
+		if (pConfig->ui8Epoch == pFrames[i].ui8Epoch)
+		{
+			fAccel = pConfig->fAccelSensitivity;
+			fGyro  = pConfig->fGyroSensitivity;
+		}
+		else
+		{
+			fAccel = 0.0;
+			fGyro  = 0.0;
+			pOut[i].ui8Flags |= ICM20948_FRAME_STALE_EPOCH;
+			i16RetValue = -1;
+		}
+
+		pOut[i].Accel.fXAxis = pFrames[i].Accel.i16XAxis * fAccel;
+		pOut[i].Accel.fYAxis = pFrames[i].Accel.i16YAxis * fAccel;
+		pOut[i].Accel.fZAxis = pFrames[i].Accel.i16ZAxis * fAccel;
+		pOut[i].Gyro.fXAxis  = pFrames[i].Gyro.i16XAxis  * fGyro;
+		pOut[i].Gyro.fYAxis  = pFrames[i].Gyro.i16YAxis  * fGyro;
+		pOut[i].Gyro.fZAxis  = pFrames[i].Gyro.i16ZAxis  * fGyro;
+	}
+
+	return i16RetValue;
+}
+
+
+int16_t ICM20948::calculateMeanValues(void)
+{
+	return calculateMeanValues(SAMPLES_MEAN_VALUE, SAMPLES_SKIP);
+}
+
+
+int16_t ICM20948::calculateMeanValues(uint16_t ui16Samples, uint16_t ui16Skip)
+{
+	ICM20948_i32Vector_t CorrectedAccelRawSum;
+	ICM20948_i32Vector_t CorrectedGyroRawSum;
+
+	uint32_t ui32Ticks;
+	uint16_t ui16Repeated = 0;
+
+	/* Mean values need both sensors and the full burst window */
+	if (ICM20948_SensorConfig.Profile != ICM20948_PROFILE_FULL) {return -1;}
+
+	/* Initialization */
+	CorrectedAccelRawSum.i32XAxis = 0;
+	CorrectedAccelRawSum.i32YAxis = 0;
+	CorrectedAccelRawSum.i32ZAxis = 0;
+	CorrectedGyroRawSum.i32XAxis  = 0;
+	CorrectedGyroRawSum.i32YAxis  = 0;
+	CorrectedGyroRawSum.i32ZAxis  = 0;
+
+	ui32Ticks = get_Ticks();
+
+	while(get_Ticks() < (ui32Ticks + 1));
+	ui32Ticks = get_Ticks(); // Update ticks
+
+	for (uint16_t i = 0; i < ui16Skip + ui16Samples; )
+	{
+		if (readAllDataRaw() != 0) {return -1;}
+
+		/* With continuity tracking a duplicate is not averaged, the loop takes another sample instead */
+		if (boDataRepeated)
+		{
+			if (++ui16Repeated > ui16Samples) {return -1;}
+		}
+		else
+		{
+			if (i >= ui16Skip) {addMeanSample(&CorrectedAccelRawSum, &CorrectedGyroRawSum);}
+			i++;
+		}
+
+		/* We need a delay of 1ms to get a process sample rate of 1000Hz
+		 * (both accelerometer and gyroscope sample rate must be 1125Hz) */
+		while(get_Ticks() < (ui32Ticks + 1));
+		ui32Ticks = get_Ticks(); // Update ticks
+	}
+
+	setMeanValues(&CorrectedAccelRawSum, &CorrectedGyroRawSum, ui16Samples);
+
+	return 0;
+}
+
+
+/* Adds the corrected raw values of the last readAllDataRaw() to the sums of calculateMeanValues() */
+void ICM20948::addMeanSample(ICM20948_i32Vector_t *pAccelSum, ICM20948_i32Vector_t *pGyroSum)
+{
+	ICM20948_i16Vector_t CorrectedAccelRaw; // Corrected raw measurement data from accelerometer
+	ICM20948_i16Vector_t CorrectedGyroRaw;  // Corrected raw measurement data from gyroscope
+
+	CorrectedAccelRaw = getCorrectedAccelRaw();
+	CorrectedGyroRaw  = getCorrectedGyroRaw();
+
+	pAccelSum->i32XAxis += CorrectedAccelRaw.i16XAxis;
+	pAccelSum->i32YAxis += CorrectedAccelRaw.i16YAxis;
+	pAccelSum->i32ZAxis += CorrectedAccelRaw.i16ZAxis;
+	pGyroSum->i32XAxis  += CorrectedGyroRaw.i16XAxis;
+	pGyroSum->i32YAxis  += CorrectedGyroRaw.i16YAxis;
+	pGyroSum->i32ZAxis  += CorrectedGyroRaw.i16ZAxis;
+}
+
+
+void ICM20948::setMeanValues(const ICM20948_i32Vector_t *pAccelSum, const ICM20948_i32Vector_t *pGyroSum, uint16_t ui16Samples)
+{
+	CorrectedAccelMean.i16XAxis = pAccelSum->i32XAxis / ui16Samples;
+	CorrectedAccelMean.i16YAxis = pAccelSum->i32YAxis / ui16Samples;
+	CorrectedAccelMean.i16ZAxis = pAccelSum->i32ZAxis / ui16Samples;
+	CorrectedGyroMean.i16XAxis  = pGyroSum->i32XAxis  / ui16Samples;
+	CorrectedGyroMean.i16YAxis  = pGyroSum->i32YAxis  / ui16Samples;
+	CorrectedGyroMean.i16ZAxis  = pGyroSum->i32ZAxis  / ui16Samples;
+}
+
+
+int16_t ICM20948::exeCalibration(void)
+{
+	uint8_t ui8Ready; /* Variable counts the calibrated sensor axes
+	                     (its value is 6 if all accelerometer and gyroscope axes are calibrated) */
+
+	uint32_t ui32Debug;
+
+	/* Calculate the CorrectedAccelMean and CorrectedGyroMean values */
+	if (calculateMeanValues() != 0) {return -1;}
+
+	/* Calculate the new AccelOffset and GyroOffset values which are used in the first iteration (i = 0) */
+	startCalibration();
+
+	for (uint8_t i = 0; i < MAX_ITERATIONS; i++)
+	{
+		if (calculateMeanValues() != 0) {return -1;}
+
+		ui8Ready = updateCalibration();
+
+		if (ui8Ready == 6) {
+			ui32Debug = 0;
+			return 0;
+		}
+		ui32Debug = 0;
+	}
+
+	/* If we get here, the calibration process was not successful */
+	ui32Debug = 0;
+
+	return -2;
+}
+
+
+/**
+  @brief  Calculates a single iteration of the calibration procedure
+  @param  ui8Iteration (between 0 and MAX_ITERATIONS-1)
+  @retval  0: All 6 axes are calibrated
+           1: Less than 6 axes are calibrated, but ui8Iteration < MAX_ITERATIONS
+          -1: An error during the function call 'calculateMeanValues' occurred (should not happen)
+          -2: ui8Iteration >= MAX_ITERATIONS --> Calibration not succeeded
+**/
+int16_t ICM20948::exeCalibrationSingleIteration(uint8_t ui8Iteration, uint8_t *pReady)
+{
+	uint8_t ui8Ready; /* Variable counts the calibrated sensor axes
+	                     (its value is 6 if all accelerometer and gyroscope axes are calibrated) */
+	*pReady = 0;
+
+	if (ui8Iteration == 0)
+	{
+		/* Calculate the CorrectedAccelMean and CorrectedGyroMean values */
+		if (calculateMeanValues() != 0) {return -1;}
+
+		/* Calculate the new AccelOffset and GyroOffset values which are used in the first iteration (i = 0) */
+		startCalibration();
+	}
+
+	if (ui8Iteration < MAX_ITERATIONS)
+	{
+		if (calculateMeanValues() != 0) {return -1;}
+
+		ui8Ready = updateCalibration();
+
+		*pReady = ui8Ready;
+
+		if (ui8Ready == 6) {return 0;}
+		else               {return 1;}
+	}
+
+	return -2;
+}
+
+
+/* AccelOffset and GyroOffset of the first calibration iteration from CorrectedAccelMean and CorrectedGyroMean */
+void ICM20948::startCalibration(void)
+{
+	int16_t i16Aux;
+
+	i16Aux = getAccelOneG();
+
+	AccelOffset.i16XAxis = -CorrectedAccelMean.i16XAxis / i16AccelPrec;
+	AccelOffset.i16YAxis = -CorrectedAccelMean.i16YAxis / i16AccelPrec;
+	AccelOffset.i16ZAxis = (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;
+	GyroOffset.i16XAxis  = -CorrectedGyroMean.i16XAxis / i16GyroPrec;
+	GyroOffset.i16YAxis  = -CorrectedGyroMean.i16YAxis / i16GyroPrec;
+	GyroOffset.i16ZAxis  = -CorrectedGyroMean.i16ZAxis / i16GyroPrec;
+	publishGyroOffset();
+}
+
+
+/**
+  @brief  Corrects AccelOffset and GyroOffset with the mean values of the current iteration
+  @retval Number of the calibrated axes (6: all accelerometer and gyroscope axes are calibrated)
+**/
+uint8_t ICM20948::updateCalibration(void)
+{
+	int16_t i16Aux;
+	uint8_t ui8Ready = 0;
+
+	i16Aux = getAccelOneG();
+
+	if (abs(CorrectedAccelMean.i16XAxis) <= i16AccelPrec) {ui8Ready++;}
+	else {AccelOffset.i16XAxis = AccelOffset.i16XAxis - CorrectedAccelMean.i16XAxis / i16AccelPrec;}
+
+	if (abs(CorrectedAccelMean.i16YAxis) <= i16AccelPrec) {ui8Ready++;}
+	else {AccelOffset.i16YAxis = AccelOffset.i16YAxis - CorrectedAccelMean.i16YAxis / i16AccelPrec;}
+
+	if (abs(i16Aux - CorrectedAccelMean.i16ZAxis) <= i16AccelPrec) {ui8Ready++;}
+	else {AccelOffset.i16ZAxis = AccelOffset.i16ZAxis + (i16Aux - CorrectedAccelMean.i16ZAxis) / i16AccelPrec;}
+
+	if (abs(CorrectedGyroMean.i16XAxis) <= i16GyroPrec) {ui8Ready++;}
+	else {GyroOffset.i16XAxis = GyroOffset.i16XAxis - CorrectedGyroMean.i16XAxis / i16GyroPrec;}
+
+	if (abs(CorrectedGyroMean.i16YAxis) <= i16GyroPrec) {ui8Ready++;}
+	else {GyroOffset.i16YAxis = GyroOffset.i16YAxis - CorrectedGyroMean.i16YAxis / i16GyroPrec;}
+
+	if (abs(CorrectedGyroMean.i16ZAxis) <= i16GyroPrec) {ui8Ready++;}
+	else {GyroOffset.i16ZAxis = GyroOffset.i16ZAxis - CorrectedGyroMean.i16ZAxis / i16GyroPrec;}
+	publishGyroOffset();
+
+	return ui8Ready;
+}
+
+
+/**
+  @brief  Executes the next step of the self-test (exeSelfTest(), ICM20948_ASYNC::selfTest())
+  @param  pDelay: Time to wait before the next call [ms]
+  @retval  1: Call again after *pDelay
+           0: Done, pResult is valid
+          -1: Error (the configuration is restored as far as possible)
+**/
+int16_t ICM20948::updateSelfTest(ICM20948_SelfTest_t *pResult, uint32_t *pDelay)
+{
+	ICM20948_i32Vector_t AccelMean;
+	ICM20948_i32Vector_t GyroMean;
+
+	switch (ui8SelfTestStep)
+	{
+	case 0:
+		/* Both sensors must be powered, the FIFO is used by the test */
+		if (ICM20948_SensorConfig.boSleep || ICM20948_SensorConfig.boFifoEnabled || ICM20948_SensorConfig.boDmpEnabled) {return -1;}
+		if (ICM20948_SensorConfig.Profile != ICM20948_PROFILE_FULL &&
+			ICM20948_SensorConfig.Profile != ICM20948_PROFILE_MOTION) {return -1;}
+
+		if (beginEpoch() != 0) {return -1;}
+		if (readBurst(2, ICM20948_GYRO_SMPLRT_DIV, &ui8SelfTestSaved[0], 3, ICM20948_SPEED_READ) != 0) {return -1;}
+		if (readBurst(2, ICM20948_ACCEL_SMPLRT_DIV_1, &ui8SelfTestSaved[3], 6, ICM20948_SPEED_READ) != 0) {return -1;}
+
+		/* From here on an error restores the configuration, the shadows are read again afterwards */
+		ui8SelfTestStep = 1;
+		boShadowValid   = false;
+
+		/* Test conditions without actuation: 1125Hz, 250dps and 2g with DLPF 2 */
+		if (writeRegister8(2, ICM20948_GYRO_SMPLRT_DIV, 0x00) != 0)                                  {break;}
+		if (writeRegister8(2, ICM20948_GYRO_CONFIG_1, ICM20948_DLPF_2 | ICM20948_GYRO_FCHOICE) != 0)   {break;}
+		if (writeRegister8(2, ICM20948_GYRO_CONFIG_2, 0x00) != 0)                                    {break;}
+		if (writeRegister16(2, ICM20948_ACCEL_SMPLRT_DIV_1, 0x0000) != 0)                            {break;}
+		if (writeRegister8(2, ICM20948_ACCEL_CONFIG, ICM20948_DLPF_2 | ICM20948_ACCEL_FCHOICE) != 0)   {break;}
+		if (writeRegister8(2, ICM20948_ACCEL_CONFIG_2, 0x00) != 0)                                   {break;}
+		if (writeRegister8(0, ICM20948_FIFO_MODE, 0x00) != 0)                                        {break;}
+		if (writeRegister8(0, ICM20948_FIFO_EN_2, ICM20948_ACCEL_FIFO_EN | ICM20948_GYRO_FIFO_EN) != 0) {break;}
+		if (setRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_FIFO_EN) != 0)                           {break;}
+
+		*pDelay = ICM20948_ST_SETTLE;
+		return 1;
+
+	case 1:
+	case 3:
+		/* The window starts with an empty FIFO */
+		if (writeRegister8(0, ICM20948_FIFO_RST, ICM20948_FIFO_RESET) != 0) {break;}
+		if (writeRegister8(0, ICM20948_FIFO_RST, 0x00) != 0)                {break;}
+
+		ui8SelfTestStep++;
+		*pDelay = ICM20948_ST_WINDOW;
+		return 1;
+
+	case 2:
+		if (readSelfTestWindow(&SelfTestAccel, &SelfTestGyro) != 0) {break;}
+
+		/* Actuation of all axes of both sensors */
+		if (writeRegister8(2, ICM20948_GYRO_CONFIG_2, ICM20948_GYRO_CTEN) != 0)    {break;}
+		if (writeRegister8(2, ICM20948_ACCEL_CONFIG_2, ICM20948_ACCEL_ST_EN) != 0) {break;}
+
+		ui8SelfTestStep = 3;
+		*pDelay = ICM20948_ST_SETTLE;
+		return 1;
+
+	case 4:
+		if (readSelfTestWindow(&AccelMean, &GyroMean) != 0)          {break;}
+		if (evaluateSelfTest(&AccelMean, &GyroMean, pResult) != 0) {break;}
+
+		return endSelfTest();
+
+	default:
+		break;
+	}
+
+	endSelfTest();
+
+	return -1;
+}
+
+
+/* Means of the first ICM20948_ST_SAMPLES frames in the FIFO (one burst), sensor axes like the factory codes */
+int16_t ICM20948::readSelfTestWindow(ICM20948_i32Vector_t *pAccel, ICM20948_i32Vector_t *pGyro)
+{
+	uint8_t  ui8Raw[ICM20948_ST_SAMPLES * ICM20948_FIFO_FRAME_SIZE];
+	uint16_t ui16Count;
+	ICM20948_Frame_t Frame;
+
+	if (getFifoCount(&ui16Count) != 0) {return -1;}
+
+	/* Less frames: the sensor does not sample */
+	if (ui16Count < sizeof(ui8Raw)) {return -1;}
+
+	if (readBurst(0, ICM20948_FIFO_R_W, ui8Raw, sizeof(ui8Raw), ICM20948_SPEED_BURST) != 0) {return -1;}
+
+	*pAccel = {0, 0, 0};
+	*pGyro  = {0, 0, 0};
+
+	for (uint16_t i = 0; i < ICM20948_ST_SAMPLES; i++)
+	{
+		decodeVector(&ui8Raw[i * ICM20948_FIFO_FRAME_SIZE], ICM20948_SENSOR_FRAME, &Frame.Accel);
+		decodeVector(&ui8Raw[i * ICM20948_FIFO_FRAME_SIZE + 6], ICM20948_SENSOR_FRAME, &Frame.Gyro);
+
+		pAccel->i32XAxis += Frame.Accel.i16XAxis;
+		pAccel->i32YAxis += Frame.Accel.i16YAxis;
+		pAccel->i32ZAxis += Frame.Accel.i16ZAxis;
+		pGyro->i32XAxis  += Frame.Gyro.i16XAxis;
+		pGyro->i32YAxis  += Frame.Gyro.i16YAxis;
+		pGyro->i32ZAxis  += Frame.Gyro.i16ZAxis;
+	}
+
+	pAccel->i32XAxis /= ICM20948_ST_SAMPLES;
+	pAccel->i32YAxis /= ICM20948_ST_SAMPLES;
+	pAccel->i32ZAxis /= ICM20948_ST_SAMPLES;
+	pGyro->i32XAxis  /= ICM20948_ST_SAMPLES;
+	pGyro->i32YAxis  /= ICM20948_ST_SAMPLES;
+	pGyro->i32ZAxis  /= ICM20948_ST_SAMPLES;
+
+	return 0;
+}
+
+
+/* Switches the actuation and the FIFO off and restores the configuration of the sample path */
+int16_t ICM20948::endSelfTest(void)
+{
+	int16_t i16RetValue = 0;
+
+	ui8SelfTestStep = 0;
+
+	if (clearRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_FIFO_EN) != 0)                     {i16RetValue = -1;}
+	if (writeRegister8(0, ICM20948_FIFO_EN_2, 0x00) != 0)                                    {i16RetValue = -1;}
+	if (writeRegister8(0, ICM20948_FIFO_RST, ICM20948_FIFO_RESET) != 0)                      {i16RetValue = -1;}
+	if (writeRegister8(0, ICM20948_FIFO_RST, 0x00) != 0)                                     {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_GYRO_SMPLRT_DIV, ui8SelfTestSaved[0]) != 0)               {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_GYRO_CONFIG_1, ui8SelfTestSaved[1]) != 0)                 {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_GYRO_CONFIG_2, ui8SelfTestSaved[2]) != 0)                 {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_ACCEL_SMPLRT_DIV_1, ui8SelfTestSaved[3]) != 0)            {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_ACCEL_SMPLRT_DIV_2, ui8SelfTestSaved[4]) != 0)            {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_ACCEL_CONFIG, ui8SelfTestSaved[7]) != 0)                  {i16RetValue = -1;}
+	if (writeRegister8(2, ICM20948_ACCEL_CONFIG_2, ui8SelfTestSaved[8]) != 0)                {i16RetValue = -1;}
+
+	/* The samples after the test are transitional */
+	if (commitEpoch() != 0) {i16RetValue = -1;}
+
+	return i16RetValue;
+}
+
+
+/* Compares the responses with the factory responses (SELF_TEST_x codes in user bank 1) */
+int16_t ICM20948::evaluateSelfTest(const ICM20948_i32Vector_t *pAccel, const ICM20948_i32Vector_t *pGyro, ICM20948_SelfTest_t *pResult)
+{
+	uint8_t ui8Code[6];     // Gyroscope X, Y, Z, accelerometer X, Y, Z
+	int32_t i32Response[6];
+	float   fRatio[6];
+	bool    boPass;
+
+	if (readBurst(1, ICM20948_SELF_TEST_X_GYRO, &ui8Code[0], 3, ICM20948_SPEED_READ) != 0)  {return -1;}
+	if (readBurst(1, ICM20948_SELF_TEST_X_ACCEL, &ui8Code[3], 3, ICM20948_SPEED_READ) != 0) {return -1;}
+
+	i32Response[0] = abs(pGyro->i32XAxis  - SelfTestGyro.i32XAxis);
+	i32Response[1] = abs(pGyro->i32YAxis  - SelfTestGyro.i32YAxis);
+	i32Response[2] = abs(pGyro->i32ZAxis  - SelfTestGyro.i32ZAxis);
+	i32Response[3] = abs(pAccel->i32XAxis - SelfTestAccel.i32XAxis);
+	i32Response[4] = abs(pAccel->i32YAxis - SelfTestAccel.i32YAxis);
+	i32Response[5] = abs(pAccel->i32ZAxis - SelfTestAccel.i32ZAxis);
+
+	pResult->ui8GyroPass  = 0;
+	pResult->ui8AccelPass = 0;
+
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		fRatio[i] = 0.0f;
+		if (ui8Code[i] != 0) {fRatio[i] = i32Response[i] / (ICM20948_ST_TRIM_BASE * powf(1.01f, ui8Code[i] - 1));}
+
+		if (i < 3)
+		{
+			boPass = (ui8Code[i] != 0) ? (fRatio[i] >= ICM20948_ST_GYRO_RATIO_MIN) : (i32Response[i] >= ICM20948_ST_GYRO_MIN);
+			if (boPass) {pResult->ui8GyroPass |= (1 << i);}
+		}
+		else
+		{
+			boPass = (ui8Code[i] != 0) ?
+					 (fRatio[i] >= ICM20948_ST_ACCEL_RATIO_MIN && fRatio[i] <= ICM20948_ST_ACCEL_RATIO_MAX) :
+					 (i32Response[i] >= ICM20948_ST_ACCEL_MIN && i32Response[i] <= ICM20948_ST_ACCEL_MAX);
+			if (boPass) {pResult->ui8AccelPass |= (1 << (i - 3));}
+		}
+	}
+
+	pResult->GyroResponse  = {i32Response[0], i32Response[1], i32Response[2]};
+	pResult->AccelResponse = {i32Response[3], i32Response[4], i32Response[5]};
+	pResult->GyroRatio     = {fRatio[0], fRatio[1], fRatio[2]};
+	pResult->AccelRatio    = {fRatio[3], fRatio[4], fRatio[5]};
+
+	return 0;
+}
+
+
+/**
+  @brief  Sets the mounting orientation of this sensor (default ICM20948_MOUNT_X/Y/Z). The offsets are in the
+          board frame and are reset, calibrate or apply a calibration record afterwards.
+  @param  ui8X, ui8Y, ui8Z: ICM20948_AXIS_... of the board X, Y and Z axes
+  @retval  0: OK
+          -1: Not a rotation (orientation not changed)
+**/
+int16_t ICM20948::setMount(uint8_t ui8X, uint8_t ui8Y, uint8_t ui8Z)
+{
+	if (!isValidMount(ui8X, ui8Y, ui8Z)) {return -1;}
+
+	ui8Mount[0] = ui8X;
+	ui8Mount[1] = ui8Y;
+	ui8Mount[2] = ui8Z;
+
+	resetAccelOffset();
+	resetGyroOffset();
+
+	return 0;
+}
+
+
+/**
+  @brief  Copies the current calibration and the sensor configuration it belongs to into pRecord
+**/
+void ICM20948::getCalibrationRecord(ICM20948_CalRecord_t *pRecord)
+{
+	getAccelOffset(&pRecord->AccelOffset);
+	getGyroOffset(&pRecord->GyroOffset);
+
+	pRecord->i16Temperature = getTemperatureRaw();
+
+	pRecord->ui8AccelFullScale = ICM20948_SensorConfig.AccelFullScale.ui8Selection;
+	pRecord->ui8GyroFullScale  = ICM20948_SensorConfig.GyroFullScale.ui8Selection;
+	pRecord->ui16AccelDiv      = ICM20948_SensorConfig.AccelSampleRate.ui16Div;
+	pRecord->ui8GyroDiv        = ICM20948_SensorConfig.GyroSampleRate.ui8Div;
+	pRecord->boAccelFCHOICE    = ICM20948_SensorConfig.AccelSampleRate.boFCHOICE;
+	pRecord->boGyroFCHOICE     = ICM20948_SensorConfig.GyroSampleRate.boFCHOICE;
+	pRecord->AccelDLPF         = ICM20948_SensorConfig.AccelDLPF;
+	pRecord->GyroDLPF          = ICM20948_SensorConfig.GyroDLPF;
+	pRecord->ui8MountX         = ui8Mount[0];
+	pRecord->ui8MountY         = ui8Mount[1];
+	pRecord->ui8MountZ         = ui8Mount[2];
+}
+
+
+/**
+  @brief  Applies the offsets of a stored calibration record
+  @retval  0: Offsets applied
+          -1: The record was made with a different sensor configuration or mounting orientation
+              (offsets not applied)
+**/
+int16_t ICM20948::setCalibrationRecord(const ICM20948_CalRecord_t *pRecord)
+{
+	if (pRecord->ui8AccelFullScale != ICM20948_SensorConfig.AccelFullScale.ui8Selection ||
+		pRecord->ui8GyroFullScale  != ICM20948_SensorConfig.GyroFullScale.ui8Selection  ||
+		pRecord->ui16AccelDiv      != ICM20948_SensorConfig.AccelSampleRate.ui16Div     ||
+		pRecord->ui8GyroDiv        != ICM20948_SensorConfig.GyroSampleRate.ui8Div       ||
+		pRecord->boAccelFCHOICE    != ICM20948_SensorConfig.AccelSampleRate.boFCHOICE   ||
+		pRecord->boGyroFCHOICE     != ICM20948_SensorConfig.GyroSampleRate.boFCHOICE    ||
+		pRecord->AccelDLPF         != ICM20948_SensorConfig.AccelDLPF                   ||
+		pRecord->GyroDLPF          != ICM20948_SensorConfig.GyroDLPF                    ||
+		pRecord->ui8MountX         != ui8Mount[0]                                       ||
+		pRecord->ui8MountY         != ui8Mount[1]                                       ||
+		pRecord->ui8MountZ         != ui8Mount[2])
+	{
+		return -1;
+	}
+
+	setAccelOffset(pRecord->AccelOffset);
+	setGyroOffset(pRecord->GyroOffset);
+
+	return 0;
+}
+
+
+/**
+  @brief  Quick check of the current offsets with a short mean value window (sensor must be at rest, board +Z up)
+  @param  ui16Samples: Number of samples of the mean value window
+  @retval  0: All 6 axes are within ICM20948_CALCHECK_FACTOR times the calibration precision
+           1: At least one axis is out of tolerance --> exeCalibration() is required
+          -1: An error during the function call 'calculateMeanValues' occurred
+**/
+int16_t ICM20948::checkCalibration(uint16_t ui16Samples)
+{
+	int16_t i16AccelTol = ICM20948_CALCHECK_FACTOR * i16AccelPrec;
+	int16_t i16GyroTol  = ICM20948_CALCHECK_FACTOR * i16GyroPrec;
+
+	if (calculateMeanValues(ui16Samples, SAMPLES_QUICK_SKIP) != 0) {return -1;}
+
+	if (abs(CorrectedAccelMean.i16XAxis) > i16AccelTol)                  {return 1;}
+	if (abs(CorrectedAccelMean.i16YAxis) > i16AccelTol)                  {return 1;}
+	if (abs(getAccelOneG() - CorrectedAccelMean.i16ZAxis) > i16AccelTol) {return 1;}
+	if (abs(CorrectedGyroMean.i16XAxis) > i16GyroTol)                    {return 1;}
+	if (abs(CorrectedGyroMean.i16YAxis) > i16GyroTol)                    {return 1;}
+	if (abs(CorrectedGyroMean.i16ZAxis) > i16GyroTol)                    {return 1;}
+
+	return 0;
+}
+
+
+/**
+  @brief  Self-test of all 6 axes: both sensors are actuated at the same time and measured with two FIFO windows of
+          ICM20948_ST_SAMPLES frames at 1125Hz, 250dps and 2g (without and with actuation, approx. 75ms). The
+          configuration is restored afterwards, the following samples are marked as transitional. Directly after
+          init() the first settling time coincides with the start-up time of the gyroscope that the first samples
+          need anyway. ICM20948_ASYNC::selfTest() suspends during the settling times and windows.
+  @param  pResult: Responses, ratios to the factory responses and the axes that passed
+  @retval  0: All 6 axes passed
+           1: At least one axis failed (see pResult)
+          -1: Sleep mode, a sensor is off (acquisition profile), FIFO or DMP enabled, no samples or bus error
+**/
+int16_t ICM20948::exeSelfTest(ICM20948_SelfTest_t *pResult)
+{
+	uint32_t ui32Delay;
+	uint32_t ui32StartTicks;
+	int16_t  i16RetValue;
+
+	while ((i16RetValue = updateSelfTest(pResult, &ui32Delay)) == 1)
+	{
+		ui32StartTicks = get_Ticks();
+		while(get_Ticks() < (ui32StartTicks + ui32Delay));
+	}
+
+	if (i16RetValue != 0) {return -1;}
+
+	return (pResult->ui8AccelPass == ICM20948_ST_ALL && pResult->ui8GyroPass == ICM20948_ST_ALL) ? 0 : 1;
+}
+
+
+/**
+  @brief  Takes a snapshot of all configuration registers (banks 0...3) and of the driver state
+  @retval  0: OK
+          -1: SPI error
+**/
+int16_t ICM20948::takeSnapshot(ICM20948_RegSnapshot_t *pSnapshot)
+{
+	uint8_t ui8Index = 0;
+
+	/* Zero padding bytes as well, they are covered by the CRC */
+	memset(pSnapshot, 0, sizeof(ICM20948_RegSnapshot_t));
+
+	for (uint8_t i = 0; i < ICM20948_REG_BLOCK_COUNT; i++)
+	{
+		if (readBurst(ICM20948_REG_BLOCKS[i].ui8Bank, ICM20948_REG_BLOCKS[i].ui8StartAddr,
+				      &pSnapshot->ui8Register[ui8Index], ICM20948_REG_BLOCKS[i].ui8Length, ICM20948_SPEED_READ) != 0) {return -1;}
+		ui8Index += ICM20948_REG_BLOCKS[i].ui8Length;
+	}
+
+	pSnapshot->SensorConfig = ICM20948_SensorConfig;
+	pSnapshot->AccelOffset  = AccelOffset;
+	pSnapshot->GyroOffset   = GyroOffset;
+	pSnapshot->i16AccelPrec = i16AccelPrec;
+	pSnapshot->i16GyroPrec  = i16GyroPrec;
+	pSnapshot->ui32CRC      = calcSnapshotCRC(pSnapshot);
+
+	if (switchBank(0) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/**
+  @brief  Compares the live configuration registers with the snapshot and writes only the differing registers
+  @param  pRestored: Number of restored registers
+  @retval  0: OK
+          -1: SPI error or invalid snapshot (CRC)
+**/
+int16_t ICM20948::restoreSnapshot(const ICM20948_RegSnapshot_t *pSnapshot, uint8_t *pRestored)
+{
+	uint8_t ui8Live[ICM20948_SNAPSHOT_SIZE];
+	uint8_t ui8Index = 0;
+	uint8_t ui8Addr;
+
+	*pRestored = 0;
+
+	if (pSnapshot->ui32CRC != calcSnapshotCRC(pSnapshot)) {return -1;}
+
+	boShadowValid = false;
+
+	for (uint8_t i = 0; i < ICM20948_REG_BLOCK_COUNT; i++)
+	{
+		if (readBurst(ICM20948_REG_BLOCKS[i].ui8Bank, ICM20948_REG_BLOCKS[i].ui8StartAddr,
+				      &ui8Live[ui8Index], ICM20948_REG_BLOCKS[i].ui8Length, ICM20948_SPEED_READ) != 0) {return -1;}
+
+		for (uint8_t j = 0; j < ICM20948_REG_BLOCKS[i].ui8Length; j++)
+		{
+			if ((ICM20948_REG_BLOCKS[i].ui32Mask & (1UL << j)) && ui8Live[ui8Index + j] != pSnapshot->ui8Register[ui8Index + j])
+			{
+				ui8Addr = ICM20948_REG_BLOCKS[i].ui8StartAddr + j;
+				if (writeRegister8(ICM20948_REG_BLOCKS[i].ui8Bank, ui8Addr, pSnapshot->ui8Register[ui8Index + j]) != 0) {return -1;}
+				(*pRestored)++;
+			}
+		}
+		ui8Index += ICM20948_REG_BLOCKS[i].ui8Length;
+	}
+
+	if (switchBank(0) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/* Returns true if the sensor was re-initialized from a snapshot (no DEVICE_RESET) */
+bool ICM20948::isWarmStart(void)
+{
+	return boWarmStart;
+}
+
+
+/**
+  @brief  Sets the SPI baud rate prescalers of the speed classes (only used with ICM20948_SPI_SPEED_PROFILES)
+  @param  ui16Config: Register writes and bank switches (max. 1 MHz)
+          ui16Read:   Configuration register reads (max. 1 MHz)
+          ui16Burst:  Sensor data bursts (max. 7 MHz)
+**/
+void ICM20948::setBusSpeedProfile(uint16_t ui16Config, uint16_t ui16Read, uint16_t ui16Burst)
+{
+	Bus.setSpeedProfile(ui16Config, ui16Read, ui16Burst);
+}
+
+
+// Debug methods
+int16_t ICM20948::setDebugFunction8(uint8_t ui8Data)
+{
+	if (writeRegister8(1, ICM20948_XA_OFFS_H, ui8Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
+
+	return 0;
+}
+
+
+int16_t ICM20948::setDebugFunction16(uint16_t ui16Data)
+{
+	if (writeRegister16(1, ICM20948_XA_OFFS_H, ui16Data) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
+
+	return 0;
+}
+
+
+int16_t ICM20948::getDebugFunction16(uint16_t *pData)
+{
+	if (readRegister16(1, ICM20948_XA_OFFS_H, pData) != 0) {return -1;}
+	if (switchBank(0) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/* Private methods */
+ICM20948_RetCode_t ICM20948::init(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+		                          ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR,
+								  ICM20948_DLPF_t DLPF)
+{
+	uint32_t ui32StartTicks;
+
+	if (initReset() != ICM20948_RET_OK) {return ICM20948_GEN_FAIL;}
+
+	/* It is not specified in datasheet how long to wait after reset, but we wait 10ms and check DEVICE_RESET bit */
+	ui32StartTicks = get_Ticks();
+	while(get_Ticks() < (ui32StartTicks + ICM20948_RESET_DELAY)); // Delay of approximately 10ms (9...11ms)
+
+	if (initWake() != ICM20948_RET_OK) {return ICM20948_GEN_FAIL;}
+
+	/* We wait a few milliseconds, otherwise the I2C_IF_DIS bit was not set in SPI mode */
+	ui32StartTicks = get_Ticks();
+	while(get_Ticks() < (ui32StartTicks + ICM20948_WAKE_DELAY)); // Delay of approximately 4ms (3...5ms)
+
+	return initConfig(ACCEL_FS, GYRO_FS, ACCEL_SR, GYRO_SR, DLPF);
+}
+
+
+/* First step of init(): checks WHO_AM_I and resets the sensor (ICM20948_RESET_DELAY before initWake()) */
+ICM20948_RetCode_t ICM20948::initReset(void)
+{
+	uint8_t ui8Data;
+	int16_t i16RetValue;
+
+	ICM20948_SensorConfig.boStatusOK = false;
+	ICM20948_SensorConfig.boSleep    = true;
+	boShadowValid   = false;
+	ui8SelfTestStep = 0;
+
+	/* In cases where the sensor is already used and a controller reset occurs, the currently selected
+	 * USER_BANK[1:0] in register ICM20948_REG_BANK_SEL is unknown.
+	 * Therefore, we reset USER_BANK[1:0] in register ICM20948_REG_BANK_SEL --> ui8CurrentBank = 0 */
+	if (resetBank() != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Check ICM20948 WHO_AM_I register */
+	i16RetValue = readRegister8(0, ICM20948_WHO_AM_I, &ui8Data);
+	if (i16RetValue != 0 || ui8Data != ICM20948_WHO_AM_I_VALUE) {return ICM20948_GEN_FAIL;}
+
+	/* Reset ICM20948 device (see datasheet p. 37)
+	 * - Write a 1 to DEVICE_RESET bit to set the reset, the bit will auto clear
+	 * - SLEEP = 1       --> Chip is in sleep mode
+	 * - CLKSEL[2:0] = 1 --> Auto select the best available clock source - PLL if ready, else use the internal oscillator */
+	if (writeRegister8(0, ICM20948_PWR_MGMT_1, ICM20948_DEVICE_RESET) != 0) {return ICM20948_GEN_FAIL;}
+
+	return ICM20948_RET_OK;
+}
+
+
+/* Second step of init(): checks the reset, sets the defaults and wakes up the sensor (ICM20948_WAKE_DELAY before initConfig()) */
+ICM20948_RetCode_t ICM20948::initWake(void)
+{
+	uint8_t ui8Data;
+
+	/* Check if DEVICE_RESET bit is cleared */
+	if (readRegister8(0, ICM20948_PWR_MGMT_1, &ui8Data) != 0) {return ICM20948_GEN_FAIL;}
+	if ((ui8Data & ICM20948_DEVICE_RESET) != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Initialization of ui8DataArray[] */
+	for (uint8_t i = 0; i < 14; i++)
+	{
+		ui8DataArray[i] = 0x00;
+	}
+
+	/* Initialization of AccelOffset and GyroOffset */
+	resetAccelOffset();
+	resetGyroOffset();
+
+	/* Default SensorConfig values after reset */
+	ICM20948_SensorConfig.boFifoEnabled   = false;
+	ICM20948_SensorConfig.boDmpEnabled    = false;
+	ICM20948_SensorConfig.Profile         = ICM20948_PROFILE_FULL;
+	ICM20948_SensorConfig.AccelFullScale  = ACCEL_FS_2G;
+	ICM20948_SensorConfig.AccelSampleRate = ACCEL_SR_1125_HZ;
+	ICM20948_SensorConfig.AccelDLPF       = ICM20948_DLPF_0;
+	ICM20948_SensorConfig.GyroFullScale   = GYRO_FS_250DPS;
+	ICM20948_SensorConfig.GyroSampleRate  = GYRO_SR_1125_HZ;
+	ICM20948_SensorConfig.GyroDLPF        = ICM20948_DLPF_0;
+	ICM20948_SensorConfig.Fsync           = ICM20948_FSYNC_OFF;
+	resetEpochs();
+	setBurstWindow();
+	boLatestReady   = false;
+	boDmpLoaded     = false;
+	ui16DmpBuffered = 0;
+	DmpAccelFullScale = ICM20948_SensorConfig.AccelFullScale;
+	DmpGyroFullScale  = ICM20948_SensorConfig.GyroFullScale;
+	ui16FsyncDelay  = 0;
+	ui32TrackHz     = 0;
+	boDataRepeated  = false;
+
+	/* Clear SLEEP bit to wake up the chip from sleep mode */
+	if (sleep(false) != 0) {return ICM20948_GEN_FAIL;}
+
+	return ICM20948_RET_OK;
+}
+
+
+/* Last step of init(): interface, full scale ranges, sample rates and DLPF */
+ICM20948_RetCode_t ICM20948::initConfig(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+		                                ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR,
+										ICM20948_DLPF_t DLPF)
+{
+	uint8_t ui8Data;
+
+	if (ICM20948_SensorConfig.boUseSPI)
+	{
+		/* Set I2C_IF_DIS bit to prevent switching into I2C mode when using SPI (datasheet p. 28) */
+		if (setRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_I2C_IF_DIS) != 0) {return ICM20948_GEN_FAIL;}
+		if (readRegister8(0, ICM20948_USER_CTRL, &ui8Data) != 0) {return ICM20948_GEN_FAIL;}
+		if ((ui8Data & ICM20948_I2C_IF_DIS) != ICM20948_I2C_IF_DIS) {return ICM20948_GEN_FAIL;}
+	}
+
+	/* Set full scale range of accelerometer and gyroscope */
+	if (setAccelFullScale(ACCEL_FS) != 0) {return ICM20948_GEN_FAIL;}
+	if (setGyroFullScale(GYRO_FS) != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Set sample rate */
+	if (setAccelSampleRate(ACCEL_SR) != 0) {return ICM20948_GEN_FAIL;}
+	if (setGyroSampleRate(GYRO_SR) != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Set DLPF */
+	if (setAccelDLPF(DLPF) != 0) {return ICM20948_GEN_FAIL;}
+	if (setGyroDLPF(DLPF) != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Use default value for maximum calibration error */
+	i16AccelPrec = ICM20948_ACCEL_PREC;
+	i16GyroPrec  = ICM20948_GYRO_PREC;
+
+	/* No error occurred */
+	ICM20948_SensorConfig.boStatusOK = true;
+
+	return ICM20948_RET_OK;
+}
+
+
+/* Raw accelerometer value of 1g for the current full scale range */
+inline int16_t ICM20948::getAccelOneG(void)
+{
+	if      (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_2G.ui8Selection) {return 16384;}
+	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_4G.ui8Selection) {return  8192;}
+	else if (ICM20948_SensorConfig.AccelFullScale.ui8Selection == ACCEL_FS_8G.ui8Selection) {return  4096;}
+	else                                                                                    {return  2048;}
+}
+
+
+/* Warm restart from a snapshot. It fails if the sensor was reset in the meantime (SLEEP bit set while the
+ * snapshot was taken in normal mode), because waking up requires the delays of init(). */
+ICM20948_RetCode_t ICM20948::warmInit(const ICM20948_RegSnapshot_t *pSnapshot)
+{
+	uint8_t ui8Data;
+	uint8_t ui8Restored;
+	int16_t i16RetValue;
+
+	ICM20948_SensorConfig.boStatusOK = false;
+
+	if (pSnapshot->ui32CRC != calcSnapshotCRC(pSnapshot)) {return ICM20948_INV_PARAM;}
+
+	/* The currently selected USER_BANK[1:0] is unknown after a controller reset */
+	if (resetBank() != 0) {return ICM20948_GEN_FAIL;}
+
+	/* Check ICM20948 WHO_AM_I register */
+	i16RetValue = readRegister8(0, ICM20948_WHO_AM_I, &ui8Data);
+	if (i16RetValue != 0 || ui8Data != ICM20948_WHO_AM_I_VALUE) {return ICM20948_GEN_FAIL;}
+
+	/* PWR_MGMT_1 is the third register of the first block */
+	if (readRegister8(0, ICM20948_PWR_MGMT_1, &ui8Data) != 0) {return ICM20948_GEN_FAIL;}
+	if ((ui8Data & ICM20948_SLEEP) && !(pSnapshot->ui8Register[2] & ICM20948_SLEEP)) {return ICM20948_INV_CONFIG;}
+
+	if (restoreSnapshot(pSnapshot, &ui8Restored) != 0) {return ICM20948_GEN_FAIL;}
+
+	for (uint8_t i = 0; i < 14; i++)
+	{
+		ui8DataArray[i] = 0x00;
+	}
+
+	ICM20948_SensorConfig = pSnapshot->SensorConfig;
+	AccelOffset  = pSnapshot->AccelOffset;
+	GyroOffset   = pSnapshot->GyroOffset;
+	i16AccelPrec = pSnapshot->i16AccelPrec;
+	i16GyroPrec  = pSnapshot->i16GyroPrec;
+	publishGyroOffset();
+	resetEpochs();
+	setBurstWindow();
+	boLatestReady   = false;
+	ui16FsyncDelay  = 0;
+	ui32TrackHz     = 0;
+	boDataRepeated  = false;
+	ui8SelfTestStep = 0;
+
+	/* The DMP memory survives a reset of the MCU, a running DMP proves the firmware is loaded */
+	boDmpLoaded     = ICM20948_SensorConfig.boDmpEnabled;
+	ui16DmpBuffered = 0;
+	DmpAccelFullScale = ICM20948_SensorConfig.AccelFullScale; // The scales before the DMP are not in the snapshot
+	DmpGyroFullScale  = ICM20948_SensorConfig.GyroFullScale;
+
+	ICM20948_SensorConfig.boStatusOK = true;
+
+	return ICM20948_RET_OK;
+}
+
+
+uint32_t ICM20948::calcSnapshotCRC(const ICM20948_RegSnapshot_t *pSnapshot)
+{
+	CHECKSUM Checksum;
+
+	return Checksum.calcCRC32((const uint8_t *)pSnapshot, offsetof(ICM20948_RegSnapshot_t, ui32CRC));
+}
+
+
+/* Derives the burst window from the acquisition profile, the data of the sensors outside the window is cleared */
+void ICM20948::setBurstWindow(void)
+{
+	const ICM20948_ProfileCfg_t *pCfg = &ICM20948_PROFILES[ICM20948_SensorConfig.Profile];
+
+	ui8BurstOffset = pCfg->ui8Offset;
+	ui8BurstLength = pCfg->ui8Length;
+
+	for (uint8_t i = 0; i < 14; i++)
+	{
+		if (i < ui8BurstOffset || i >= ui8BurstOffset + ui8BurstLength) {ui8DataArray[i] = 0x00;}
+	}
+}
 
-	/* In cases where the sensor is already used and a controller reset occurs, the currently selected
-	 * USER_BANK[1:0] in register ICM20948_REG_BANK_SEL is unknown.
-	 * Therefore, we reset USER_BANK[1:0] in register ICM20948_REG_BANK_SEL --> ui8CurrentBank = 0 */
-	if (resetBank() != 0) {return ICM20948_GEN_FAIL;}
 
-	/* Check ICM20948 WHO_AM_I register */
-	i16RetValue = readRegister8(0, ICM20948_WHO_AM_I, &ui8Data);
-	if (i16RetValue != 0 || ui8Data != ICM20948_WHO_AM_I_VALUE) {return ICM20948_GEN_FAIL;}
+/* Starts the epoch history at the current configuration */
+void ICM20948::resetEpochs(void)
+{
+	ui8Epoch = 0;
 
-	/* Reset ICM20948 device (see datasheet p. 37)
-	 * - Write a 1 to DEVICE_RESET bit to set the reset, the bit will auto clear
-	 * - SLEEP = 1       --> Chip is in sleep mode
-	 * - CLKSEL[2:0] = 1 --> Auto select the best available clock source - PLL if ready, else use the internal oscillator */
-	if (writeRegister8(0, ICM20948_PWR_MGMT_1, ICM20948_DEVICE_RESET) != 0) {return ICM20948_GEN_FAIL;}
+	for (uint8_t i = 0; i < ICM20948_EPOCH_HISTORY; i++)
+	{
+		EpochConfig[i].ui8Epoch = ui8Epoch + 1; // Invalid
+		ui16EpochFrames[i]      = 0;
+	}
 
-	/* It is not specified in datasheet how long to wait after reset, but we wait 10ms and check DEVICE_RESET bit */
-	ui32StartTicks = get_Ticks();
-	while(get_Ticks() < (ui32StartTicks + 10)); // Delay of approximately 10ms (9...11ms)
+	EpochConfig[0].ui8Epoch          = ui8Epoch;
+	EpochConfig[0].ui8Range          = ICM20948_RANGE(ICM20948_SensorConfig.AccelFullScale, ICM20948_SensorConfig.GyroFullScale);
+	EpochConfig[0].fAccelSensitivity = ICM20948_SensorConfig.AccelFullScale.fSensitivity;
+	EpochConfig[0].fGyroSensitivity  = ICM20948_SensorConfig.GyroFullScale.fSensitivity;
+
+	ui16FifoFramesAtChange = 0;
+	ui8FifoEpoch      = ui8Epoch;
+	ui8FifoSettle     = 0;
+	ui8RegisterSettle = 0;
+	ui8DataEpoch      = ui8Epoch;
+	ui8DataFlags      = 0;
+	ui8RateRatio      = 0;
+}
 
-	/* Check if DEVICE_RESET bit is cleared */
-	if (readRegister8(0, ICM20948_PWR_MGMT_1, &ui8Data) != 0) {return ICM20948_GEN_FAIL;}
-	if ((ui8Data & ICM20948_DEVICE_RESET) != 0) {return ICM20948_GEN_FAIL;}
 
-	/* Initialization of ui8DataArray[] */
-	for (uint8_t i = 0; i < 14; i++)
+/* Called before a configuration register is changed: all frames that are in the FIFO at this point were
+ * captured under the current configuration (a partially written frame is counted as well) */
+int16_t ICM20948::beginEpoch(void)
+{
+	uint16_t ui16Bytes = 0;
+
+	if (ICM20948_SensorConfig.boFifoEnabled)
 	{
-		ui8DataArray[i] = 0x00;
+		if (getFifoCount(&ui16Bytes) != 0) {return -1;}
 	}
 
-	/* Initialization of AccelOffset and GyroOffset */
-	resetAccelOffset();
-	resetGyroOffset();
+	ui16FifoFramesAtChange = (ui16Bytes + ICM20948_FIFO_FRAME_SIZE - 1) / ICM20948_FIFO_FRAME_SIZE;
 
-	/* Default SensorConfig values after reset */
-	ICM20948_SensorConfig.AccelFullScale  = ACCEL_FS_2G;
-	ICM20948_SensorConfig.AccelSampleRate = ACCEL_SR_1125_HZ;
-	ICM20948_SensorConfig.AccelDLPF       = ICM20948_DLPF_0;
-	ICM20948_SensorConfig.GyroFullScale   = GYRO_FS_250DPS;
-	ICM20948_SensorConfig.GyroSampleRate  = GYRO_SR_1125_HZ;
-	ICM20948_SensorConfig.GyroDLPF        = ICM20948_DLPF_0;
+	return 0;
+}
 
-	/* Clear SLEEP bit to wake up the chip from sleep mode */
-	if (sleep(false) != 0) {return ICM20948_GEN_FAIL;}
 
-	/* We wait a few milliseconds, otherwise the I2C_IF_DIS bit was not set in SPI mode */
-	ui32StartTicks = get_Ticks();
-	while(get_Ticks() < (ui32StartTicks + 4)); // Delay of approximately 4ms (3...5ms)
-	if (ICM20948_SensorConfig.boUseSPI)
+/* Called after the configuration register was changed: starts a new epoch. Frames written between
+ * beginEpoch() and the register access are counted to the new epoch and marked as transitional. If the FIFO
+ * holds more epochs than the history can convert, it is flushed. */
+int16_t ICM20948::commitEpoch(void)
+{
+	uint8_t  ui8Old = ui8Epoch;
+	uint16_t ui16Pending = 0;
+
+	/* The configuration registers are written, the sample path expects user bank 0 */
+	if (switchBank(0) != 0) {return -1;}
+
+	for (uint8_t e = ui8FifoEpoch; e != ui8Old; e++)
 	{
-		/* Set I2C_IF_DIS bit to prevent switching into I2C mode when using SPI (datasheet p. 28) */
-		if (setRegister8Bit(0, ICM20948_USER_CTRL, ICM20948_I2C_IF_DIS) != 0) {return ICM20948_GEN_FAIL;}
-		if (readRegister8(0, ICM20948_USER_CTRL, &ui8Data) != 0) {return ICM20948_GEN_FAIL;}
-		if ((ui8Data & ICM20948_I2C_IF_DIS) != ICM20948_I2C_IF_DIS) {return ICM20948_GEN_FAIL;}
+		ui16Pending += ui16EpochFrames[e & (ICM20948_EPOCH_HISTORY - 1)];
 	}
 
-	/* Set full scale range of accelerometer and gyroscope */
-	if (setAccelFullScale(ACCEL_FS) != 0) {return ICM20948_GEN_FAIL;}
-	if (setGyroFullScale(GYRO_FS) != 0) {return ICM20948_GEN_FAIL;}
+	ui8Epoch++;
+	EpochConfig[ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)].ui8Epoch          = ui8Epoch;
+	EpochConfig[ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)].ui8Range          =
+			ICM20948_RANGE(ICM20948_SensorConfig.AccelFullScale, ICM20948_SensorConfig.GyroFullScale);
+	EpochConfig[ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)].fAccelSensitivity = ICM20948_SensorConfig.AccelFullScale.fSensitivity;
+	EpochConfig[ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)].fGyroSensitivity  = ICM20948_SensorConfig.GyroFullScale.fSensitivity;
+	ui16EpochFrames[ui8Epoch & (ICM20948_EPOCH_HISTORY - 1)] = 0;
 
-	/* Set sample rate */
-	if (setAccelSampleRate(ACCEL_SR) != 0) {return ICM20948_GEN_FAIL;}
-	if (setGyroSampleRate(GYRO_SR) != 0) {return ICM20948_GEN_FAIL;}
+	ui8RegisterSettle = ICM20948_EPOCH_SETTLE;
+	ui8RateRatio      = 0; // The multi-rate mode ends with a configuration change
 
-	/* Set DLPF */
-	if (setAccelDLPF(DLPF) != 0) {return ICM20948_GEN_FAIL;}
-	if (setGyroDLPF(DLPF) != 0) {return ICM20948_GEN_FAIL;}
+	if (ui32TrackHz != 0) {anchorContinuity();}
 
-	/* Use default value for maximum calibration error */
-	i16AccelPrec = ICM20948_ACCEL_PREC;
-	i16GyroPrec  = ICM20948_GYRO_PREC;
+	if (!ICM20948_SensorConfig.boFifoEnabled)
+	{
+		ui8FifoEpoch  = ui8Epoch;
+		ui8FifoSettle = 0;
+		return 0;
+	}
 
-	/* No error occurred */
-	ICM20948_SensorConfig.boStatusOK = true;
+	if ((uint8_t)(ui8Epoch - ui8FifoEpoch) >= ICM20948_EPOCH_HISTORY)
+	{
+		if (resetFifo() != 0) {return -1;}
+		ui8FifoSettle = ICM20948_EPOCH_SETTLE;
+		return 0;
+	}
 
-	return ICM20948_RET_OK;
+	ui16EpochFrames[ui8Old & (ICM20948_EPOCH_HISTORY - 1)] =
+			(ui16FifoFramesAtChange > ui16Pending) ? (ui16FifoFramesAtChange - ui16Pending) : 0;
+
+	return 0;
 }
 
 
-int16_t ICM20948::resetBank(void)
+/* Publishes the working copy of the gyro offset (sequence lock, single writer, wait-free). The counter is odd
+ * while the current words are written, the fences keep the data stores between the two counter stores. The
+ * previous publication stays in the second pair of words until the counter is even again, so a reader that
+ * interrupts the writer reads that one instead of waiting for a write that cannot finish. */
+void ICM20948::publishGyroOffset(void)
+{
+	const uint32_t ui32XY = (uint32_t)(uint16_t)GyroOffset.i16XAxis | ((uint32_t)(uint16_t)GyroOffset.i16YAxis << 16);
+	const uint32_t ui32Z  = (uint16_t)GyroOffset.i16ZAxis;
+	uint32_t ui32Seq = ui32GyroOffsetSequence.load(std::memory_order_relaxed);
+
+	ui32GyroOffsetSequence.store(ui32Seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	ui32GyroOffsetXY.store(ui32XY, std::memory_order_relaxed);
+	ui32GyroOffsetZ.store(ui32Z, std::memory_order_relaxed);
+
+	ui32GyroOffsetSequence.store(ui32Seq + 2, std::memory_order_release);
+
+	/* Readers only use the previous copy while the counter is odd */
+	std::atomic_thread_fence(std::memory_order_release);
+	ui32GyroOffsetLastXY.store(ui32XY, std::memory_order_relaxed);
+	ui32GyroOffsetLastZ.store(ui32Z, std::memory_order_relaxed);
+}
+
+
+/* Returns a copy of the published gyro offset, the axes always belong to the same publication. While a write is
+ * in progress (odd counter), the previous publication is returned: a reader that interrupts the writer on the same
+ * core (e.g. correctGyro() in an ISR of higher priority than setGyroOffset()) succeeds with the first attempt.
+ * Only a writer on another core that publishes continuously can exhaust ICM20948_GYRO_OFFSET_RETRIES, the last
+ * copy is returned then (each word of one publication). */
+ICM20948_i16Vector_t ICM20948::loadGyroOffset(void)
+{
+	ICM20948_i16Vector_t Offset;
+	uint32_t ui32Seq1, ui32Seq2, ui32XY, ui32Z;
+
+	for (uint8_t ui8Attempt = 0; ui8Attempt < ICM20948_GYRO_OFFSET_RETRIES; ui8Attempt++)
+	{
+		ui32Seq1 = ui32GyroOffsetSequence.load(std::memory_order_acquire);
+
+		if (ui32Seq1 & 1)
+		{
+			ui32XY = ui32GyroOffsetLastXY.load(std::memory_order_relaxed);
+			ui32Z  = ui32GyroOffsetLastZ.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			ui32XY = ui32GyroOffsetXY.load(std::memory_order_relaxed);
+			ui32Z  = ui32GyroOffsetZ.load(std::memory_order_relaxed);
+		}
+
+		/* The fence keeps the data loads ahead of the second counter load */
+		std::atomic_thread_fence(std::memory_order_acquire);
+		ui32Seq2 = ui32GyroOffsetSequence.load(std::memory_order_relaxed);
+
+		if (ui32Seq1 == ui32Seq2) {break;}
+	}
+
+	Offset.i16XAxis = (int16_t)(ui32XY & 0xFFFF);
+	Offset.i16YAxis = (int16_t)(ui32XY >> 16);
+	Offset.i16ZAxis = (int16_t)(ui32Z & 0xFFFF);
+
+	return Offset;
+}
+
+
+/* Starts the model of the continuity tracking now with the sample rate of the faster powered sensor */
+void ICM20948::anchorContinuity(void)
+{
+	const ICM20948_AccelSampleRate_t *pAccelSR = &ICM20948_SensorConfig.AccelSampleRate;
+	const ICM20948_GyroSampleRate_t  *pGyroSR  = &ICM20948_SensorConfig.GyroSampleRate;
+	uint32_t ui32Num, ui32Den;
+
+	/* Rates as fractions: 4500Hz / 9000Hz without DLPF, 1125Hz / (1 + divider) with DLPF */
+	ui32TrackRateNum = pAccelSR->boFCHOICE ? 1125 : pAccelSR->ui16Value;
+	ui32TrackRateDen = pAccelSR->boFCHOICE ? (pAccelSR->ui16Div + 1) : 1;
+	ui32Num = pGyroSR->boFCHOICE ? 1125 : pGyroSR->ui16Value;
+	ui32Den = pGyroSR->boFCHOICE ? (pGyroSR->ui8Div + 1) : 1;
+
+	if (ICM20948_SensorConfig.Profile == ICM20948_PROFILE_GYRO ||
+		(ICM20948_SensorConfig.Profile != ICM20948_PROFILE_ACCEL && ui32Num * ui32TrackRateDen > ui32TrackRateNum * ui32Den))
+	{
+		ui32TrackRateNum = ui32Num;
+		ui32TrackRateDen = ui32Den;
+	}
+
+	ui32TrackLast     = pTrackTimestamp();
+	ui64TrackPhase    = 0;
+	ui32TrackExpected = 0;
+	ui32TrackCount    = 0;
+}
+
+
+/* Compares the samples expected at ui32Time with the delivered ones and the ones still pending (FIFO).
+ * ui32Time must be taken before the data was read: every sample expected up to then was readable. */
+void ICM20948::checkContinuity(uint32_t ui32Time, uint16_t ui16Delivered, uint16_t ui16Pending)
+{
+	uint64_t ui64Period = (uint64_t)ui32TrackHz * ui32TrackRateDen; // Sample period in units of ui64TrackPhase
+	uint32_t ui32Elapsed;
+	uint32_t ui32Have;
+
+	/* Unsigned differences are correct across a wrap-around of the time base */
+	ui64TrackPhase += (uint64_t)(ui32Time - ui32TrackLast) * ui32TrackRateNum;
+	ui32TrackLast   = ui32Time;
+
+	ui32Elapsed        = ui64TrackPhase / ui64Period;
+	ui64TrackPhase    -= ui32Elapsed * ui64Period;
+	ui32TrackExpected += ui32Elapsed;
+
+	ui32TrackCount += ui16Delivered;
+	ui32Have = ui32TrackCount + ui16Pending;
+
+	if ((int32_t)(ui32Have - ui32TrackExpected) > 0)
+	{
+		/* The sensor is ahead of the model (phase of the first sample, clock tolerance): the sample just arrived */
+		ui32TrackExpected = ui32Have;
+		ui64TrackPhase    = 0;
+	}
+	else if (ui32Have != ui32TrackExpected)
+	{
+		/* The lost samples precede the delivered ones */
+		ContinuityStats.ui32Missed += ui32TrackExpected - ui32Have;
+		logGap(ui32Time, ICM20948_GAP_MISSED, (ui32TrackExpected - ui32Have > 0xFFFF) ? 0xFFFF : (ui32TrackExpected - ui32Have));
+		ui32TrackCount += ui32TrackExpected - ui32Have;
+	}
+
+	ContinuityStats.ui32Samples += ui16Delivered;
+}
+
+
+inline void ICM20948::checkOverflow(uint32_t ui32Time, uint8_t ui8Status2)
+{
+	if ((ui8Status2 & ICM20948_FIFO_OVERFLOW_INT) == 0) {return;}
+
+	ContinuityStats.ui32Overflows++;
+	logGap(ui32Time, ICM20948_GAP_OVERFLOW, 1);
+}
+
+
+/* Adds an entry to the gap log, an event of the same type without a new sample in between is merged */
+void ICM20948::logGap(uint32_t ui32Time, uint8_t ui8Type, uint16_t ui16Count)
+{
+	ICM20948_Gap_t *pGap = &GapLog[(uint8_t)(ui8GapHead - 1) & (ICM20948_GAP_LOG_SIZE - 1)];
+
+	if (ui8GapCount > 0 && pGap->ui8Type == ui8Type && pGap->ui32Sample == ContinuityStats.ui32Samples)
+	{
+		pGap->ui16Count = (0xFFFF - pGap->ui16Count < ui16Count) ? 0xFFFF : (pGap->ui16Count + ui16Count);
+		return;
+	}
+
+	pGap = &GapLog[ui8GapHead & (ICM20948_GAP_LOG_SIZE - 1)];
+	pGap->ui32Time   = ui32Time;
+	pGap->ui32Sample = ContinuityStats.ui32Samples;
+	pGap->ui16Count  = ui16Count;
+	pGap->ui8Type    = ui8Type;
+
+	ui8GapHead++;
+	if (ui8GapCount < ICM20948_GAP_LOG_SIZE) {ui8GapCount++;}
+	ContinuityStats.ui32Gaps++;
+}
+
+
+/* Histogram bin of a value (log2) */
+inline uint8_t ICM20948::getHistogramBin(uint32_t ui32Value)
+{
+	uint8_t ui8Bin = 0;
+
+	while (ui32Value > 1 && ui8Bin < ICM20948_LATENCY_BINS - 1)
+	{
+		ui32Value >>= 1;
+		ui8Bin++;
+	}
+
+	return ui8Bin;
+}
+
+
+/* Decodes accelerometer (bytes 0...5) and gyroscope (bytes 6...11), big endian, into the board frame */
+inline void ICM20948::decodeFrame(const uint8_t *pData, ICM20948_Frame_t *pFrame)
+{
+	decodeVector(&pData[0], ui8Mount, &pFrame->Accel);
+	decodeVector(&pData[6], ui8Mount, &pFrame->Gyro);
+}
+
+
+/* Returns ICM20948_FRAME_FSYNC and clears the status bit if the FSYNC status is set in the raw data */
+/* The register that carries the FSYNC status is part of the burst window of the profile */
+inline bool ICM20948::isFsyncInWindow(ICM20948_FsyncLatch_t Latch, ICM20948_Profile_t Profile)
+{
+	const ICM20948_ProfileCfg_t *pCfg = &ICM20948_PROFILES[Profile];
+
+	if (Latch == ICM20948_FSYNC_OFF) {return true;}
+
+	return ICM20948_FSYNC_LSB[Latch] >= pCfg->ui8Offset && ICM20948_FSYNC_LSB[Latch] < pCfg->ui8Offset + pCfg->ui8Length;
+}
+
+
+inline uint8_t ICM20948::latchFsync(uint8_t *pData, uint8_t ui8Length)
+{
+	uint8_t ui8Index = ICM20948_FSYNC_LSB[ICM20948_SensorConfig.Fsync];
+
+	if (ui8Index >= ui8Length || (pData[ui8Index] & 0x01) == 0) {return 0;}
+
+	pData[ui8Index] &= 0xFE;
+
+	return ICM20948_FRAME_FSYNC;
+}
+
+
+/* Length of the DMP packet at pData: 0 if ui16Available bytes do not hold the complete packet yet,
+ * -1 if the header contains undefined bits */
+int16_t ICM20948::getDmpPacketLength(const uint8_t *pData, uint16_t ui16Available)
+{
+	uint16_t ui16Header;
+	uint16_t ui16Header2 = 0;
+	int16_t  i16Length   = 2 + ICM20948_DMP_FOOTER_SIZE;
+
+	if (ui16Available < 2) {return 0;}
+
+	ui16Header = (pData[0] << 8) | pData[1];
+	if (ui16Header & ~ICM20948_DMP_HEADER_MASK) {return -1;}
+
+	if (ui16Header & ICM20948_DMP_HEADER2)
+	{
+		if (ui16Available < 4) {return 0;}
+
+		ui16Header2 = (pData[2] << 8) | pData[3];
+		if (ui16Header2 & ~ICM20948_DMP_HEADER2_MASK) {return -1;}
+
+		i16Length += 2;
+	}
+
+	for (uint8_t i = 0; i < sizeof(ICM20948_DMP_FIELDS) / sizeof(ICM20948_DmpField_t); i++)
+	{
+		if (ui16Header & ICM20948_DMP_FIELDS[i].ui16Bit) {i16Length += ICM20948_DMP_FIELDS[i].ui8Length;}
+	}
+	for (uint8_t i = 0; i < sizeof(ICM20948_DMP_FIELDS2) / sizeof(ICM20948_DmpField_t); i++)
+	{
+		if (ui16Header2 & ICM20948_DMP_FIELDS2[i].ui16Bit) {i16Length += ICM20948_DMP_FIELDS2[i].ui8Length;}
+	}
+
+	if (ui16Available < i16Length) {return 0;}
+
+	return i16Length;
+}
+
+
+/* Decodes a complete DMP packet (see getDmpPacketLength()), big endian */
+void ICM20948::decodeDmpPacket(const uint8_t *pData, ICM20948_DmpPacket_t *pPacket)
+{
+	const uint8_t *p;
+
+	memset(pPacket, 0, sizeof(ICM20948_DmpPacket_t));
+
+	pPacket->ui16Header = (pData[0] << 8) | pData[1];
+	p = &pData[2];
+
+	if (pPacket->ui16Header & ICM20948_DMP_HEADER2)
+	{
+		pPacket->ui16Header2 = (p[0] << 8) | p[1];
+		p += 2;
+	}
+
+	for (uint8_t i = 0; i < sizeof(ICM20948_DMP_FIELDS) / sizeof(ICM20948_DmpField_t); i++)
+	{
+		if (!(pPacket->ui16Header & ICM20948_DMP_FIELDS[i].ui16Bit)) {continue;}
+
+		switch (ICM20948_DMP_FIELDS[i].ui16Bit)
+		{
+		case ICM20948_DMP_ACCEL:
+			decodeVector(&p[0], ui8Mount, &pPacket->Accel);
+			break;
+		case ICM20948_DMP_GYRO:
+			decodeVector(&p[0], ui8Mount, &pPacket->Gyro);
+			decodeVector(&p[6], ui8Mount, &pPacket->GyroBias);
+			break;
+		case ICM20948_DMP_QUAT6:
+			pPacket->Quat6.i32XAxis = (int32_t)(((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+			pPacket->Quat6.i32YAxis = (int32_t)(((uint32_t)p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]);
+			pPacket->Quat6.i32ZAxis = (int32_t)(((uint32_t)p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11]);
+			break;
+		case ICM20948_DMP_PQUAT6:
+			pPacket->PQuat6.i16XAxis = (p[0] << 8) | p[1];
+			pPacket->PQuat6.i16YAxis = (p[2] << 8) | p[3];
+			pPacket->PQuat6.i16ZAxis = (p[4] << 8) | p[5];
+			break;
+		case ICM20948_DMP_GYRO_CALIBR:
+			pPacket->GyroCalibr.i32XAxis = (int32_t)(((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+			pPacket->GyroCalibr.i32YAxis = (int32_t)(((uint32_t)p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]);
+			pPacket->GyroCalibr.i32ZAxis = (int32_t)(((uint32_t)p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11]);
+			break;
+		default:
+			break; // Skipped
+		}
+
+		p += ICM20948_DMP_FIELDS[i].ui8Length;
+	}
+
+	for (uint8_t i = 0; i < sizeof(ICM20948_DMP_FIELDS2) / sizeof(ICM20948_DmpField_t); i++)
+	{
+		if (!(pPacket->ui16Header2 & ICM20948_DMP_FIELDS2[i].ui16Bit)) {continue;}
+
+		if (ICM20948_DMP_FIELDS2[i].ui16Bit == ICM20948_DMP_HDR2_ACCEL_ACCURACY) {pPacket->ui16AccelAccuracy = (p[0] << 8) | p[1];}
+		if (ICM20948_DMP_FIELDS2[i].ui16Bit == ICM20948_DMP_HDR2_GYRO_ACCURACY)  {pPacket->ui16GyroAccuracy  = (p[0] << 8) | p[1];}
+
+		p += ICM20948_DMP_FIELDS2[i].ui8Length;
+	}
+
+	pPacket->ui16Footer = (p[0] << 8) | p[1];
+}
+
+
+/* Writes up to ICM20948_DMP_CHUNK_SIZE bytes into the DMP memory (within one bank of 256 bytes) */
+int16_t ICM20948::writeDmpMemory(uint16_t ui16Addr, const uint8_t *pData, uint8_t ui8Length)
+{
+	if (writeRegister8(0, ICM20948_MEM_BANK_SEL, ui16Addr >> 8) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_MEM_START_ADDR, ui16Addr & 0x00FF) != 0) {return -1;}
+
+	if (Bus.writeBurst(ICM20948_MEM_R_W, pData, ui8Length) != 0) {return -1;}
+
+	return 0;
+}
+
+
+int16_t ICM20948::readDmpMemory(uint16_t ui16Addr, uint8_t *pData, uint8_t ui8Length)
+{
+	if (writeRegister8(0, ICM20948_MEM_BANK_SEL, ui16Addr >> 8) != 0) {return -1;}
+	if (writeRegister8(0, ICM20948_MEM_START_ADDR, ui16Addr & 0x00FF) != 0) {return -1;}
+
+	if (Bus.readBurst(ICM20948_MEM_R_W, pData, ui8Length, ICM20948_SPEED_READ) != 0) {return -1;}
+
+	return 0;
+}
+
+
+/* Configuration value of the DMP memory (2 or 4 bytes, big endian) */
+int16_t ICM20948::writeDmpRegister(uint16_t ui16Addr, uint32_t ui32Value, uint8_t ui8Length)
 {
-	//if (pSPI->writeByte(ICM20948_REG_BANK_SEL, 0 << 4) != 0) {return -1;}
+	uint8_t ui8Array[4];
+
+	for (uint8_t i = 0; i < ui8Length; i++)
+	{
+		ui8Array[i] = ui32Value >> (8 * (ui8Length - 1 - i));
+	}
+
+	return writeDmpMemory(ui16Addr, ui8Array, ui8Length);
+}
+
 
-	/* First byte includes R/W-bit (write = 0) and 7-bit memory address */
-	uint8_t ui8Array[] = {0x7F & ICM20948_REG_BANK_SEL, uint8_t(0 << 4)};
+int16_t ICM20948::resetBank(void)
+{
+	uint8_t ui8Data = 0 << 4;
 
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(ui8Array, 2) != 0) {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
+	if (Bus.writeBurst(ICM20948_REG_BANK_SEL, &ui8Data, 1) != 0) {return -1;}
 
 	ui8CurrentBank = 0;
 	return 0;
@@ -741,16 +2914,11 @@ int16_t ICM20948::resetBank(void)
 
 int16_t ICM20948::switchBank(uint8_t ui8NewBank)
 {
-	/* First byte includes R/W-bit (write = 0) and 7-bit memory/register address */
-	uint8_t ui8Array[] = {uint8_t(0x7F & ICM20948_REG_BANK_SEL), uint8_t(ui8NewBank << 4)};
+	uint8_t ui8Data = ui8NewBank << 4;
 
 	if (ui8NewBank != ui8CurrentBank)
 	{
-		//if (pSPI->writeByte(ICM20948_REG_BANK_SEL, ui8NewBank << 4) != 0) {return -1;}
-
-		pSPI->enableNSS();
-		if (pSPI->transmitSPI(ui8Array, 2) != 0) {pSPI->disableNSS(); return -1;}
-		pSPI->disableNSS();
+		if (Bus.writeBurst(ICM20948_REG_BANK_SEL, &ui8Data, 1) != 0) {return -1;}
 
 		ui8CurrentBank = ui8NewBank;
 	}
@@ -760,16 +2928,9 @@ int16_t ICM20948::switchBank(uint8_t ui8NewBank)
 
 int16_t ICM20948::writeRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Data)
 {
-	/* First byte includes R/W-bit (write = 0) and 7-bit memory/register address */
-	uint8_t ui8Array[] = {uint8_t(0x7F & ui8RegAddr), ui8Data};
-
 	if (switchBank(ui8Bank) != 0) {return -1;}
 
-	//if (pSPI->writeByte(ui8RegAddr, ui8Data) != 0) {return -1;}
-
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(ui8Array, 2) != 0) {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
+	if (Bus.writeBurst(ui8RegAddr, &ui8Data, 1) != 0) {return -1;}
 
 	return 0;
 }
@@ -777,17 +2938,9 @@ int16_t ICM20948::writeRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui
 
 int16_t ICM20948::readRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t *pData)
 {
-	/* Byte includes R/W-bit (read = 1) and 7-bit memory/register address */
-	uint8_t ui8Data = 0x80 | ui8RegAddr;
-
 	if (switchBank(ui8Bank) != 0) {return -1;}
 
-	//if (pSPI->readByte(ui8RegAddr, pData) != 0) {return -1;}
-
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(&ui8Data, 1) != 0) {pSPI->disableNSS(); return -1;}
-	if (pSPI->receiveSPI(pData, 1) != 0)     {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
+	if (Bus.readBurst(ui8RegAddr, pData, 1, ICM20948_SPEED_READ) != 0) {return -1;}
 
 	return 0;
 }
@@ -795,24 +2948,14 @@ int16_t ICM20948::readRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t *pD
 
 int16_t ICM20948::writeRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t ui16Data)
 {
-	uint8_t ui8Array[3];
-
-	ui8Array[0] = 0x7F & ui8RegAddrH;
-	ui8Array[1] = ui16Data >> 8; // High byte is transmitted first
-	ui8Array[2] = ui16Data;      // Low byte
-
-//	uint8_t ui8Data[2];
+	uint8_t ui8Array[2];
 
-//	ui8Data[0] = ui16Data >> 8; // High byte is transmitted first
-//	ui8Data[1] = ui16Data;      // Low byte
+	ui8Array[0] = ui16Data >> 8; // High byte is transmitted first
+	ui8Array[1] = ui16Data;      // Low byte
 
 	if (switchBank(ui8Bank) != 0) {return -1;}
 
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(ui8Array, 3) != 0) {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
-
-//	if (pSPI->writeBurst(ui8RegAddrH, 2, ui8Data) != 0) {return -1;}
+	if (Bus.writeBurst(ui8RegAddrH, ui8Array, 2) != 0) {return -1;}
 
 	return 0;
 }
@@ -820,20 +2963,11 @@ int16_t ICM20948::writeRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t
 
 int16_t ICM20948::readRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t *pData)
 {
-	/* Byte includes R/W-bit (read = 1) and 7-bit memory/register address */
-	uint8_t ui8Data = 0x80 | ui8RegAddrH;
-
 	uint8_t ui8Array[2];
 
 	if (switchBank(ui8Bank) != 0) {return -1;}
 
-	//if (pSPI->readBurst(ui8RegAddrH, 2, ui8Data) != 0) {return -1;}
-	//*pData = (ui8Data[0] << 8) | ui8Data[1];
-
-	pSPI->enableNSS();
-	if (pSPI->transmitSPI(&ui8Data, 1) != 0) {pSPI->disableNSS(); return -1;}
-	if (pSPI->receiveSPI(ui8Array, 2) != 0)      {pSPI->disableNSS(); return -1;}
-	pSPI->disableNSS();
+	if (Bus.readBurst(ui8RegAddrH, ui8Array, 2, ICM20948_SPEED_READ) != 0) {return -1;}
 
 	*pData = (ui8Array[0] << 8) | ui8Array[1];
 
@@ -841,6 +2975,17 @@ int16_t ICM20948::readRegister16(uint8_t ui8Bank, uint8_t ui8RegAddrH, uint16_t
 }
 
 
+/* Reads ui16Length consecutive registers with one transfer (the register address auto-increments) */
+int16_t ICM20948::readBurst(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t *pData, uint16_t ui16Length, ICM20948_BusSpeed_t Speed)
+{
+	if (switchBank(ui8Bank) != 0) {return -1;}
+
+	if (Bus.readBurst(ui8RegAddr, pData, ui16Length, Speed) != 0) {return -1;}
+
+	return 0;
+}
+
+
 int16_t ICM20948::setRegister8Bit(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Pos)
 {
 	uint8_t ui8Data;
@@ -907,6 +3052,29 @@ int16_t ICM20948::changeRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t u
 }
 
 
+/* Like changeRegister8(), but the register content is taken from the shadow (no read access). An unchanged
+ * value is not written at all. The first access after a reset or restore reads the register once. */
+int16_t ICM20948::changeShadowRegister8(uint8_t ui8Bank, uint8_t ui8RegAddr, uint8_t ui8Msk, uint8_t ui8Value, uint8_t *pShadow)
+{
+	uint8_t ui8Data;
+
+	if (!boShadowValid)
+	{
+		if (readRegister8(2, ICM20948_ACCEL_CONFIG, &ui8AccelConfig) != 0) {return -1;}
+		if (readRegister8(2, ICM20948_GYRO_CONFIG_1, &ui8GyroConfig1) != 0) {return -1;}
+		boShadowValid = true;
+	}
+
+	ui8Data = (*pShadow & ~ui8Msk) | (ui8Value & ui8Msk);
+	if (ui8Data == *pShadow) {return 0;}
+
+	if (writeRegister8(ui8Bank, ui8RegAddr, ui8Data) != 0) {return -1;}
+	*pShadow = ui8Data;
+
+	return 0;
+}
+
+
 inline bool ICM20948::isValidPos(uint8_t ui8Pos)
 {
 	return ((ui8Pos == 0x01) || (ui8Pos == 0x02) || (ui8Pos == 0x04) || (ui8Pos == 0x08) ||
@@ -954,6 +3122,13 @@ inline bool ICM20948::isValidGyroSampleRate(ICM20948_GyroSampleRate_t SampleRate
 }
 
 
+/* Same output data rate of both sensors: 1125Hz / (1 + divider) each, the DLPF bypass rates differ (4500Hz / 9000Hz) */
+inline bool ICM20948::isEqualSampleRate(ICM20948_AccelSampleRate_t AccelSR, ICM20948_GyroSampleRate_t GyroSR)
+{
+	return (AccelSR.boFCHOICE && GyroSR.boFCHOICE && AccelSR.ui16Div == GyroSR.ui8Div);
+}
+
+
 inline bool ICM20948::isValidDLPF(ICM20948_DLPF_t DLPF)
 {
 	return ((DLPF == ICM20948_DLPF_0) || (DLPF == ICM20948_DLPF_1) || (DLPF == ICM20948_DLPF_2) || (DLPF == ICM20948_DLPF_3) ||
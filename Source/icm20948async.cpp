@@ -0,0 +1,435 @@
+/*
+ * icm20948async.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "icm20948async.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <cstddef>
+
+
+extern "C" uint32_t get_Ticks(void);
+
+static_assert(ASYNC_FRAMES >= 1 && ASYNC_FRAMES <= 32, "ASYNC_FRAMES must be 1...32");
+static_assert(ASYNC_FRAME_SIZE % 8 == 0, "ASYNC_FRAME_SIZE must be a multiple of 8");
+static_assert(ASYNC_SLOTS >= 1 && ASYNC_SLOTS <= 32, "ASYNC_SLOTS must be 1...32");
+
+/* Pool of the coroutine frames (tasks are created and destroyed in the context of the scheduler only) */
+alignas(std::max_align_t) static uint8_t ui8FramePool[ASYNC_FRAMES][ASYNC_FRAME_SIZE];
+static uint32_t ui32FrameUsed = 0;  // Bit i: ui8FramePool[i] is used
+
+
+/* ASYNC_TASK class */
+ASYNC_TASK ASYNC_TASK::promise_type::get_return_object(void) noexcept
+{
+	return ASYNC_TASK(std::coroutine_handle<promise_type>::from_promise(*this));
+}
+
+
+ASYNC_TASK ASYNC_TASK::promise_type::get_return_object_on_allocation_failure(void) noexcept
+{
+	return ASYNC_TASK(std::coroutine_handle<promise_type>());
+}
+
+
+ASYNC_TASK::FinalAwaiter ASYNC_TASK::promise_type::final_suspend(void) noexcept
+{
+	return {};
+}
+
+
+void *ASYNC_TASK::promise_type::operator new(std::size_t Size) noexcept
+{
+	if (Size > ASYNC_FRAME_SIZE) {return NULL;}
+
+	for (uint8_t i = 0; i < ASYNC_FRAMES; i++)
+	{
+		if ((ui32FrameUsed & (1UL << i)) == 0)
+		{
+			ui32FrameUsed |= (1UL << i);
+			return ui8FramePool[i];
+		}
+	}
+
+	return NULL;
+}
+
+
+void ASYNC_TASK::promise_type::operator delete(void *pFrame) noexcept
+{
+	uint32_t ui32Index = ((uint8_t*)pFrame - &ui8FramePool[0][0]) / ASYNC_FRAME_SIZE;
+
+	ui32FrameUsed &= ~(1UL << ui32Index);
+}
+
+
+std::coroutine_handle<> ASYNC_TASK::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> Handle) noexcept
+{
+	/* A top-level task stays suspended, the owner reads the result and destroys it */
+	if (Handle.promise().Continuation) {return Handle.promise().Continuation;}
+
+	return std::noop_coroutine();
+}
+
+
+std::coroutine_handle<> ASYNC_TASK::Awaiter::await_suspend(std::coroutine_handle<> Caller) noexcept
+{
+	Handle.promise().Continuation = Caller;
+
+	return Handle;
+}
+
+
+int16_t ASYNC_TASK::Awaiter::await_resume(void) noexcept
+{
+	if (!Handle) {return ICM20948_GEN_FAIL;}
+
+	return Handle.promise().i16Result;
+}
+
+
+ASYNC_TASK::ASYNC_TASK(ASYNC_TASK &&Other) noexcept : Handle(Other.Handle)
+{
+	Other.Handle = nullptr;
+}
+
+
+ASYNC_TASK::~ASYNC_TASK(void)
+{
+	if (Handle) {Handle.destroy();}
+}
+
+
+/* False: the frame pool was empty when the task was created */
+bool ASYNC_TASK::isValid(void)
+{
+	return (bool)Handle;
+}
+
+
+bool ASYNC_TASK::isDone(void)
+{
+	return !Handle || Handle.done();
+}
+
+
+/* Result of a finished task (ICM20948_GEN_FAIL if the task is invalid) */
+int16_t ASYNC_TASK::getResult(void)
+{
+	if (!Handle) {return ICM20948_GEN_FAIL;}
+
+	return Handle.promise().i16Result;
+}
+
+
+uint8_t ASYNC_TASK::getFreeFrames(void)
+{
+	uint8_t ui8Free = 0;
+
+	for (uint8_t i = 0; i < ASYNC_FRAMES; i++)
+	{
+		if ((ui32FrameUsed & (1UL << i)) == 0) {ui8Free++;}
+	}
+
+	return ui8Free;
+}
+
+
+/* ASYNC_DELAY */
+bool ASYNC_DELAY::await_suspend(std::coroutine_handle<> Handle) noexcept
+{
+	uint32_t ui32StartTicks;
+
+	ui32StartTicks = get_Ticks();
+	if (pScheduler->schedule(Handle, ui32StartTicks + ui32Ticks) == 0) {return true;}
+
+	/* All slots are used (ASYNC_SLOTS is too small): the delay is executed blocking */
+	while ((int32_t)(get_Ticks() - (ui32StartTicks + ui32Ticks)) < 0);
+
+	return false;
+}
+
+
+/* ASYNC_SCHEDULER class */
+ASYNC_SCHEDULER::ASYNC_SCHEDULER(void)
+{
+	for (uint8_t i = 0; i < ASYNC_SLOTS; i++)
+	{
+		Slot[i]    = nullptr;
+		ui32Due[i] = 0;
+	}
+}
+
+
+/**
+  @brief  Starts a top-level task with the next poll() (the task object must exist until it is done)
+  @retval  0: OK
+          -1: Task is invalid, already started or all slots are used
+**/
+int16_t ASYNC_SCHEDULER::spawn(ASYNC_TASK *pTask)
+{
+	if (!pTask->Handle || pTask->Handle.done()) {return -1;}
+
+	return schedule(pTask->Handle, get_Ticks());
+}
+
+
+/**
+  @brief  Resumes every waiting task chain whose delay has expired (call it from the main loop)
+  @retval Number of resumed task chains
+**/
+uint16_t ASYNC_SCHEDULER::poll(void)
+{
+	std::coroutine_handle<> Handle;
+	uint32_t ui32Now;
+	uint32_t ui32Expired = 0;
+	uint16_t ui16Resumed = 0;
+
+	ui32Now = get_Ticks();
+
+	/* Chains that wait again while this poll() runs are resumed with the next one (yield()) */
+	for (uint8_t i = 0; i < ASYNC_SLOTS; i++)
+	{
+		/* Differences are correct across a wrap-around of the ticks */
+		if (Slot[i] && (int32_t)(ui32Now - ui32Due[i]) >= 0) {ui32Expired |= (1UL << i);}
+	}
+
+	for (uint8_t i = 0; i < ASYNC_SLOTS; i++)
+	{
+		if (ui32Expired & (1UL << i))
+		{
+			Handle  = Slot[i];
+			Slot[i] = nullptr;   // The chain may wait again while it runs
+			Handle.resume();
+			ui16Resumed++;
+		}
+	}
+
+	return ui16Resumed;
+}
+
+
+/**
+  @brief  Starts pTask and polls until it is done (host, initialization before the main loop)
+  @retval Result of the task
+**/
+int16_t ASYNC_SCHEDULER::run(ASYNC_TASK *pTask)
+{
+	if (spawn(pTask) != 0) {return ICM20948_GEN_FAIL;}
+
+	while (!pTask->isDone())
+	{
+		poll();
+	}
+
+	return pTask->getResult();
+}
+
+
+bool ASYNC_SCHEDULER::isIdle(void)
+{
+	for (uint8_t i = 0; i < ASYNC_SLOTS; i++)
+	{
+		if (Slot[i]) {return false;}
+	}
+
+	return true;
+}
+
+
+/* co_await delay(n): resumed by the first poll() at least n ticks later */
+ASYNC_DELAY ASYNC_SCHEDULER::delay(uint32_t ui32Ms)
+{
+	return ASYNC_DELAY{this, ui32Ms};
+}
+
+
+/* co_await yield(): resumed by the next poll() */
+ASYNC_DELAY ASYNC_SCHEDULER::yield(void)
+{
+	return ASYNC_DELAY{this, 0};
+}
+
+
+int16_t ASYNC_SCHEDULER::schedule(std::coroutine_handle<> Handle, uint32_t ui32DueTicks)
+{
+	for (uint8_t i = 0; i < ASYNC_SLOTS; i++)
+	{
+		if (!Slot[i])
+		{
+			Slot[i]    = Handle;
+			ui32Due[i] = ui32DueTicks;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+
+/* ICM20948_ASYNC class */
+ICM20948_ASYNC::ICM20948_ASYNC(ICM20948_Port_t *pPort, ASYNC_SCHEDULER *pScheduler) : Device(pPort), pScheduler(pScheduler)
+{
+}
+
+
+/* Public methods */
+
+/**
+  @brief  Initialization of ICM20948::init() with suspended delays, prepares readFrame()
+  @param  pSelfTest: If not NULL, the self-test runs directly after the configuration (its first settling time
+                     overlaps the start-up of the gyroscope), the result is stored here
+  @retval ICM20948_RET_OK or ICM20948_GEN_FAIL (initialization or self-test error, a failed axis is only
+          reported in *pSelfTest)
+**/
+ASYNC_TASK ICM20948_ASYNC::init(ICM20948_FullScale_t ACCEL_FS, ICM20948_FullScale_t GYRO_FS,
+		                        ICM20948_AccelSampleRate_t ACCEL_SR, ICM20948_GyroSampleRate_t GYRO_SR, ICM20948_DLPF_t DLPF,
+								ICM20948_SelfTest_t *pSelfTest)
+{
+	uint32_t ui32Delay;
+	int16_t  i16RetValue;
+
+	if (Device.initReset() != ICM20948_RET_OK) {co_return ICM20948_GEN_FAIL;}
+
+	co_await pScheduler->delay(ICM20948_RESET_DELAY);
+
+	if (Device.initWake() != ICM20948_RET_OK) {co_return ICM20948_GEN_FAIL;}
+
+	co_await pScheduler->delay(ICM20948_WAKE_DELAY);
+
+	if (Device.initConfig(ACCEL_FS, GYRO_FS, ACCEL_SR, GYRO_SR, DLPF) != ICM20948_RET_OK) {co_return ICM20948_GEN_FAIL;}
+
+	/* Steps of the self-test in this frame (no nested task) */
+	if (pSelfTest != NULL)
+	{
+		while ((i16RetValue = Device.updateSelfTest(pSelfTest, &ui32Delay)) == 1)
+		{
+			co_await pScheduler->delay(ui32Delay);
+		}
+
+		if (i16RetValue != 0) {co_return ICM20948_GEN_FAIL;}
+	}
+
+	if (Device.setupLatest() != 0) {co_return ICM20948_GEN_FAIL;}
+
+	co_return ICM20948_RET_OK;
+}
+
+
+/**
+  @brief  Waits for a new sample (data ready status) and reads it, the status is polled once per poll()
+  @param  pFrame: New frame
+  @retval  0: OK
+          -1: Read error or init() not done
+**/
+ASYNC_TASK ICM20948_ASYNC::readFrame(ICM20948_Frame_t *pFrame)
+{
+	int16_t  i16RetValue;
+	uint32_t ui32Age;
+
+	while (true)
+	{
+		i16RetValue = Device.readLatest(pFrame, &ui32Age);
+
+		if (i16RetValue < 0) {co_return -1;}
+		if (i16RetValue == 1) {co_return 0;}
+
+		co_await pScheduler->yield();
+	}
+}
+
+
+/* Mean values of ICM20948::calculateMeanValues(), the 1ms between the samples are suspended */
+ASYNC_TASK ICM20948_ASYNC::calculateMeanValues(uint16_t ui16Samples, uint16_t ui16Skip)
+{
+	ICM20948_i32Vector_t CorrectedAccelRawSum = {0, 0, 0};
+	ICM20948_i32Vector_t CorrectedGyroRawSum  = {0, 0, 0};
+	uint16_t ui16Repeated = 0;
+
+	/* Mean values need both sensors and the full burst window */
+	if (Device.ICM20948_SensorConfig.Profile != ICM20948_PROFILE_FULL) {co_return -1;}
+
+	co_await pScheduler->delay(1);
+
+	for (uint16_t i = 0; i < ui16Skip + ui16Samples; )
+	{
+		if (Device.readAllDataRaw() != 0) {co_return -1;}
+
+		/* Duplicates (continuity tracking) are replaced by another sample */
+		if (Device.boDataRepeated)
+		{
+			if (++ui16Repeated > ui16Samples) {co_return -1;}
+		}
+		else
+		{
+			if (i >= ui16Skip) {Device.addMeanSample(&CorrectedAccelRawSum, &CorrectedGyroRawSum);}
+			i++;
+		}
+
+		/* Process sample rate of 1000Hz (both accelerometer and gyroscope sample rate must be 1125Hz) */
+		co_await pScheduler->delay(1);
+	}
+
+	Device.setMeanValues(&CorrectedAccelRawSum, &CorrectedGyroRawSum, ui16Samples);
+
+	co_return 0;
+}
+
+
+/**
+  @brief  Calibration of ICM20948::exeCalibration() (approx. 1.1s per iteration without blocking)
+  @retval  0: All 6 axes are calibrated
+          -1: Error while calculating the mean values
+          -2: Calibration not succeeded after MAX_ITERATIONS
+**/
+ASYNC_TASK ICM20948_ASYNC::calibrate(void)
+{
+	if (co_await calculateMeanValues() != 0) {co_return -1;}
+
+	Device.startCalibration();
+
+	for (uint8_t i = 0; i < MAX_ITERATIONS; i++)
+	{
+		if (co_await calculateMeanValues() != 0) {co_return -1;}
+
+		if (Device.updateCalibration() == 6) {co_return 0;}
+	}
+
+	co_return -2;
+}
+
+
+/**
+  @brief  Self-test of ICM20948::exeSelfTest(), the settling times and windows are suspended
+  @retval  0: All 6 axes passed
+           1: At least one axis failed (see pResult)
+          -1: Error, see ICM20948::exeSelfTest()
+**/
+ASYNC_TASK ICM20948_ASYNC::selfTest(ICM20948_SelfTest_t *pResult)
+{
+	uint32_t ui32Delay;
+	int16_t  i16RetValue;
+
+	while ((i16RetValue = Device.updateSelfTest(pResult, &ui32Delay)) == 1)
+	{
+		co_await pScheduler->delay(ui32Delay);
+	}
+
+	if (i16RetValue != 0) {co_return -1;}
+
+	co_return (pResult->ui8AccelPass == ICM20948_ST_ALL && pResult->ui8GyroPass == ICM20948_ST_ALL) ? 0 : 1;
+}
+
+
+/* Synchronous access to all other methods (e.g. FIFO, offsets, snapshots) */
+ICM20948 *ICM20948_ASYNC::getDevice(void)
+{
+	return &Device;
+}
+
+
+#endif /* __cpp_impl_coroutine */
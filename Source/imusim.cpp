@@ -0,0 +1,352 @@
+/*
+ * imusim.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "imusim.hpp"
+#include <cmath>
+#include <string.h>
+
+
+#define IMUSIM_PI              3.14159265358979f
+#define IMUSIM_TEMP_SENS       333.87f // [LSB/degC] (datasheet p. 14)
+#define IMUSIM_TEMP_OFFSET     21.0f   // [degC]
+
+/* Sum of four uniform 16-bit numbers: mean 2 * 65535, standard deviation 65536 / sqrt(3) */
+#define IMUSIM_GAUSS_MEAN      131070.0f
+#define IMUSIM_GAUSS_SCALE     (1.0f / 37837.23f)
+
+
+/* IMUSIM class */
+IMUSIM::IMUSIM(const IMUSIM_Config_t *pConfig, ICM20948_FullScale_t AccelFullScale, ICM20948_FullScale_t GyroFullScale)
+{
+	setFullScale(AccelFullScale, GyroFullScale);
+
+	if (init(pConfig) != 0) {init(&IMUSIM_DEFAULT_CONFIG);}
+}
+
+
+/* Public methods */
+/**
+  @brief  Applies a configuration and restarts the sequence
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t IMUSIM::init(const IMUSIM_Config_t *pConfig)
+{
+	if (pConfig->fSampleRate <= 0.0f || pConfig->fCorrelationTime <= 0.0f) {return -1;}
+	if (pConfig->fImpactLength < 0.0f || pConfig->fImpactPeriod < pConfig->fImpactLength) {return -1;}
+
+	Config = *pConfig;
+
+	reset();
+
+	return 0;
+}
+
+
+/* Restarts the sequence with the seed of the configuration (turn-on biases included) */
+void IMUSIM::reset(void)
+{
+	float fRate[3] = {Config.Rate.fXAxis, Config.Rate.fYAxis, Config.Rate.fZAxis};
+	float fOmega, fAngle, fSin, fCos, fAxis[3];
+	float fBiasDt;
+
+	ui64State   = 0x9E3779B97F4A7C15ULL ^ Config.ui32Seed;
+	ui64Samples = 0;
+	fDt         = 1.0f / Config.fSampleRate;
+
+	fAccelSigma = Config.fAccelNoise * std::sqrt(Config.fSampleRate / 2.0f);
+	fGyroSigma  = Config.fGyroNoise  * std::sqrt(Config.fSampleRate / 2.0f);
+
+	/* Per-sample rotation of the gravity vector (Rodrigues): the sensor rotates with Rate, the gravity vector
+	 * rotates with -Rate in the sensor frame */
+	fOmega     = std::sqrt(fRate[0] * fRate[0] + fRate[1] * fRate[1] + fRate[2] * fRate[2]) * IMUSIM_PI / 180.0f;
+	boRotation = (fOmega > 0.0f);
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		for (uint8_t j = 0; j < 3; j++) {fRotation[i][j] = (i == j) ? 1.0f : 0.0f;}
+	}
+
+	if (boRotation)
+	{
+		fAngle = -fOmega * fDt;
+		fSin   = std::sin(fAngle);
+		fCos   = std::cos(fAngle);
+
+		for (uint8_t i = 0; i < 3; i++) {fAxis[i] = fRate[i] * IMUSIM_PI / 180.0f / fOmega;}
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			for (uint8_t j = 0; j < 3; j++)
+			{
+				fRotation[i][j] = (1.0f - fCos) * fAxis[i] * fAxis[j] + ((i == j) ? fCos : 0.0f);
+			}
+		}
+
+		fRotation[0][1] -= fSin * fAxis[2];
+		fRotation[0][2] += fSin * fAxis[1];
+		fRotation[1][0] += fSin * fAxis[2];
+		fRotation[1][2] -= fSin * fAxis[0];
+		fRotation[2][0] -= fSin * fAxis[1];
+		fRotation[2][1] += fSin * fAxis[0];
+	}
+
+	for (uint8_t t = 0; t < IMUSIM_MAX_TONES; t++)
+	{
+		fTone[t][0]     = 1.0f;
+		fTone[t][1]     = 0.0f;
+		fToneStep[t][0] = std::cos(2.0f * IMUSIM_PI * Config.Tone[t].fFreq * fDt);
+		fToneStep[t][1] = std::sin(2.0f * IMUSIM_PI * Config.Tone[t].fFreq * fDt);
+	}
+
+	ui32ImpactPeriod = (uint32_t)(Config.fImpactPeriod * Config.fSampleRate + 0.5f);
+	ui32ImpactLength = (uint32_t)(Config.fImpactLength * Config.fSampleRate + 0.5f);
+	ui32ImpactPhase  = 0;
+	fImpact[0]       = 1.0f;
+	fImpact[1]       = 0.0f;
+	fImpactStep[0]   = (ui32ImpactLength > 0) ? std::cos(IMUSIM_PI / ui32ImpactLength) : 1.0f;
+	fImpactStep[1]   = (ui32ImpactLength > 0) ? std::sin(IMUSIM_PI / ui32ImpactLength) : 0.0f;
+
+	/* Bias processes, updated every IMUSIM_BIAS_DECIMATION samples */
+	fBiasDt       = IMUSIM_BIAS_DECIMATION * fDt;
+	fGaussMarkov  = std::exp(-fBiasDt / Config.fCorrelationTime);
+	fAccelGMDrive = Config.fAccelInstability * std::sqrt(1.0f - fGaussMarkov * fGaussMarkov);
+	fGyroGMDrive  = Config.fGyroInstability  * std::sqrt(1.0f - fGaussMarkov * fGaussMarkov);
+	fAccelRWStep  = Config.fAccelRandomWalk * std::sqrt(fBiasDt);
+	fGyroRWStep   = Config.fGyroRandomWalk  * std::sqrt(fBiasDt);
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		fAccelTurnOn[i] = Config.fAccelBias * getGauss();
+		fGyroTurnOn[i]  = Config.fGyroBias  * getGauss();
+		fAccelGM[i]     = Config.fAccelInstability * getGauss();
+		fGyroGM[i]      = Config.fGyroInstability  * getGauss();
+		fAccelRW[i]     = 0.0f;
+		fGyroRW[i]      = 0.0f;
+	}
+
+	Gravity            = Config.Gravity;
+	Truth.Accel        = Config.Gravity;
+	Truth.Gyro         = Config.Rate;
+	Truth.fTemperature = Config.fTemperature;
+	updateBias();
+}
+
+
+/* Quantization and saturation of the following frames */
+void IMUSIM::setFullScale(ICM20948_FullScale_t AccelFullScale, ICM20948_FullScale_t GyroFullScale)
+{
+	fAccelCounts = 32768.0f / AccelFullScale.ui16Range;
+	fGyroCounts  = 32768.0f / GyroFullScale.ui16Range;
+	ui8Range     = ICM20948_RANGE(AccelFullScale, GyroFullScale);
+}
+
+
+/* Frames in register format (IMUSIM_FRAME_SIZE bytes each) */
+void IMUSIM::generate(uint8_t *pFrames, uint32_t ui32Count)
+{
+	int16_t i16Raw[7];
+
+	for (uint32_t n = 0; n < ui32Count; n++)
+	{
+		step(i16Raw);
+
+		for (uint8_t i = 0; i < 7; i++)
+		{
+			pFrames[2 * i]     = (uint16_t)i16Raw[i] >> 8;
+			pFrames[2 * i + 1] = (uint16_t)i16Raw[i];
+		}
+
+		pFrames += IMUSIM_FRAME_SIZE;
+	}
+}
+
+
+/* Decoded frames (epoch 0, no flags, range of the selected full scale) */
+void IMUSIM::generate(ICM20948_Frame_t *pFrames, uint32_t ui32Count)
+{
+	int16_t i16Raw[7];
+
+	for (uint32_t n = 0; n < ui32Count; n++)
+	{
+		step(i16Raw);
+
+		pFrames[n].Accel.i16XAxis = i16Raw[0];
+		pFrames[n].Accel.i16YAxis = i16Raw[1];
+		pFrames[n].Accel.i16ZAxis = i16Raw[2];
+		pFrames[n].Gyro.i16XAxis  = i16Raw[3];
+		pFrames[n].Gyro.i16YAxis  = i16Raw[4];
+		pFrames[n].Gyro.i16ZAxis  = i16Raw[5];
+		pFrames[n].i16Temperature = i16Raw[6];
+		pFrames[n].ui8Epoch       = 0;
+		pFrames[n].ui8Flags       = 0;
+		pFrames[n].ui8Range       = ui8Range;
+	}
+}
+
+
+void IMUSIM::getTruth(IMUSIM_Truth_t *pTruth)
+{
+	*pTruth = Truth;
+}
+
+
+uint64_t IMUSIM::getSampleCount(void)
+{
+	return ui64Samples;
+}
+
+
+/* Private methods */
+/* One sample: accelerometer X/Y/Z, gyroscope X/Y/Z and temperature as raw values */
+void IMUSIM::step(int16_t *pRaw)
+{
+	ICM20948_fVector_t Accel;
+	float fPhase0, fPhase1, fNorm;
+
+	if ((ui64Samples & (IMUSIM_BIAS_DECIMATION - 1)) == 0 && ui64Samples > 0) {updateBias();}
+
+	/* Rotation */
+	if (boRotation)
+	{
+		Accel.fXAxis = fRotation[0][0] * Gravity.fXAxis + fRotation[0][1] * Gravity.fYAxis + fRotation[0][2] * Gravity.fZAxis;
+		Accel.fYAxis = fRotation[1][0] * Gravity.fXAxis + fRotation[1][1] * Gravity.fYAxis + fRotation[1][2] * Gravity.fZAxis;
+		Accel.fZAxis = fRotation[2][0] * Gravity.fXAxis + fRotation[2][1] * Gravity.fYAxis + fRotation[2][2] * Gravity.fZAxis;
+		Gravity      = Accel;
+
+		/* Rounding errors of the repeated rotation */
+		if ((ui64Samples % IMUSIM_RENORM_INTERVAL) == IMUSIM_RENORM_INTERVAL - 1)
+		{
+			fNorm = std::sqrt(Config.Gravity.fXAxis * Config.Gravity.fXAxis + Config.Gravity.fYAxis * Config.Gravity.fYAxis
+					+ Config.Gravity.fZAxis * Config.Gravity.fZAxis)
+					/ std::sqrt(Accel.fXAxis * Accel.fXAxis + Accel.fYAxis * Accel.fYAxis + Accel.fZAxis * Accel.fZAxis);
+			Gravity.fXAxis *= fNorm;
+			Gravity.fYAxis *= fNorm;
+			Gravity.fZAxis *= fNorm;
+		}
+	}
+
+	Accel = Gravity;
+
+	for (uint8_t t = 0; t < IMUSIM_MAX_TONES; t++)
+	{
+		if (Config.Tone[t].fFreq <= 0.0f) {continue;}
+
+		Accel.fXAxis += Config.Tone[t].Amplitude.fXAxis * fTone[t][1];
+		Accel.fYAxis += Config.Tone[t].Amplitude.fYAxis * fTone[t][1];
+		Accel.fZAxis += Config.Tone[t].Amplitude.fZAxis * fTone[t][1];
+
+		fPhase0 = fTone[t][0] * fToneStep[t][0] - fTone[t][1] * fToneStep[t][1];
+		fPhase1 = fTone[t][1] * fToneStep[t][0] + fTone[t][0] * fToneStep[t][1];
+
+		/* First-order correction of the phasor magnitude */
+		fNorm = 1.5f - 0.5f * (fPhase0 * fPhase0 + fPhase1 * fPhase1);
+		fTone[t][0] = fPhase0 * fNorm;
+		fTone[t][1] = fPhase1 * fNorm;
+	}
+
+	if (ui32ImpactLength > 0)
+	{
+		if (ui32ImpactPhase == ui32ImpactPeriod)
+		{
+			ui32ImpactPhase = 0;
+			fImpact[0] = 1.0f;
+			fImpact[1] = 0.0f;
+		}
+
+		if (ui32ImpactPhase++ < ui32ImpactLength)
+		{
+			Accel.fXAxis += Config.ImpactPeak.fXAxis * fImpact[1];
+			Accel.fYAxis += Config.ImpactPeak.fYAxis * fImpact[1];
+			Accel.fZAxis += Config.ImpactPeak.fZAxis * fImpact[1];
+
+			fPhase0    = fImpact[0] * fImpactStep[0] - fImpact[1] * fImpactStep[1];
+			fImpact[1] = fImpact[1] * fImpactStep[0] + fImpact[0] * fImpactStep[1];
+			fImpact[0] = fPhase0;
+		}
+	}
+
+	Truth.Accel = Accel;
+
+	pRaw[0] = quantize(Accel.fXAxis + Truth.AccelBias.fXAxis + fAccelSigma * getGauss(), fAccelCounts);
+	pRaw[1] = quantize(Accel.fYAxis + Truth.AccelBias.fYAxis + fAccelSigma * getGauss(), fAccelCounts);
+	pRaw[2] = quantize(Accel.fZAxis + Truth.AccelBias.fZAxis + fAccelSigma * getGauss(), fAccelCounts);
+	pRaw[3] = quantize(Truth.Gyro.fXAxis + Truth.GyroBias.fXAxis + fGyroSigma * getGauss(), fGyroCounts);
+	pRaw[4] = quantize(Truth.Gyro.fYAxis + Truth.GyroBias.fYAxis + fGyroSigma * getGauss(), fGyroCounts);
+	pRaw[5] = quantize(Truth.Gyro.fZAxis + Truth.GyroBias.fZAxis + fGyroSigma * getGauss(), fGyroCounts);
+	pRaw[6] = quantize(Truth.fTemperature - IMUSIM_TEMP_OFFSET, IMUSIM_TEMP_SENS);
+
+	ui64Samples++;
+}
+
+
+/* Gauss-Markov instability, random walk and temperature drift of the biases */
+void IMUSIM::updateBias(void)
+{
+	float fAccelBias[3], fGyroBias[3];
+	float fDeltaT;
+
+	if (ui64Samples > 0)
+	{
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			fAccelGM[i]  = fGaussMarkov * fAccelGM[i] + fAccelGMDrive * getGauss();
+			fGyroGM[i]   = fGaussMarkov * fGyroGM[i]  + fGyroGMDrive  * getGauss();
+			fAccelRW[i] += fAccelRWStep * getGauss();
+			fGyroRW[i]  += fGyroRWStep  * getGauss();
+		}
+	}
+
+	Truth.fTemperature = Config.fTemperature + Config.fTemperatureSlope * (float)ui64Samples * fDt;
+	fDeltaT = Truth.fTemperature - Config.fTemperature;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		fAccelBias[i] = fAccelTurnOn[i] + fAccelGM[i] + fAccelRW[i] + Config.fAccelTempCoeff * fDeltaT;
+		fGyroBias[i]  = fGyroTurnOn[i]  + fGyroGM[i]  + fGyroRW[i]  + Config.fGyroTempCoeff  * fDeltaT;
+	}
+
+	Truth.AccelBias.fXAxis = fAccelBias[0];
+	Truth.AccelBias.fYAxis = fAccelBias[1];
+	Truth.AccelBias.fZAxis = fAccelBias[2];
+	Truth.GyroBias.fXAxis  = fGyroBias[0];
+	Truth.GyroBias.fYAxis  = fGyroBias[1];
+	Truth.GyroBias.fZAxis  = fGyroBias[2];
+}
+
+
+inline uint64_t IMUSIM::getRandom(void)
+{
+	ui64State ^= ui64State >> 12;
+	ui64State ^= ui64State << 25;
+	ui64State ^= ui64State >> 27;
+
+	return ui64State * 0x2545F4914F6CDD1DULL;
+}
+
+
+/* Approximately normal distributed (Irwin-Hall, n = 4), mean 0, standard deviation 1 */
+inline float IMUSIM::getGauss(void)
+{
+	uint64_t ui64Random = getRandom();
+	uint32_t ui32Sum = (uint32_t)(ui64Random & 0xFFFF) + (uint32_t)((ui64Random >> 16) & 0xFFFF)
+			         + (uint32_t)((ui64Random >> 32) & 0xFFFF) + (uint32_t)(ui64Random >> 48);
+
+	return ((float)ui32Sum - IMUSIM_GAUSS_MEAN) * IMUSIM_GAUSS_SCALE;
+}
+
+
+/* Rounding to the nearest count, saturation like the sensor */
+inline int16_t IMUSIM::quantize(float fValue, float fCounts)
+{
+	float fRaw = fValue * fCounts;
+
+	if (fRaw >=  32767.0f) {return  32767;}
+	if (fRaw <= -32768.0f) {return -32768;}
+
+	return (int16_t)std::lrintf(fRaw);
+}
@@ -0,0 +1,412 @@
+/*
+ * motion.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "motion.hpp"
+#include <string.h>
+
+
+/* MOTION class */
+MOTION::MOTION(const MOTION_Config_t *pConfig) : ui16Head(0), ui16Tail(0), ui32Dropped(0)
+{
+	if (init(pConfig) != 0) {init(&MOTION_DEFAULT_CONFIG);}
+}
+
+
+/* Public methods */
+/**
+  @brief  Checks and applies a configuration (the event queue is kept)
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t MOTION::init(const MOTION_Config_t *pConfig)
+{
+	int32_t i32Shock, i32FreeFall, i32Hyst;
+
+	if (pConfig->ui8TapShift == 0 || pConfig->ui8TapShift > 15) {return -1;}
+	if (pConfig->ui8OrientShift == 0 || pConfig->ui8OrientShift > 15) {return -1;}
+	if (pConfig->ui16ShockDuration == 0 || pConfig->ui16FreeFallDuration == 0 || pConfig->ui16TapMaxDuration == 0) {return -1;}
+	if (pConfig->ui16Hysteresis >= pConfig->ui16ShockThreshold || pConfig->ui16Hysteresis >= pConfig->ui16TapThreshold) {return -1;}
+
+	/* The magnitude is at most sqrt(3) * 16g, larger thresholds never trigger */
+	if (pConfig->ui16ShockThreshold > 27000 || pConfig->ui16FreeFallThreshold + pConfig->ui16Hysteresis > 27000) {return -1;}
+
+	Config = *pConfig;
+
+	i32Shock    = (int32_t)Config.ui16ShockThreshold * MOTION_LSB_PER_G / 1000;
+	i32FreeFall = (int32_t)Config.ui16FreeFallThreshold * MOTION_LSB_PER_G / 1000;
+	i32Hyst     = (int32_t)Config.ui16Hysteresis * MOTION_LSB_PER_G / 1000;
+
+	ui32ShockThr2        = i32Shock * i32Shock;
+	ui32ShockRelease2    = (i32Shock - i32Hyst) * (i32Shock - i32Hyst);
+	ui32FreeFallThr2     = i32FreeFall * i32FreeFall;
+	ui32FreeFallRelease2 = (i32FreeFall + i32Hyst) * (i32FreeFall + i32Hyst);
+	i32TapThr            = (int32_t)Config.ui16TapThreshold * MOTION_LSB_PER_G / 1000;
+	i32TapRelease        = i32TapThr - i32Hyst;
+	i32OrientThr         = (int32_t)Config.ui16OrientThreshold * MOTION_LSB_PER_G / 1000;
+
+	reset();
+
+	return 0;
+}
+
+
+/* Restarts all detectors (the event queue is kept) */
+void MOTION::reset(void)
+{
+	boShock         = false;
+	ui16ShockLength = 0;
+	ui32ShockPeak2  = 0;
+	ui32ShockStart  = 0;
+
+	ui16FreeFallLength = 0;
+	ui32FreeFallMin2   = 0xFFFFFFFF;
+	ui32FreeFallStart  = 0;
+
+	boTap           = false;
+	boTapReject     = false;
+	ui16TapLength   = 0;
+	i32TapPeak      = 0;
+	ui8TapDirection = MOTION_ORIENT_UNKNOWN;
+	ui32TapStart    = 0;
+	ui16TapQuiet    = 0;
+	ui16TapWindow   = 0;
+	memset(&PendingTap, 0, sizeof(PendingTap));
+
+	ui8Orientation      = MOTION_ORIENT_UNKNOWN;
+	ui8Candidate        = MOTION_ORIENT_UNKNOWN;
+	ui16CandidateLength = 0;
+
+	boFirst = true;
+}
+
+
+/**
+  @brief  Runs the detectors over decoded frames
+  @param  ui32Timestamp: Timestamp of the first frame, the following frames are ui32SamplePeriod apart
+  @retval Number of events queued
+**/
+uint16_t MOTION::process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count, uint32_t ui32Timestamp)
+{
+	uint16_t ui16Before = ui16Head.load(std::memory_order_relaxed);
+	int32_t  i32Sample[3];
+	uint8_t  ui8Shift;
+
+	for (uint16_t i = 0; i < ui16Count; i++, ui32Timestamp += Config.ui32SamplePeriod)
+	{
+		if (pFrames[i].ui8Flags & ICM20948_FRAME_TRANSITION) {continue;}
+
+		/* MOTION_LSB_PER_G: 16384 LSB/g (ACCEL_FS_2G) / 16, doubled for every larger full scale */
+		ui8Shift = (ICM20948_RANGE_ACCEL(pFrames[i].ui8Range) >> 1) & 0x03;
+		i32Sample[0] = ((int32_t)pFrames[i].Accel.i16XAxis * (1 << ui8Shift)) >> 4;
+		i32Sample[1] = ((int32_t)pFrames[i].Accel.i16YAxis * (1 << ui8Shift)) >> 4;
+		i32Sample[2] = ((int32_t)pFrames[i].Accel.i16ZAxis * (1 << ui8Shift)) >> 4;
+
+		processSample(i32Sample, ui32Timestamp);
+	}
+
+	return ui16Head.load(std::memory_order_relaxed) - ui16Before;
+}
+
+
+/**
+  @brief  Takes the oldest event from the queue
+  @retval  1: Event copied to pEvent
+           0: Queue empty
+**/
+int16_t MOTION::getEvent(MOTION_Event_t *pEvent)
+{
+	uint16_t ui16Index = ui16Tail.load(std::memory_order_relaxed);
+
+	if (ui16Index == ui16Head.load(std::memory_order_acquire)) {return 0;}
+
+	*pEvent = Queue[ui16Index & (MOTION_QUEUE_SIZE - 1)];
+	ui16Tail.store(ui16Index + 1, std::memory_order_release);
+
+	return 1;
+}
+
+
+/* Events lost because the queue was full */
+uint32_t MOTION::getDropped(void)
+{
+	return ui32Dropped.load(std::memory_order_relaxed);
+}
+
+
+/* MOTION_ORIENT_... (MOTION_ORIENT_UNKNOWN until the first orientation was stable) */
+uint8_t MOTION::getOrientation(void)
+{
+	return ui8Orientation;
+}
+
+
+/* Private methods */
+inline void MOTION::processSample(const int32_t *pSample, uint32_t ui32Time)
+{
+	MOTION_Event_t Event;
+	uint32_t ui32Mag2;
+	int32_t  i32Dev, i32MaxDev = 0, i32MaxGrav = 0, i32Abs;
+	uint8_t  ui8Dir = 0, ui8Up = 0;
+
+	memset(&Event, 0, sizeof(Event));
+	Event.ui8Previous = MOTION_ORIENT_UNKNOWN;
+
+	if (boFirst)
+	{
+		for (uint8_t a = 0; a < 3; a++)
+		{
+			i32TapLowPass[a]    = pSample[a] * 256;
+			i32OrientLowPass[a] = pSample[a] * 256;
+		}
+		boFirst = false;
+	}
+
+	ui32Mag2 = pSample[0] * pSample[0] + pSample[1] * pSample[1] + pSample[2] * pSample[2];
+
+	/* Shock: magnitude above the threshold for at least ui16ShockDuration samples, reported at the release */
+	if (!boShock)
+	{
+		if (ui32Mag2 > ui32ShockThr2)
+		{
+			boShock         = true;
+			ui16ShockLength = 0;
+			ui32ShockPeak2  = 0;
+			ui32ShockStart  = ui32Time;
+		}
+	}
+	if (boShock)
+	{
+		if (ui32Mag2 > ui32ShockPeak2) {ui32ShockPeak2 = ui32Mag2;}
+
+		if (ui32Mag2 < ui32ShockRelease2)
+		{
+			boShock = false;
+
+			if (ui16ShockLength >= Config.ui16ShockDuration && (Config.ui8Enable & MOTION_EVENT_SHOCK))
+			{
+				Event.ui32Timestamp = ui32ShockStart;
+				Event.ui8Type       = MOTION_EVENT_SHOCK;
+				Event.ui8Direction  = MOTION_ORIENT_UNKNOWN;
+				Event.ui16Duration  = ui16ShockLength;
+				Event.ui16Value     = toMilliG(sqrtInt(ui32ShockPeak2));
+				pushEvent(&Event);
+			}
+		}
+		else if (ui16ShockLength < 0xFFFF) {ui16ShockLength++;}
+	}
+
+	/* Free-fall: magnitude below the threshold for ui16FreeFallDuration samples, reported once per fall */
+	if (ui32Mag2 < ui32FreeFallThr2)
+	{
+		if (ui16FreeFallLength == 0)
+		{
+			ui32FreeFallStart = ui32Time;
+			ui32FreeFallMin2  = 0xFFFFFFFF;
+		}
+		if (ui32Mag2 < ui32FreeFallMin2) {ui32FreeFallMin2 = ui32Mag2;}
+
+		if (ui16FreeFallLength < 0xFFFF) {ui16FreeFallLength++;}
+
+		if (ui16FreeFallLength == Config.ui16FreeFallDuration && (Config.ui8Enable & MOTION_EVENT_FREEFALL))
+		{
+			Event.ui32Timestamp = ui32FreeFallStart;
+			Event.ui8Type       = MOTION_EVENT_FREEFALL;
+			Event.ui8Direction  = MOTION_ORIENT_UNKNOWN;
+			Event.ui16Duration  = ui16FreeFallLength;
+			Event.ui16Value     = toMilliG(sqrtInt(ui32FreeFallMin2));
+			pushEvent(&Event);
+		}
+	}
+	else if (ui32Mag2 > ui32FreeFallRelease2)
+	{
+		ui16FreeFallLength = 0;
+	}
+
+	/* Tap: short deviation of an axis from its low-pass value. The low-pass is held during a tap. */
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		i32Dev = pSample[a] - (i32TapLowPass[a] >> 8);
+		i32Abs = (i32Dev < 0) ? -i32Dev : i32Dev;
+		if (i32Abs > i32MaxDev)
+		{
+			i32MaxDev = i32Abs;
+			ui8Dir    = 2 * a + ((i32Dev < 0) ? 1 : 0);
+		}
+	}
+
+	if (ui16TapQuiet > 0) {ui16TapQuiet--;}
+
+	if (!boTap)
+	{
+		if (i32MaxDev > i32TapThr && ui16TapQuiet == 0)
+		{
+			boTap           = true;
+			boTapReject     = false;
+			ui16TapLength   = 0;
+			i32TapPeak      = 0;
+			ui8TapDirection = ui8Dir;
+			ui32TapStart    = ui32Time;
+		}
+	}
+	if (boTap)
+	{
+		if (i32MaxDev > i32TapPeak) {i32TapPeak = i32MaxDev;}
+
+		/* A shock is not a tap */
+		if (boShock) {boTapReject = true;}
+
+		if (i32MaxDev < i32TapRelease)
+		{
+			boTap = false;
+
+			if (!boTapReject && (Config.ui8Enable & (MOTION_EVENT_TAP | MOTION_EVENT_DOUBLE_TAP)))
+			{
+				Event.ui32Timestamp = ui32TapStart;
+				Event.ui8Type       = MOTION_EVENT_TAP;
+				Event.ui8Direction  = ui8TapDirection;
+				Event.ui16Duration  = ui16TapLength;
+				Event.ui16Value     = toMilliG(i32TapPeak);
+
+				if (ui16TapWindow > 0)
+				{
+					/* Second tap within the window */
+					PendingTap.ui8Type = MOTION_EVENT_DOUBLE_TAP;
+					pushEvent(&PendingTap);
+					ui16TapWindow = 0;
+				}
+				else if (Config.ui8Enable & MOTION_EVENT_DOUBLE_TAP)
+				{
+					PendingTap    = Event;
+					ui16TapWindow = Config.ui16TapWindow + 1;
+				}
+				else
+				{
+					pushEvent(&Event);
+				}
+
+				ui16TapQuiet = Config.ui16TapQuiet;
+			}
+		}
+		else if (++ui16TapLength > Config.ui16TapMaxDuration)
+		{
+			boTapReject = true;
+		}
+	}
+
+	if (!boTap || boTapReject)
+	{
+		for (uint8_t a = 0; a < 3; a++)
+		{
+			i32TapLowPass[a] += (pSample[a] * 256 - i32TapLowPass[a]) >> Config.ui8TapShift;
+		}
+	}
+
+	/* No second tap: single tap (reported with the time of the tap) */
+	if (ui16TapWindow > 0 && --ui16TapWindow == 0 && (Config.ui8Enable & MOTION_EVENT_TAP))
+	{
+		pushEvent(&PendingTap);
+	}
+
+	/* Orientation: axis with the largest low-pass gravity, stable for ui16OrientDuration samples */
+	for (uint8_t a = 0; a < 3; a++)
+	{
+		i32OrientLowPass[a] += (pSample[a] * 256 - i32OrientLowPass[a]) >> Config.ui8OrientShift;
+
+		i32Abs = i32OrientLowPass[a] >> 8;
+		if (i32Abs < 0) {i32Abs = -i32Abs;}
+		if (i32Abs > i32MaxGrav)
+		{
+			i32MaxGrav = i32Abs;
+			ui8Up      = 2 * a + ((i32OrientLowPass[a] < 0) ? 1 : 0);
+		}
+	}
+
+	/* Between two orientations (below the threshold) the current orientation is kept */
+	if (i32MaxGrav < i32OrientThr || ui8Up == ui8Orientation)
+	{
+		ui8Candidate        = MOTION_ORIENT_UNKNOWN;
+		ui16CandidateLength = 0;
+		return;
+	}
+
+	if (ui8Up != ui8Candidate)
+	{
+		ui8Candidate        = ui8Up;
+		ui16CandidateLength = 0;
+	}
+
+	if (++ui16CandidateLength >= Config.ui16OrientDuration)
+	{
+		if (Config.ui8Enable & MOTION_EVENT_ORIENTATION)
+		{
+			Event.ui32Timestamp = ui32Time;
+			Event.ui8Type       = MOTION_EVENT_ORIENTATION;
+			Event.ui8Direction  = ui8Up;
+			Event.ui8Previous   = ui8Orientation;
+			Event.ui16Duration  = 0;
+			Event.ui16Value     = 0;
+			pushEvent(&Event);
+		}
+
+		ui8Orientation      = ui8Up;
+		ui8Candidate        = MOTION_ORIENT_UNKNOWN;
+		ui16CandidateLength = 0;
+	}
+}
+
+
+/* Producer side of the queue, a full queue drops the new event */
+bool MOTION::pushEvent(const MOTION_Event_t *pEvent)
+{
+	uint16_t ui16Index = ui16Head.load(std::memory_order_relaxed);
+
+	if ((uint16_t)(ui16Index - ui16Tail.load(std::memory_order_acquire)) >= MOTION_QUEUE_SIZE)
+	{
+		ui32Dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Queue[ui16Index & (MOTION_QUEUE_SIZE - 1)] = *pEvent;
+	ui16Head.store(ui16Index + 1, std::memory_order_release);
+
+	return true;
+}
+
+
+/* MOTION_LSB_PER_G to mg */
+uint16_t MOTION::toMilliG(uint32_t ui32Value)
+{
+	ui32Value = ui32Value * 1000 / MOTION_LSB_PER_G;
+
+	return (ui32Value > 0xFFFF) ? 0xFFFF : ui32Value;
+}
+
+
+/* Integer square root (only evaluated for an event) */
+uint32_t MOTION::sqrtInt(uint32_t ui32Value)
+{
+	uint32_t ui32Root = 0;
+	uint32_t ui32Bit  = (uint32_t)1 << 30;
+
+	while (ui32Bit > ui32Value) {ui32Bit >>= 2;}
+
+	while (ui32Bit != 0)
+	{
+		if (ui32Value >= ui32Root + ui32Bit)
+		{
+			ui32Value -= ui32Root + ui32Bit;
+			ui32Root   = (ui32Root >> 1) + ui32Bit;
+		}
+		else
+		{
+			ui32Root >>= 1;
+		}
+		ui32Bit >>= 2;
+	}
+
+	return ui32Root;
+}
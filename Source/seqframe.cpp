@@ -0,0 +1,99 @@
+/*
+ * seqframe.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "seqframe.hpp"
+#include <string.h>
+#include <type_traits>
+
+
+static_assert(std::is_trivially_copyable<SEQFRAME_Sample_t>::value, "SEQFRAME_Sample_t must be copied word by word");
+
+
+/* SEQFRAME class */
+SEQFRAME::SEQFRAME(void) : ui32Sequence(0)
+{
+	for (uint16_t i = 0; i < SEQFRAME_WORDS; i++)
+	{
+		ui32Data[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+
+/* Public methods */
+/* Single writer, wait-free */
+void SEQFRAME::publish(const ICM20948_Frame_t *pFrame, uint64_t ui64Timestamp)
+{
+	SEQFRAME_Sample_t Sample;
+	uint32_t ui32Buffer[SEQFRAME_WORDS] = {0};
+	uint32_t ui32Seq = ui32Sequence.load(std::memory_order_relaxed);
+
+	Sample.Frame         = *pFrame;
+	Sample.ui64Timestamp = ui64Timestamp;
+	Sample.ui32Sequence  = (ui32Seq >> 1) + 1;
+	memcpy(ui32Buffer, &Sample, sizeof(SEQFRAME_Sample_t));
+
+	/* Odd: write in progress. The fence keeps the data stores behind the counter store. */
+	ui32Sequence.store(ui32Seq + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (uint16_t i = 0; i < SEQFRAME_WORDS; i++)
+	{
+		ui32Data[i].store(ui32Buffer[i], std::memory_order_relaxed);
+	}
+
+	ui32Sequence.store(ui32Seq + 2, std::memory_order_release);
+}
+
+
+/**
+  @brief  Copies the latest sample
+  @param  ui16MaxRetries: Max. number of repeated attempts if the writer interferes
+  @retval >=0: Number of repeated attempts (contention)
+           -1: No consistent copy within the attempts (writer faster than the reader) or nothing published yet
+**/
+int16_t SEQFRAME::read(SEQFRAME_Sample_t *pSample, uint16_t ui16MaxRetries)
+{
+	uint32_t ui32Copy[SEQFRAME_WORDS];
+	uint32_t ui32Seq1, ui32Seq2;
+
+	if (ui16MaxRetries > INT16_MAX) {ui16MaxRetries = INT16_MAX;}
+
+	for (uint16_t ui16Attempt = 0; ui16Attempt <= ui16MaxRetries; ui16Attempt++)
+	{
+		ui32Seq1 = ui32Sequence.load(std::memory_order_acquire);
+
+		if (ui32Seq1 == 0) {return -1;}
+
+		if ((ui32Seq1 & 1) == 0)
+		{
+			for (uint16_t i = 0; i < SEQFRAME_WORDS; i++)
+			{
+				ui32Copy[i] = ui32Data[i].load(std::memory_order_relaxed);
+			}
+
+			/* The fence keeps the data loads ahead of the second counter load */
+			std::atomic_thread_fence(std::memory_order_acquire);
+			ui32Seq2 = ui32Sequence.load(std::memory_order_relaxed);
+
+			if (ui32Seq1 == ui32Seq2)
+			{
+				memcpy(pSample, ui32Copy, sizeof(SEQFRAME_Sample_t));
+				return ui16Attempt;
+			}
+		}
+	}
+
+	return -1;
+}
+
+
+/* Number of publications, a reader compares it with the last value to detect a new sample */
+uint32_t SEQFRAME::getSequence(void)
+{
+	return ui32Sequence.load(std::memory_order_acquire) >> 1;
+}
+
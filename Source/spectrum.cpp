@@ -0,0 +1,419 @@
+/*
+ * spectrum.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include "spectrum.hpp"
+#include <cmath>
+#include <string.h>
+
+
+/* Accelerometer sensitivity [g/LSB], indexed by ICM20948_RANGE_ACCEL() >> 1 */
+static const float SPECTRUM_ACCEL_SENS[4] = {2.0f / 32768, 4.0f / 32768, 8.0f / 32768, 16.0f / 32768};
+
+
+/* SPECTRUM class */
+SPECTRUM::SPECTRUM(void)
+{
+	memset(&Config, 0, sizeof(Config));
+	ui16Half  = 0;
+	fPsdScale = 0.0;
+
+	memset(&Summary, 0, sizeof(Summary));
+	memset(fPsd, 0, sizeof(fPsd));
+
+	reset();
+}
+
+
+/* Public methods */
+/**
+  @brief  Checks and applies a configuration, calculates the twiddle factors, the window and the bit reversal
+  @retval  0: OK
+          -1: Invalid configuration
+**/
+int16_t SPECTRUM::init(const SPECTRUM_Config_t *pConfig)
+{
+	uint16_t ui16Size = pConfig->ui16Size;
+	uint8_t  ui8Log2Half = 0;
+	float    fSum = 0.0;
+
+	if (pConfig->fSampleRate <= 0.0) {return -1;}
+	if (ui16Size < SPECTRUM_MIN_SIZE || ui16Size > SPECTRUM_MAX_SIZE || (ui16Size & (ui16Size - 1)) != 0) {return -1;}
+	if (pConfig->ui16Hop == 0 || pConfig->ui16Hop > ui16Size || pConfig->ui16Averages == 0) {return -1;}
+	if (pConfig->ui8Bands > SPECTRUM_MAX_BANDS) {return -1;}
+
+	for (uint8_t b = 0; b < pConfig->ui8Bands; b++)
+	{
+		if (pConfig->fBandEdge[b] < 0.0 || pConfig->fBandEdge[b + 1] <= pConfig->fBandEdge[b]) {return -1;}
+	}
+
+	Config   = *pConfig;
+	ui16Half = ui16Size / 2;
+
+	for (uint16_t k = 0; k < ui16Size; k++)
+	{
+		fCos[k] = std::cos(2.0 * M_PI * k / ui16Size);
+	}
+
+	/* Periodic Hann window */
+	for (uint16_t n = 0; n < ui16Size; n++)
+	{
+		fWindow[n] = 0.5f - 0.5f * fCos[n];
+		fSum += fWindow[n] * fWindow[n];
+	}
+	fPsdScale = 2.0f / (Config.fSampleRate * fSum);
+
+	while (((uint16_t)1 << ui8Log2Half) < ui16Half) {ui8Log2Half++;}
+	for (uint16_t k = 0; k < ui16Half; k++)
+	{
+		ui16BitRev[k] = 0;
+		for (uint8_t b = 0; b < ui8Log2Half; b++)
+		{
+			if (k & (1 << b)) {ui16BitRev[k] |= 1 << (ui8Log2Half - 1 - b);}
+		}
+	}
+
+	memset(&Summary, 0, sizeof(Summary));
+	memset(fPsd, 0, sizeof(fPsd));
+
+	reset();
+
+	return 0;
+}
+
+
+/* Discards the buffered samples and the windows of the current summary */
+void SPECTRUM::reset(void)
+{
+	memset(fPsdSum, 0, sizeof(fPsdSum));
+
+	ui16Fill    = 0;
+	ui16Windows = 0;
+	ui8Flags    = 0;
+}
+
+
+/**
+  @brief  Adds decoded frames (accelerometer data is used, any full scale)
+  @retval  1: A new summary is ready (getSummary()), only the last one is kept if a batch completes several
+           0: No new summary
+          -1: Not initialized
+**/
+int16_t SPECTRUM::process(const ICM20948_Frame_t *pFrames, uint16_t ui16Count)
+{
+	int16_t i16Ready = 0;
+	float fSens;
+
+	if (ui16Half == 0) {return -1;}
+
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		fSens = SPECTRUM_ACCEL_SENS[(ICM20948_RANGE_ACCEL(pFrames[i].ui8Range) >> 1) & 0x03];
+
+		fInput[0][ui16Fill] = pFrames[i].Accel.i16XAxis * fSens;
+		fInput[1][ui16Fill] = pFrames[i].Accel.i16YAxis * fSens;
+		fInput[2][ui16Fill] = pFrames[i].Accel.i16ZAxis * fSens;
+		ui16Fill++;
+		ui8Flags |= pFrames[i].ui8Flags;
+
+		if (ui16Fill < Config.ui16Size) {continue;}
+
+		processWindow();
+
+		/* Overlap: the last ui16Size - ui16Hop samples are part of the next window */
+		ui16Fill = Config.ui16Size - Config.ui16Hop;
+		for (uint8_t a = 0; a < SPECTRUM_AXES; a++)
+		{
+			memmove(fInput[a], &fInput[a][Config.ui16Hop], ui16Fill * sizeof(float));
+		}
+
+		if (++ui16Windows >= Config.ui16Averages)
+		{
+			finishSummary();
+			i16Ready = 1;
+		}
+	}
+
+	return i16Ready;
+}
+
+
+void SPECTRUM::getSummary(SPECTRUM_Summary_t *pSummary)
+{
+	*pSummary = Summary;
+}
+
+
+/**
+  @brief  Copies the averaged PSD of the last summary (bins 0...ui16Size / 2, bin k is centered at k * getBinWidth())
+  @param  pPsd:  [g^2/Hz]
+          pBins: Number of bins copied
+  @retval  0: OK
+          -1: Invalid axis
+**/
+int16_t SPECTRUM::getPsd(uint8_t ui8Axis, float *pPsd, uint16_t ui16MaxBins, uint16_t *pBins)
+{
+	uint16_t ui16Bins = ui16Half + 1;
+
+	*pBins = 0;
+
+	if (ui8Axis >= SPECTRUM_AXES) {return -1;}
+
+	if (ui16Bins > ui16MaxBins) {ui16Bins = ui16MaxBins;}
+	memcpy(pPsd, fPsd[ui8Axis], ui16Bins * sizeof(float));
+	*pBins = ui16Bins;
+
+	return 0;
+}
+
+
+float SPECTRUM::getBinWidth(void)
+{
+	if (Config.ui16Size == 0) {return 0.0;}
+
+	return Config.fSampleRate / Config.ui16Size;
+}
+
+
+/**
+  @brief  Packs a summary for the uplink: sequence (4 bytes), windows (2 bytes), bands, flags, then per axis the
+          overall level, the peak bin (2 bytes) and the band levels. Levels are 8 bit, SPECTRUM_LEVEL_STEP dB
+          above SPECTRUM_LEVEL_REF (see getLevelRms()), multi-byte values are big endian.
+  @param  ui16Size: Size of pBuffer, at least SPECTRUM_PACKED_SIZE(ui8Bands)
+  @retval Number of bytes written (0: buffer too small)
+**/
+uint16_t SPECTRUM::packSummary(const SPECTRUM_Summary_t *pSummary, uint8_t *pBuffer, uint16_t ui16Size)
+{
+	uint16_t ui16Pos = 0;
+	uint16_t ui16Peak;
+	float fLevel;
+
+	if (ui16Size < SPECTRUM_PACKED_SIZE(pSummary->ui8Bands)) {return 0;}
+
+	pBuffer[ui16Pos++] = pSummary->ui32Sequence >> 24;
+	pBuffer[ui16Pos++] = pSummary->ui32Sequence >> 16;
+	pBuffer[ui16Pos++] = pSummary->ui32Sequence >> 8;
+	pBuffer[ui16Pos++] = pSummary->ui32Sequence;
+	pBuffer[ui16Pos++] = pSummary->ui16Windows >> 8;
+	pBuffer[ui16Pos++] = pSummary->ui16Windows;
+	pBuffer[ui16Pos++] = pSummary->ui8Bands;
+	pBuffer[ui16Pos++] = pSummary->ui8Flags;
+
+	for (uint8_t a = 0; a < SPECTRUM_AXES; a++)
+	{
+		for (int16_t b = -1; b < pSummary->ui8Bands; b++)
+		{
+			fLevel = (b < 0) ? pSummary->fRms[a] : pSummary->fBandRms[a][b];
+			fLevel = (fLevel > SPECTRUM_LEVEL_REF) ? 20.0f * log10f(fLevel / SPECTRUM_LEVEL_REF) / SPECTRUM_LEVEL_STEP : 0.0f;
+			pBuffer[ui16Pos++] = (fLevel < 255.0f) ? (uint8_t)(fLevel + 0.5f) : 255;
+
+			if (b < 0)
+			{
+				ui16Peak = (pSummary->fPeakFreq[a] < 65535.0f) ? (uint16_t)(pSummary->fPeakFreq[a] + 0.5f) : 65535;
+				pBuffer[ui16Pos++] = ui16Peak >> 8;
+				pBuffer[ui16Pos++] = ui16Peak;
+			}
+		}
+	}
+
+	return ui16Pos;
+}
+
+
+/* RMS [g] of a packed level */
+float SPECTRUM::getLevelRms(uint8_t ui8Level)
+{
+	return SPECTRUM_LEVEL_REF * powf(10.0f, ui8Level * SPECTRUM_LEVEL_STEP / 20.0f);
+}
+
+
+/* Private methods */
+/* Windowed real FFT of the last ui16Size samples of each axis, the PSD is added to fPsdSum */
+void SPECTRUM::processWindow(void)
+{
+	const uint16_t N = Config.ui16Size;
+	const uint16_t M = ui16Half;
+	const uint16_t Q = N / 4;
+	float fMean;
+	float fZr, fZi, fCr, fCi, fEr, fEi, fOr, fOi, fWr, fWi, fXr, fXi;
+	uint16_t ui16K, ui16C;
+
+	for (uint8_t a = 0; a < SPECTRUM_AXES; a++)
+	{
+		const float *pIn = fInput[a];
+		float *pPsd = fPsdSum[a];
+
+		/* Detrend and window, the even samples are the real part, the odd samples the imaginary part */
+		fMean = 0.0;
+		for (uint16_t n = 0; n < N; n++) {fMean += pIn[n];}
+		fMean /= N;
+
+		for (uint16_t n = 0; n < M; n++)
+		{
+			fRe[n] = (pIn[2 * n] - fMean) * fWindow[2 * n];
+			fIm[n] = (pIn[2 * n + 1] - fMean) * fWindow[2 * n + 1];
+		}
+
+		transform();
+
+		/* Split into the spectrum of the real sequence: X[k] = E[k] + W_N^k * O[k] with
+		 * E[k] = (Z[k] + conj(Z[M-k])) / 2 and O[k] = (Z[k] - conj(Z[M-k])) / 2i (Z is in bit reversed order) */
+		fZr = fRe[0];
+		fZi = fIm[0];
+		pPsd[0] += 0.5f * fPsdScale * (fZr + fZi) * (fZr + fZi);
+		pPsd[M] += 0.5f * fPsdScale * (fZr - fZi) * (fZr - fZi);
+
+		for (uint16_t k = 1; k < M; k++)
+		{
+			ui16K = ui16BitRev[k];
+			ui16C = ui16BitRev[M - k];
+
+			fZr =  fRe[ui16K];
+			fZi =  fIm[ui16K];
+			fCr =  fRe[ui16C];
+			fCi = -fIm[ui16C];
+
+			fEr = 0.5f * (fZr + fCr);
+			fEi = 0.5f * (fZi + fCi);
+			fOr = 0.5f * (fZi - fCi);
+			fOi = 0.5f * (fCr - fZr);
+
+			fWr = fCos[k];
+			fWi = fCos[k + Q];
+
+			fXr = fEr + fWr * fOr - fWi * fOi;
+			fXi = fEi + fWr * fOi + fWi * fOr;
+
+			pPsd[k] += fPsdScale * (fXr * fXr + fXi * fXi);
+		}
+	}
+}
+
+
+/* In-place complex FFT of fRe/fIm (length ui16Half), the result is in bit reversed order */
+void SPECTRUM::transform(void)
+{
+	const uint16_t N = Config.ui16Size;
+	const uint16_t M = ui16Half;
+	const uint16_t Q4 = N / 4;   // Offset of the imaginary part in fCos[]
+	uint16_t L = M;
+	uint16_t Q, ui16Stride;
+	float fAr, fAi, fBr, fBi, fCr, fCi, fDr, fDi;
+	float fT0r, fT0i, fT1r, fT1i, fT2r, fT2i, fT3r, fT3i;
+	float fW1r, fW1i, fW2r, fW2i, fW3r, fW3i;
+
+	/* Radix-2^2 stages: two radix-2 decimation in frequency stages merged, 3 complex multiplications per butterfly */
+	for (; L >= 4; L >>= 2)
+	{
+		Q = L / 4;
+		ui16Stride = N / L; // W_L^j = W_N^(j * ui16Stride)
+
+		for (uint16_t g = 0; g < M; g += L)
+		{
+			float *pRe = &fRe[g];
+			float *pIm = &fIm[g];
+
+			for (uint16_t j = 0; j < Q; j++)
+			{
+				fAr = pRe[j];         fAi = pIm[j];
+				fBr = pRe[j + Q];     fBi = pIm[j + Q];
+				fCr = pRe[j + 2 * Q]; fCi = pIm[j + 2 * Q];
+				fDr = pRe[j + 3 * Q]; fDi = pIm[j + 3 * Q];
+
+				fT0r = fAr + fCr; fT0i = fAi + fCi;
+				fT1r = fAr - fCr; fT1i = fAi - fCi;
+				fT2r = fBr + fDr; fT2i = fBi + fDi;
+				fT3r = fBr - fDr; fT3i = fBi - fDi;
+
+				fW1r = fCos[j * ui16Stride];     fW1i = fCos[j * ui16Stride + Q4];
+				fW2r = fCos[2 * j * ui16Stride]; fW2i = fCos[2 * j * ui16Stride + Q4];
+				fW3r = fCos[3 * j * ui16Stride]; fW3i = fCos[3 * j * ui16Stride + Q4];
+
+				/* x[j] = t0 + t2 */
+				pRe[j] = fT0r + fT2r;
+				pIm[j] = fT0i + fT2i;
+
+				/* x[j+Q] = (t0 - t2) * W^2j */
+				fAr = fT0r - fT2r; fAi = fT0i - fT2i;
+				pRe[j + Q] = fAr * fW2r - fAi * fW2i;
+				pIm[j + Q] = fAr * fW2i + fAi * fW2r;
+
+				/* x[j+2Q] = (t1 - i t3) * W^j */
+				fAr = fT1r + fT3i; fAi = fT1i - fT3r;
+				pRe[j + 2 * Q] = fAr * fW1r - fAi * fW1i;
+				pIm[j + 2 * Q] = fAr * fW1i + fAi * fW1r;
+
+				/* x[j+3Q] = (t1 + i t3) * W^3j */
+				fAr = fT1r - fT3i; fAi = fT1i + fT3r;
+				pRe[j + 3 * Q] = fAr * fW3r - fAi * fW3i;
+				pIm[j + 3 * Q] = fAr * fW3i + fAi * fW3r;
+			}
+		}
+	}
+
+	/* Remaining radix-2 stage (no twiddle factors) */
+	if (L == 2)
+	{
+		for (uint16_t g = 0; g < M; g += 2)
+		{
+			fAr = fRe[g]; fAi = fIm[g];
+			fRe[g]     = fAr + fRe[g + 1];
+			fIm[g]     = fAi + fIm[g + 1];
+			fRe[g + 1] = fAr - fRe[g + 1];
+			fIm[g + 1] = fAi - fIm[g + 1];
+		}
+	}
+}
+
+
+/* Averages the PSD of the windows and derives the summary */
+void SPECTRUM::finishSummary(void)
+{
+	const float fBin = getBinWidth();
+	float fScale = 1.0f / ui16Windows;
+	float fSum, fFreq;
+	uint16_t ui16Peak;
+
+	Summary.ui32Sequence++;
+	Summary.ui16Windows = ui16Windows;
+	Summary.ui8Bands    = Config.ui8Bands;
+	Summary.ui8Flags    = ui8Flags;
+
+	for (uint8_t a = 0; a < SPECTRUM_AXES; a++)
+	{
+		fSum     = 0.0;
+		ui16Peak = 1;
+
+		for (uint16_t k = 0; k <= ui16Half; k++)
+		{
+			fPsd[a][k] = fPsdSum[a][k] * fScale;
+
+			if (k == 0) {continue;}
+			fSum += fPsd[a][k];
+			if (fPsd[a][k] > fPsd[a][ui16Peak]) {ui16Peak = k;}
+		}
+
+		Summary.fRms[a]      = sqrtf(fSum * fBin);
+		Summary.fPeakFreq[a] = ui16Peak * fBin;
+		Summary.fPeakPsd[a]  = fPsd[a][ui16Peak];
+
+		/* A bin belongs to the band that contains its center */
+		for (uint8_t b = 0; b < Config.ui8Bands; b++)
+		{
+			fSum = 0.0;
+			for (uint16_t k = 0; k <= ui16Half; k++)
+			{
+				fFreq = k * fBin;
+				if (fFreq >= Config.fBandEdge[b] && fFreq < Config.fBandEdge[b + 1]) {fSum += fPsd[a][k];}
+			}
+			Summary.fBandRms[a][b] = sqrtf(fSum * fBin);
+		}
+	}
+
+	memset(fPsdSum, 0, sizeof(fPsdSum));
+	ui16Windows = 0;
+	ui8Flags    = 0;
+}
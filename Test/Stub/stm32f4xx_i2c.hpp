@@ -0,0 +1,70 @@
+/*
+ * stm32f4xx_i2c.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_TEST_STUB_STM32F4XX_I2C_HPP_
+#define ZULS_TEST_STUB_STM32F4XX_I2C_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define I2C_STUB_LOG_SIZE  64
+
+
+/* Host stand-in of the I2C class of the target device (only for test_bus): records the last burst */
+class I2C
+{
+public:
+	I2C(void)
+	{
+		memset(ui8Data, 0, sizeof(ui8Data));
+		ui8SlaveAddr = 0;
+		ui8RegAddr   = 0;
+		ui16Length   = 0;
+		boRead       = false;
+	}
+
+	int16_t readBurst(uint8_t ui8SlaveAddr, uint8_t ui8RegAddr, uint16_t ui16Length, uint8_t *pData)
+	{
+		log(ui8SlaveAddr, ui8RegAddr, ui16Length, true);
+
+		for (uint16_t i = 0; i < ui16Length; i++)
+		{
+			pData[i] = ui8RegAddr + i;
+		}
+
+		return 0;
+	}
+
+	int16_t writeBurst(uint8_t ui8SlaveAddr, uint8_t ui8RegAddr, uint16_t ui16Length, uint8_t *pData)
+	{
+		log(ui8SlaveAddr, ui8RegAddr, ui16Length, false);
+		memcpy(ui8Data, pData, (ui16Length < I2C_STUB_LOG_SIZE) ? ui16Length : I2C_STUB_LOG_SIZE);
+
+		return 0;
+	}
+
+	/* Log of the last burst */
+	uint8_t  ui8Data[I2C_STUB_LOG_SIZE];  // Written bytes
+	uint8_t  ui8SlaveAddr;
+	uint8_t  ui8RegAddr;
+	uint16_t ui16Length;
+	bool     boRead;
+
+
+private:
+	void log(uint8_t ui8SlaveAddr, uint8_t ui8RegAddr, uint16_t ui16Length, bool boRead)
+	{
+		this->ui8SlaveAddr = ui8SlaveAddr;
+		this->ui8RegAddr   = ui8RegAddr;
+		this->ui16Length   = ui16Length;
+		this->boRead       = boRead;
+	}
+};
+
+
+#endif /* ZULS_TEST_STUB_STM32F4XX_I2C_HPP_ */
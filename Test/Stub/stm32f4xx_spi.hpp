@@ -0,0 +1,88 @@
+/*
+ * stm32f4xx_spi.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_TEST_STUB_STM32F4XX_SPI_HPP_
+#define ZULS_TEST_STUB_STM32F4XX_SPI_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define SPI_STUB_LOG_SIZE  64
+
+
+/* Host stand-in of the SPI class of the target device (only for test_bus): records the transfers and the
+ * chip select, receiveSPI() returns a counting pattern. A transfer can be made to fail. */
+class SPI
+{
+public:
+	SPI(void) {clear();}
+
+	void clear(void)
+	{
+		memset(ui8Tx, 0, sizeof(ui8Tx));
+		ui16TxLength      = 0;
+		ui16RxLength      = 0;
+		ui8Transfers      = 0;
+		ui8NssSelects     = 0;
+		boNssLow          = false;
+		boNssLowOnTx      = true;
+		ui16Prescaler     = 0;
+		ui8PrescalerCalls = 0;
+		i8FailTransfer    = -1;
+	}
+
+	void enableNSS(void)  {boNssLow = true; ui8NssSelects++;}
+	void disableNSS(void) {boNssLow = false;}
+
+	int16_t transmitSPI(uint8_t *pData, uint16_t ui16Length)
+	{
+		if (!boNssLow) {boNssLowOnTx = false;}
+		if (ui8Transfers++ == i8FailTransfer) {return -1;}
+
+		for (uint16_t i = 0; i < ui16Length && ui16TxLength < SPI_STUB_LOG_SIZE; i++)
+		{
+			ui8Tx[ui16TxLength++] = pData[i];
+		}
+
+		return 0;
+	}
+
+	int16_t receiveSPI(uint8_t *pData, uint16_t ui16Length)
+	{
+		if (!boNssLow) {boNssLowOnTx = false;}
+		if (ui8Transfers++ == i8FailTransfer) {return -1;}
+
+		for (uint16_t i = 0; i < ui16Length; i++)
+		{
+			pData[i] = ui16RxLength++;
+		}
+
+		return 0;
+	}
+
+	void setBaudRatePrescaler(uint16_t ui16Prescaler)
+	{
+		this->ui16Prescaler = ui16Prescaler;
+		ui8PrescalerCalls++;
+	}
+
+	/* Log */
+	uint8_t  ui8Tx[SPI_STUB_LOG_SIZE];  // All transmitted bytes
+	uint16_t ui16TxLength;
+	uint16_t ui16RxLength;              // All received bytes
+	uint8_t  ui8Transfers;              // transmitSPI() and receiveSPI() calls
+	uint8_t  ui8NssSelects;
+	bool     boNssLow;
+	bool     boNssLowOnTx;              // false: a transfer ran without chip select
+	uint16_t ui16Prescaler;
+	uint8_t  ui8PrescalerCalls;
+	int8_t   i8FailTransfer;            // Index of the transfer that fails (-1: none)
+};
+
+
+#endif /* ZULS_TEST_STUB_STM32F4XX_SPI_HPP_ */
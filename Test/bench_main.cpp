@@ -0,0 +1,66 @@
+/*
+ * bench_main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Runner of the host benchmarks (BENCH)
+ *
+ *   bench                           Writes the results as CSV to stdout
+ *   bench <baseline> [tolerance]    Compares the results with a stored CSV, exit code 1 on a regression
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.hpp"
+
+
+/* The driver delays run on the deterministic time base of the benchmarks */
+extern "C" uint32_t get_Ticks(void)
+{
+	return BENCH::getTicks();
+}
+
+
+int main(int argc, char *argv[])
+{
+	static BENCH Bench;
+	FILE   *pBaseline;
+	double  dTolerance = BENCH_DEFAULT_TOLERANCE;
+	int16_t i16Regressions;
+
+	if (Bench.run() != 0)
+	{
+		fprintf(stderr, "bench: at least one case failed\n");
+		return 1;
+	}
+
+	if (argc < 2)
+	{
+		Bench.writeResults(stdout);
+		return 0;
+	}
+
+	if (argc > 2) {dTolerance = atof(argv[2]);}
+
+	pBaseline = fopen(argv[1], "r");
+	if (pBaseline == NULL)
+	{
+		fprintf(stderr, "bench: cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	i16Regressions = Bench.compareBaseline(pBaseline, dTolerance, stdout);
+	fclose(pBaseline);
+
+	if (i16Regressions < 0)
+	{
+		fprintf(stderr, "bench: no entries in %s\n", argv[1]);
+		return 1;
+	}
+
+	printf("%d regression(s), tolerance %.0f%%\n", i16Regressions, dTolerance * 100.0);
+
+	return (i16Regressions == 0) ? 0 : 1;
+}
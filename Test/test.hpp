@@ -0,0 +1,27 @@
+/*
+ * test.hpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifndef ZULS_TEST_TEST_HPP_
+#define ZULS_TEST_TEST_HPP_
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+/* Minimal check macros of the host tests: a failed check is reported and counted, the test continues.
+ * The main function returns TEST_RESULT() (0: all checks passed). */
+static uint32_t ui32TestChecks   = 0;
+static uint32_t ui32TestFailures = 0;
+
+#define TEST_CHECK(Cond)  do {ui32TestChecks++; if (!(Cond)) {ui32TestFailures++; \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Cond);}} while (0)
+
+#define TEST_RESULT()     (printf("%s: %u checks, %u failed\n", __FILE__, ui32TestChecks, ui32TestFailures), \
+		(ui32TestFailures == 0) ? 0 : 1)
+
+
+#endif /* ZULS_TEST_TEST_HPP_ */
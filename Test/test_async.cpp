@@ -0,0 +1,169 @@
+/*
+ * test_async.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Asynchronous driver (ICM20948_ASYNC, C++20 coroutines) on the register emulator: every sequence runs through
+ * ASYNC_SCHEDULER::run(), the frame pool must never run empty */
+#include <stdlib.h>
+
+#include "icm20948async.hpp"
+#include "test.hpp"
+
+
+/* Accelerometer 100, -200, 16000 and gyroscope 30, -40, 50 (big endian), temperature 0 */
+static const uint8_t TEST_SAMPLE[14] = {0x00, 0x64, 0xFF, 0x38, 0x3E, 0x80, 0x00, 0x1E, 0xFF, 0xD8, 0x00, 0x32, 0x00, 0x00};
+
+/* Register emulator that samples while the tasks wait (one sample per millisecond) */
+static ICM20948_MOCK *pSamplingMock = NULL;
+
+/* Fewest free coroutine frames seen by the time base */
+static uint8_t ui8MinFreeFrames = ASYNC_FRAMES;
+
+
+/* Time base of the driver and the scheduler: 1ms every 4 calls. poll() reads it once per pass, so it also
+ * watches the frame pool while the tasks are suspended. */
+extern "C" uint32_t get_Ticks(void)
+{
+	static uint32_t ui32Calls = 0;
+	uint8_t ui8Free = ASYNC_TASK::getFreeFrames();
+
+	if (ui8Free < ui8MinFreeFrames) {ui8MinFreeFrames = ui8Free;}
+
+	if (pSamplingMock != NULL && ui32Calls % 4 == 0) {pSamplingMock->pushSample(TEST_SAMPLE);}
+
+	return ui32Calls++ / 4;
+}
+
+
+static int16_t runInit(ASYNC_SCHEDULER *pScheduler, ICM20948_ASYNC *pAsync, ICM20948_SelfTest_t *pSelfTest)
+{
+	ASYNC_TASK Task = pAsync->init(ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3, pSelfTest);
+
+	TEST_CHECK(Task.isValid());
+
+	return pScheduler->run(&Task);
+}
+
+
+static void testInit(void)
+{
+	ICM20948_MOCK Mock;
+	ASYNC_SCHEDULER Scheduler;
+	ICM20948_ASYNC Async(&Mock, &Scheduler);
+
+	TEST_CHECK(runInit(&Scheduler, &Async, NULL) == ICM20948_RET_OK);
+
+	TEST_CHECK(Async.getDevice()->getSensorConfig().boStatusOK);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_2G.ui8Selection);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_GYRO_SMPLRT_DIV) == GYRO_SR_1125_HZ.ui8Div);
+	TEST_CHECK(Scheduler.isIdle());
+	TEST_CHECK(ASYNC_TASK::getFreeFrames() == ASYNC_FRAMES);
+}
+
+
+/* The emulator does not respond to the actuation: all axes fail, the initialization itself succeeds */
+static void testInitSelfTest(void)
+{
+	ICM20948_MOCK Mock;
+	ASYNC_SCHEDULER Scheduler;
+	ICM20948_ASYNC Async(&Mock, &Scheduler);
+	ICM20948_SelfTest_t SelfTest;
+
+	pSamplingMock = &Mock;
+	TEST_CHECK(runInit(&Scheduler, &Async, &SelfTest) == ICM20948_RET_OK);
+	pSamplingMock = NULL;
+
+	TEST_CHECK(SelfTest.ui8AccelPass == 0 && SelfTest.ui8GyroPass == 0);
+	TEST_CHECK(SelfTest.AccelResponse.i32XAxis == 0 && SelfTest.GyroResponse.i32ZAxis == 0);
+
+	/* The configuration of init() is restored after the self-test */
+	TEST_CHECK(!Async.getDevice()->getSensorConfig().boFifoEnabled);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_2G.ui8Selection);
+	TEST_CHECK(Scheduler.isIdle());
+	TEST_CHECK(ASYNC_TASK::getFreeFrames() == ASYNC_FRAMES);
+}
+
+
+static void testReadFrame(void)
+{
+	ICM20948_MOCK Mock;
+	ASYNC_SCHEDULER Scheduler;
+	ICM20948_ASYNC Async(&Mock, &Scheduler);
+	ICM20948_Frame_t Frame;
+
+	/* init() prepares readFrame() */
+	{
+		ASYNC_TASK Task = Async.readFrame(&Frame);
+		TEST_CHECK(Scheduler.run(&Task) == -1);
+	}
+
+	TEST_CHECK(runInit(&Scheduler, &Async, NULL) == ICM20948_RET_OK);
+
+	/* The task yields until the emulator has a new sample */
+	pSamplingMock = &Mock;
+	{
+		ASYNC_TASK Task = Async.readFrame(&Frame);
+		TEST_CHECK(Scheduler.run(&Task) == 0);
+	}
+	pSamplingMock = NULL;
+
+	TEST_CHECK(Frame.Accel.i16XAxis == 100 && Frame.Accel.i16YAxis == -200 && Frame.Accel.i16ZAxis == 16000);
+	TEST_CHECK(Frame.Gyro.i16XAxis == 30 && Frame.Gyro.i16YAxis == -40 && Frame.Gyro.i16ZAxis == 50);
+	TEST_CHECK(Scheduler.isIdle());
+	TEST_CHECK(ASYNC_TASK::getFreeFrames() == ASYNC_FRAMES);
+}
+
+
+static void testCalibrate(void)
+{
+	ICM20948_MOCK Mock;
+	ASYNC_SCHEDULER Scheduler;
+	ICM20948_ASYNC Async(&Mock, &Scheduler);
+	ICM20948_i16Vector_t Accel, Gyro;
+
+	TEST_CHECK(runInit(&Scheduler, &Async, NULL) == ICM20948_RET_OK);
+
+	pSamplingMock = &Mock;
+	{
+		ASYNC_TASK Task = Async.calculateMeanValues();
+		TEST_CHECK(Scheduler.run(&Task) == 0);
+	}
+	{
+		/* Nested tasks: calibrate() awaits calculateMeanValues() in every iteration */
+		ASYNC_TASK Task = Async.calibrate();
+		TEST_CHECK(Scheduler.run(&Task) == 0);
+	}
+
+	/* Same check as after ICM20948::exeCalibration() */
+	TEST_CHECK(Async.getDevice()->checkCalibration() == 0);
+	pSamplingMock = NULL;
+
+	TEST_CHECK(Async.getDevice()->readAllDataRaw() == 0);
+	Accel = Async.getDevice()->getCorrectedAccelRaw();
+	Gyro  = Async.getDevice()->getCorrectedGyroRaw();
+	TEST_CHECK(abs(Accel.i16XAxis) <= ICM20948_ACCEL_PREC && abs(Accel.i16YAxis) <= ICM20948_ACCEL_PREC);
+	TEST_CHECK(abs(Accel.i16ZAxis - 16384) <= ICM20948_ACCEL_PREC);
+	TEST_CHECK(abs(Gyro.i16XAxis) <= ICM20948_GYRO_PREC && abs(Gyro.i16YAxis) <= ICM20948_GYRO_PREC &&
+			   abs(Gyro.i16ZAxis) <= ICM20948_GYRO_PREC);
+
+	TEST_CHECK(Scheduler.isIdle());
+	TEST_CHECK(ASYNC_TASK::getFreeFrames() == ASYNC_FRAMES);
+}
+
+
+int main(void)
+{
+	testInit();
+	testInitSelfTest();
+	testReadFrame();
+	testCalibrate();
+
+	/* calibrate() -> calculateMeanValues() is the deepest chain (2 frames) */
+	TEST_CHECK(ui8MinFreeFrames > 0);
+	TEST_CHECK(ui8MinFreeFrames == ASYNC_FRAMES - 2);
+
+	return TEST_RESULT();
+}
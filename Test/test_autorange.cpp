@@ -0,0 +1,86 @@
+/*
+ * test_autorange.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Automatic full scale switching (AUTORANGE) on FIFO frames of the register emulator */
+#include "autorange.hpp"
+#include "test.hpp"
+
+
+/* Accelerometer sample (X axis only), gyroscope at rest */
+static void pushAccel(ICM20948_MOCK *pMock, int16_t i16Accel, uint8_t ui8Count)
+{
+	uint8_t ui8Sample[14] = {0};
+
+	ui8Sample[0] = (uint16_t)i16Accel >> 8;
+	ui8Sample[1] = (uint16_t)i16Accel;
+
+	for (uint8_t i = 0; i < ui8Count; i++) {pMock->pushSample(ui8Sample);}
+}
+
+
+static void testConfig(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	AUTORANGE Autorange(&Device);
+	AUTORANGE_Config_t Config = AUTORANGE_DEFAULT_CONFIG;
+
+	TEST_CHECK(Autorange.init(&Config) == 0);
+
+	/* The ranges would toggle */
+	Config.i16DownThreshold = Config.i16UpThreshold / 2;
+	TEST_CHECK(Autorange.init(&Config) == -1);
+
+	Config = AUTORANGE_DEFAULT_CONFIG;
+	Config.ui8AccelMin = 2;
+	Config.ui8AccelMax = 1;
+	TEST_CHECK(Autorange.init(&Config) == -1);
+
+	Config = AUTORANGE_DEFAULT_CONFIG;
+	Config.ui8GyroMax = 4;
+	TEST_CHECK(Autorange.init(&Config) == -1);
+}
+
+
+/* One step up: the frames of the old epoch and the transitional frames that still hold counts of the old
+ * range must not cause a second switch */
+static void testStepUp(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	AUTORANGE Autorange(&Device);
+	ICM20948_Frame_t Frames[16];
+	uint16_t ui16Frames;
+
+	TEST_CHECK(Device.enableFifo(true) == 0);
+
+	/* 1.8g at 2g: up to 4g, the other frames of the batch belong to the old epoch */
+	pushAccel(&Mock, 29500, 4);
+	TEST_CHECK(Device.readFifoFrames(Frames, 16, &ui16Frames) == 0 && ui16Frames == 4);
+	TEST_CHECK(Autorange.process(Frames, ui16Frames) == 1);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_4G.ui8Selection);
+
+	/* Settling samples with the old counts, then the same 1.8g at 4g */
+	pushAccel(&Mock, 29500, ICM20948_EPOCH_SETTLE);
+	pushAccel(&Mock, 14750, 8);
+	TEST_CHECK(Device.readFifoFrames(Frames, 16, &ui16Frames) == 0 && ui16Frames == ICM20948_EPOCH_SETTLE + 8);
+	TEST_CHECK(Frames[0].ui8Flags & ICM20948_FRAME_TRANSITION);
+	TEST_CHECK(!(Frames[ICM20948_EPOCH_SETTLE].ui8Flags & ICM20948_FRAME_TRANSITION));
+	TEST_CHECK(Autorange.process(Frames, ui16Frames) == 0);
+
+	TEST_CHECK(Autorange.getSwitchCount() == 1);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_4G.ui8Selection);
+}
+
+
+int main(void)
+{
+	testConfig();
+	testStepUp();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+/*
+ * test_batch.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* BATCH: the merged outputs of a job do not depend on the number of threads or on the chunking */
+#include <thread>
+#include <vector>
+
+#include "batch.hpp"
+#include "test.hpp"
+
+
+#define TEST_FRAMES  (1UL << 18)
+#define TEST_CHUNK   4096
+
+
+static const DECIMATOR_Config_t TEST_DECIMATOR_CONFIG = {4500.0f, 3, 4, 4, 32, NULL, 100.0f};
+
+
+/* Field by field, the padding of ICM20948_Frame_t is not defined */
+static bool isEqual(const ICM20948_Frame_t *pA, const ICM20948_Frame_t *pB)
+{
+	return pA->Accel.i16XAxis == pB->Accel.i16XAxis && pA->Accel.i16YAxis == pB->Accel.i16YAxis &&
+		   pA->Accel.i16ZAxis == pB->Accel.i16ZAxis && pA->Gyro.i16XAxis == pB->Gyro.i16XAxis &&
+		   pA->Gyro.i16YAxis == pB->Gyro.i16YAxis && pA->Gyro.i16ZAxis == pB->Gyro.i16ZAxis &&
+		   pA->i16Temperature == pB->i16Temperature && pA->ui8Epoch == pB->ui8Epoch &&
+		   pA->ui8Flags == pB->ui8Flags && pA->ui8Range == pB->ui8Range;
+}
+
+
+/* Noise around a slow ramp (LCG), one configuration epoch */
+static void makeArchive(std::vector<ICM20948_Frame_t> *pFrames)
+{
+	uint32_t ui32Seed = 12345;
+
+	for (uint32_t i = 0; i < pFrames->size(); i++)
+	{
+		int16_t i16Noise[7];
+
+		for (uint8_t k = 0; k < 7; k++)
+		{
+			ui32Seed = ui32Seed * 1664525 + 1013904223;
+			i16Noise[k] = (int16_t)(ui32Seed >> 20) - 2048;
+		}
+
+		(*pFrames)[i].Accel          = {(int16_t)(i16Noise[0] + (i >> 6)), i16Noise[1], (int16_t)(i16Noise[2] + 16384)};
+		(*pFrames)[i].Gyro           = {i16Noise[3], i16Noise[4], (int16_t)(i16Noise[5] * 8)};
+		(*pFrames)[i].i16Temperature = i16Noise[6];
+		(*pFrames)[i].ui8Epoch       = 0;
+		(*pFrames)[i].ui8Flags       = 0;
+		(*pFrames)[i].ui8Range       = 0;
+	}
+}
+
+
+/* Decimator job: the reference is one chunk on one thread (sequential run) */
+static void testDecimator(const std::vector<ICM20948_Frame_t> &Archive, const uint16_t *pThreads, uint8_t ui8Runs)
+{
+	const BATCH_Kernel_t Kernel = BATCH::getDecimatorKernel(&TEST_DECIMATOR_CONFIG);
+	std::vector<ICM20948_Frame_t> Reference(Archive.size()), Out(Archive.size());
+	uint64_t ui64Reference, ui64Out;
+	uint32_t ui32Mismatches;
+
+	{
+		BATCH Batch(1, TEST_FRAMES);
+		TEST_CHECK(Batch.run(&Kernel, Archive.data(), Archive.size(), Reference.data(), &ui64Reference) == 0);
+		TEST_CHECK(ui64Reference == TEST_FRAMES / 16);
+	}
+
+	for (uint8_t r = 0; r < ui8Runs; r++)
+	{
+		BATCH Batch(pThreads[r], TEST_CHUNK);
+
+		TEST_CHECK(Batch.run(&Kernel, Archive.data(), Archive.size(), Out.data(), &ui64Out) == 0);
+		TEST_CHECK(ui64Out == ui64Reference);
+
+		ui32Mismatches = 0;
+		for (uint64_t i = 0; i < ui64Reference && i < ui64Out; i++)
+		{
+			if (!isEqual(&Out[i], &Reference[i])) {ui32Mismatches++;}
+		}
+
+		if (ui32Mismatches != 0) {printf("%u threads: %u output frames differ\n", pThreads[r], ui32Mismatches);}
+		TEST_CHECK(ui32Mismatches == 0);
+	}
+}
+
+
+/* Mean job: exact integer sums, merged in chunk order */
+static void testMean(const std::vector<ICM20948_Frame_t> &Archive, const uint16_t *pThreads, uint8_t ui8Runs)
+{
+	const BATCH_Kernel_t Kernel = BATCH::getMeanKernel();
+	BATCH_Mean_t Reference = {}, Mean;
+	uint64_t ui64Out;
+
+	for (uint32_t i = 0; i < Archive.size(); i++)
+	{
+		Reference.i64AccelSum[0] += Archive[i].Accel.i16XAxis;
+		Reference.i64AccelSum[2] += Archive[i].Accel.i16ZAxis;
+		Reference.i64GyroSum[1]  += Archive[i].Gyro.i16YAxis;
+		Reference.i64TempSum     += Archive[i].i16Temperature;
+	}
+
+	for (uint8_t r = 0; r < ui8Runs; r++)
+	{
+		BATCH Batch(pThreads[r], TEST_CHUNK);
+
+		Mean = {};
+		TEST_CHECK(Batch.run(&Kernel, Archive.data(), Archive.size(), NULL, &ui64Out, &Mean) == 0);
+		TEST_CHECK(ui64Out == 0 && Mean.ui64Count == TEST_FRAMES);
+		TEST_CHECK(Mean.i64AccelSum[0] == Reference.i64AccelSum[0] && Mean.i64AccelSum[2] == Reference.i64AccelSum[2]);
+		TEST_CHECK(Mean.i64GyroSum[1] == Reference.i64GyroSum[1] && Mean.i64TempSum == Reference.i64TempSum);
+	}
+}
+
+
+int main(void)
+{
+	std::vector<ICM20948_Frame_t> Archive(TEST_FRAMES);
+	uint16_t ui16Threads[3] = {1, 2, (uint16_t)std::thread::hardware_concurrency()};
+
+	/* N threads: at least 4, the work stealing also runs on a machine with few cores */
+	if (ui16Threads[2] < 4) {ui16Threads[2] = 4;}
+
+	makeArchive(&Archive);
+
+	testDecimator(Archive, ui16Threads, 3);
+	testMean(Archive, ui16Threads, 3);
+
+	return TEST_RESULT();
+}
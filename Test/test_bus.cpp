@@ -0,0 +1,126 @@
+/*
+ * test_bus.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Framing of the target transports with the stand-ins of Stub/ (built with STM32F411xE, once for SPI, SPI
+ * with speed profiles and I2C) */
+#include "icm20948bus.hpp"
+#include "test.hpp"
+
+
+#if defined (ICM20948_USE_I2C)
+static void testI2C(void)
+{
+	I2C Port;
+	ICM20948_I2C_BUS Bus(&Port);
+	uint8_t ui8Data[14];
+	const uint8_t ui8Write[2] = {0x12, 0x34};
+
+	TEST_CHECK(!ICM20948_I2C_BUS::boSPI);
+
+	/* Read: 7-bit slave address with AD0, register address unchanged (no R/W bit), whole burst in one call */
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Port.boRead);
+	TEST_CHECK(Port.ui8SlaveAddr == (ICM20948_I2C_BASE_ADDR | ICM20948_I2C_AD0));
+	TEST_CHECK(Port.ui8RegAddr == ICM20948_ACCEL_XOUT_H);
+	TEST_CHECK(Port.ui16Length == 14);
+	TEST_CHECK(ui8Data[0] == ICM20948_ACCEL_XOUT_H && ui8Data[13] == ICM20948_ACCEL_XOUT_H + 13);
+
+	/* Write */
+	TEST_CHECK(Bus.writeBurst(ICM20948_REG_BANK_SEL, ui8Write, 2) == 0);
+	TEST_CHECK(!Port.boRead);
+	TEST_CHECK(Port.ui8RegAddr == ICM20948_REG_BANK_SEL);
+	TEST_CHECK(Port.ui16Length == 2);
+	TEST_CHECK(Port.ui8Data[0] == 0x12 && Port.ui8Data[1] == 0x34);
+}
+
+#else
+static void testSPI(void)
+{
+	SPI Port;
+	ICM20948_SPI_BUS Bus(&Port);
+	uint8_t ui8Data[14];
+	const uint8_t ui8Write[2] = {0x12, 0x34};
+
+	TEST_CHECK(ICM20948_SPI_BUS::boSPI);
+
+	/* Read: address byte with R/W = 1, then the data within one chip select */
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Port.ui16TxLength == 1);
+	TEST_CHECK(Port.ui8Tx[0] == (0x80 | ICM20948_ACCEL_XOUT_H));
+	TEST_CHECK(Port.ui16RxLength == 14);
+	TEST_CHECK(ui8Data[0] == 0 && ui8Data[13] == 13);
+	TEST_CHECK(Port.ui8NssSelects == 1 && !Port.boNssLow && Port.boNssLowOnTx);
+
+	/* Write: address byte with R/W = 0 (also for addresses with bit 7 set by mistake), then the data */
+	Port.clear();
+	TEST_CHECK(Bus.writeBurst(0x80 | ICM20948_REG_BANK_SEL, ui8Write, 2) == 0);
+	TEST_CHECK(Port.ui16TxLength == 3);
+	TEST_CHECK(Port.ui8Tx[0] == ICM20948_REG_BANK_SEL);
+	TEST_CHECK(Port.ui8Tx[1] == 0x12 && Port.ui8Tx[2] == 0x34);
+	TEST_CHECK(Port.ui16RxLength == 0);
+	TEST_CHECK(Port.ui8NssSelects == 1 && !Port.boNssLow && Port.boNssLowOnTx);
+
+	/* A failed transfer releases the chip select */
+	Port.clear();
+	Port.i8FailTransfer = 0;
+	TEST_CHECK(Bus.readBurst(ICM20948_WHO_AM_I, ui8Data, 1, ICM20948_SPEED_READ) == -1);
+	TEST_CHECK(!Port.boNssLow);
+
+	Port.clear();
+	Port.i8FailTransfer = 1;
+	TEST_CHECK(Bus.writeBurst(ICM20948_PWR_MGMT_1, ui8Write, 1) == -1);
+	TEST_CHECK(!Port.boNssLow);
+}
+
+
+static void testSpeedProfiles(void)
+{
+	SPI Port;
+	ICM20948_SPI_BUS Bus(&Port);
+	uint8_t ui8Data[14];
+	const uint8_t ui8Write = 0x00;
+
+#if defined (ICM20948_SPI_SPEED_PROFILES)
+	/* The prescaler is only changed when the speed class changes */
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 1 && Port.ui16Prescaler == ICM20948_SPI_PRESC_FAST);
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 1);
+
+	/* Writes always run with the configuration class */
+	TEST_CHECK(Bus.writeBurst(ICM20948_PWR_MGMT_1, &ui8Write, 1) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 2 && Port.ui16Prescaler == ICM20948_SPI_PRESC_SLOW);
+	TEST_CHECK(Bus.readBurst(ICM20948_WHO_AM_I, ui8Data, 1, ICM20948_SPEED_READ) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 3 && Port.ui16Prescaler == ICM20948_SPI_PRESC_SLOW);
+
+	/* A new profile is applied with the next transfer */
+	Bus.setSpeedProfile(64, 32, 4);
+	TEST_CHECK(Bus.readBurst(ICM20948_WHO_AM_I, ui8Data, 1, ICM20948_SPEED_READ) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 4 && Port.ui16Prescaler == 32);
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 5 && Port.ui16Prescaler == 4);
+#else
+	/* Without speed profiles the prescaler of the application is never touched */
+	TEST_CHECK(Bus.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14, ICM20948_SPEED_BURST) == 0);
+	TEST_CHECK(Bus.writeBurst(ICM20948_PWR_MGMT_1, &ui8Write, 1) == 0);
+	TEST_CHECK(Port.ui8PrescalerCalls == 0);
+#endif
+}
+#endif
+
+
+int main(void)
+{
+#if defined (ICM20948_USE_I2C)
+	testI2C();
+#else
+	testSPI();
+	testSpeedProfiles();
+#endif
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,158 @@
+/*
+ * test_calstore.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Calibration record (version 2, CALSTORE_RECORD_SIZE bytes) in a file: round trip, rejected records and the
+ * fallback of warmStart() to the full calibration */
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "calstore.hpp"
+#include "checksum.hpp"
+#include "test.hpp"
+
+
+/* Sensor at rest: accelerometer 100, -200, 16000, gyroscope 30, -40, 50 (big endian), temperature set by the test */
+static void setSample(ICM20948_MOCK *pMock, int16_t i16Temperature)
+{
+	uint8_t ui8Sample[14] = {0x00, 0x64, 0xFF, 0x38, 0x3E, 0x80, 0x00, 0x1E, 0xFF, 0xD8, 0x00, 0x32, 0x00, 0x00};
+
+	ui8Sample[12] = (uint16_t)i16Temperature >> 8;
+	ui8Sample[13] = (uint16_t)i16Temperature;
+
+	pMock->setSensorData(ui8Sample);
+}
+
+
+static int16_t readFile(const char *pPath, uint8_t *pData, uint16_t ui16Size)
+{
+	FILE *pFile = fopen(pPath, "rb");
+	size_t Read;
+
+	if (pFile == NULL) {return -1;}
+	Read = fread(pData, 1, ui16Size + 1, pFile);
+	fclose(pFile);
+
+	return (int16_t)Read;
+}
+
+
+static void writeFile(const char *pPath, const uint8_t *pData, uint16_t ui16Size)
+{
+	FILE *pFile = fopen(pPath, "wb");
+
+	if (pFile == NULL) {return;}
+	fwrite(pData, 1, ui16Size, pFile);
+	fclose(pFile);
+}
+
+
+static void testRecord(const char *pPath)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_4G, GYRO_FS_500DPS, ACCEL_SR_562_5_HZ, GYRO_SR_562_5_HZ, ICM20948_DLPF_2);
+	CALSTORE_FILE File(pPath);
+	CALSTORE Store(&File);
+	CHECKSUM Checksum;
+	ICM20948_CalRecord_t Record, Loaded;
+	uint8_t ui8Buffer[CALSTORE_RECORD_SIZE + 1];
+	uint32_t ui32CRC;
+
+	Device.getCalibrationRecord(&Record);
+	Record.AccelOffset    = {-32768, 1234, 32767};
+	Record.GyroOffset     = {-5, 0, 77};
+	Record.i16Temperature = -4000;
+
+	TEST_CHECK(Store.save(&Record) == 0);
+	TEST_CHECK(readFile(pPath, ui8Buffer, CALSTORE_RECORD_SIZE) == CALSTORE_RECORD_SIZE);
+	TEST_CHECK(ui8Buffer[4] == CALSTORE_VERSION && ui8Buffer[5] == 0 && ui8Buffer[6] == CALSTORE_RECORD_SIZE);
+
+	/* Every field survives the round trip */
+	TEST_CHECK(Store.load(&Loaded) == 0);
+	TEST_CHECK(Loaded.AccelOffset.i16XAxis == -32768 && Loaded.AccelOffset.i16YAxis == 1234 && Loaded.AccelOffset.i16ZAxis == 32767);
+	TEST_CHECK(Loaded.GyroOffset.i16XAxis == -5 && Loaded.GyroOffset.i16YAxis == 0 && Loaded.GyroOffset.i16ZAxis == 77);
+	TEST_CHECK(Loaded.i16Temperature == -4000);
+	TEST_CHECK(Loaded.ui8AccelFullScale == ACCEL_FS_4G.ui8Selection && Loaded.ui8GyroFullScale == GYRO_FS_500DPS.ui8Selection);
+	TEST_CHECK(Loaded.ui16AccelDiv == ACCEL_SR_562_5_HZ.ui16Div && Loaded.ui8GyroDiv == GYRO_SR_562_5_HZ.ui8Div);
+	TEST_CHECK(Loaded.boAccelFCHOICE && Loaded.boGyroFCHOICE);
+	TEST_CHECK(Loaded.AccelDLPF == ICM20948_DLPF_2 && Loaded.GyroDLPF == ICM20948_DLPF_2);
+	TEST_CHECK(Loaded.ui8MountX == Record.ui8MountX && Loaded.ui8MountY == Record.ui8MountY && Loaded.ui8MountZ == Record.ui8MountZ);
+	TEST_CHECK(Device.setCalibrationRecord(&Loaded) == 0);
+
+	/* A changed data byte or CRC byte */
+	ui8Buffer[9] ^= 0x01;
+	writeFile(pPath, ui8Buffer, CALSTORE_RECORD_SIZE);
+	TEST_CHECK(Store.load(&Loaded) == -1);
+	ui8Buffer[9]  ^= 0x01;
+	ui8Buffer[39] ^= 0x80;
+	writeFile(pPath, ui8Buffer, CALSTORE_RECORD_SIZE);
+	TEST_CHECK(Store.load(&Loaded) == -1);
+	ui8Buffer[39] ^= 0x80;
+
+	/* A version 1 record with a valid CRC */
+	ui8Buffer[4] = 1;
+	ui32CRC = Checksum.calcCRC32(ui8Buffer, CALSTORE_RECORD_SIZE - 4);
+	for (uint8_t i = 0; i < 4; i++) {ui8Buffer[36 + i] = (uint8_t)(ui32CRC >> (8 * i));}
+	writeFile(pPath, ui8Buffer, CALSTORE_RECORD_SIZE);
+	TEST_CHECK(Store.load(&Loaded) == -1);
+
+	/* Truncated file */
+	writeFile(pPath, ui8Buffer, CALSTORE_RECORD_SIZE - 1);
+	TEST_CHECK(Store.load(&Loaded) == -1);
+
+	unlink(pPath);
+	TEST_CHECK(Store.load(&Loaded) == -1);
+}
+
+
+static void testWarmStart(const char *pPath)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	CALSTORE_FILE File(pPath);
+	CALSTORE Store(&File);
+	ICM20948_CalRecord_t Record;
+
+	setSample(&Mock, 1000);
+
+	/* No record yet: full calibration, the record is stored */
+	TEST_CHECK(Store.warmStart(&Device) == CALSTORE_RECALIBRATED);
+	TEST_CHECK(Store.load(&Record) == 0);
+	TEST_CHECK(Record.i16Temperature == 1000);
+	TEST_CHECK(Record.GyroOffset.i16XAxis != 0 && Record.AccelOffset.i16ZAxis != 0);
+
+	/* Same temperature, the stored offsets pass the quick check */
+	Device.resetGyroOffset();
+	Device.resetAccelOffset();
+	TEST_CHECK(Store.warmStart(&Device) == CALSTORE_RESTORED);
+
+	/* Temperature difference above ICM20948_CALCHECK_TEMP: full calibration despite valid offsets */
+	setSample(&Mock, 1000 + ICM20948_CALCHECK_TEMP + 1);
+	TEST_CHECK(Store.warmStart(&Device) == CALSTORE_RECALIBRATED);
+	TEST_CHECK(Store.load(&Record) == 0);
+	TEST_CHECK(Record.i16Temperature == 1000 + ICM20948_CALCHECK_TEMP + 1);
+
+	/* Exactly ICM20948_CALCHECK_TEMP below the new record */
+	setSample(&Mock, 1001);
+	TEST_CHECK(Store.warmStart(&Device) == CALSTORE_RESTORED);
+
+	unlink(pPath);
+}
+
+
+int main(void)
+{
+	char cPath[] = "/tmp/test_calstore_XXXXXX";
+	int iFile = mkstemp(cPath);
+
+	TEST_CHECK(iFile >= 0);
+	if (iFile >= 0) {close(iFile);}
+
+	testRecord(cPath);
+	testWarmStart(cPath);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,112 @@
+/*
+ * test_decimator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* FIR design and frequency response of the DECIMATOR cascade */
+#include <cmath>
+
+#include "decimator.hpp"
+#include "test.hpp"
+
+
+static void testDesign(void)
+{
+	int16_t i16Coeffs[DECIMATOR_MAX_TAPS];
+	int32_t i32Sum;
+
+	/* The center tap of 1...3 taps does not fit into Q15 */
+	for (uint8_t ui8Taps = 1; ui8Taps < DECIMATOR_MIN_DESIGN; ui8Taps++)
+	{
+		TEST_CHECK(DECIMATOR::designFir(ui8Taps, 100.0f, 1125.0f, i16Coeffs) == -1);
+	}
+
+	/* Exact DC gain, symmetric, the outer taps of short filters are not zero (long filters may round them to 0) */
+	for (uint8_t ui8Taps = DECIMATOR_MIN_DESIGN; ui8Taps <= DECIMATOR_MAX_TAPS; ui8Taps++)
+	{
+		TEST_CHECK(DECIMATOR::designFir(ui8Taps, 100.0f, 1125.0f, i16Coeffs) == 0);
+
+		i32Sum = 0;
+		for (uint8_t k = 0; k < ui8Taps; k++) {i32Sum += i16Coeffs[k];}
+
+		TEST_CHECK(i32Sum == 32768);
+		TEST_CHECK(i16Coeffs[0] == i16Coeffs[ui8Taps - 1]);
+		if (ui8Taps <= 16) {TEST_CHECK(i16Coeffs[0] != 0);}
+	}
+
+	/* Cutoff close to Nyquist with few taps: a valid design or an error, never a wrapped center tap */
+	for (float fCutoff = 400.0f; fCutoff < 562.0f; fCutoff += 20.0f)
+	{
+		if (DECIMATOR::designFir(4, fCutoff, 1125.0f, i16Coeffs) == 0)
+		{
+			TEST_CHECK(i16Coeffs[1] > 0 && i16Coeffs[2] > 0);
+		}
+	}
+
+	TEST_CHECK(DECIMATOR::designFir(32, 0.0f, 1125.0f, i16Coeffs) == -1);
+	TEST_CHECK(DECIMATOR::designFir(32, 562.5f, 1125.0f, i16Coeffs) == -1);
+}
+
+
+static void testResponse(void)
+{
+	DECIMATOR Decimator;
+	const DECIMATOR_Config_t Config = {4500.0f, 3, 4, 4, 32, NULL, 100.0f};
+	const DECIMATOR_Config_t Short  = {4500.0f, 0, 1, 1, 3, NULL, 100.0f};
+
+	TEST_CHECK(Decimator.init(&Short) == -1);
+	TEST_CHECK(Decimator.init(&Config) == 0);
+
+	TEST_CHECK(std::fabs(Decimator.getFrequencyResponse(0.0f) - 1.0f) < 0.001f);
+	TEST_CHECK(Decimator.getFrequencyResponse(100.0f) > 0.4f && Decimator.getFrequencyResponse(100.0f) < 0.6f);
+
+	/* Stopband from the output Nyquist frequency (140.6Hz) on: components that alias into the output band */
+	for (float fFreq = 200.0f; fFreq <= 2250.0f; fFreq += 10.0f)
+	{
+		TEST_CHECK(Decimator.getFrequencyResponse(fFreq) < 0.001f);
+	}
+}
+
+
+static void testStep(void)
+{
+	DECIMATOR Decimator;
+	const DECIMATOR_Config_t Config = {4500.0f, 3, 4, 4, 32, NULL, 100.0f};
+	ICM20948_Frame_t In[64];
+	ICM20948_Frame_t Out[8];
+	uint16_t ui16Out;
+
+	TEST_CHECK(Decimator.init(&Config) == 0);
+
+	for (uint8_t i = 0; i < 64; i++)
+	{
+		In[i].Accel          = {16384, -16384, 1000};
+		In[i].Gyro           = {-32768, 32767, 0};
+		In[i].i16Temperature = 0;
+		In[i].ui8Epoch       = 0;
+		In[i].ui8Flags       = 0;
+		In[i].ui8Range       = 0;
+	}
+
+	/* Constant input: unity gain once the filter memory is filled, no overflow at full scale */
+	for (uint8_t n = 0; n < 12; n++)
+	{
+		Decimator.process(In, 64, Out, &ui16Out);
+		TEST_CHECK(ui16Out == 4);
+	}
+
+	TEST_CHECK(Out[3].Accel.i16XAxis == 16384 && Out[3].Accel.i16YAxis == -16384 && Out[3].Accel.i16ZAxis == 1000);
+	TEST_CHECK(Out[3].Gyro.i16XAxis == -32768 && Out[3].Gyro.i16YAxis == 32767);
+}
+
+
+int main(void)
+{
+	testDesign();
+	testResponse();
+	testStep();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,177 @@
+/*
+ * test_fsync.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* FSYNC input of the driver (latch register, flag, DELAY_TIME) on the register emulator and the trigger
+ * windows of the FSYNC class */
+#include "fsync.hpp"
+#include "test.hpp"
+
+
+/* Sample with the gyroscope Z LSB (FSYNC status of ICM20948_FSYNC_GYRO_Z) set or cleared */
+static void makeSample(uint8_t *pSample, int16_t i16Accel, bool boFsync)
+{
+	for (uint8_t i = 0; i < 14; i++) {pSample[i] = 0x00;}
+
+	pSample[0]  = (uint16_t)i16Accel >> 8;
+	pSample[1]  = (uint16_t)i16Accel;
+	pSample[10] = 0x01;
+	pSample[11] = boFsync ? 0x21 : 0x20;
+}
+
+
+static void makeFrames(ICM20948_Frame_t *pFrames, uint16_t ui16Count, uint32_t ui32Triggers)
+{
+	for (uint16_t i = 0; i < ui16Count; i++)
+	{
+		pFrames[i].Accel          = {(int16_t)i, 0, 0};
+		pFrames[i].Gyro           = {0, 0, 0};
+		pFrames[i].i16Temperature = 0;
+		pFrames[i].ui8Epoch       = 0;
+		pFrames[i].ui8Flags       = (ui32Triggers & (1UL << i)) ? ICM20948_FRAME_FSYNC : 0;
+		pFrames[i].ui8Range       = 0;
+	}
+}
+
+
+/* The latch register must be read with the burst window of the acquisition profile */
+static void testSetup(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_ACCEL_Z, true) == 0);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_FSYNC_CONFIG) == (ICM20948_DELAY_TIME_EN | ICM20948_FSYNC_ACCEL_Z));
+	TEST_CHECK(Mock.getRegister(0, ICM20948_INT_PIN_CFG) & ICM20948_ACTL_FSYNC);
+
+	/* Bank 0 is selected again: a sample read is one transaction */
+	Mock.resetCounters();
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	TEST_CHECK(Mock.ui32Transactions == 1);
+
+	/* The gyroscope profile does not read ACCEL_ZOUT */
+	TEST_CHECK(Device.setAcquisitionProfile(ICM20948_PROFILE_GYRO) == -1);
+	TEST_CHECK(Device.getSensorConfig().Profile == ICM20948_PROFILE_FULL);
+	TEST_CHECK(Device.setAcquisitionProfile(ICM20948_PROFILE_ACCEL) == 0);
+
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_GYRO_X, false) == -1);
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_TEMP, false) == -1);
+	TEST_CHECK(Device.getSensorConfig().Fsync == ICM20948_FSYNC_ACCEL_Z);
+
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_OFF, false) == 0);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_FSYNC_CONFIG) == 0x00);
+	TEST_CHECK(!(Mock.getRegister(0, ICM20948_INT_PIN_CFG) & ICM20948_ACTL_FSYNC));
+	TEST_CHECK(Device.setAcquisitionProfile(ICM20948_PROFILE_GYRO) == 0);
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_GYRO_Z, false) == 0);
+	TEST_CHECK(Device.setupFsync((ICM20948_FsyncLatch_t)8, false) == -1);
+}
+
+
+static void testFlag(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	ICM20948_Frame_t Frames[8];
+	uint8_t ui8Sample[14];
+	uint16_t ui16Frames;
+
+	TEST_CHECK(Device.setupFsync(ICM20948_FSYNC_GYRO_Z, false) == 0);
+	Mock.setRegister(0, ICM20948_DELAY_TIMEH, 0x01);
+	Mock.setRegister(0, ICM20948_DELAY_TIMEL, 0x2C);
+
+	/* Register reads: the flag is set and the status bit is cleared */
+	makeSample(ui8Sample, 100, false);
+	Mock.pushSample(ui8Sample);
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	TEST_CHECK(!(Device.getFrame().ui8Flags & ICM20948_FRAME_FSYNC));
+	TEST_CHECK(Device.getFsyncDelay() == 0);
+
+	makeSample(ui8Sample, 100, true);
+	Mock.pushSample(ui8Sample);
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	TEST_CHECK(Device.getFrame().ui8Flags & ICM20948_FRAME_FSYNC);
+	TEST_CHECK(Device.getFrame().Gyro.i16ZAxis == 0x0120);
+	TEST_CHECK(Device.getFsyncDelay() == 300);
+
+	/* FIFO frames: only the frame with the status bit is flagged */
+	Mock.setRegister(0, ICM20948_DELAY_TIMEL, 0x90);
+	TEST_CHECK(Device.enableFifo(true) == 0);
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		makeSample(ui8Sample, i, i == 3);
+		Mock.pushSample(ui8Sample);
+	}
+	TEST_CHECK(Device.readFifoFrames(Frames, 8, &ui16Frames) == 0 && ui16Frames == 6);
+
+	for (uint8_t i = 0; i < 6; i++)
+	{
+		TEST_CHECK(((Frames[i].ui8Flags & ICM20948_FRAME_FSYNC) != 0) == (i == 3));
+		TEST_CHECK(Frames[i].Accel.i16XAxis == i && Frames[i].Gyro.i16ZAxis == 0x0120);
+	}
+	TEST_CHECK(Device.getFsyncDelay() == 400);
+}
+
+
+static void testWindow(void)
+{
+	const FSYNC_Config_t Config  = {1000, 2, 3};
+	const FSYNC_Config_t TooLong = {1000, 40, 40};
+	const FSYNC_Config_t NoRate  = {0, 2, 3};
+	FSYNC Fsync(&Config);
+	FSYNC_Window_t Window;
+	ICM20948_Frame_t Frames[16];
+
+	TEST_CHECK(Fsync.init(&TooLong) == -1);
+	TEST_CHECK(Fsync.init(&NoRate) == -1);
+	TEST_CHECK(Fsync.getWindow(&Window) == 0);
+
+	/* Trigger at sample 4: complete with sample 7 */
+	makeFrames(Frames, 10, 1UL << 4);
+	TEST_CHECK(Fsync.process(Frames, 7, 250) == 0);
+	TEST_CHECK(Fsync.process(&Frames[7], 3, 250) == 1);
+	TEST_CHECK(Fsync.getTriggers() == 1);
+
+	TEST_CHECK(Fsync.getWindow(&Window) == 1);
+	TEST_CHECK(Window.ui32Trigger == 1 && Window.ui32Sample == 4 && Window.ui16Delay == 250);
+	TEST_CHECK(Window.ui16Frames == 6 && Window.ui16TriggerIndex == 2 && Window.ui8Flags == 0);
+
+	for (uint16_t i = 0; i < Window.ui16Frames; i++)
+	{
+		TEST_CHECK(Window.Frames[i].Frame.Accel.i16XAxis == 2 + i);
+		TEST_CHECK(Window.Frames[i].i32Offset == ((int32_t)i - 2) * 1000 + 250);
+	}
+	TEST_CHECK(Fsync.getWindow(&Window) == 0);
+
+	/* Trigger at the first sample after reset(), a second one inside its window */
+	Fsync.reset();
+	makeFrames(Frames, 8, (1UL << 0) | (1UL << 2));
+	TEST_CHECK(Fsync.process(Frames, 8, 0) == 2);
+
+	TEST_CHECK(Fsync.getWindow(&Window) == 1);
+	TEST_CHECK(Window.ui16Frames == 4 && Window.ui16TriggerIndex == 0);
+	TEST_CHECK(Window.ui8Flags == (FSYNC_WINDOW_TRUNCATED | FSYNC_WINDOW_OVERLAP));
+	TEST_CHECK(Fsync.getWindow(&Window) == 1);
+	TEST_CHECK(Window.ui32Trigger == 2 && Window.ui16Frames == 6 && Window.ui8Flags == FSYNC_WINDOW_OVERLAP);
+
+	/* A full queue drops the newest window */
+	Fsync.reset();
+	makeFrames(Frames, 16, (1UL << 2) | (1UL << 6) | (1UL << 10));
+	TEST_CHECK(Fsync.process(Frames, 16, 0) == FSYNC_QUEUE_SIZE);
+	TEST_CHECK(Fsync.getDropped() == 1);
+	TEST_CHECK(Fsync.getWindow(&Window) == 1 && Window.ui32Sample == 2);
+	TEST_CHECK(Fsync.getWindow(&Window) == 1 && Window.ui32Sample == 6);
+	TEST_CHECK(Fsync.getWindow(&Window) == 0);
+}
+
+
+int main(void)
+{
+	testSetup();
+	testFlag();
+	testWindow();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,591 @@
+/*
+ * test_mock.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Transport primitives of the register emulator ICM20948_MOCK and their use by the driver (ICM20948_HOST) */
+#include <cmath>
+
+#include "icm20948.hpp"
+#include "test.hpp"
+
+
+/* Time base of readLatest() and of the continuity tracking, set by the tests */
+static uint32_t ui32TestTime = 0;
+
+static uint32_t getTestTime(void)
+{
+	return ui32TestTime;
+}
+
+
+static void testBurst(void)
+{
+	ICM20948_MOCK Mock;
+	uint8_t ui8Data[14];
+	uint8_t ui8Sample[14];
+
+	for (uint8_t i = 0; i < 14; i++) {ui8Sample[i] = 0x10 + i;}
+	Mock.setSensorData(ui8Sample);
+
+	/* Register bursts auto-increment the address */
+	TEST_CHECK(Mock.readBurst(ICM20948_ACCEL_XOUT_H, ui8Data, 14) == 0);
+	TEST_CHECK(memcmp(ui8Data, ui8Sample, 14) == 0);
+	TEST_CHECK(Mock.ui32Transactions == 1 && Mock.ui32BytesRead == 14);
+
+	/* Interrupt status registers are cleared on read */
+	Mock.pushSample(ui8Sample);
+	TEST_CHECK(Mock.readBurst(ICM20948_INT_STATUS_1, ui8Data, 1) == 0);
+	TEST_CHECK(ui8Data[0] == ICM20948_RAW_DATA_0_RDY_INT);
+	TEST_CHECK(Mock.readBurst(ICM20948_INT_STATUS_1, ui8Data, 1) == 0);
+	TEST_CHECK(ui8Data[0] == 0x00);
+
+	/* WHO_AM_I is read-only, DEVICE_RESET restores the reset values */
+	ui8Data[0] = 0x00;
+	TEST_CHECK(Mock.writeBurst(ICM20948_WHO_AM_I, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_WHO_AM_I) == ICM20948_WHO_AM_I_VALUE);
+	ui8Data[0] = ICM20948_DEVICE_RESET;
+	TEST_CHECK(Mock.writeBurst(ICM20948_PWR_MGMT_1, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_PWR_MGMT_1) == 0x41);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_ACCEL_XOUT_H) == 0x00);
+}
+
+
+static void testFifoStream(void)
+{
+	ICM20948_MOCK Mock;
+	uint8_t ui8Data[ICM20948_FIFO_SIZE];
+	uint8_t ui8Count[2];
+
+	for (uint16_t i = 0; i < 20; i++) {ui8Data[i] = i;}
+	Mock.pushFifo(ui8Data, 20);
+
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_COUNTH, ui8Count, 2) == 0);
+	TEST_CHECK(((ui8Count[0] << 8) | ui8Count[1]) == 20);
+
+	/* FIFO_R_W does not increment: a burst drains the FIFO in order */
+	memset(ui8Data, 0, sizeof(ui8Data));
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_R_W, ui8Data, 12) == 0);
+	TEST_CHECK(ui8Data[0] == 0 && ui8Data[11] == 11);
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_COUNTH, ui8Count, 2) == 0);
+	TEST_CHECK(((ui8Count[0] << 8) | ui8Count[1]) == 8);
+
+	/* Reading an empty FIFO returns 0xFF */
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_R_W, ui8Data, 9) == 0);
+	TEST_CHECK(ui8Data[7] == 19 && ui8Data[8] == 0xFF);
+
+	/* Overflow: the oldest bytes are overwritten and FIFO_OVERFLOW_INT is set */
+	for (uint16_t i = 0; i < ICM20948_FIFO_SIZE; i++) {ui8Data[i] = i;}
+	Mock.pushFifo(ui8Data, ICM20948_FIFO_SIZE);
+	Mock.pushFifo(ui8Data, 4);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_INT_STATUS_2) & ICM20948_FIFO_OVERFLOW_INT);
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_R_W, ui8Data, 1) == 0);
+	TEST_CHECK(ui8Data[0] == 4);
+
+	/* FIFO_RESET empties the FIFO */
+	ui8Data[0] = ICM20948_FIFO_RESET;
+	TEST_CHECK(Mock.writeBurst(ICM20948_FIFO_RST, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_COUNTH, ui8Count, 2) == 0);
+	TEST_CHECK(ui8Count[0] == 0 && ui8Count[1] == 0);
+}
+
+
+static void testMemStream(void)
+{
+	ICM20948_MOCK Mock;
+	const uint8_t ui8Write[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+	uint8_t ui8Data[4];
+	const uint8_t ui8Addr[2] = {0x01, 0x10}; // DMP memory bank, start address
+
+	TEST_CHECK(Mock.writeBurst(ICM20948_MEM_BANK_SEL, &ui8Addr[0], 1) == 0);
+	TEST_CHECK(Mock.writeBurst(ICM20948_MEM_START_ADDR, &ui8Addr[1], 1) == 0);
+
+	/* MEM_R_W does not increment, the DMP memory address does */
+	TEST_CHECK(Mock.writeBurst(ICM20948_MEM_R_W, ui8Write, 4) == 0);
+	TEST_CHECK(Mock.getDmpMemory(0x0110) == 0xDE && Mock.getDmpMemory(0x0113) == 0xEF);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_MEM_START_ADDR) == 0x14);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_MEM_R_W) == 0x00);
+
+	TEST_CHECK(Mock.writeBurst(ICM20948_MEM_START_ADDR, &ui8Addr[1], 1) == 0);
+	TEST_CHECK(Mock.readBurst(ICM20948_MEM_R_W, ui8Data, 4) == 0);
+	TEST_CHECK(memcmp(ui8Data, ui8Write, 4) == 0);
+}
+
+
+static void testBankSwitch(void)
+{
+	ICM20948_MOCK Mock;
+	uint8_t ui8Data[2];
+
+	/* REG_BANK_SEL (bits 4...5) is accessible in every bank */
+	ui8Data[0] = 2 << 4;
+	TEST_CHECK(Mock.writeBurst(ICM20948_REG_BANK_SEL, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.readBurst(ICM20948_REG_BANK_SEL, ui8Data, 1) == 0);
+	TEST_CHECK(ui8Data[0] == (2 << 4));
+
+	/* Register addresses are per bank */
+	ui8Data[0] = 0x5A;
+	TEST_CHECK(Mock.writeBurst(ICM20948_ACCEL_CONFIG, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ACCEL_CONFIG) == 0x5A);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_ACCEL_CONFIG) != 0x5A);
+
+	/* 0x72 and 0x7D are only streams in bank 0: in bank 2 a burst increments */
+	Mock.setRegister(2, ICM20948_FIFO_R_W, 0x11);
+	Mock.setRegister(2, ICM20948_FIFO_R_W + 1, 0x22);
+	TEST_CHECK(Mock.readBurst(ICM20948_FIFO_R_W, ui8Data, 2) == 0);
+	TEST_CHECK(ui8Data[0] == 0x11 && ui8Data[1] == 0x22);
+
+	ui8Data[0] = 3 << 4;
+	TEST_CHECK(Mock.writeBurst(ICM20948_REG_BANK_SEL, ui8Data, 1) == 0);
+	TEST_CHECK(Mock.readBurst(ICM20948_REG_BANK_SEL, ui8Data, 1) == 0);
+	TEST_CHECK(ui8Data[0] == (3 << 4));
+}
+
+
+static void testSpeedViolations(void)
+{
+	ICM20948_MOCK Mock;
+	const uint8_t ui8Data = 0x00;
+
+	/* A write with a read class is a violation, a change of the class is a switch */
+	Mock.setSpeed(ICM20948_SPEED_BURST);
+	TEST_CHECK(Mock.writeBurst(ICM20948_PWR_MGMT_2, &ui8Data, 1) == 0);
+	TEST_CHECK(Mock.ui32SpeedViolations == 1);
+	TEST_CHECK(Mock.ui32SpeedSwitches == 1);
+
+	Mock.setSpeed(ICM20948_SPEED_CONFIG);
+	TEST_CHECK(Mock.writeBurst(ICM20948_PWR_MGMT_2, &ui8Data, 1) == 0);
+	TEST_CHECK(Mock.ui32SpeedViolations == 1);
+	TEST_CHECK(Mock.ui32SpeedSwitches == 2);
+}
+
+
+static void testDriver(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	const uint8_t ui8Sample[14] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E};
+	ICM20948_i16Vector_t Accel, Gyro, Offset;
+	uint16_t ui16Frames;
+	ICM20948_Frame_t Frames[4];
+
+	TEST_CHECK(Device.getSensorConfig().boStatusOK);
+
+	/* The driver writes all registers with the configuration class */
+	TEST_CHECK(Mock.ui32SpeedViolations == 0);
+
+	/* A bank 2 access in between: the next sample read switches back to bank 0 */
+	Mock.setSensorData(ui8Sample);
+	TEST_CHECK(Device.setAccelFullScale(ACCEL_FS_4G) == 0);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ACCEL_FS_4G.ui8Selection);
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	Accel = Device.getAccelRaw();
+	TEST_CHECK(Accel.i16XAxis == 0x0102 && Accel.i16ZAxis == 0x0506);
+
+	/* The published gyro offset keeps the sign of every axis */
+	Offset.i16XAxis = -3;
+	Offset.i16YAxis = 300;
+	Offset.i16ZAxis = -32768;
+	Device.setGyroOffset(Offset);
+	Gyro = Device.getCorrectedGyroRaw();
+	TEST_CHECK(Gyro.i16XAxis == 0x0708 - 3 && Gyro.i16YAxis == 0x090A + 300 && Gyro.i16ZAxis == (int16_t)(0x0B0C - 32768));
+	Device.resetGyroOffset();
+	Gyro = Device.getCorrectedGyroRaw();
+	TEST_CHECK(Gyro.i16XAxis == 0x0708 && Gyro.i16ZAxis == 0x0B0C);
+
+	/* Without another bank access, a sample read is one transaction */
+	Mock.resetCounters();
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	TEST_CHECK(Mock.ui32Transactions == 1 && Mock.ui32BytesRead == 14);
+
+	/* FIFO frames are read with one FIFO_R_W burst */
+	TEST_CHECK(Device.enableFifo(true) == 0);
+	for (uint8_t i = 0; i < 4; i++) {Mock.pushSample(ui8Sample);}
+	Mock.resetCounters();
+	TEST_CHECK(Device.readFifoFrames(Frames, 4, &ui16Frames) == 0);
+	TEST_CHECK(ui16Frames == 4);
+	TEST_CHECK(Frames[3].Gyro.i16XAxis == 0x0708);
+	TEST_CHECK(Mock.ui32Transactions == 2 && Mock.ui32BytesRead == 2 + 4 * ICM20948_FIFO_FRAME_SIZE);
+	TEST_CHECK(Mock.ui32SpeedViolations == 0);
+}
+
+
+/* One FIFO frame holds one sample of each sensor: unequal sample rates are rejected */
+static void testFifoRates(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_4500_HZ, GYRO_SR_9000_HZ, ICM20948_DLPF_3);
+
+	TEST_CHECK(Device.enableFifo(true) == -1);
+	TEST_CHECK(!Device.getSensorConfig().boFifoEnabled);
+	TEST_CHECK(Mock.getRegister(0, ICM20948_FIFO_EN_2) == 0x00);
+
+	/* Same divider, one of the sensors without DLPF */
+	TEST_CHECK(Device.setGyroSampleRate(GYRO_SR_1125_HZ) == 0);
+	TEST_CHECK(Device.enableFifo(true) == -1);
+
+	TEST_CHECK(Device.setAccelSampleRate(ACCEL_SR_1125_HZ) == 0);
+	TEST_CHECK(Device.enableFifo(true) == 0);
+
+	/* While the FIFO is enabled, the rates only change together */
+	TEST_CHECK(Device.setGyroSampleRate(GYRO_SR_562_5_HZ) == -1);
+	TEST_CHECK(Device.setAccelSampleRate(ACCEL_SR_4500_HZ) == -1);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_GYRO_SMPLRT_DIV) == GYRO_SR_1125_HZ.ui8Div);
+	TEST_CHECK(Device.setGyroSampleRate(GYRO_SR_1125_HZ) == 0);
+
+	TEST_CHECK(Device.enableFifo(false) == 0);
+	TEST_CHECK(Device.setGyroSampleRate(GYRO_SR_562_5_HZ) == 0);
+	TEST_CHECK(Device.setAccelSampleRate(ACCEL_SR_562_5_HZ) == 0);
+	TEST_CHECK(Device.enableFifo(true) == 0);
+}
+
+
+/* Full scale switch while the FIFO streams: the frames carry the epoch they were captured under, the settling
+ * frames of the new epoch are transitional, convertFrames() scales every frame with the range of its epoch */
+static void testEpochSwitch(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	const uint8_t ui8Sample[14] = {0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	ICM20948_Frame_t Frames[8];
+	ICM20948_fFrame_t Converted[8];
+	uint16_t ui16Frames;
+	uint8_t ui8Epoch;
+	float fAccel;
+
+	TEST_CHECK(Device.enableFifo(true) == 0);
+	ui8Epoch = Device.getConfigEpoch();
+
+	/* 3 frames at 2g, switch, 5 frames at 4g (accelerometer X 8192, gyroscope X 131) */
+	for (uint8_t i = 0; i < 3; i++) {Mock.pushSample(ui8Sample);}
+	TEST_CHECK(Device.setAccelFullScale(ACCEL_FS_4G) == 0);
+	TEST_CHECK(Device.getConfigEpoch() == (uint8_t)(ui8Epoch + 1));
+	for (uint8_t i = 0; i < 5; i++) {Mock.pushSample(ui8Sample);}
+
+	TEST_CHECK(Device.readFifoFrames(Frames, 8, &ui16Frames) == 0 && ui16Frames == 8);
+
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		if (i < 3)
+		{
+			TEST_CHECK(Frames[i].ui8Epoch == ui8Epoch && Frames[i].ui8Flags == 0);
+			TEST_CHECK(Frames[i].ui8Range == ICM20948_RANGE(ACCEL_FS_2G, GYRO_FS_250DPS));
+		}
+		else
+		{
+			TEST_CHECK(Frames[i].ui8Epoch == (uint8_t)(ui8Epoch + 1));
+			TEST_CHECK(Frames[i].ui8Range == ICM20948_RANGE(ACCEL_FS_4G, GYRO_FS_250DPS));
+			TEST_CHECK(((Frames[i].ui8Flags & ICM20948_FRAME_TRANSITION) != 0) == (i < 3 + ICM20948_EPOCH_SETTLE));
+		}
+	}
+
+	TEST_CHECK(Device.convertFrames(Frames, 8, Converted) == 0);
+	for (uint8_t i = 0; i < 8; i++)
+	{
+		fAccel = 8192 * ((i < 3) ? ACCEL_FS_2G.fSensitivity : ACCEL_FS_4G.fSensitivity);
+		TEST_CHECK(std::fabs(Converted[i].Accel.fXAxis - fAccel) < 1e-6f);
+		TEST_CHECK(std::fabs(Converted[i].Gyro.fXAxis - 131 * GYRO_FS_250DPS.fSensitivity) < 1e-6f);
+	}
+	TEST_CHECK(std::fabs(Converted[0].Accel.fXAxis - 0.5f) < 0.001f && std::fabs(Converted[7].Accel.fXAxis - 1.0f) < 0.001f);
+	TEST_CHECK(Converted[3].ui8Epoch == (uint8_t)(ui8Epoch + 1) && (Converted[3].ui8Flags & ICM20948_FRAME_TRANSITION));
+
+	/* After ICM20948_EPOCH_HISTORY further switches, the scale of the first epoch is no longer known */
+	for (uint8_t i = 0; i < ICM20948_EPOCH_HISTORY; i++)
+	{
+		TEST_CHECK(Device.setGyroFullScale((i & 1) ? GYRO_FS_250DPS : GYRO_FS_500DPS) == 0);
+	}
+	TEST_CHECK(Device.convertFrames(Frames, 8, Converted) == -1);
+	TEST_CHECK((Converted[0].ui8Flags & ICM20948_FRAME_STALE_EPOCH) && Converted[0].Accel.fXAxis == 0.0f);
+}
+
+
+/* DMP: firmware upload with a defective memory cell, packet decoding across FIFO reads and the full scales
+ * after disableDmp() */
+static void testDmp(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	/* ACCEL | QUAT6 | HEADER2, accuracies, accelerometer 1000, -2000, 8192, quaternion 0.25, -0.125, 0, footer */
+	const uint8_t ui8Packet[28] = {0x88, 0x08, 0x60, 0x00, 0x03, 0xE8, 0xF8, 0x30, 0x20, 0x00,
+								   0x10, 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+								   0x00, 0x03, 0x00, 0x02, 0x00, 0x00};
+	const uint8_t ui8Invalid[2] = {0x00, 0x01};
+	ICM20948_DmpPacket_t Packets[4];
+	ICM20948_Quaternion_t Quat;
+	uint8_t ui8Image[300];
+	uint16_t ui16Packets;
+	bool boMatch = true;
+
+	for (uint16_t i = 0; i < sizeof(ui8Image); i++) {ui8Image[i] = (uint8_t)(i * 7 + 1);}
+
+	TEST_CHECK(Device.enableDmp(ICM20948_DMP_ACCEL, 0) == -1);
+
+	/* Bit 7 of one cell in the second bank stuck at 0: the read back of that burst fails */
+	Mock.setDmpFault(ICM20948_DMP_LOAD_START + 201, 0x80);
+	TEST_CHECK((ui8Image[201] & 0x80) != 0);
+	TEST_CHECK(Device.loadDmpFirmware(ui8Image, sizeof(ui8Image)) == -1);
+	TEST_CHECK(Device.enableDmp(ICM20948_DMP_ACCEL, 0) == -1);
+
+	Mock.setDmpFault(0, 0x00);
+	TEST_CHECK(Device.loadDmpFirmware(ui8Image, sizeof(ui8Image)) == 0);
+	for (uint16_t i = 0; i < sizeof(ui8Image); i++)
+	{
+		if (Mock.getDmpMemory(ICM20948_DMP_LOAD_START + i) != ui8Image[i]) {boMatch = false;}
+	}
+	TEST_CHECK(boMatch);
+	TEST_CHECK(((Mock.getRegister(2, ICM20948_PRGM_START_ADDRH) << 8) | Mock.getRegister(2, ICM20948_PRGM_START_ADDRL)) == ICM20948_DMP_START_ADDR);
+
+	TEST_CHECK(Device.enableDmp(ICM20948_DMP_ACCEL | ICM20948_DMP_QUAT6, 0) == 0);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_4G.ui8Selection);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_GYRO_CONFIG_1) & ICM20948_GYRO_FS_SEL) == GYRO_FS_2000DPS.ui8Selection);
+
+	/* One packet and the first 10 bytes of the next one */
+	Mock.pushFifo(ui8Packet, 28);
+	Mock.pushFifo(ui8Packet, 10);
+	TEST_CHECK(Device.readDmpPackets(Packets, 4, &ui16Packets) == 0 && ui16Packets == 1);
+	TEST_CHECK(Packets[0].ui16Header == 0x8808 && Packets[0].ui16Header2 == 0x6000);
+	TEST_CHECK(Packets[0].Accel.i16XAxis == 1000 && Packets[0].Accel.i16YAxis == -2000 && Packets[0].Accel.i16ZAxis == 8192);
+	TEST_CHECK(Packets[0].Quat6.i32XAxis == 0x10000000 && Packets[0].Quat6.i32YAxis == -0x08000000 && Packets[0].Quat6.i32ZAxis == 0);
+	TEST_CHECK(Packets[0].ui16AccelAccuracy == 3 && Packets[0].ui16GyroAccuracy == 2);
+
+	ICM20948::getDmpQuaternion(&Packets[0], &Quat);
+	TEST_CHECK(std::fabs(Quat.fX - 0.25f) < 1e-6f && std::fabs(Quat.fY + 0.125f) < 1e-6f && Quat.fZ == 0.0f);
+	TEST_CHECK(std::fabs(Quat.fW - std::sqrt(1.0f - 0.0625f - 0.015625f)) < 1e-6f);
+
+	/* The rest completes the buffered packet */
+	TEST_CHECK(Device.readDmpPackets(Packets, 4, &ui16Packets) == 0 && ui16Packets == 0);
+	Mock.pushFifo(&ui8Packet[10], 18);
+	TEST_CHECK(Device.readDmpPackets(Packets, 4, &ui16Packets) == 0 && ui16Packets == 1);
+	TEST_CHECK(Packets[0].Accel.i16YAxis == -2000 && Packets[0].ui16AccelAccuracy == 3);
+
+	/* An undefined header bit: out of sync, the FIFO is reset */
+	Mock.pushFifo(ui8Invalid, 2);
+	Mock.pushFifo(ui8Packet, 28);
+	TEST_CHECK(Device.readDmpPackets(Packets, 4, &ui16Packets) == -1 && ui16Packets == 0);
+	TEST_CHECK(Device.readDmpPackets(Packets, 4, &ui16Packets) == 0 && ui16Packets == 0);
+
+	TEST_CHECK(Device.disableDmp() == 0);
+	TEST_CHECK(!Device.getSensorConfig().boDmpEnabled);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_2G.ui8Selection);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_GYRO_CONFIG_1) & ICM20948_GYRO_FS_SEL) == GYRO_FS_250DPS.ui8Selection);
+	TEST_CHECK(Device.getSensorConfig().AccelFullScale.ui8Selection == ACCEL_FS_2G.ui8Selection);
+	TEST_CHECK(Device.getSensorConfig().GyroFullScale.ui8Selection == GYRO_FS_250DPS.ui8Selection);
+
+	/* Not running: the full scales stay */
+	TEST_CHECK(Device.setAccelFullScale(ACCEL_FS_8G) == 0);
+	TEST_CHECK(Device.disableDmp() == 0);
+	TEST_CHECK(Device.getSensorConfig().AccelFullScale.ui8Selection == ACCEL_FS_8G.ui8Selection);
+}
+
+
+/* Mounting orientation per instance: axis remap, sign flip with saturation, invalid orientations */
+static void testMount(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	ICM20948 Default(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	/* Accelerometer 100, -32768, 300, gyroscope 1, 2, -32768 */
+	const uint8_t ui8Sample[14] = {0x00, 0x64, 0x80, 0x00, 0x01, 0x2C, 0x00, 0x01, 0x00, 0x02, 0x80, 0x00, 0x00, 0x00};
+	ICM20948_i16Vector_t Accel, Gyro;
+	ICM20948_CalRecord_t Record;
+	ICM20948_Frame_t Frames[2];
+	uint16_t ui16Frames;
+
+	/* Reflections, a sensor axis used twice and undefined codes are rejected */
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_NX, ICM20948_AXIS_PY, ICM20948_AXIS_PZ) == -1);
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_PX, ICM20948_AXIS_PX, ICM20948_AXIS_PZ) == -1);
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_PX, ICM20948_AXIS_PY, 0x03) == -1);
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_PX, ICM20948_AXIS_PY, 0x42) == -1);
+
+	/* Rotated by 90 degrees about Z: board X = -sensor Y, board Y = sensor X */
+	Device.setAccelOffset({1, 2, 3});
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_NY, ICM20948_AXIS_PX, ICM20948_AXIS_PZ) == 0);
+	Device.getAccelOffset(&Accel);
+	TEST_CHECK(Accel.i16XAxis == 0 && Accel.i16YAxis == 0 && Accel.i16ZAxis == 0);
+
+	Mock.setSensorData(ui8Sample);
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+	Accel = Device.getAccelRaw();
+	Gyro  = Device.getGyroRaw();
+	TEST_CHECK(Accel.i16XAxis == 32767 && Accel.i16YAxis == 100 && Accel.i16ZAxis == 300);
+	TEST_CHECK(Gyro.i16XAxis == -2 && Gyro.i16YAxis == 1 && Gyro.i16ZAxis == -32768);
+
+	/* The other instance keeps the default orientation */
+	TEST_CHECK(Default.readAllDataRaw() == 0);
+	Accel = Default.getAccelRaw();
+	TEST_CHECK(Accel.i16XAxis == 100 && Accel.i16YAxis == -32768 && Accel.i16ZAxis == 300);
+
+	/* Upside down, FIFO frames */
+	TEST_CHECK(Device.setMount(ICM20948_AXIS_PX, ICM20948_AXIS_NY, ICM20948_AXIS_NZ) == 0);
+	TEST_CHECK(Device.enableFifo(true) == 0);
+	Mock.pushSample(ui8Sample);
+	TEST_CHECK(Device.readFifoFrames(Frames, 2, &ui16Frames) == 0 && ui16Frames == 1);
+	TEST_CHECK(Frames[0].Accel.i16XAxis == 100 && Frames[0].Accel.i16YAxis == 32767 && Frames[0].Accel.i16ZAxis == -300);
+	TEST_CHECK(Frames[0].Gyro.i16XAxis == 1 && Frames[0].Gyro.i16YAxis == -2 && Frames[0].Gyro.i16ZAxis == 32767);
+
+	/* A calibration record only applies to the same orientation */
+	Device.getCalibrationRecord(&Record);
+	TEST_CHECK(Record.ui8MountX == ICM20948_AXIS_PX && Record.ui8MountY == ICM20948_AXIS_NY && Record.ui8MountZ == ICM20948_AXIS_NZ);
+	TEST_CHECK(Device.enableFifo(false) == 0);
+	TEST_CHECK(Device.setCalibrationRecord(&Record) == 0);
+	TEST_CHECK(Default.setCalibrationRecord(&Record) == -1);
+}
+
+
+/* Accelerometer 562.5Hz, gyroscope 1125Hz: the accelerometer registers change with every second gyroscope sample */
+static void pushRateSample(ICM20948_MOCK *pMock, uint8_t ui8Tick)
+{
+	uint8_t ui8Sample[14] = {0};
+
+	ui8Sample[1] = (ui8Tick & 0xFE) * 10;
+	ui8Sample[7] = ui8Tick;
+
+	pMock->pushSample(ui8Sample);
+}
+
+
+/* Multi-rate mode of readLatest(): fresh flags, tick numbering and a missed sample (time base 10 per gyroscope tick) */
+static void testMultiRate(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	ICM20948_Frame_t Frame;
+	uint32_t ui32Age;
+
+	ui32TestTime = 0;
+	TEST_CHECK(Device.setupMultiRate(ACCEL_SR_562_5_HZ, GYRO_SR_1125_HZ, 10) == -1);
+	TEST_CHECK(Device.setupLatest(getTestTime) == 0);
+	TEST_CHECK(Device.setupMultiRate(ACCEL_SR_1125_HZ, GYRO_SR_225_HZ, 10) == 0);
+	TEST_CHECK(Device.setupMultiRate(ACCEL_SR_562_5_HZ, GYRO_SR_1125_HZ, 10) == 0);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ODR_ALIGN_EN) == ICM20948_ODR_ALIGN);
+
+	/* The accelerometer is read and marked with every second tick only */
+	for (uint8_t k = 1; k <= 6; k++)
+	{
+		ui32TestTime = 10 * k;
+		pushRateSample(&Mock, k);
+		TEST_CHECK(Device.readLatest(&Frame, &ui32Age) == 1);
+		TEST_CHECK(Device.getSampleTick() == k);
+		TEST_CHECK(Frame.Gyro.i16XAxis == k && (Frame.ui8Flags & ICM20948_FRAME_GYRO_FRESH));
+		TEST_CHECK(((Frame.ui8Flags & ICM20948_FRAME_ACCEL_FRESH) != 0) == (k % 2 == 0));
+		if (k % 2 == 0) {TEST_CHECK(Frame.Accel.i16XAxis == 10 * k);}
+	}
+
+	/* No new sample */
+	ui32TestTime = 65;
+	TEST_CHECK(Device.readLatest(&Frame, &ui32Age) == 0);
+	TEST_CHECK(Device.getSampleTick() == 6);
+
+	/* Sample 7 is overwritten before the next call: sample 8 gets tick 8, its accelerometer sample is read with tick 9 */
+	pushRateSample(&Mock, 7);
+	ui32TestTime = 80;
+	pushRateSample(&Mock, 8);
+	TEST_CHECK(Device.readLatest(&Frame, &ui32Age) == 1);
+	TEST_CHECK(Device.getSampleTick() == 8 && Frame.Gyro.i16XAxis == 8);
+	TEST_CHECK(!(Frame.ui8Flags & ICM20948_FRAME_ACCEL_FRESH));
+
+	ui32TestTime = 90;
+	pushRateSample(&Mock, 9);
+	TEST_CHECK(Device.readLatest(&Frame, &ui32Age) == 1);
+	TEST_CHECK(Device.getSampleTick() == 9);
+	TEST_CHECK((Frame.ui8Flags & ICM20948_FRAME_ACCEL_FRESH) && Frame.Accel.i16XAxis == 80);
+
+	/* A configuration change ends the mode */
+	TEST_CHECK(Device.setGyroFullScale(GYRO_FS_500DPS) == 0);
+	ui32TestTime = 100;
+	pushRateSample(&Mock, 10);
+	TEST_CHECK(Device.readLatest(&Frame, &ui32Age) == 1);
+	TEST_CHECK(!(Frame.ui8Flags & (ICM20948_FRAME_ACCEL_FRESH | ICM20948_FRAME_GYRO_FRESH)));
+}
+
+
+/* Continuity tracking of readAllDataRaw() and readFifoFrames() at 1125Hz (time base 11250Hz: 10 per sample) */
+static void testContinuity(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	uint8_t ui8Sample[14] = {0};
+	ICM20948_ContinuityStats_t Stats;
+	ICM20948_Gap_t Gaps[4];
+	ICM20948_Frame_t Frames[64];
+	uint16_t ui16Frames;
+
+	ui32TestTime = 0;
+	TEST_CHECK(Device.setupContinuity(0, getTestTime) == -1);
+	TEST_CHECK(Device.setupContinuity(11250, getTestTime) == 0);
+
+	/* Samples 1...5, 3 and 4 are overwritten before they are read */
+	for (uint8_t k = 1; k <= 5; k++)
+	{
+		ui32TestTime = 10 * k;
+		ui8Sample[1] = k;
+		Mock.pushSample(ui8Sample);
+		if (k == 3 || k == 4) {continue;}
+		TEST_CHECK(Device.readAllDataRaw() == 0);
+	}
+
+	/* The same sample again */
+	ui32TestTime = 55;
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+
+	/* A sample ahead of the model (phase of the sensor clock) is no gap */
+	ui32TestTime = 59;
+	ui8Sample[1] = 6;
+	Mock.pushSample(ui8Sample);
+	TEST_CHECK(Device.readAllDataRaw() == 0);
+
+	Device.getContinuityStats(&Stats);
+	TEST_CHECK(Stats.ui32Samples == 4 && Stats.ui32Missed == 2 && Stats.ui32Duplicates == 1);
+	TEST_CHECK(Stats.ui32Overflows == 0 && Stats.ui32Gaps == 2);
+
+	TEST_CHECK(Device.readGapLog(Gaps, 4) == 2);
+	TEST_CHECK(Gaps[0].ui8Type == ICM20948_GAP_MISSED && Gaps[0].ui16Count == 2);
+	TEST_CHECK(Gaps[0].ui32Time == 50 && Gaps[0].ui32Sample == 2);
+	TEST_CHECK(Gaps[1].ui8Type == ICM20948_GAP_DUPLICATE && Gaps[1].ui16Count == 1);
+	TEST_CHECK(Gaps[1].ui32Time == 55 && Gaps[1].ui32Sample == 3);
+	TEST_CHECK(Device.readGapLog(Gaps, 4) == 0);
+
+	/* FIFO (one acquisition path: the tracking is started again), the frames left in the FIFO are not missed */
+	ui32TestTime = 100;
+	TEST_CHECK(Device.enableFifo(true) == 0);
+	TEST_CHECK(Device.setupContinuity(11250, getTestTime) == 0);
+
+	ui32TestTime = 150;
+	for (uint8_t k = 0; k < 5; k++) {Mock.pushSample(ui8Sample);}
+	TEST_CHECK(Device.readFifoFrames(Frames, 3, &ui16Frames) == 0 && ui16Frames == 3);
+	TEST_CHECK(Device.readFifoFrames(Frames, 3, &ui16Frames) == 0 && ui16Frames == 2);
+	Device.getContinuityStats(&Stats);
+	TEST_CHECK(Stats.ui32Samples == 5 && Stats.ui32Missed == 0 && Stats.ui32Gaps == 0);
+
+	/* 50 frames in this time, the FIFO keeps the last ICM20948_FIFO_SIZE bytes */
+	ui32TestTime = 650;
+	for (uint8_t k = 0; k < 50; k++) {Mock.pushSample(ui8Sample);}
+	TEST_CHECK(Device.readFifoFrames(Frames, 64, &ui16Frames) == 0);
+	Device.getContinuityStats(&Stats);
+	TEST_CHECK(Stats.ui32Overflows == 1);
+	TEST_CHECK(Stats.ui32Samples == 5u + ui16Frames && Stats.ui32Missed == 50u - ui16Frames);
+	TEST_CHECK(Device.readGapLog(Gaps, 4) == 2);
+	TEST_CHECK(Gaps[0].ui8Type == ICM20948_GAP_OVERFLOW && Gaps[1].ui8Type == ICM20948_GAP_MISSED);
+	TEST_CHECK(Gaps[1].ui16Count == 50 - ui16Frames);
+}
+
+
+int main(void)
+{
+	testBurst();
+	testFifoStream();
+	testMemStream();
+	testBankSwitch();
+	testSpeedViolations();
+	testDriver();
+	testFifoRates();
+	testEpochSwitch();
+	testDmp();
+	testMount();
+	testMultiRate();
+	testContinuity();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,156 @@
+/*
+ * test_selftest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Self-test (exeSelfTest()) on the register emulator: the time base samples the emulator and adds a response on
+ * the actuated axes, the result is checked per axis against the factory codes and the absolute limits */
+#include "icm20948.hpp"
+#include "test.hpp"
+
+
+/* Sensor at rest: accelerometer 0, 0, 16384, gyroscope 10, 10, 10 */
+static const int16_t TEST_ACCEL_REST[3] = {0, 0, 16384};
+static const int16_t TEST_GYRO_REST[3]  = {10, 10, 10};
+
+/* Actuation bits of the axes X, Y, Z (ACCEL_CONFIG_2 and GYRO_CONFIG_2, bank 2) */
+static const uint8_t TEST_ACCEL_ST[3] = {0x10, 0x08, 0x04};
+static const uint8_t TEST_GYRO_ST[3]  = {0x20, 0x10, 0x08};
+
+/* Register emulator that samples while the driver waits (one sample per millisecond) */
+static ICM20948_MOCK *pSamplingMock = NULL;
+
+/* Response of the actuated axes [LSB], set by the test */
+static int16_t i16AccelResponse[3];
+static int16_t i16GyroResponse[3];
+
+
+static void pushSample(ICM20948_MOCK *pMock)
+{
+	uint8_t ui8AccelST = pMock->getRegister(2, ICM20948_ACCEL_CONFIG_2);
+	uint8_t ui8GyroST  = pMock->getRegister(2, ICM20948_GYRO_CONFIG_2);
+	uint8_t ui8Sample[14] = {0};
+	int16_t i16Value;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		i16Value = TEST_ACCEL_REST[i] + ((ui8AccelST & TEST_ACCEL_ST[i]) ? i16AccelResponse[i] : 0);
+		ui8Sample[2 * i]     = (uint16_t)i16Value >> 8;
+		ui8Sample[2 * i + 1] = (uint16_t)i16Value;
+
+		i16Value = TEST_GYRO_REST[i] + ((ui8GyroST & TEST_GYRO_ST[i]) ? i16GyroResponse[i] : 0);
+		ui8Sample[6 + 2 * i] = (uint16_t)i16Value >> 8;
+		ui8Sample[7 + 2 * i] = (uint16_t)i16Value;
+	}
+
+	pMock->pushSample(ui8Sample);
+}
+
+
+/* Time base of the driver: 1ms every 4 calls */
+extern "C" uint32_t get_Ticks(void)
+{
+	static uint32_t ui32Calls = 0;
+
+	if (pSamplingMock != NULL && ui32Calls % 4 == 0) {pushSample(pSamplingMock);}
+
+	return ui32Calls++ / 4;
+}
+
+
+/* Factory codes of all gyroscope axes and all accelerometer axes (SELF_TEST_x, bank 1) */
+static void setCodes(ICM20948_MOCK *pMock, uint8_t ui8GyroCode, uint8_t ui8AccelCode)
+{
+	pMock->setRegister(1, ICM20948_SELF_TEST_X_GYRO, ui8GyroCode);
+	pMock->setRegister(1, ICM20948_SELF_TEST_Y_GYRO, ui8GyroCode);
+	pMock->setRegister(1, ICM20948_SELF_TEST_Z_GYRO, ui8GyroCode);
+	pMock->setRegister(1, ICM20948_SELF_TEST_X_ACCEL, ui8AccelCode);
+	pMock->setRegister(1, ICM20948_SELF_TEST_Y_ACCEL, ui8AccelCode);
+	pMock->setRegister(1, ICM20948_SELF_TEST_Z_ACCEL, ui8AccelCode);
+}
+
+
+static int16_t runSelfTest(ICM20948_MOCK *pMock, ICM20948 *pDevice, const int16_t *pAccel, const int16_t *pGyro,
+						   ICM20948_SelfTest_t *pResult)
+{
+	int16_t i16RetValue;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		i16AccelResponse[i] = pAccel[i];
+		i16GyroResponse[i]  = pGyro[i];
+	}
+
+	pSamplingMock = pMock;
+	i16RetValue = pDevice->exeSelfTest(pResult);
+	pSamplingMock = NULL;
+
+	return i16RetValue;
+}
+
+
+/* Factory code 1: factory response ICM20948_ST_TRIM_BASE */
+static void testFactoryCodes(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_4G, GYRO_FS_500DPS, ACCEL_SR_225_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	const int16_t i16AccelPass[3] = {2620, -2620, 2000};
+	const int16_t i16GyroPass[3]  = {2620, 1400, -9000};
+	/* Ratios: accelerometer 1.91, 0.76, 0.38, gyroscope 0.38, 3.44, 0.496 */
+	const int16_t i16AccelMixed[3] = {5000, -2000, 1000};
+	const int16_t i16GyroMixed[3]  = {1000, 9000, 1300};
+	ICM20948_SelfTest_t Result;
+
+	setCodes(&Mock, 1, 1);
+
+	TEST_CHECK(runSelfTest(&Mock, &Device, i16AccelPass, i16GyroPass, &Result) == 0);
+	TEST_CHECK(Result.ui8AccelPass == ICM20948_ST_ALL && Result.ui8GyroPass == ICM20948_ST_ALL);
+	TEST_CHECK(Result.AccelResponse.i32XAxis == 2620 && Result.AccelResponse.i32YAxis == 2620 && Result.AccelResponse.i32ZAxis == 2000);
+	TEST_CHECK(Result.GyroResponse.i32XAxis == 2620 && Result.GyroResponse.i32YAxis == 1400 && Result.GyroResponse.i32ZAxis == 9000);
+	TEST_CHECK(Result.AccelRatio.fXAxis > 0.999f && Result.AccelRatio.fXAxis < 1.001f);
+
+	TEST_CHECK(runSelfTest(&Mock, &Device, i16AccelMixed, i16GyroMixed, &Result) == 1);
+	TEST_CHECK(Result.ui8AccelPass == ICM20948_ST_Y);
+	TEST_CHECK(Result.ui8GyroPass == ICM20948_ST_Y);
+	TEST_CHECK(Result.AccelResponse.i32XAxis == 5000 && Result.GyroResponse.i32ZAxis == 1300);
+
+	/* The configuration of the constructor is restored */
+	TEST_CHECK((Mock.getRegister(2, ICM20948_ACCEL_CONFIG) & ICM20948_ACCEL_FS_SEL) == ACCEL_FS_4G.ui8Selection);
+	TEST_CHECK((Mock.getRegister(2, ICM20948_GYRO_CONFIG_1) & ICM20948_GYRO_FS_SEL) == GYRO_FS_500DPS.ui8Selection);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ACCEL_SMPLRT_DIV_2) == ACCEL_SR_225_HZ.ui16Div);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ACCEL_CONFIG_2) == 0x00 && Mock.getRegister(2, ICM20948_GYRO_CONFIG_2) == 0x00);
+	TEST_CHECK(!(Mock.getRegister(0, ICM20948_USER_CTRL) & ICM20948_FIFO_EN));
+}
+
+
+/* Factory code 0: absolute limits ICM20948_ST_GYRO_MIN and ICM20948_ST_ACCEL_MIN...ICM20948_ST_ACCEL_MAX */
+static void testAbsoluteLimits(void)
+{
+	ICM20948_MOCK Mock;
+	ICM20948 Device(&Mock, ACCEL_FS_2G, GYRO_FS_250DPS, ACCEL_SR_1125_HZ, GYRO_SR_1125_HZ, ICM20948_DLPF_3);
+	const int16_t i16Accel[3] = {ICM20948_ST_ACCEL_MIN, ICM20948_ST_ACCEL_MIN - 1, ICM20948_ST_ACCEL_MAX + 1};
+	const int16_t i16Gyro[3]  = {ICM20948_ST_GYRO_MIN - 1, -ICM20948_ST_GYRO_MIN, 12000};
+	ICM20948_SelfTest_t Result;
+
+	setCodes(&Mock, 0, 0);
+
+	TEST_CHECK(runSelfTest(&Mock, &Device, i16Accel, i16Gyro, &Result) == 1);
+	TEST_CHECK(Result.ui8AccelPass == ICM20948_ST_X);
+	TEST_CHECK(Result.ui8GyroPass == (ICM20948_ST_Y | ICM20948_ST_Z));
+	TEST_CHECK(Result.AccelRatio.fXAxis == 0.0f && Result.GyroRatio.fZAxis == 0.0f);
+
+	/* No samples: the sensor does not respond at all */
+	TEST_CHECK(Device.exeSelfTest(&Result) == -1);
+	TEST_CHECK(Mock.getRegister(2, ICM20948_ACCEL_CONFIG_2) == 0x00 && Mock.getRegister(2, ICM20948_GYRO_CONFIG_2) == 0x00);
+}
+
+
+int main(void)
+{
+	testFactoryCodes();
+	testAbsoluteLimits();
+
+	return TEST_RESULT();
+}
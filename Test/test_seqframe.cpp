@@ -0,0 +1,157 @@
+/*
+ * test_seqframe.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Publication of the latest frame with SEQFRAME: one writer thread, several reader threads, no torn copies */
+#include <atomic>
+#include <thread>
+
+#include "seqframe.hpp"
+#include "test.hpp"
+
+
+#define TEST_READERS       3
+#define TEST_PUBLICATIONS  1000000
+
+
+/* Frame of a publication: every field depends on the sequence, the temperature is a checksum of the others */
+static void makeFrame(uint32_t ui32Sequence, ICM20948_Frame_t *pFrame, uint64_t *pTimestamp)
+{
+	uint64_t ui64X = ui32Sequence * 0x9E3779B97F4A7C15ULL;
+
+	pFrame->Accel.i16XAxis = (int16_t)(ui64X);
+	pFrame->Accel.i16YAxis = (int16_t)(ui64X >> 16);
+	pFrame->Accel.i16ZAxis = (int16_t)(ui64X >> 32);
+	pFrame->Gyro.i16XAxis  = (int16_t)(ui64X >> 48);
+	pFrame->Gyro.i16YAxis  = (int16_t)(ui64X >> 8);
+	pFrame->Gyro.i16ZAxis  = (int16_t)(ui64X >> 24);
+	pFrame->ui8Epoch       = (uint8_t)ui32Sequence;
+	pFrame->ui8Flags       = (uint8_t)(ui32Sequence >> 8);
+	pFrame->ui8Range       = (uint8_t)(ui32Sequence >> 16);
+	pFrame->i16Temperature = 0;
+
+	*pTimestamp = ui64X ^ 0xFFFFFFFFULL;
+}
+
+
+static int16_t getChecksum(const ICM20948_Frame_t *pFrame, uint32_t ui32Sequence)
+{
+	uint16_t ui16Sum = (uint16_t)ui32Sequence ^ (uint16_t)(ui32Sequence >> 16);
+
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Accel.i16XAxis;
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Accel.i16YAxis;
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Accel.i16ZAxis;
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Gyro.i16XAxis;
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Gyro.i16YAxis;
+	ui16Sum = ui16Sum * 31 + (uint16_t)pFrame->Gyro.i16ZAxis;
+	ui16Sum = ui16Sum * 31 + pFrame->ui8Epoch + (pFrame->ui8Flags << 8);
+	ui16Sum = ui16Sum * 31 + pFrame->ui8Range;
+
+	return (int16_t)ui16Sum;
+}
+
+
+/* Field by field, the padding of ICM20948_Frame_t is not defined */
+static bool isEqual(const ICM20948_Frame_t *pA, const ICM20948_Frame_t *pB)
+{
+	return pA->Accel.i16XAxis == pB->Accel.i16XAxis && pA->Accel.i16YAxis == pB->Accel.i16YAxis &&
+		   pA->Accel.i16ZAxis == pB->Accel.i16ZAxis && pA->Gyro.i16XAxis == pB->Gyro.i16XAxis &&
+		   pA->Gyro.i16YAxis == pB->Gyro.i16YAxis && pA->Gyro.i16ZAxis == pB->Gyro.i16ZAxis &&
+		   pA->i16Temperature == pB->i16Temperature && pA->ui8Epoch == pB->ui8Epoch &&
+		   pA->ui8Flags == pB->ui8Flags && pA->ui8Range == pB->ui8Range;
+}
+
+
+static void testSingle(void)
+{
+	SEQFRAME Seqframe;
+	SEQFRAME_Sample_t Sample;
+	ICM20948_Frame_t Frame;
+	uint64_t ui64Timestamp;
+
+	/* Nothing published yet */
+	TEST_CHECK(Seqframe.read(&Sample) == -1);
+	TEST_CHECK(Seqframe.getSequence() == 0);
+
+	makeFrame(1, &Frame, &ui64Timestamp);
+	Seqframe.publish(&Frame, ui64Timestamp);
+
+	TEST_CHECK(Seqframe.read(&Sample) == 0);
+	TEST_CHECK(Sample.ui32Sequence == 1 && Seqframe.getSequence() == 1);
+	TEST_CHECK(Sample.ui64Timestamp == ui64Timestamp);
+	TEST_CHECK(isEqual(&Sample.Frame, &Frame));
+}
+
+
+static void testStress(void)
+{
+	SEQFRAME Seqframe;
+	std::atomic<bool> boDone(false);
+	std::atomic<uint32_t> ui32Torn(0), ui32Reads(0), ui32Backwards(0);
+	std::thread Readers[TEST_READERS];
+
+	for (uint8_t r = 0; r < TEST_READERS; r++)
+	{
+		Readers[r] = std::thread([&]()
+		{
+			SEQFRAME_Sample_t Sample;
+			ICM20948_Frame_t Expected;
+			uint64_t ui64Timestamp;
+			uint32_t ui32Last = 0;
+
+			while (!boDone.load(std::memory_order_relaxed))
+			{
+				if (Seqframe.read(&Sample) < 0) {continue;}
+
+				/* The frame, the timestamp and the sequence of one copy belong to the same publication */
+				makeFrame(Sample.ui32Sequence, &Expected, &ui64Timestamp);
+				Expected.i16Temperature = getChecksum(&Expected, Sample.ui32Sequence);
+
+				if (Sample.Frame.i16Temperature != getChecksum(&Sample.Frame, Sample.ui32Sequence) ||
+					!isEqual(&Sample.Frame, &Expected) ||
+					Sample.ui64Timestamp != ui64Timestamp)
+				{
+					ui32Torn++;
+				}
+
+				if (Sample.ui32Sequence < ui32Last) {ui32Backwards++;}
+				ui32Last = Sample.ui32Sequence;
+
+				ui32Reads++;
+			}
+		});
+	}
+
+	{
+		ICM20948_Frame_t Frame;
+		uint64_t ui64Timestamp;
+
+		for (uint32_t i = 1; i <= TEST_PUBLICATIONS; i++)
+		{
+			makeFrame(i, &Frame, &ui64Timestamp);
+			Frame.i16Temperature = getChecksum(&Frame, i);
+			Seqframe.publish(&Frame, ui64Timestamp);
+		}
+	}
+
+	boDone = true;
+
+	for (uint8_t r = 0; r < TEST_READERS; r++) {Readers[r].join();}
+
+	TEST_CHECK(ui32Reads > 0);
+	TEST_CHECK(ui32Torn == 0);
+	TEST_CHECK(ui32Backwards == 0);
+	TEST_CHECK(Seqframe.getSequence() == TEST_PUBLICATIONS);
+}
+
+
+int main(void)
+{
+	testSingle();
+	testStress();
+
+	return TEST_RESULT();
+}
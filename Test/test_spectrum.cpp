@@ -0,0 +1,154 @@
+/*
+ * test_spectrum.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* SPECTRUM: the Welch PSD of the FFT (radix-2^2 with and without the radix-2 stage) against a direct DFT in double
+ * precision of the same windows. Tolerance: every bin within TEST_TOLERANCE of the largest reference bin of its
+ * axis (single precision FFT). */
+#include <cmath>
+#include <vector>
+
+#include "spectrum.hpp"
+#include "test.hpp"
+
+
+#define TEST_SAMPLE_RATE  1125.0
+#define TEST_TOLERANCE    1.0e-4
+#define TEST_AVERAGES     4
+#define TEST_TONE_FREQ    100.0   // X axis [Hz], between two bins
+#define TEST_TONE_AMPL    0.5     // [g]
+
+
+/* ACCEL_FS_2G, frames as converted by SPECTRUM */
+static const double TEST_SENS = 2.0 / 32768;
+
+
+/* X: tone, Y: white noise (LCG, uniform +-0.25g), Z: 1g */
+static void makeFrames(std::vector<ICM20948_Frame_t> *pFrames)
+{
+	uint32_t ui32Seed = 4711;
+
+	for (uint32_t i = 0; i < pFrames->size(); i++)
+	{
+		ui32Seed = ui32Seed * 1664525 + 1013904223;
+
+		(*pFrames)[i].Accel.i16XAxis = (int16_t)std::lround(TEST_TONE_AMPL * std::sin(2.0 * M_PI * TEST_TONE_FREQ * i / TEST_SAMPLE_RATE) / TEST_SENS);
+		(*pFrames)[i].Accel.i16YAxis = (int16_t)((int32_t)(ui32Seed >> 16) - 32768) / 8;
+		(*pFrames)[i].Accel.i16ZAxis = 16384;
+		(*pFrames)[i].Gyro           = {0, 0, 0};
+		(*pFrames)[i].i16Temperature = 0;
+		(*pFrames)[i].ui8Epoch       = 0;
+		(*pFrames)[i].ui8Flags       = 0;
+		(*pFrames)[i].ui8Range       = ICM20948_RANGE(ACCEL_FS_2G, GYRO_FS_250DPS);
+	}
+}
+
+
+/* Welch PSD with the definitions of SPECTRUM: mean removed, periodic Hann window, one-sided, DC and Nyquist not
+ * doubled */
+static void calcReference(const std::vector<ICM20948_Frame_t> &Frames, uint8_t ui8Axis, uint16_t ui16Size,
+						  uint16_t ui16Hop, std::vector<double> *pPsd)
+{
+	std::vector<double> Window(ui16Size), Input(ui16Size);
+	double dSum = 0.0, dScale, dMean, dRe, dIm;
+
+	for (uint16_t n = 0; n < ui16Size; n++)
+	{
+		Window[n] = 0.5 - 0.5 * std::cos(2.0 * M_PI * n / ui16Size);
+		dSum += Window[n] * Window[n];
+	}
+	dScale = 2.0 / (TEST_SAMPLE_RATE * dSum);
+
+	pPsd->assign(ui16Size / 2 + 1, 0.0);
+
+	for (uint16_t w = 0; w < TEST_AVERAGES; w++)
+	{
+		dMean = 0.0;
+		for (uint16_t n = 0; n < ui16Size; n++)
+		{
+			const ICM20948_i16Vector_t &Accel = Frames[w * ui16Hop + n].Accel;
+
+			Input[n] = ((ui8Axis == 0) ? Accel.i16XAxis : (ui8Axis == 1) ? Accel.i16YAxis : Accel.i16ZAxis) * TEST_SENS;
+			dMean += Input[n];
+		}
+		dMean /= ui16Size;
+
+		for (uint16_t k = 0; k <= ui16Size / 2; k++)
+		{
+			dRe = 0.0;
+			dIm = 0.0;
+			for (uint16_t n = 0; n < ui16Size; n++)
+			{
+				dRe += (Input[n] - dMean) * Window[n] * std::cos(2.0 * M_PI * k * n / ui16Size);
+				dIm -= (Input[n] - dMean) * Window[n] * std::sin(2.0 * M_PI * k * n / ui16Size);
+			}
+
+			(*pPsd)[k] += ((k == 0 || k == ui16Size / 2) ? 0.5 : 1.0) * dScale * (dRe * dRe + dIm * dIm) / TEST_AVERAGES;
+		}
+	}
+}
+
+
+static void testSize(uint16_t ui16Size)
+{
+	static SPECTRUM Spectrum;
+	const uint16_t ui16Hop = ui16Size / 2;
+	SPECTRUM_Config_t Config = {(float)TEST_SAMPLE_RATE, ui16Size, ui16Hop, TEST_AVERAGES, 0, {}};
+	std::vector<ICM20948_Frame_t> Frames((TEST_AVERAGES - 1) * ui16Hop + ui16Size);
+	std::vector<double> Reference;
+	float fPsd[SPECTRUM_MAX_SIZE / 2 + 1];
+	SPECTRUM_Summary_t Summary;
+	double dMax, dError;
+	uint16_t ui16Bins;
+
+	makeFrames(&Frames);
+
+	TEST_CHECK(Spectrum.init(&Config) == 0);
+	TEST_CHECK(Spectrum.process(Frames.data(), Frames.size() - 1) == 0);
+	TEST_CHECK(Spectrum.process(&Frames[Frames.size() - 1], 1) == 1);
+	Spectrum.getSummary(&Summary);
+	TEST_CHECK(Summary.ui16Windows == TEST_AVERAGES);
+
+	for (uint8_t a = 0; a < 2; a++)
+	{
+		calcReference(Frames, a, ui16Size, ui16Hop, &Reference);
+		TEST_CHECK(Spectrum.getPsd(a, fPsd, SPECTRUM_MAX_SIZE / 2 + 1, &ui16Bins) == 0 && ui16Bins == ui16Size / 2 + 1);
+
+		dMax   = 0.0;
+		dError = 0.0;
+		for (uint16_t k = 0; k < ui16Bins; k++)
+		{
+			if (Reference[k] > dMax) {dMax = Reference[k];}
+		}
+		for (uint16_t k = 0; k < ui16Bins; k++)
+		{
+			if (std::fabs(fPsd[k] - Reference[k]) > dError) {dError = std::fabs(fPsd[k] - Reference[k]);}
+		}
+
+		if (dError > TEST_TOLERANCE * dMax) {printf("N=%u axis %u: error %g of %g\n", ui16Size, a, dError, dMax);}
+		TEST_CHECK(dMax > 0.0 && dError <= TEST_TOLERANCE * dMax);
+	}
+
+	/* Tone: peak at the nearest bin, RMS of the sine (the Hann window keeps the power) */
+	TEST_CHECK(std::fabs(Summary.fPeakFreq[0] - TEST_TONE_FREQ) <= 0.5 * Spectrum.getBinWidth());
+	TEST_CHECK(std::fabs(Summary.fRms[0] - TEST_TONE_AMPL / std::sqrt(2.0)) < 0.01 * TEST_TONE_AMPL);
+
+	/* White noise: uniform +-0.25g has an RMS of 0.25 / sqrt(3) */
+	TEST_CHECK(std::fabs(Summary.fRms[1] - 0.25 / std::sqrt(3.0)) < 0.1 * 0.25 / std::sqrt(3.0));
+
+	/* Constant: no power without DC */
+	TEST_CHECK(Summary.fRms[2] < 1.0e-6f);
+}
+
+
+int main(void)
+{
+	/* log2(N/2) odd: radix-2^2 stages and the radix-2 stage, even: radix-2^2 stages only */
+	testSize(256);
+	testSize(512);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,18 @@
+/*
+ * test_ticks.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+/* Time base of the host tests that link the driver */
+#include <stdint.h>
+
+
+/* Deterministic time base of the driver delays: one millisecond per four calls */
+extern "C" uint32_t get_Ticks(void)
+{
+	static uint32_t ui32Calls = 0;
+
+	return ui32Calls++ / 4;
+}